@@ -20,6 +20,7 @@
 package advisor
 
 import (
+	"bytes"
 	"encoding/json"
 	"os"
 	"path/filepath"
@@ -63,21 +64,49 @@ type CommandDB interface {
 // results to make the changes live, or Rollback to abort; either of
 // these closes the database again.
 func Create() (CommandDB, error) {
-	var err error
-	t := &writer{
+	t := newWriter()
+	if err := t.open(); err != nil {
+		return nil, err
+	}
+	return t, nil
+}
+
+// copyCommandsDB opens a copy of the commands database for writing, like
+// Create, with its contents to change before renaming it into place on
+// Commit.
+func copyCommandsDB() (*writer, error) {
+	t := newWriter()
+	// the database in place is only ever replaced, never written to
+	if err := osutil.CopyFile(dirs.SnapCommandsDB, t.fn, osutil.CopyFlagDefault); err != nil {
+		return nil, err
+	}
+	if err := t.open(); err != nil {
+		os.Remove(t.fn)
+		return nil, err
+	}
+	return t, nil
+}
+
+func newWriter() *writer {
+	return &writer{
 		fn: dirs.SnapCommandsDB + "." + strutil.MakeRandomString(12) + "~",
 	}
+}
 
+// open opens the database and starts a transaction, creating the
+// buckets if missing.
+func (t *writer) open() error {
+	var err error
 	t.db, err = bolt.Open(t.fn, 0644, &bolt.Options{Timeout: 1 * time.Second})
 	if err != nil {
-		return nil, err
+		return err
 	}
 
 	t.tx, err = t.db.Begin(true)
 	if err == nil {
-		t.cmdBucket, err = t.tx.CreateBucket(cmdBucketKey)
+		t.cmdBucket, err = t.tx.CreateBucketIfNotExists(cmdBucketKey)
 		if err == nil {
-			t.pkgBucket, err = t.tx.CreateBucket(pkgBucketKey)
+			t.pkgBucket, err = t.tx.CreateBucketIfNotExists(pkgBucketKey)
 		}
 
 		if err != nil {
@@ -87,10 +116,10 @@ func Create() (CommandDB, error) {
 
 	if err != nil {
 		t.db.Close()
-		return nil, err
+		return err
 	}
 
-	return t, nil
+	return nil
 }
 
 func (t *writer) AddSnap(snapName, version, summary string, commands []string) error {
@@ -131,12 +160,63 @@ func (t *writer) AddSnap(snapName, version, summary string, commands []string) e
 	return nil
 }
 
+// syncRows makes the buckets hold exactly the given rows, already
+// encoded, writing only the ones that changed and deleting the ones that
+// are gone.
+func (t *writer) syncRows(cmdRows, pkgRows map[string][]byte) error {
+	if err := syncBucket(t.cmdBucket, cmdRows); err != nil {
+		return err
+	}
+	return syncBucket(t.pkgBucket, pkgRows)
+}
+
+func syncBucket(b *bolt.Bucket, rows map[string][]byte) error {
+	var gone [][]byte
+	c := b.Cursor()
+	for k, _ := c.First(); k != nil; k, _ = c.Next() {
+		if _, ok := rows[string(k)]; !ok {
+			// k is only valid during the transaction, and the
+			// bucket cannot be changed while iterating
+			gone = append(gone, append([]byte(nil), k...))
+		}
+	}
+	for _, k := range gone {
+		if err := b.Delete(k); err != nil {
+			return err
+		}
+	}
+	for k, row := range rows {
+		if bytes.Equal(b.Get([]byte(k)), row) {
+			continue
+		}
+		if err := b.Put([]byte(k), row); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
 func (t *writer) Commit() error {
 	// either everything worked, and therefore this will fail, or something
 	// will fail, and that error is more important than this one if this one
 	// then fails as well. So, ignore the error.
 	defer os.Remove(t.fn)
 
+	if t.tx == nil {
+		// already committed or rolled back
+		return t.done(true)
+	}
+	index, err := buildIndex(t.tx)
+	if err != nil {
+		t.done(false)
+		return err
+	}
+	// the index describes the old database until rewritten
+	if err := os.Remove(dirs.SnapCommandsIndex); err != nil && !os.IsNotExist(err) {
+		t.done(false)
+		return err
+	}
+
 	if err := t.done(true); err != nil {
 		return err
 	}
@@ -151,7 +231,11 @@ func (t *writer) Commit() error {
 		return err
 	}
 
-	return dir.Sync()
+	if err := dir.Sync(); err != nil {
+		return err
+	}
+
+	return writeIndex(index)
 }
 
 func (t *writer) Rollback() error {
@@ -186,6 +270,145 @@ func (t *writer) done(commit bool) error {
 	return e1
 }
 
+// updater collects the snaps of a new catalog in memory, to apply on
+// Commit only its differences with the existing database.
+type updater struct {
+	cmds map[string][]Package
+	pkgs map[string]Package
+	done bool
+}
+
+// Update returns a CommandDB that, like the one returned by Create,
+// replaces the contents of the commands database with the snaps added
+// to it. On Commit however the existing database is left alone if it is
+// already up to date, otherwise the rows that changed are written to a
+// copy of it, and the ones that are gone deleted, before renaming it into
+// place as done by Create.
+func Update() (CommandDB, error) {
+	return &updater{
+		cmds: make(map[string][]Package),
+		pkgs: make(map[string]Package),
+	}, nil
+}
+
+func (u *updater) AddSnap(snapName, version, summary string, commands []string) error {
+	for _, cmd := range commands {
+		// For the mapping of command->snap we do not need the summary, nothing is using that.
+		u.cmds[cmd] = append(u.cmds[cmd], Package{Snap: snapName, Version: version})
+	}
+	u.pkgs[snapName] = Package{
+		Snap:    snapName,
+		Version: version,
+		Summary: summary,
+	}
+	return nil
+}
+
+func (u *updater) Commit() error {
+	if u.done {
+		return nil
+	}
+	u.done = true
+
+	cmdRows := make(map[string][]byte, len(u.cmds))
+	for cmd, sil := range u.cmds {
+		row, err := json.Marshal(sil)
+		if err != nil {
+			return err
+		}
+		cmdRows[cmd] = row
+	}
+	pkgRows := make(map[string][]byte, len(u.pkgs))
+	for snapName, pkg := range u.pkgs {
+		row, err := json.Marshal(pkg)
+		if err != nil {
+			return err
+		}
+		pkgRows[snapName] = row
+	}
+
+	upToDate, index, err := compareCommandsDB(cmdRows, pkgRows)
+	if err != nil {
+		return err
+	}
+	if upToDate {
+		if index == nil {
+			return nil
+		}
+		return writeIndex(index)
+	}
+
+	var t *writer
+	if osutil.FileExists(dirs.SnapCommandsDB) {
+		t, err = copyCommandsDB()
+	} else {
+		t = newWriter()
+		err = t.open()
+	}
+	if err != nil {
+		return err
+	}
+	if err := t.syncRows(cmdRows, pkgRows); err != nil {
+		t.Rollback()
+		return err
+	}
+	return t.Commit()
+}
+
+func (u *updater) Rollback() error {
+	u.done = true
+	return nil
+}
+
+// compareCommandsDB returns whether the existing commands database holds
+// exactly the given rows, without locking it for writing. If it does but
+// the commands index is not current, the index for it is returned too.
+func compareCommandsDB(cmdRows, pkgRows map[string][]byte) (upToDate bool, index []byte, err error) {
+	if !osutil.FileExists(dirs.SnapCommandsDB) {
+		return false, nil, nil
+	}
+	hadIndex := indexIsCurrent()
+	db, err := bolt.Open(dirs.SnapCommandsDB, 0644, &bolt.Options{
+		ReadOnly: true,
+		Timeout:  1 * time.Second,
+	})
+	if err != nil {
+		return false, nil, err
+	}
+	defer db.Close()
+
+	err = db.View(func(tx *bolt.Tx) error {
+		upToDate = bucketHolds(tx, cmdBucketKey, cmdRows) && bucketHolds(tx, pkgBucketKey, pkgRows)
+		if upToDate && !hadIndex {
+			index, err = buildIndex(tx)
+		}
+		return err
+	})
+	if err != nil {
+		return false, nil, err
+	}
+	return upToDate, index, nil
+}
+
+// bucketHolds returns whether the bucket with the given key holds exactly
+// the given rows.
+func bucketHolds(tx *bolt.Tx, key []byte, rows map[string][]byte) bool {
+	b := tx.Bucket(key)
+	if b == nil {
+		return false
+	}
+	n := 0
+	c := b.Cursor()
+	for k, v := c.First(); k != nil; k, v = c.Next() {
+		row, ok := rows[string(k)]
+		if !ok || !bytes.Equal(v, row) {
+			return false
+		}
+		n++
+	}
+	return n == len(rows)
+}
+
 // DumpCommands returns the whole database as a map. For use in
 // testing and debugging.
 func DumpCommands() (map[string]string, error) {
@@ -222,7 +445,8 @@ type boltFinder struct {
 	*bolt.DB
 }
 
-// Open the database for reading.
+// Open the database for reading. The memory mapped commands index is
+// used when it is current, the database itself otherwise.
 func Open() (Finder, error) {
 	// Check for missing file manually to workaround bug in bolt.
 	// bolt.Open() is using os.OpenFile(.., os.O_RDONLY |
@@ -231,6 +455,13 @@ func Open() (Finder, error) {
 	if !osutil.FileExists(dirs.SnapCommandsDB) {
 		return nil, os.ErrNotExist
 	}
+	if finder, err := openIndex(); err == nil {
+		return finder, nil
+	}
+	return openBoltFinder()
+}
+
+func openBoltFinder() (Finder, error) {
 	db, err := bolt.Open(dirs.SnapCommandsDB, 0644, &bolt.Options{
 		ReadOnly: true,
 		Timeout:  1 * time.Second,
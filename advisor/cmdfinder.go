@@ -95,6 +95,14 @@ func FindMisspelledCommand(command string) ([]Command, error) {
 	}
 	defer finder.Close()
 
+	if mf, ok := finder.(misspelledCommandFinder); ok {
+		return mf.FindMisspelledCommand(command)
+	}
+	return findSimilarCommands(finder, command)
+}
+
+// findSimilarCommands looks up each of the similarWords of command.
+func findSimilarCommands(finder Finder, command string) ([]Command, error) {
 	alternatives := make([]Command, 0, 32)
 	for _, w := range similarWords(command) {
 		res, err := finder.FindCommand(w)
@@ -20,7 +20,9 @@
 package advisor_test
 
 import (
+	"io/ioutil"
 	"os"
+	"path/filepath"
 	"sort"
 	"testing"
 
@@ -135,6 +137,93 @@ func (s *cmdfinderSuite) TestDumpCommands(c *C) {
 	})
 }
 
+func (s *cmdfinderSuite) TestUpdate(c *C) {
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	c.Assert(db.AddSnap("bar", "2.1", "bar summary", []string{"bar", "meh"}), IsNil)
+	c.Assert(db.AddSnap("baz", "3.0", "baz summary", []string{"baz"}), IsNil)
+	c.Assert(db.Commit(), IsNil)
+
+	cmds, err := advisor.DumpCommands()
+	c.Assert(err, IsNil)
+	c.Check(cmds, DeepEquals, map[string]string{
+		"bar": `[{"snap":"bar","version":"2.1"}]`,
+		"baz": `[{"snap":"baz","version":"3.0"}]`,
+		"meh": `[{"snap":"bar","version":"2.1"}]`,
+	})
+
+	pkg, err := advisor.FindPackage("foo")
+	c.Assert(err, IsNil)
+	c.Check(pkg, IsNil)
+	pkg, err = advisor.FindPackage("baz")
+	c.Assert(err, IsNil)
+	c.Check(pkg, DeepEquals, &advisor.Package{Snap: "baz", Version: "3.0", Summary: "baz summary"})
+}
+
+func (s *cmdfinderSuite) TestUpdateReplacesDatabase(c *C) {
+	before, err := os.Stat(dirs.SnapCommandsDB)
+	c.Assert(err, IsNil)
+
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	c.Assert(db.AddSnap("foo", "1.1", "foo summary", []string{"foo", "meh"}), IsNil)
+	c.Assert(db.Commit(), IsNil)
+
+	// the new database was written aside and renamed into place
+	after, err := os.Stat(dirs.SnapCommandsDB)
+	c.Assert(err, IsNil)
+	c.Check(os.SameFile(before, after), Equals, false)
+	matches, err := filepath.Glob(dirs.SnapCommandsDB + ".*~")
+	c.Assert(err, IsNil)
+	c.Check(matches, HasLen, 0)
+
+	cmds, err := advisor.FindCommand("foo")
+	c.Assert(err, IsNil)
+	c.Check(cmds, DeepEquals, []advisor.Command{{Snap: "foo", Version: "1.1", Command: "foo"}})
+}
+
+func (s *cmdfinderSuite) TestUpdateUnchangedWritesNothing(c *C) {
+	before, err := ioutil.ReadFile(dirs.SnapCommandsDB)
+	c.Assert(err, IsNil)
+
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	c.Assert(db.AddSnap("foo", "1.0", "foo summary", []string{"foo", "meh"}), IsNil)
+	c.Assert(db.AddSnap("bar", "2.0", "bar summary", []string{"bar", "meh"}), IsNil)
+	c.Assert(db.Commit(), IsNil)
+
+	// not even a new transaction id got written
+	c.Check(dirs.SnapCommandsDB, testutil.FileEquals, before)
+}
+
+func (s *cmdfinderSuite) TestUpdateMissingCommandsDB(c *C) {
+	c.Assert(os.Remove(dirs.SnapCommandsDB), IsNil)
+
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	c.Assert(db.AddSnap("foo", "1.0", "foo summary", []string{"foo"}), IsNil)
+	c.Assert(db.Commit(), IsNil)
+
+	cmds, err := advisor.DumpCommands()
+	c.Assert(err, IsNil)
+	c.Check(cmds, DeepEquals, map[string]string{
+		"foo": `[{"snap":"foo","version":"1.0"}]`,
+	})
+}
+
+func (s *cmdfinderSuite) TestUpdateRollback(c *C) {
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	c.Assert(db.AddSnap("baz", "3.0", "baz summary", []string{"baz"}), IsNil)
+	c.Assert(db.Rollback(), IsNil)
+	// committing after a rollback does nothing
+	c.Assert(db.Commit(), IsNil)
+
+	cmds, err := advisor.DumpCommands()
+	c.Assert(err, IsNil)
+	c.Check(cmds, HasLen, 3)
+}
+
 func (s *cmdfinderSuite) TestFindMissingCommandsDB(c *C) {
 	err := os.Remove(dirs.SnapCommandsDB)
 	c.Assert(err, IsNil)
@@ -20,3 +20,22 @@
 package advisor
 
 var SimilarWords = similarWords
+
+var FindSimilarCommands = findSimilarCommands
+
+func OpenBoltFinder() (Finder, error) {
+	return openBoltFinder()
+}
+
+func OpenIndexFinder() (Finder, error) {
+	finder, err := openIndex()
+	if err != nil {
+		return nil, err
+	}
+	return finder, nil
+}
+
+func IsIndexFinder(finder Finder) bool {
+	_, ok := finder.(*indexFinder)
+	return ok
+}
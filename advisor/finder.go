@@ -27,6 +27,12 @@ type Finder interface {
 	Close() error
 }
 
+// misspelledCommandFinder is implemented by the finders that can look
+// up all the commands similar to a misspelled one at once.
+type misspelledCommandFinder interface {
+	FindMisspelledCommand(command string) ([]Command, error)
+}
+
 func ReplaceCommandsFinder(constructor func() (Finder, error)) (restore func()) {
 	old := newFinder
 	newFinder = constructor
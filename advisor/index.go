@@ -0,0 +1,431 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package advisor
+
+import (
+	"bytes"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"sort"
+	"syscall"
+	"time"
+
+	"github.com/snapcore/bolt"
+
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/osutil"
+)
+
+// The commands index is a read-only copy of the commands database laid
+// out to be memory mapped and searched in place, it is regenerated
+// whenever the database is written.
+//
+// All integers are little endian uint32s, offsets are from the start
+// of the file. The header holds a magic, the number of commands,
+// packages and deletions and a reserved word. It is followed by the
+// sorted table of commands, whose entries are the offset and length of
+// the command and of the JSON list of packages providing it, as in the
+// database. The sorted table of packages follows, laid out the same
+// with the JSON package as value. Then comes the table of deletions,
+// the command number and byte position of each of the commands with
+// one byte removed, sorted by the resulting string: the deletion
+// neighbourhoods used to look up misspellings. The keys and values
+// are stored last.
+var indexMagic = []byte("snapcnf\x01")
+
+// indexMaxFileSize is the largest index that can be mapped and indexed
+// with an int on 32-bit systems too.
+const (
+	indexHeaderSize  = 24
+	indexEntrySize   = 16
+	indexDelSize     = 8
+	indexMaxFileSize = 1<<31 - 1
+)
+
+var errBadIndex = errors.New("invalid commands index")
+
+type indexKV struct {
+	key, value []byte
+}
+
+type indexDel struct {
+	cmd, pos uint32
+	key      string
+}
+
+func bucketKVs(tx *bolt.Tx, key []byte) []indexKV {
+	b := tx.Bucket(key)
+	if b == nil {
+		return nil
+	}
+	var kvs []indexKV
+	c := b.Cursor()
+	// bolt keeps the keys sorted bytewise
+	for k, v := c.First(); k != nil; k, v = c.Next() {
+		kvs = append(kvs, indexKV{
+			key:   append([]byte(nil), k...),
+			value: append([]byte(nil), v...),
+		})
+	}
+	return kvs
+}
+
+// buildIndex returns the commands index for the database read through tx.
+func buildIndex(tx *bolt.Tx) ([]byte, error) {
+	cmds := bucketKVs(tx, cmdBucketKey)
+	pkgs := bucketKVs(tx, pkgBucketKey)
+
+	var dels []indexDel
+	for i, kv := range cmds {
+		cmd := string(kv.key)
+		for pos := range kv.key {
+			dels = append(dels, indexDel{cmd: uint32(i), pos: uint32(pos), key: cmd[:pos] + cmd[pos+1:]})
+		}
+	}
+	sort.Slice(dels, func(i, j int) bool {
+		if dels[i].key != dels[j].key {
+			return dels[i].key < dels[j].key
+		}
+		return dels[i].cmd < dels[j].cmd
+	})
+	// deleting either of repeated bytes gives the same key
+	uniq := dels[:0]
+	for i, del := range dels {
+		if i > 0 && del.key == dels[i-1].key && del.cmd == dels[i-1].cmd {
+			continue
+		}
+		uniq = append(uniq, del)
+	}
+	dels = uniq
+
+	stringsOff := indexHeaderSize + (len(cmds)+len(pkgs))*indexEntrySize + len(dels)*indexDelSize
+	var buf, strs bytes.Buffer
+	put := func(v int) {
+		var b [4]byte
+		binary.LittleEndian.PutUint32(b[:], uint32(v))
+		buf.Write(b[:])
+	}
+	putKVs := func(kvs []indexKV) {
+		for _, kv := range kvs {
+			put(stringsOff + strs.Len())
+			put(len(kv.key))
+			strs.Write(kv.key)
+			put(stringsOff + strs.Len())
+			put(len(kv.value))
+			strs.Write(kv.value)
+		}
+	}
+
+	buf.Write(indexMagic)
+	put(len(cmds))
+	put(len(pkgs))
+	put(len(dels))
+	// reserved
+	put(0)
+	putKVs(cmds)
+	putKVs(pkgs)
+	for _, del := range dels {
+		put(int(del.cmd))
+		put(int(del.pos))
+	}
+	buf.Write(strs.Bytes())
+
+	if buf.Len() > indexMaxFileSize {
+		return nil, fmt.Errorf("commands index too big (%d bytes)", buf.Len())
+	}
+	return buf.Bytes(), nil
+}
+
+func writeIndex(index []byte) error {
+	return osutil.AtomicWriteFile(dirs.SnapCommandsIndex, index, 0644, 0)
+}
+
+// EnsureIndex writes the commands index again from the commands
+// database if it went missing or is not current, the database itself
+// being left alone.
+func EnsureIndex() error {
+	if !osutil.FileExists(dirs.SnapCommandsDB) || indexIsCurrent() {
+		return nil
+	}
+	db, err := bolt.Open(dirs.SnapCommandsDB, 0644, &bolt.Options{
+		ReadOnly: true,
+		Timeout:  1 * time.Second,
+	})
+	if err != nil {
+		return err
+	}
+	defer db.Close()
+
+	var index []byte
+	err = db.View(func(tx *bolt.Tx) error {
+		index, err = buildIndex(tx)
+		return err
+	})
+	if err != nil {
+		return err
+	}
+	return writeIndex(index)
+}
+
+// indexFinder looks up commands and packages in the memory mapped
+// commands index.
+type indexFinder struct {
+	data  []byte
+	nCmds int
+	nPkgs int
+	nDels int
+}
+
+// indexIsCurrent returns whether the commands index was written after
+// the commands database, and so describes it.
+func indexIsCurrent() bool {
+	st, err := os.Stat(dirs.SnapCommandsIndex)
+	if err != nil {
+		return false
+	}
+	dbSt, err := os.Stat(dirs.SnapCommandsDB)
+	if err != nil {
+		return false
+	}
+	return !st.ModTime().Before(dbSt.ModTime())
+}
+
+// openIndex maps the commands index in memory, if it is current.
+func openIndex() (*indexFinder, error) {
+	if !indexIsCurrent() {
+		return nil, errBadIndex
+	}
+	f, err := os.Open(dirs.SnapCommandsIndex)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+	st, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+	size := st.Size()
+	if size < indexHeaderSize || size > indexMaxFileSize {
+		return nil, errBadIndex
+	}
+	data, err := syscall.Mmap(int(f.Fd()), 0, int(size), syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, err
+	}
+	finder, err := newIndexFinder(data)
+	if err != nil {
+		syscall.Munmap(data)
+		return nil, err
+	}
+	return finder, nil
+}
+
+func newIndexFinder(data []byte) (*indexFinder, error) {
+	if len(data) < indexHeaderSize || !bytes.Equal(data[:len(indexMagic)], indexMagic) {
+		return nil, errBadIndex
+	}
+	f := &indexFinder{data: data}
+	f.nCmds = int(f.uint32At(8))
+	f.nPkgs = int(f.uint32At(12))
+	f.nDels = int(f.uint32At(16))
+	tablesEnd := indexHeaderSize + (f.nCmds+f.nPkgs)*indexEntrySize + f.nDels*indexDelSize
+	if tablesEnd > len(data) {
+		return nil, errBadIndex
+	}
+	// check all the references once, so that lookups need not
+	for i := 0; i < f.nCmds+f.nPkgs; i++ {
+		entry := indexHeaderSize + i*indexEntrySize
+		for _, off := range []int{entry, entry + 8} {
+			start, length := int(f.uint32At(off)), int(f.uint32At(off+4))
+			if start < tablesEnd || start+length > len(data) {
+				return nil, errBadIndex
+			}
+		}
+	}
+	for i := 0; i < f.nDels; i++ {
+		cmd, pos := f.del(i)
+		if cmd >= f.nCmds || pos >= len(f.key(cmd)) {
+			return nil, errBadIndex
+		}
+	}
+	return f, nil
+}
+
+func (f *indexFinder) uint32At(off int) uint32 {
+	return binary.LittleEndian.Uint32(f.data[off : off+4])
+}
+
+func (f *indexFinder) slice(off int) []byte {
+	start := int(f.uint32At(off))
+	return f.data[start : start+int(f.uint32At(off+4))]
+}
+
+// key returns the key of the i-th entry of the commands and packages
+// tables taken as one.
+func (f *indexFinder) key(i int) []byte {
+	return f.slice(indexHeaderSize + i*indexEntrySize)
+}
+
+func (f *indexFinder) value(i int) []byte {
+	return f.slice(indexHeaderSize + i*indexEntrySize + 8)
+}
+
+func (f *indexFinder) del(i int) (cmd, pos int) {
+	off := indexHeaderSize + (f.nCmds+f.nPkgs)*indexEntrySize + i*indexDelSize
+	return int(f.uint32At(off)), int(f.uint32At(off + 4))
+}
+
+// compareDel compares the key of the i-th deletion with s.
+func (f *indexFinder) compareDel(i int, s string) int {
+	cmd, pos := f.del(i)
+	key := f.key(cmd)
+	if pos > len(s) {
+		// s ends before the deleted byte
+		return compareBytesString(key[:pos], s)
+	}
+	if c := compareBytesString(key[:pos], s[:pos]); c != 0 {
+		return c
+	}
+	return compareBytesString(key[pos+1:], s[pos:])
+}
+
+func compareBytesString(b []byte, s string) int {
+	switch {
+	case string(b) < s:
+		return -1
+	case string(b) > s:
+		return 1
+	}
+	return 0
+}
+
+// search returns the index of the entry with the given key in the
+// table of n entries starting at entry first, or -1.
+func (f *indexFinder) search(first, n int, key string) int {
+	i := sort.Search(n, func(i int) bool {
+		return string(f.key(first+i)) >= key
+	})
+	if i < n && string(f.key(first+i)) == key {
+		return first + i
+	}
+	return -1
+}
+
+func (f *indexFinder) commands(i int, command string) ([]Command, error) {
+	var sil []Package
+	if err := json.Unmarshal(f.value(i), &sil); err != nil {
+		return nil, err
+	}
+	cmds := make([]Command, len(sil))
+	for j, si := range sil {
+		cmds[j] = Command{
+			Snap:    si.Snap,
+			Version: si.Version,
+			Command: command,
+		}
+	}
+	return cmds, nil
+}
+
+func (f *indexFinder) FindCommand(command string) ([]Command, error) {
+	i := f.search(0, f.nCmds, command)
+	if i < 0 {
+		return nil, nil
+	}
+	return f.commands(i, command)
+}
+
+func (f *indexFinder) FindPackage(pkgName string) (*Package, error) {
+	i := f.search(f.nCmds, f.nPkgs, pkgName)
+	if i < 0 {
+		return nil, nil
+	}
+	var si Package
+	if err := json.Unmarshal(f.value(i), &si); err != nil {
+		return nil, err
+	}
+	return &Package{Snap: pkgName, Version: si.Version, Summary: si.Summary}, nil
+}
+
+// FindMisspelledCommand returns the commands that are one of the
+// similarWords of command. Instead of looking up every similar word,
+// the commands one edit away are found through the deletion
+// neighbourhoods: such a command either is command with a byte
+// deleted, or has command itself or command with a byte deleted in
+// its neighbourhood. The candidates are then checked against the
+// similar words, as the neighbourhoods also match some commands two
+// edits away.
+func (f *indexFinder) FindMisspelledCommand(command string) ([]Command, error) {
+	candidates := make(map[int]bool)
+	lookup := func(key string) {
+		if i := f.search(0, f.nCmds, key); i >= 0 {
+			candidates[i] = true
+		}
+		j := sort.Search(f.nDels, func(j int) bool {
+			return f.compareDel(j, key) >= 0
+		})
+		for ; j < f.nDels && f.compareDel(j, key) == 0; j++ {
+			cmd, _ := f.del(j)
+			candidates[cmd] = true
+		}
+	}
+	lookup(command)
+	for pos := 0; pos < len(command); pos++ {
+		lookup(command[:pos] + command[pos+1:])
+	}
+	if len(candidates) == 0 {
+		return nil, nil
+	}
+
+	similar := make(map[string]bool)
+	for _, w := range similarWords(command) {
+		similar[w] = true
+	}
+	// keep the commands sorted, as in the index
+	matches := make([]int, 0, len(candidates))
+	for i := range candidates {
+		if similar[string(f.key(i))] {
+			matches = append(matches, i)
+		}
+	}
+	sort.Ints(matches)
+
+	var alternatives []Command
+	for _, i := range matches {
+		res, err := f.commands(i, string(f.key(i)))
+		if err != nil {
+			return nil, err
+		}
+		alternatives = append(alternatives, res...)
+	}
+	return alternatives, nil
+}
+
+func (f *indexFinder) Close() error {
+	if f.data == nil {
+		return nil
+	}
+	err := syscall.Munmap(f.data)
+	f.data = nil
+	return err
+}
@@ -0,0 +1,288 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package advisor_test
+
+import (
+	"fmt"
+	"io/ioutil"
+	"math/rand"
+	"os"
+	"sort"
+	"testing"
+	"time"
+
+	. "gopkg.in/check.v1"
+
+	"github.com/snapcore/snapd/advisor"
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/testutil"
+)
+
+type indexSuite struct{}
+
+var _ = Suite(&indexSuite{})
+
+func (s *indexSuite) SetUpTest(c *C) {
+	dirs.SetRootDir(c.MkDir())
+	c.Assert(os.MkdirAll(dirs.SnapCacheDir, 0755), IsNil)
+}
+
+func (s *indexSuite) TearDownTest(c *C) {
+	dirs.SetRootDir("")
+}
+
+// populate writes a commands database of n snaps with a couple of
+// commands each, with names made of a small alphabet so that there
+// are many similar ones.
+func populate(create func() (advisor.CommandDB, error), n int) error {
+	db, err := create()
+	if err != nil {
+		return err
+	}
+	defer db.Rollback()
+	rnd := rand.New(rand.NewSource(42))
+	word := func() string {
+		const letters = "abcde-"
+		b := make([]byte, 3+rnd.Intn(5))
+		for i := range b {
+			b[i] = letters[rnd.Intn(len(letters))]
+		}
+		return string(b)
+	}
+	for i := 0; i < n; i++ {
+		name := fmt.Sprintf("snap%d", i)
+		if err := db.AddSnap(name, "1.0", name+" summary", []string{word(), word(), name + "." + word()}); err != nil {
+			return err
+		}
+	}
+	return db.Commit()
+}
+
+func sortedCommands(cmds []advisor.Command) []advisor.Command {
+	sort.Slice(cmds, func(i, j int) bool {
+		if cmds[i].Command != cmds[j].Command {
+			return cmds[i].Command < cmds[j].Command
+		}
+		return cmds[i].Snap < cmds[j].Snap
+	})
+	return cmds
+}
+
+func (s *indexSuite) TestIndexWrittenAndUsed(c *C) {
+	for _, create := range []func() (advisor.CommandDB, error){advisor.Create, advisor.Update} {
+		c.Assert(os.RemoveAll(dirs.SnapCacheDir), IsNil)
+		c.Assert(os.MkdirAll(dirs.SnapCacheDir, 0755), IsNil)
+
+		c.Assert(populate(create, 10), IsNil)
+		c.Check(dirs.SnapCommandsIndex, testutil.FilePresent)
+
+		finder, err := advisor.Open()
+		c.Assert(err, IsNil)
+		c.Check(advisor.IsIndexFinder(finder), Equals, true)
+		c.Assert(finder.Close(), IsNil)
+	}
+}
+
+func (s *indexSuite) TestIndexMatchesDatabase(c *C) {
+	c.Assert(populate(advisor.Create, 300), IsNil)
+
+	bolt, err := advisor.OpenBoltFinder()
+	c.Assert(err, IsNil)
+	defer bolt.Close()
+	index, err := advisor.OpenIndexFinder()
+	c.Assert(err, IsNil)
+	defer index.Close()
+
+	queries := []string{"abc", "abcd", "ab-", "eeee", "zzz", "snap12", "snap12.abc", "a", "", "abcdeabcde"}
+	for i := 0; i < 300; i += 7 {
+		queries = append(queries, fmt.Sprintf("snap%d", i))
+	}
+	dump, err := advisor.DumpCommands()
+	c.Assert(err, IsNil)
+	for cmd := range dump {
+		queries = append(queries, cmd, cmd[1:], cmd+"x", "x"+cmd)
+	}
+
+	for _, q := range queries {
+		expected, err := bolt.FindCommand(q)
+		c.Assert(err, IsNil)
+		found, err := index.FindCommand(q)
+		c.Assert(err, IsNil)
+		c.Check(found, DeepEquals, expected, Commentf("%q", q))
+
+		expectedPkg, err := bolt.FindPackage(q)
+		c.Assert(err, IsNil)
+		foundPkg, err := index.FindPackage(q)
+		c.Assert(err, IsNil)
+		c.Check(foundPkg, DeepEquals, expectedPkg, Commentf("%q", q))
+
+		expected, err = advisor.FindSimilarCommands(bolt, q)
+		c.Assert(err, IsNil)
+		found, err = advisor.FindSimilarCommands(index, q)
+		c.Assert(err, IsNil)
+		c.Check(sortedCommands(found), DeepEquals, sortedCommands(expected), Commentf("%q", q))
+
+		if len(q) < 3 {
+			continue
+		}
+		found, err = advisor.FindMisspelledCommand(q)
+		c.Assert(err, IsNil)
+		if len(expected) == 0 {
+			c.Check(found, HasLen, 0, Commentf("%q", q))
+		} else {
+			c.Check(sortedCommands(found), DeepEquals, expected, Commentf("%q", q))
+		}
+	}
+}
+
+func (s *indexSuite) TestStaleIndexIgnored(c *C) {
+	c.Assert(populate(advisor.Create, 10), IsNil)
+
+	// the database got written after the index
+	future := time.Now().Add(time.Hour)
+	c.Assert(os.Chtimes(dirs.SnapCommandsDB, future, future), IsNil)
+
+	finder, err := advisor.Open()
+	c.Assert(err, IsNil)
+	defer finder.Close()
+	c.Check(advisor.IsIndexFinder(finder), Equals, false)
+
+	cmds, err := finder.FindCommand("snap1.nope")
+	c.Assert(err, IsNil)
+	c.Check(cmds, HasLen, 0)
+}
+
+func (s *indexSuite) TestCorruptIndexIgnored(c *C) {
+	c.Assert(populate(advisor.Create, 10), IsNil)
+
+	for _, content := range []string{"", "snapcnf\x01", "snapcnf\x01\xff\xff\xff\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", "garbage garbage garbage garbage"} {
+		c.Assert(ioutil.WriteFile(dirs.SnapCommandsIndex, []byte(content), 0644), IsNil)
+
+		_, err := advisor.OpenIndexFinder()
+		c.Check(err, ErrorMatches, "invalid commands index")
+
+		finder, err := advisor.Open()
+		c.Assert(err, IsNil)
+		c.Check(advisor.IsIndexFinder(finder), Equals, false)
+		finder.Close()
+	}
+}
+
+func (s *indexSuite) TestUpdateUnchangedWritesMissingIndex(c *C) {
+	c.Assert(populate(advisor.Create, 10), IsNil)
+	c.Assert(os.Remove(dirs.SnapCommandsIndex), IsNil)
+
+	c.Assert(populate(advisor.Update, 10), IsNil)
+
+	finder, err := advisor.Open()
+	c.Assert(err, IsNil)
+	defer finder.Close()
+	c.Check(advisor.IsIndexFinder(finder), Equals, true)
+}
+
+func (s *indexSuite) TestEnsureIndex(c *C) {
+	c.Assert(populate(advisor.Create, 10), IsNil)
+	index, err := ioutil.ReadFile(dirs.SnapCommandsIndex)
+	c.Assert(err, IsNil)
+
+	// nothing to do for a current index
+	c.Assert(advisor.EnsureIndex(), IsNil)
+	c.Check(dirs.SnapCommandsIndex, testutil.FileEquals, index)
+
+	// a missing or stale one is written again
+	c.Assert(os.Remove(dirs.SnapCommandsIndex), IsNil)
+	c.Assert(advisor.EnsureIndex(), IsNil)
+	c.Check(dirs.SnapCommandsIndex, testutil.FileEquals, index)
+
+	past := time.Now().Add(-time.Hour)
+	c.Assert(os.Chtimes(dirs.SnapCommandsIndex, past, past), IsNil)
+	c.Assert(advisor.EnsureIndex(), IsNil)
+	finder, err := advisor.Open()
+	c.Assert(err, IsNil)
+	defer finder.Close()
+	c.Check(advisor.IsIndexFinder(finder), Equals, true)
+}
+
+func benchmarkFinder(b *testing.B, index bool, lookup func(finder advisor.Finder) error) {
+	tmpdir, err := ioutil.TempDir("", "advisor-bench")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(tmpdir)
+	dirs.SetRootDir(tmpdir)
+	defer dirs.SetRootDir("")
+	if err := os.MkdirAll(dirs.SnapCacheDir, 0755); err != nil {
+		b.Fatal(err)
+	}
+	if err := populate(advisor.Create, 5000); err != nil {
+		b.Fatal(err)
+	}
+
+	open := advisor.OpenBoltFinder
+	if index {
+		open = advisor.OpenIndexFinder
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		// like command-not-found, which opens the finder every time
+		finder, err := open()
+		if err != nil {
+			b.Fatal(err)
+		}
+		if err := lookup(finder); err != nil {
+			b.Fatal(err)
+		}
+		finder.Close()
+	}
+}
+
+func findCommand(finder advisor.Finder) error {
+	_, err := finder.FindCommand("snap42.abc")
+	return err
+}
+
+func findMisspelledCommand(finder advisor.Finder) error {
+	type misspelledCommandFinder interface {
+		FindMisspelledCommand(command string) ([]advisor.Command, error)
+	}
+	var err error
+	if mf, ok := finder.(misspelledCommandFinder); ok {
+		_, err = mf.FindMisspelledCommand("abcdf")
+	} else {
+		_, err = advisor.FindSimilarCommands(finder, "abcdf")
+	}
+	return err
+}
+
+func BenchmarkFindCommandBolt(b *testing.B) {
+	benchmarkFinder(b, false, findCommand)
+}
+
+func BenchmarkFindCommandIndex(b *testing.B) {
+	benchmarkFinder(b, true, findCommand)
+}
+
+func BenchmarkFindMisspelledCommandBolt(b *testing.B) {
+	benchmarkFinder(b, false, findMisspelledCommand)
+}
+
+func BenchmarkFindMisspelledCommandIndex(b *testing.B) {
+	benchmarkFinder(b, true, findMisspelledCommand)
+}
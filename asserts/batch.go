@@ -115,6 +115,13 @@ func (b *Batch) Fetch(trustedDB RODatabase, retrieve func(*Ref) (Assertion, erro
 	return fetching(f)
 }
 
+// BulkFetch is like Fetch but the internal Fetcher is a BulkFetcher
+// that uses also retrieveMany to retrieve many assertions at once.
+func (b *Batch) BulkFetch(trustedDB RODatabase, retrieve func(*Ref) (Assertion, error), retrieveMany func([]*Ref) ([]Assertion, error), fetching func(Fetcher) error) error {
+	f := NewBulkFetcher(trustedDB, retrieve, retrieveMany, b.Add)
+	return fetching(f)
+}
+
 func (b *Batch) precheck(db *Database) error {
 	db = db.WithStackedBackstore(NewMemoryBackstore())
 	return b.commitTo(db)
@@ -204,6 +204,9 @@ type Database struct {
 	stackedOn []Backstore
 
 	checkers []Checker
+
+	// sigs remembers the verified signatures, shared with stacked dbs
+	sigs *signatureCache
 }
 
 // OpenDatabase opens the assertion database based on the configuration.
@@ -266,6 +269,7 @@ func OpenDatabase(cfg *DatabaseConfig) (*Database, error) {
 		// general backstore!
 		backstores: []Backstore{trustedBackstore, otherPredefinedBackstore, bs},
 		checkers:   dbCheckers,
+		sigs:       newSignatureCache(),
 	}, nil
 }
 
@@ -290,9 +294,20 @@ func (db *Database) WithStackedBackstore(backstore Backstore) *Database {
 		backstores: backstores,
 		stackedOn:  stackedOn,
 		checkers:   db.checkers,
+		sigs:       db.sigs,
 	}
 }
 
+func (db *Database) verifiedSignatures() *signatureCache {
+	return db.sigs
+}
+
+// SignatureCacheStats returns statistics about the use of the cache of
+// verified signatures consulted by Check.
+func (db *Database) SignatureCacheStats() SignatureCacheStats {
+	return db.sigs.stats()
+}
+
 // ImportKey stores the given private/public key pair.
 func (db *Database) ImportKey(privKey PrivateKey) error {
 	return db.keypairMgr.Put(privKey)
@@ -455,7 +470,14 @@ func (db *Database) Add(assert Assertion) error {
 		}
 	}
 
-	return db.bs.Put(ref.Type, assert)
+	if err := db.bs.Put(ref.Type, assert); err != nil {
+		return err
+	}
+	if accKey, ok := assert.(*AccountKey); ok {
+		// a new revision of a key might revoke it
+		db.sigs.invalidateKey(accKey.PublicKeyID())
+	}
+	return nil
 }
 
 func searchMatch(assert Assertion, expectedHeaders map[string]string) bool {
@@ -592,9 +614,19 @@ func CheckSigningKeyIsNotExpired(assert Assertion, signingKey *AccountKey, roDB
 }
 
 // CheckSignature checks that the signature is valid.
+// If roDB remembers verified signatures, as a Database does, signatures
+// it already verified with the same revision of the signing key are not
+// verified again.
 func CheckSignature(assert Assertion, signingKey *AccountKey, roDB RODatabase, checkTime time.Time) error {
 	var pubKey PublicKey
+	var sigs *signatureCache
 	if signingKey != nil {
+		if cacher, ok := roDB.(signatureCacher); ok {
+			sigs = cacher.verifiedSignatures()
+			if sigs.verified(assert, signingKey, checkTime) {
+				return nil
+			}
+		}
 		pubKey = signingKey.publicKey()
 	} else {
 		custom, ok := assert.(customSigner)
@@ -612,6 +644,9 @@ func CheckSignature(assert Assertion, signingKey *AccountKey, roDB RODatabase, c
 	if err != nil {
 		return fmt.Errorf("failed signature verification: %v", err)
 	}
+	if sigs != nil {
+		sigs.add(assert, signingKey)
+	}
 	return nil
 }
 
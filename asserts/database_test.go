@@ -24,6 +24,7 @@ import (
 	"crypto"
 	"encoding/base64"
 	"errors"
+	"fmt"
 	"io/ioutil"
 	"os"
 	"path/filepath"
@@ -1287,3 +1288,151 @@ func (s *isUnacceptedUpdateSuite) TestIsUnacceptedUpdate(c *C) {
 		c.Check(asserts.IsUnaccceptedUpdate(t.err), Equals, t.keptCurrent, Commentf("%v", t.err))
 	}
 }
+
+func (safs *signAddFindSuite) TestCheckSignatureCached(c *C) {
+	headers := map[string]interface{}{
+		"authority-id": "canonical",
+		"primary-key":  "a",
+	}
+	a1, err := safs.signingDB.Sign(asserts.TestOnlyType, headers, nil, safs.signingKeyID)
+	c.Assert(err, IsNil)
+
+	c.Assert(safs.db.Check(a1), IsNil)
+	c.Check(safs.db.SignatureCacheStats(), DeepEquals, asserts.SignatureCacheStats{Misses: 1, Entries: 1})
+
+	c.Assert(safs.db.Check(a1), IsNil)
+	stats := safs.db.SignatureCacheStats()
+	c.Check(stats, DeepEquals, asserts.SignatureCacheStats{Hits: 1, Misses: 1, Entries: 1})
+	c.Check(stats.HitRate(), Equals, 0.5)
+
+	// stacked databases share the cache
+	stacked := safs.db.WithStackedBackstore(asserts.NewMemoryBackstore())
+	c.Assert(stacked.Check(a1), IsNil)
+	c.Check(safs.db.SignatureCacheStats().Hits, Equals, uint64(2))
+}
+
+func (safs *signAddFindSuite) TestCheckSignatureCacheNotFooledBySameContent(c *C) {
+	headers := map[string]interface{}{
+		"authority-id": "canonical",
+		"primary-key":  "a",
+	}
+	a1, err := safs.signingDB.Sign(asserts.TestOnlyType, headers, nil, safs.signingKeyID)
+	c.Assert(err, IsNil)
+	c.Assert(safs.db.Check(a1), IsNil)
+
+	// same content with a signature by another key
+	encoded := asserts.Encode(a1)
+	content, encodedSig := a1.Signature()
+	forgedSig := new(packet.Signature)
+	forgedSig.PubKeyAlgo = packet.PubKeyAlgoRSA
+	forgedSig.Hash = crypto.SHA512
+	forgedSig.CreationTime = time.Now()
+	h := crypto.SHA512.New()
+	h.Write(content)
+	pk1 := packet.NewRSAPrivateKey(time.Unix(1, 0), testPrivKey1RSA)
+	err = forgedSig.Sign(h, pk1, &packet.Config{DefaultHash: crypto.SHA512})
+	c.Assert(err, IsNil)
+	buf := new(bytes.Buffer)
+	forgedSig.Serialize(buf)
+	forgedSigEncoded := base64.StdEncoding.EncodeToString(append([]byte{0x1}, buf.Bytes()...))
+	forgedEncoded := bytes.Replace(encoded, encodedSig, []byte(forgedSigEncoded), 1)
+	forged, err := asserts.Decode(forgedEncoded)
+	c.Assert(err, IsNil)
+
+	err = safs.db.Check(forged)
+	c.Check(err, ErrorMatches, "failed signature verification: .*")
+}
+
+func (safs *signAddFindSuite) TestSignatureCacheDigestUnambiguous(c *C) {
+	c.Check(asserts.DigestSignedParts([]byte("ab"), []byte("c")), Not(Equals), asserts.DigestSignedParts([]byte("a"), []byte("bc")))
+	c.Check(asserts.DigestSignedParts([]byte("a"), []byte("bc")), Equals, asserts.DigestSignedParts([]byte("a"), []byte("bc")))
+}
+
+func (safs *signAddFindSuite) TestCheckSignatureCacheInvalidatedByNewKeyRevision(c *C) {
+	pk1 := testPrivKey1
+	c.Assert(safs.signingDB.ImportKey(pk1), IsNil)
+
+	acct1 := assertstest.NewAccount(safs.signingDB, "acc-id1", map[string]interface{}{
+		"authority-id": "canonical",
+	}, safs.signingKeyID)
+	acct1Key := assertstest.NewAccountKey(safs.signingDB, acct1, map[string]interface{}{
+		"authority-id": "canonical",
+	}, pk1.PublicKey(), safs.signingKeyID)
+	c.Assert(safs.db.Add(acct1), IsNil)
+	c.Assert(safs.db.Add(acct1Key), IsNil)
+
+	headers := map[string]interface{}{
+		"authority-id": "acc-id1",
+		"primary-key":  "a",
+	}
+	a1, err := safs.signingDB.Sign(asserts.TestOnlyType, headers, nil, pk1.PublicKey().ID())
+	c.Assert(err, IsNil)
+
+	c.Assert(safs.db.Check(a1), IsNil)
+	before := safs.db.SignatureCacheStats()
+	c.Assert(safs.db.Check(a1), IsNil)
+	c.Check(safs.db.SignatureCacheStats().Hits, Equals, before.Hits+1)
+
+	// a new revision of the signing key, as would be used to revoke it
+	acct1KeyRev1 := assertstest.NewAccountKey(safs.signingDB, acct1, map[string]interface{}{
+		"authority-id": "canonical",
+		"revision":     "1",
+	}, pk1.PublicKey(), safs.signingKeyID)
+	c.Assert(safs.db.Add(acct1KeyRev1), IsNil)
+
+	before = safs.db.SignatureCacheStats()
+	c.Assert(safs.db.Check(a1), IsNil)
+	after := safs.db.SignatureCacheStats()
+	c.Check(after.Hits, Equals, before.Hits)
+	c.Check(after.Misses, Equals, before.Misses+1)
+}
+
+// BenchmarkAckBundleTwice adds a bundle of 500 assertions to a database
+// twice, as done when acking a bundle that is already present.
+func BenchmarkAckBundleTwice(b *testing.B) {
+	signingDB, err := asserts.OpenDatabase(&asserts.DatabaseConfig{})
+	if err != nil {
+		b.Fatal(err)
+	}
+	if err := signingDB.ImportKey(testPrivKey0); err != nil {
+		b.Fatal(err)
+	}
+	keyID := testPrivKey0.PublicKey().ID()
+
+	const bundleSize = 500
+	bundle := make([]asserts.Assertion, bundleSize)
+	for i := range bundle {
+		headers := map[string]interface{}{
+			"authority-id": "canonical",
+			"primary-key":  fmt.Sprintf("key%d", i),
+		}
+		bundle[i], err = signingDB.Sign(asserts.TestOnlyType, headers, nil, keyID)
+		if err != nil {
+			b.Fatal(err)
+		}
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		db, err := asserts.OpenDatabase(&asserts.DatabaseConfig{
+			Backstore: asserts.NewMemoryBackstore(),
+			Trusted: []asserts.Assertion{
+				asserts.BootstrapAccountForTest("canonical"),
+				asserts.BootstrapAccountKeyForTest("canonical", testPrivKey0.PublicKey()),
+			},
+		})
+		if err != nil {
+			b.Fatal(err)
+		}
+		for ack := 0; ack < 2; ack++ {
+			for _, a := range bundle {
+				if err := db.Add(a); err != nil && !asserts.IsUnaccceptedUpdate(err) {
+					b.Fatal(err)
+				}
+			}
+		}
+		if hits := db.SignatureCacheStats().Hits; hits != bundleSize {
+			b.Fatalf("expected %d signature cache hits, got %d", bundleSize, hits)
+		}
+	}
+}
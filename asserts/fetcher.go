@@ -41,12 +41,27 @@ type Fetcher interface {
 	Save(Assertion) error
 }
 
+// A BulkFetcher is a Fetcher that can retrieve many assertions together.
+type BulkFetcher interface {
+	Fetcher
+	// Prefetch retrieves together the assertions indicated by refs
+	// and then, level by level, their prerequisites, without saving
+	// them. Fetch and Save will then use them instead of retrieving
+	// them one by one. Assertions that cannot be found are left to
+	// be retrieved and reported by Fetch.
+	Prefetch([]*Ref) error
+}
+
 type fetcher struct {
-	db       RODatabase
-	retrieve func(*Ref) (Assertion, error)
-	save     func(Assertion) error
+	db           RODatabase
+	retrieve     func(*Ref) (Assertion, error)
+	retrieveMany func([]*Ref) ([]Assertion, error)
+	save         func(Assertion) error
 
 	fetched map[string]fetchProgress
+
+	prefetched    map[string]Assertion
+	prefetchTried map[string]bool
 }
 
 // NewFetcher creates a Fetcher which will use trustedDB to determine trusted assertions, will fetch assertions following prerequisites using retrieve, and then will pass them to save, saving prerequisites before dependent assertions.
@@ -59,6 +74,68 @@ func NewFetcher(trustedDB RODatabase, retrieve func(*Ref) (Assertion, error), sa
 	}
 }
 
+// NewBulkFetcher creates a BulkFetcher which works like the Fetcher
+// created by NewFetcher but that uses retrieveMany to retrieve many
+// assertions at once, both for Prefetch and for the prerequisites
+// chased by Fetch and Save. retrieveMany should return the found
+// assertions among the requested ones, in any order, and skip the
+// ones that cannot be found.
+func NewBulkFetcher(trustedDB RODatabase, retrieve func(*Ref) (Assertion, error), retrieveMany func([]*Ref) ([]Assertion, error), save func(Assertion) error) BulkFetcher {
+	return &fetcher{
+		db:            trustedDB,
+		retrieve:      retrieve,
+		retrieveMany:  retrieveMany,
+		save:          save,
+		fetched:       make(map[string]fetchProgress),
+		prefetched:    make(map[string]Assertion),
+		prefetchTried: make(map[string]bool),
+	}
+}
+
+// Prefetch retrieves together the assertions indicated by refs and
+// then, level by level, their prerequisites.
+func (f *fetcher) Prefetch(refs []*Ref) error {
+	if f.retrieveMany == nil {
+		return nil
+	}
+	wave := refs
+	for len(wave) != 0 {
+		var toRetrieve []*Ref
+		for _, ref := range wave {
+			u := ref.Unique()
+			if f.prefetchTried[u] || f.fetched[u] != fetchNotSeen {
+				continue
+			}
+			f.prefetchTried[u] = true
+			_, err := ref.Resolve(f.db.FindPredefined)
+			if err == nil {
+				continue
+			}
+			if !IsNotFound(err) {
+				return err
+			}
+			toRetrieve = append(toRetrieve, ref)
+		}
+		if len(toRetrieve) == 0 {
+			break
+		}
+		retrieved, err := f.retrieveMany(toRetrieve)
+		if err != nil {
+			return err
+		}
+		wave = nil
+		for _, a := range retrieved {
+			f.prefetched[a.Ref().Unique()] = a
+			wave = append(wave, a.Prerequisites()...)
+			wave = append(wave, &Ref{
+				Type:       AccountKeyType,
+				PrimaryKey: []string{a.SignKeyID()},
+			})
+		}
+	}
+	return nil
+}
+
 func (f *fetcher) chase(ref *Ref, a Assertion) error {
 	// check if ref points to predefined assertion, in which case
 	// there is nothing to do
@@ -76,6 +153,9 @@ func (f *fetcher) chase(ref *Ref, a Assertion) error {
 	case fetchRetrieved:
 		return fmt.Errorf("circular assertions are not expected: %s", ref)
 	}
+	if a == nil {
+		a = f.prefetched[u]
+	}
 	if a == nil {
 		retrieved, err := f.retrieve(ref)
 		if err != nil {
@@ -83,7 +163,18 @@ func (f *fetcher) chase(ref *Ref, a Assertion) error {
 		}
 		a = retrieved
 	}
+	delete(f.prefetched, u)
 	f.fetched[u] = fetchRetrieved
+	if f.retrieveMany != nil {
+		// retrieve the missing prerequisites together
+		prereqs := append(a.Prerequisites(), &Ref{
+			Type:       AccountKeyType,
+			PrimaryKey: []string{a.SignKeyID()},
+		})
+		if err := f.Prefetch(prereqs); err != nil {
+			return err
+		}
+	}
 	for _, preref := range a.Prerequisites() {
 		if err := f.Fetch(preref); err != nil {
 			return err
@@ -102,6 +193,9 @@ func (f *fetcher) chase(ref *Ref, a Assertion) error {
 // Fetch retrieves the assertion indicated by ref then its prerequisites
 // recursively, along the way saving prerequisites before dependent assertions.
 func (f *fetcher) Fetch(ref *Ref) error {
+	if err := f.Prefetch([]*Ref{ref}); err != nil {
+		return err
+	}
 	return f.chase(ref, nil)
 }
 
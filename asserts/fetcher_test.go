@@ -165,3 +165,95 @@ func (s *fetcherSuite) TestSave(c *C) {
 	c.Assert(err, IsNil)
 	c.Check(snapDecl.(*asserts.SnapDeclaration).SnapName(), Equals, "foo")
 }
+
+func (s *fetcherSuite) TestBulkFetch(c *C) {
+	s.prereqSnapAssertions(c, 10, 11, 12)
+
+	db, err := asserts.OpenDatabase(&asserts.DatabaseConfig{
+		Backstore: asserts.NewMemoryBackstore(),
+		Trusted:   s.storeSigning.Trusted,
+	})
+	c.Assert(err, IsNil)
+
+	retrieveCalls := 0
+	retrieve := func(ref *asserts.Ref) (asserts.Assertion, error) {
+		retrieveCalls++
+		return ref.Resolve(s.storeSigning.Find)
+	}
+	var bulks [][]string
+	retrieveMany := func(refs []*asserts.Ref) ([]asserts.Assertion, error) {
+		var types []string
+		var found []asserts.Assertion
+		for _, ref := range refs {
+			types = append(types, ref.Type.Name)
+			a, err := ref.Resolve(s.storeSigning.Find)
+			if asserts.IsNotFound(err) {
+				continue
+			}
+			if err != nil {
+				return nil, err
+			}
+			found = append(found, a)
+		}
+		bulks = append(bulks, types)
+		return found, nil
+	}
+
+	f := asserts.NewBulkFetcher(db, retrieve, retrieveMany, db.Add)
+
+	var refs []*asserts.Ref
+	for _, rev := range []int{10, 11, 12} {
+		refs = append(refs, &asserts.Ref{
+			Type:       asserts.SnapRevisionType,
+			PrimaryKey: []string{makeDigest(rev)},
+		})
+	}
+	err = f.Prefetch(refs)
+	c.Assert(err, IsNil)
+	// the revisions, then together all their prerequisites
+	c.Check(bulks, DeepEquals, [][]string{
+		{"snap-revision", "snap-revision", "snap-revision"},
+		{"snap-declaration", "account", "account-key"},
+	})
+
+	for _, ref := range refs {
+		err = f.Fetch(ref)
+		c.Assert(err, IsNil)
+
+		_, err := ref.Resolve(db.Find)
+		c.Assert(err, IsNil)
+	}
+	c.Check(retrieveCalls, Equals, 0)
+	c.Check(bulks, HasLen, 2)
+
+	snapDecl, err := db.Find(asserts.SnapDeclarationType, map[string]string{
+		"series":  "16",
+		"snap-id": "snap-id-1",
+	})
+	c.Assert(err, IsNil)
+	c.Check(snapDecl.(*asserts.SnapDeclaration).SnapName(), Equals, "foo")
+}
+
+func (s *fetcherSuite) TestBulkFetchNotFound(c *C) {
+	db, err := asserts.OpenDatabase(&asserts.DatabaseConfig{
+		Backstore: asserts.NewMemoryBackstore(),
+		Trusted:   s.storeSigning.Trusted,
+	})
+	c.Assert(err, IsNil)
+
+	retrieve := func(ref *asserts.Ref) (asserts.Assertion, error) {
+		return ref.Resolve(s.storeSigning.Find)
+	}
+	retrieveMany := func(refs []*asserts.Ref) ([]asserts.Assertion, error) {
+		return nil, nil
+	}
+
+	f := asserts.NewBulkFetcher(db, retrieve, retrieveMany, db.Add)
+
+	ref := &asserts.Ref{
+		Type:       asserts.SnapRevisionType,
+		PrimaryKey: []string{makeDigest(10)},
+	}
+	err = f.Fetch(ref)
+	c.Check(asserts.IsNotFound(err), Equals, true)
+}
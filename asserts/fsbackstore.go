@@ -24,9 +24,12 @@ import (
 	"net/url"
 	"os"
 	"path/filepath"
+	"sort"
 	"strconv"
 	"strings"
 	"sync"
+
+	"github.com/snapcore/snapd/strutil"
 )
 
 // the default filesystem based backstore for assertions
@@ -39,6 +42,10 @@ const (
 type filesystemBackstore struct {
 	top string
 	mu  sync.RWMutex
+
+	// indexes holds for each assertion type the in-memory index of
+	// its stored assertions, loaded from disk on first use
+	indexes map[string]*fsbsIndex
 }
 
 // OpenFSBackstore opens a filesystem backed assertions backstore under path.
@@ -48,7 +55,200 @@ func OpenFSBackstore(path string) (Backstore, error) {
 	if err != nil {
 		return nil, err
 	}
-	return &filesystemBackstore{top: top}, nil
+	return &filesystemBackstore{
+		top:     top,
+		indexes: make(map[string]*fsbsIndex),
+	}, nil
+}
+
+// fsbsIndex is the in-memory index of the assertions of one type stored in
+// a filesystem backstore. It is loaded from disk once and then kept up to
+// date by Put, so that lookups and searches do not need to walk and decode
+// the storage tree again.
+type fsbsIndex struct {
+	// entries maps the escaped primary key to the stored revisions
+	// of the assertion, one per format
+	entries map[string]map[int]Assertion
+	// keys are the keys of entries, sorted if !keysDirty
+	keys      []string
+	keysDirty bool
+	// byHeader maps a non primary key header, and its values, to the
+	// keys of the entries that have an assertion with that value for
+	// it. Headers get indexed on demand the first time they are used
+	// in a search.
+	byHeader map[string]map[string]*fsbsKeySet
+}
+
+// fsbsKeySet is an insertion ordered set of index keys.
+type fsbsKeySet struct {
+	keys []string
+	has  map[string]bool
+}
+
+func (ks *fsbsKeySet) add(key string) {
+	if ks.has[key] {
+		return
+	}
+	ks.has[key] = true
+	ks.keys = append(ks.keys, key)
+}
+
+func newFSBSIndex() *fsbsIndex {
+	return &fsbsIndex{
+		entries:  make(map[string]map[int]Assertion),
+		byHeader: make(map[string]map[string]*fsbsKeySet),
+	}
+}
+
+func addToHeaderIndex(values map[string]*fsbsKeySet, header string, assert Assertion, key string) {
+	v, ok := assert.Header(header).(string)
+	if !ok {
+		return
+	}
+	ks := values[v]
+	if ks == nil {
+		ks = &fsbsKeySet{has: make(map[string]bool)}
+		values[v] = ks
+	}
+	ks.add(key)
+}
+
+func indexKey(primaryPath []string) string {
+	return strings.Join(diskPrimaryPathComps(primaryPath, "")[:len(primaryPath)], "/")
+}
+
+func (idx *fsbsIndex) add(assert Assertion) {
+	key := indexKey(assert.Ref().PrimaryKey)
+	formats := idx.entries[key]
+	if formats == nil {
+		formats = make(map[int]Assertion)
+		idx.entries[key] = formats
+		idx.keys = append(idx.keys, key)
+		idx.keysDirty = true
+	}
+	formats[assert.Format()] = assert
+	for header, values := range idx.byHeader {
+		addToHeaderIndex(values, header, assert, key)
+	}
+}
+
+// cur returns the latest revision of the assertion stored under key with
+// a format not above maxFormat.
+func (idx *fsbsIndex) cur(key string, maxFormat int) (a Assertion) {
+	for formatnum, a1 := range idx.entries[key] {
+		if formatnum <= maxFormat {
+			if a == nil || a1.Revision() > a.Revision() {
+				a = a1
+			}
+		}
+	}
+	return a
+}
+
+func (idx *fsbsIndex) indexed(header string) bool {
+	return idx.byHeader[header] != nil
+}
+
+func (idx *fsbsIndex) indexHeader(header string) {
+	if idx.indexed(header) {
+		return
+	}
+	values := make(map[string]*fsbsKeySet)
+	for _, key := range idx.sortedKeys() {
+		for _, a := range idx.entries[key] {
+			addToHeaderIndex(values, header, a, key)
+		}
+	}
+	idx.byHeader[header] = values
+}
+
+func (idx *fsbsIndex) sortedKeys() []string {
+	if idx.keysDirty {
+		sort.Strings(idx.keys)
+		idx.keysDirty = false
+	}
+	return idx.keys
+}
+
+// searchHeader returns the non primary key header to use to look up
+// candidates for a search with the given headers, if any.
+func searchHeader(assertType *AssertionType, headers map[string]string) string {
+	header := ""
+	for h := range headers {
+		if strutil.ListContains(assertType.PrimaryKey, h) {
+			continue
+		}
+		if header == "" || h < header {
+			header = h
+		}
+	}
+	return header
+}
+
+// loadIndex returns the index of the assertions of the given type, reading
+// them from disk if not done already. It must be called with mu locked for
+// writing.
+func (fsbs *filesystemBackstore) loadIndex(assertType *AssertionType) (*fsbsIndex, error) {
+	if idx := fsbs.indexes[assertType.Name]; idx != nil {
+		return idx, nil
+	}
+
+	idx := newFSBSIndex()
+	maxSupp := assertType.MaxSupportedFormat()
+	n := len(assertType.PrimaryKey)
+	diskPattern := make([]string, n+1)
+	for i := 0; i < n; i++ {
+		diskPattern[i] = "*"
+	}
+	diskPattern[n] = "active*"
+	candCb := func(diskPrimaryPaths []string) error {
+		for _, diskPrimaryPath := range diskPrimaryPaths {
+			formatnum, err := activeFormat(diskPrimaryPath)
+			if err != nil {
+				return err
+			}
+			if formatnum > maxSupp {
+				// not something we can make sense of
+				continue
+			}
+			a, err := fsbs.readAssertion(assertType, diskPrimaryPath)
+			if err != nil {
+				return err
+			}
+			idx.add(a)
+		}
+		return nil
+	}
+	assertTypeTop := filepath.Join(fsbs.top, assertType.Name)
+	if err := findWildcard(assertTypeTop, diskPattern, candCb); err != nil {
+		return nil, fmt.Errorf("broken assertion storage, indexing %s: %v", assertType.Name, err)
+	}
+	fsbs.indexes[assertType.Name] = idx
+	return idx, nil
+}
+
+// withIndex invokes f with the index of the given type, with header
+// indexed as well if not empty, loading them as needed.
+func (fsbs *filesystemBackstore) withIndex(assertType *AssertionType, header string, f func(idx *fsbsIndex) error) error {
+	fsbs.mu.RLock()
+	idx := fsbs.indexes[assertType.Name]
+	if idx != nil && (header == "" || idx.indexed(header)) && !idx.keysDirty {
+		defer fsbs.mu.RUnlock()
+		return f(idx)
+	}
+	fsbs.mu.RUnlock()
+
+	fsbs.mu.Lock()
+	defer fsbs.mu.Unlock()
+	idx, err := fsbs.loadIndex(assertType)
+	if err != nil {
+		return err
+	}
+	if header != "" {
+		idx.indexHeader(header)
+	}
+	idx.sortedKeys()
+	return f(idx)
 }
 
 // guarantees that result assertion is of the expected type (both in the AssertionType and go type sense)
@@ -71,32 +271,18 @@ func (fsbs *filesystemBackstore) readAssertion(assertType *AssertionType, diskPr
 	return assert, nil
 }
 
-func (fsbs *filesystemBackstore) pickLatestAssertion(assertType *AssertionType, diskPrimaryPaths []string, maxFormat int) (a Assertion, er error) {
-	for _, diskPrimaryPath := range diskPrimaryPaths {
-		fn := filepath.Base(diskPrimaryPath)
-		parts := strings.SplitN(fn, ".", 2)
-		formatnum := 0
-		if len(parts) == 2 {
-			var err error
-			formatnum, err = strconv.Atoi(parts[1])
-			if err != nil {
-				return nil, fmt.Errorf("invalid active assertion filename: %q", fn)
-			}
-		}
-		if formatnum <= maxFormat {
-			a1, err := fsbs.readAssertion(assertType, diskPrimaryPath)
-			if err != nil {
-				return nil, err
-			}
-			if a == nil || a1.Revision() > a.Revision() {
-				a = a1
-			}
+// activeFormat returns the format of the assertion stored at the given
+// path, encoded in its filename.
+func activeFormat(diskPrimaryPath string) (formatnum int, err error) {
+	fn := filepath.Base(diskPrimaryPath)
+	parts := strings.SplitN(fn, ".", 2)
+	if len(parts) == 2 {
+		formatnum, err = strconv.Atoi(parts[1])
+		if err != nil {
+			return 0, fmt.Errorf("invalid active assertion filename: %q", fn)
 		}
 	}
-	if a == nil {
-		return nil, errNotFound
-	}
-	return a, nil
+	return formatnum, nil
 }
 
 func diskPrimaryPathComps(primaryPath []string, active string) []string {
@@ -110,46 +296,24 @@ func diskPrimaryPathComps(primaryPath []string, active string) []string {
 	return comps
 }
 
-func (fsbs *filesystemBackstore) currentAssertion(assertType *AssertionType, primaryPath []string, maxFormat int) (Assertion, error) {
-	var a Assertion
-	namesCb := func(relpaths []string) error {
-		var err error
-		a, err = fsbs.pickLatestAssertion(assertType, relpaths, maxFormat)
-		if err == errNotFound {
-			return nil
-		}
-		return err
-	}
-
-	comps := diskPrimaryPathComps(primaryPath, "active*")
-	assertTypeTop := filepath.Join(fsbs.top, assertType.Name)
-	err := findWildcard(assertTypeTop, comps, namesCb)
-	if err != nil {
-		return nil, fmt.Errorf("broken assertion storage, looking for %s: %v", assertType.Name, err)
-	}
-
-	if a == nil {
-		return nil, errNotFound
-	}
-
-	return a, nil
-}
-
 func (fsbs *filesystemBackstore) Put(assertType *AssertionType, assert Assertion) error {
 	fsbs.mu.Lock()
 	defer fsbs.mu.Unlock()
 
+	idx, err := fsbs.loadIndex(assertType)
+	if err != nil {
+		return err
+	}
+
 	primaryPath := assert.Ref().PrimaryKey
 
-	curAssert, err := fsbs.currentAssertion(assertType, primaryPath, assertType.MaxSupportedFormat())
-	if err == nil {
+	curAssert := idx.cur(indexKey(primaryPath), assertType.MaxSupportedFormat())
+	if curAssert != nil {
 		curRev := curAssert.Revision()
 		rev := assert.Revision()
 		if curRev >= rev {
 			return &RevisionError{Current: curRev, Used: rev}
 		}
-	} else if err != errNotFound {
-		return err
 	}
 
 	formatnum := assert.Format()
@@ -162,60 +326,59 @@ func (fsbs *filesystemBackstore) Put(assertType *AssertionType, assert Assertion
 	if err != nil {
 		return fmt.Errorf("broken assertion storage, cannot write assertion: %v", err)
 	}
+	idx.add(assert)
 	return nil
 }
 
 func (fsbs *filesystemBackstore) Get(assertType *AssertionType, key []string, maxFormat int) (Assertion, error) {
-	fsbs.mu.RLock()
-	defer fsbs.mu.RUnlock()
-
-	a, err := fsbs.currentAssertion(assertType, key, maxFormat)
-	if err == errNotFound {
-		return nil, &NotFoundError{Type: assertType}
-	}
-	return a, err
-}
-
-func (fsbs *filesystemBackstore) search(assertType *AssertionType, diskPattern []string, foundCb func(Assertion), maxFormat int) error {
-	assertTypeTop := filepath.Join(fsbs.top, assertType.Name)
-	candCb := func(diskPrimaryPaths []string) error {
-		a, err := fsbs.pickLatestAssertion(assertType, diskPrimaryPaths, maxFormat)
-		if err == errNotFound {
-			return nil
-		}
-		if err != nil {
-			return err
-		}
-		foundCb(a)
+	var a Assertion
+	err := fsbs.withIndex(assertType, "", func(idx *fsbsIndex) error {
+		a = idx.cur(indexKey(key), maxFormat)
 		return nil
-	}
-	err := findWildcard(assertTypeTop, diskPattern, candCb)
+	})
 	if err != nil {
-		return fmt.Errorf("broken assertion storage, searching for %s: %v", assertType.Name, err)
+		return nil, err
 	}
-	return nil
+	if a == nil {
+		return nil, &NotFoundError{Type: assertType}
+	}
+	return a, nil
 }
 
 func (fsbs *filesystemBackstore) Search(assertType *AssertionType, headers map[string]string, foundCb func(Assertion), maxFormat int) error {
-	fsbs.mu.RLock()
-	defer fsbs.mu.RUnlock()
-
 	n := len(assertType.PrimaryKey)
-	diskPattern := make([]string, n+1)
+	keyVals := make([]string, n)
+	fullKey := true
 	for i, k := range assertType.PrimaryKey {
-		keyVal := headers[k]
-		if keyVal == "" {
-			diskPattern[i] = "*"
-		} else {
-			diskPattern[i] = url.QueryEscape(keyVal)
+		keyVals[i] = headers[k]
+		if keyVals[i] == "" {
+			fullKey = false
 		}
 	}
-	diskPattern[n] = "active*"
 
-	candCb := func(a Assertion) {
-		if searchMatch(a, headers) {
-			foundCb(a)
-		}
+	header := ""
+	if !fullKey {
+		header = searchHeader(assertType, headers)
 	}
-	return fsbs.search(assertType, diskPattern, candCb, maxFormat)
+
+	return fsbs.withIndex(assertType, header, func(idx *fsbsIndex) error {
+		var candidates []string
+		switch {
+		case fullKey:
+			candidates = []string{indexKey(keyVals)}
+		case header != "":
+			if ks := idx.byHeader[header][headers[header]]; ks != nil {
+				candidates = ks.keys
+			}
+		default:
+			candidates = idx.sortedKeys()
+		}
+		for _, key := range candidates {
+			a := idx.cur(key, maxFormat)
+			if a != nil && searchMatch(a, headers) {
+				foundCb(a)
+			}
+		}
+		return nil
+	})
 }
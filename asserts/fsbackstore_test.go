@@ -20,9 +20,12 @@
 package asserts_test
 
 import (
+	"fmt"
+	"io/ioutil"
 	"os"
 	"path/filepath"
 	"syscall"
+	"testing"
 
 	. "gopkg.in/check.v1"
 
@@ -256,3 +259,161 @@ func (fsbss *fsBackstoreSuite) TestSearchFormat(c *C) {
 	c.Check(as[0].Revision(), Equals, 1)
 
 }
+
+func decodeTestOnly2(c *C, pk1, pk2 string, rev int, extra string) asserts.Assertion {
+	a, err := asserts.Decode([]byte(fmt.Sprintf("type: test-only-2\n"+
+		"authority-id: auth-id1\n"+
+		"pk1: %s\n"+
+		"pk2: %s\n"+
+		"revision: %d\n"+
+		"extra: %s\n"+
+		"sign-key-sha3-384: Jv8_JiHiIzJVcO9M55pPdqSDWUvuhfDIBJUS-3VW7F_idjix7Ffn5qMxB21ZQuij"+
+		"\n\n"+
+		"AXNpZw==", pk1, pk2, rev, extra)))
+	c.Assert(err, IsNil)
+	return a
+}
+
+func (fsbss *fsBackstoreSuite) TestIndexLoadedFromDisk(c *C) {
+	topDir := filepath.Join(c.MkDir(), "asserts-db")
+	bs, err := asserts.OpenFSBackstore(topDir)
+	c.Assert(err, IsNil)
+
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "bar", 0, "x")), IsNil)
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "bar", 1, "y")), IsNil)
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo/1", "baz", 3, "x")), IsNil)
+
+	// a fresh backstore builds its index from what is on disk
+	bs, err = asserts.OpenFSBackstore(topDir)
+	c.Assert(err, IsNil)
+
+	a, err := bs.Get(asserts.TestOnly2Type, []string{"foo", "bar"}, 0)
+	c.Assert(err, IsNil)
+	c.Check(a.Revision(), Equals, 1)
+	a, err = bs.Get(asserts.TestOnly2Type, []string{"foo/1", "baz"}, 0)
+	c.Assert(err, IsNil)
+	c.Check(a.Revision(), Equals, 3)
+
+	err = bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "bar", 1, "z"))
+	c.Check(err, DeepEquals, &asserts.RevisionError{Current: 1, Used: 1})
+}
+
+func (fsbss *fsBackstoreSuite) TestSearchByHeaderKeptUpToDate(c *C) {
+	topDir := filepath.Join(c.MkDir(), "asserts-db")
+	bs, err := asserts.OpenFSBackstore(topDir)
+	c.Assert(err, IsNil)
+
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "bar", 0, "x")), IsNil)
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "baz", 0, "y")), IsNil)
+
+	search := func(headers map[string]string) []string {
+		var found []string
+		err := bs.Search(asserts.TestOnly2Type, headers, func(a asserts.Assertion) {
+			found = append(found, fmt.Sprintf("%s/%s@%d", a.HeaderString("pk1"), a.HeaderString("pk2"), a.Revision()))
+		}, 0)
+		c.Assert(err, IsNil)
+		return found
+	}
+
+	c.Check(search(map[string]string{"extra": "x"}), DeepEquals, []string{"foo/bar@0"})
+	c.Check(search(map[string]string{"pk1": "foo", "extra": "y"}), DeepEquals, []string{"foo/baz@0"})
+
+	// the header index follows new revisions and new assertions
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "foo", "bar", 1, "y")), IsNil)
+	c.Assert(bs.Put(asserts.TestOnly2Type, decodeTestOnly2(c, "zoo", "bar", 0, "x")), IsNil)
+
+	c.Check(search(map[string]string{"extra": "x"}), DeepEquals, []string{"zoo/bar@0"})
+	c.Check(search(map[string]string{"extra": "y"}), DeepEquals, []string{"foo/baz@0", "foo/bar@1"})
+	c.Check(search(map[string]string{"pk2": "bar"}), DeepEquals, []string{"foo/bar@1", "zoo/bar@0"})
+	c.Check(search(map[string]string{"pk1": "zoo", "pk2": "bar"}), DeepEquals, []string{"zoo/bar@0"})
+	c.Check(search(map[string]string{"extra": "none"}), HasLen, 0)
+}
+
+// populateFSBackstore stores n assertions in a new filesystem backstore,
+// spread over 100 values of a non primary key header.
+func populateFSBackstore(b *testing.B, n int) (topDir string) {
+	tmpdir, err := ioutil.TempDir("", "asserts-bench")
+	if err != nil {
+		b.Fatal(err)
+	}
+	topDir = filepath.Join(tmpdir, "asserts-db")
+	bs, err := asserts.OpenFSBackstore(topDir)
+	if err != nil {
+		b.Fatal(err)
+	}
+	for i := 0; i < n; i++ {
+		a, err := asserts.Decode([]byte(fmt.Sprintf("type: test-only-2\n"+
+			"authority-id: auth-id1\n"+
+			"pk1: key%d\n"+
+			"pk2: series\n"+
+			"extra: group%d\n"+
+			"sign-key-sha3-384: Jv8_JiHiIzJVcO9M55pPdqSDWUvuhfDIBJUS-3VW7F_idjix7Ffn5qMxB21ZQuij"+
+			"\n\n"+
+			"AXNpZw==", i, i%100)))
+		if err != nil {
+			b.Fatal(err)
+		}
+		if err := bs.Put(asserts.TestOnly2Type, a); err != nil {
+			b.Fatal(err)
+		}
+	}
+	return topDir
+}
+
+const benchAssertions = 10000
+
+func BenchmarkFSBackstoreGet10k(b *testing.B) {
+	topDir := populateFSBackstore(b, benchAssertions)
+	defer os.RemoveAll(filepath.Dir(topDir))
+	bs, err := asserts.OpenFSBackstore(topDir)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		key := []string{fmt.Sprintf("key%d", (i*7919)%benchAssertions), "series"}
+		if _, err := bs.Get(asserts.TestOnly2Type, key, 0); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkFSBackstoreSearchHeader10k(b *testing.B) {
+	topDir := populateFSBackstore(b, benchAssertions)
+	defer os.RemoveAll(filepath.Dir(topDir))
+	bs, err := asserts.OpenFSBackstore(topDir)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		found := 0
+		headers := map[string]string{"extra": fmt.Sprintf("group%d", i%100)}
+		err := bs.Search(asserts.TestOnly2Type, headers, func(asserts.Assertion) { found++ }, 0)
+		if err != nil {
+			b.Fatal(err)
+		}
+		if found != benchAssertions/100 {
+			b.Fatalf("found %d assertions", found)
+		}
+	}
+}
+
+func BenchmarkFSBackstoreOpenAndGet10k(b *testing.B) {
+	topDir := populateFSBackstore(b, benchAssertions)
+	defer os.RemoveAll(filepath.Dir(topDir))
+
+	// includes loading the index from disk
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		bs, err := asserts.OpenFSBackstore(topDir)
+		if err != nil {
+			b.Fatal(err)
+		}
+		if _, err := bs.Get(asserts.TestOnly2Type, []string{"key1", "series"}, 0); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
@@ -0,0 +1,197 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package asserts
+
+import (
+	"encoding/binary"
+	"sync"
+	"time"
+
+	"golang.org/x/crypto/sha3"
+)
+
+// maxSignatureCacheEntries bounds the number of verified signatures
+// remembered by a database.
+var maxSignatureCacheEntries = 10000
+
+// SignatureCacheStats reports how a database signature cache has been used.
+type SignatureCacheStats struct {
+	// Hits is the number of signature checks served from the cache.
+	Hits uint64
+	// Misses is the number of signature checks that needed a
+	// cryptographic verification.
+	Misses uint64
+	// Entries is the number of verified signatures currently cached.
+	Entries int
+}
+
+// HitRate returns the fraction of signature checks served from the cache.
+func (st SignatureCacheStats) HitRate() float64 {
+	total := st.Hits + st.Misses
+	if total == 0 {
+		return 0
+	}
+	return float64(st.Hits) / float64(total)
+}
+
+// sigCacheEntry remembers the signing key an assertion was verified
+// against, a new revision of the key (e.g. one revoking it) invalidates
+// the entry.
+type sigCacheEntry struct {
+	keyRevision int
+	keyUntil    time.Time
+}
+
+// signatureCache remembers the assertions whose signatures were
+// successfully verified, keyed by the digest of their signed content
+// and signature and by the signing key, so that checking them again
+// can skip the cryptographic verification.
+type signatureCache struct {
+	mu sync.Mutex
+	// byKey maps the signing key ID to the digests it verified
+	byKey   map[string]map[string]sigCacheEntry
+	entries int
+
+	hits   uint64
+	misses uint64
+}
+
+func newSignatureCache() *signatureCache {
+	return &signatureCache{
+		byKey: make(map[string]map[string]sigCacheEntry),
+	}
+}
+
+func signatureDigest(assert Assertion) string {
+	content, encSig := assert.Signature()
+	return digestSignedParts(content, encSig)
+}
+
+// digestSignedParts digests the signed content and the signature, each
+// prefixed by its length so that moving bytes from one to the other
+// cannot produce the same digest.
+func digestSignedParts(content, encSig []byte) string {
+	h := sha3.New384()
+	var size [8]byte
+	for _, part := range [][]byte{content, encSig} {
+		binary.BigEndian.PutUint64(size[:], uint64(len(part)))
+		h.Write(size[:])
+		h.Write(part)
+	}
+	return string(h.Sum(nil))
+}
+
+// verified returns whether the signature of the assertion was already
+// verified against the given signing key, still valid at checkTime.
+func (sc *signatureCache) verified(assert Assertion, signingKey *AccountKey, checkTime time.Time) bool {
+	keyID := signingKey.PublicKeyID()
+	digest := signatureDigest(assert)
+
+	sc.mu.Lock()
+	defer sc.mu.Unlock()
+
+	entry, ok := sc.byKey[keyID][digest]
+	if ok {
+		expired := !entry.keyUntil.IsZero() && !checkTime.Before(entry.keyUntil)
+		if entry.keyRevision != signingKey.Revision() || expired {
+			sc.forget(keyID, digest)
+			ok = false
+		}
+	}
+	if ok {
+		sc.hits++
+	} else {
+		sc.misses++
+	}
+	return ok
+}
+
+// add remembers that the signature of the assertion is valid for the
+// given signing key.
+func (sc *signatureCache) add(assert Assertion, signingKey *AccountKey) {
+	keyID := signingKey.PublicKeyID()
+	digest := signatureDigest(assert)
+
+	sc.mu.Lock()
+	defer sc.mu.Unlock()
+
+	if sc.entries >= maxSignatureCacheEntries {
+		// make room by dropping some arbitrary entry
+	evict:
+		for evictKeyID, digests := range sc.byKey {
+			for evictDigest := range digests {
+				sc.forget(evictKeyID, evictDigest)
+				break evict
+			}
+		}
+	}
+
+	digests := sc.byKey[keyID]
+	if digests == nil {
+		digests = make(map[string]sigCacheEntry)
+		sc.byKey[keyID] = digests
+	}
+	if _, ok := digests[digest]; !ok {
+		sc.entries++
+	}
+	digests[digest] = sigCacheEntry{
+		keyRevision: signingKey.Revision(),
+		keyUntil:    signingKey.Until(),
+	}
+}
+
+func (sc *signatureCache) forget(keyID, digest string) {
+	digests := sc.byKey[keyID]
+	if _, ok := digests[digest]; !ok {
+		return
+	}
+	delete(digests, digest)
+	sc.entries--
+	if len(digests) == 0 {
+		delete(sc.byKey, keyID)
+	}
+}
+
+// invalidateKey forgets all the signatures verified with the given key.
+func (sc *signatureCache) invalidateKey(keyID string) {
+	sc.mu.Lock()
+	defer sc.mu.Unlock()
+
+	sc.entries -= len(sc.byKey[keyID])
+	delete(sc.byKey, keyID)
+}
+
+func (sc *signatureCache) stats() SignatureCacheStats {
+	sc.mu.Lock()
+	defer sc.mu.Unlock()
+
+	return SignatureCacheStats{
+		Hits:    sc.hits,
+		Misses:  sc.misses,
+		Entries: sc.entries,
+	}
+}
+
+// signatureCacher is implemented by databases that can remember verified
+// signatures, CheckSignature consults it before doing the cryptographic
+// verification.
+type signatureCacher interface {
+	verifiedSignatures() *signatureCache
+}
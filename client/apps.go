@@ -70,6 +70,9 @@ type AppOptions struct {
 	// If Service is true, only return apps that are services
 	// (app.IsService() is true); otherwise, return all.
 	Service bool
+	// Fields, if not empty, restricts the app details returned to
+	// the ones with the given JSON field names.
+	Fields []string
 }
 
 // Apps returns information about all matching apps. Each name can be
@@ -83,6 +86,9 @@ func (client *Client) Apps(names []string, opts AppOptions) ([]*AppInfo, error)
 	if opts.Service {
 		q.Add("select", "service")
 	}
+	if len(opts.Fields) > 0 {
+		q.Add("fields", strings.Join(opts.Fields, ","))
+	}
 
 	var appInfos []*AppInfo
 	_, err := client.doSync("GET", "/v2/apps", q, nil, nil, &appInfos)
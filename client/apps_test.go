@@ -64,6 +64,17 @@ func testClientAppsService(cs *clientSuite, c *check.C) ([]*client.AppInfo, erro
 	return services, err
 }
 
+func (cs *clientSuite) TestClientAppsFields(c *check.C) {
+	cs.rsp = `{"type": "sync", "result": [{"snap": "foo", "name": "foo"}]}`
+	apps, err := cs.cli.Apps([]string{"foo"}, client.AppOptions{Fields: []string{"snap", "name"}})
+	c.Assert(err, check.IsNil)
+	c.Check(apps, check.DeepEquals, []*client.AppInfo{{Snap: "foo", Name: "foo"}})
+	query := cs.req.URL.Query()
+	c.Check(query, check.HasLen, 2)
+	c.Check(query.Get("names"), check.Equals, "foo")
+	c.Check(query.Get("fields"), check.Equals, "snap,name")
+}
+
 var appcheckers = []func(*clientSuite, *check.C) ([]*client.AppInfo, error){testClientApps, testClientAppsService}
 
 func (cs *clientSuite) TestClientServiceGetHappy(c *check.C) {
@@ -24,6 +24,7 @@ import (
 	"encoding/json"
 	"fmt"
 	"net/url"
+	"strings"
 	"time"
 )
 
@@ -134,6 +135,9 @@ const (
 type ChangesOptions struct {
 	SnapName string // if empty, no filtering by name is done
 	Selector ChangeSelector
+	// Fields, if not empty, restricts the change details returned
+	// to the ones with the given JSON field names.
+	Fields []string
 }
 
 func (client *Client) Changes(opts *ChangesOptions) ([]*Change, error) {
@@ -145,6 +149,9 @@ func (client *Client) Changes(opts *ChangesOptions) ([]*Change, error) {
 		if opts.SnapName != "" {
 			query.Set("for", opts.SnapName)
 		}
+		if len(opts.Fields) > 0 {
+			query.Set("fields", strings.Join(opts.Fields, ","))
+		}
 	}
 
 	var chgds []changeAndData
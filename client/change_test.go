@@ -178,6 +178,15 @@ func (cs *clientSuite) TestClientChanges(c *check.C) {
 
 }
 
+func (cs *clientSuite) TestClientChangesFields(c *check.C) {
+	cs.rsp = `{"type": "sync", "result": [{"id": "uno", "status": "Do"}]}`
+
+	chgs, err := cs.cli.Changes(&client.ChangesOptions{Fields: []string{"id", "status"}})
+	c.Assert(err, check.IsNil)
+	c.Check(chgs, check.DeepEquals, []*client.Change{{ID: "uno", Status: "Do"}})
+	c.Check(cs.req.URL.Query().Get("fields"), check.Equals, "id,status")
+}
+
 func (cs *clientSuite) TestClientChangesData(c *check.C) {
 	cs.rsp = `{"type": "sync", "result": [{
   "id":   "uno",
@@ -83,6 +83,9 @@ type InterfaceOptions struct {
 	Plugs     bool
 	Slots     bool
 	Connected bool
+	// Fields, if not empty, restricts the interface details returned
+	// to the ones with the given JSON field names.
+	Fields []string
 }
 
 func (client *Client) Interfaces(opts *InterfaceOptions) ([]*Interface, error) {
@@ -100,6 +103,9 @@ func (client *Client) Interfaces(opts *InterfaceOptions) ([]*Interface, error) {
 		if opts.Slots {
 			query.Set("slots", "true") // Return slots of each selected interface.
 		}
+		if len(opts.Fields) > 0 {
+			query.Set("fields", strings.Join(opts.Fields, ",")) // Return just those details of each interface.
+		}
 	}
 	// NOTE: Presence of "select" triggers the use of the new response format.
 	if opts != nil && opts.Connected {
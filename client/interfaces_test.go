@@ -156,6 +156,20 @@ func (cs *clientSuite) TestClientInterfacesMultiple(c *check.C) {
 	})
 }
 
+func (cs *clientSuite) TestClientInterfacesFields(c *check.C) {
+	cs.rsp = `{
+		"type": "sync",
+		"result": [
+			{"name": "iface-a"}
+		]
+	}`
+	ifaces, err := cs.cli.Interfaces(&client.InterfaceOptions{Names: []string{"iface-a"}, Fields: []string{"name"}})
+	c.Check(cs.req.URL.Path, check.Equals, "/v2/interfaces")
+	c.Check(cs.req.URL.RawQuery, check.Equals, "fields=name&names=iface-a&select=all")
+	c.Assert(err, check.IsNil)
+	c.Check(ifaces, check.DeepEquals, []*client.Interface{{Name: "iface-a"}})
+}
+
 func (cs *clientSuite) TestClientConnectCallsEndpoint(c *check.C) {
 	cs.cli.Connect("producer", "plug", "consumer", "slot")
 	c.Check(cs.req.Method, check.Equals, "POST")
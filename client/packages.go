@@ -145,6 +145,9 @@ var ErrNoSnapsInstalled = errors.New("no snaps installed")
 
 type ListOptions struct {
 	All bool
+	// Fields, if not empty, restricts the snap details returned to
+	// the ones with the given JSON field names.
+	Fields []string
 }
 
 // List returns the list of all snaps installed on the system
@@ -161,6 +164,9 @@ func (client *Client) List(names []string, opts *ListOptions) ([]*Snap, error) {
 	if len(names) > 0 {
 		q.Add("snaps", strings.Join(names, ","))
 	}
+	if len(opts.Fields) > 0 {
+		q.Add("fields", strings.Join(opts.Fields, ","))
+	}
 
 	snaps, _, err := client.snapsFromPath("/v2/snaps", q)
 	if err != nil {
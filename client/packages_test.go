@@ -187,6 +187,15 @@ func (cs *clientSuite) TestClientSnaps(c *check.C) {
 	}})
 }
 
+func (cs *clientSuite) TestClientSnapsFields(c *check.C) {
+	cs.rsp = `{"type": "sync", "result": [{"name": "hello-world", "version": "1.0"}]}`
+	snaps, err := cs.cli.List([]string{"hello-world"}, &client.ListOptions{Fields: []string{"name", "version"}})
+	c.Assert(err, check.IsNil)
+	c.Check(snaps, check.DeepEquals, []*client.Snap{{Name: "hello-world", Version: "1.0"}})
+	c.Check(cs.req.URL.Path, check.Equals, "/v2/snaps")
+	c.Check(cs.req.URL.Query().Get("fields"), check.Equals, "name,version")
+}
+
 func (cs *clientSuite) TestClientFilterSnaps(c *check.C) {
 	_, _, _ = cs.cli.Find(&client.FindOptions{Query: "foo"})
 	c.Check(cs.req.URL.Path, check.Equals, "/v2/find")
@@ -33,6 +33,11 @@ type SnapCtlOptions struct {
 
 	// Args contains a list of parameters to use for this invocation.
 	Args []string `json:"args"`
+
+	// Batch contains the lists of parameters of several invocations
+	// to run one after the other in a single request, it is used
+	// instead of Args by RunSnapctlBatch.
+	Batch [][]string `json:"batch,omitempty"`
 }
 
 type snapctlOutput struct {
@@ -55,3 +60,80 @@ func (client *Client) RunSnapctl(options *SnapCtlOptions) (stdout, stderr []byte
 
 	return []byte(output.Stdout), []byte(output.Stderr), nil
 }
+
+// SnapCtlOutput holds the output of a snapctl invocation.
+type SnapCtlOutput struct {
+	Stdout []byte
+	Stderr []byte
+}
+
+type snapctlBatchOutput struct {
+	Batch []snapctlOutput `json:"batch"`
+}
+
+// RunSnapctlBatch requests running the snapctl invocations of
+// options.Batch in a single round trip. The invocations stop at the
+// first failing one, and configuration changes done outside of hooks
+// are applied together only if all the invocations succeeded.
+func (client *Client) RunSnapctlBatch(options *SnapCtlOptions) ([]SnapCtlOutput, error) {
+	if len(options.Args) != 0 {
+		return nil, fmt.Errorf("cannot run a snapctl batch with args")
+	}
+	b, err := json.Marshal(options)
+	if err != nil {
+		return nil, fmt.Errorf("cannot marshal options: %s", err)
+	}
+
+	var output snapctlBatchOutput
+	_, err = client.doSync("POST", "/v2/snapctl", nil, nil, bytes.NewReader(b), &output)
+	if err != nil {
+		return nil, err
+	}
+
+	outputs := make([]SnapCtlOutput, len(output.Batch))
+	for i, o := range output.Batch {
+		outputs[i] = SnapCtlOutput{Stdout: []byte(o.Stdout), Stderr: []byte(o.Stderr)}
+	}
+	return outputs, nil
+}
+
+// SnapCtlSession runs snapctl invocations for a context, reusing the
+// connection to snapd, either right away or queued to run together in
+// a single batch.
+type SnapCtlSession struct {
+	client    *Client
+	contextID string
+	queued    [][]string
+}
+
+// NewSnapCtlSession returns a session running snapctl invocations for
+// the given context.
+func (client *Client) NewSnapCtlSession(contextID string) *SnapCtlSession {
+	return &SnapCtlSession{client: client, contextID: contextID}
+}
+
+// Run runs a snapctl invocation right away.
+func (s *SnapCtlSession) Run(args ...string) (stdout, stderr []byte, err error) {
+	return s.client.RunSnapctl(&SnapCtlOptions{
+		ContextID: s.contextID,
+		Args:      args,
+	})
+}
+
+// Queue queues a snapctl invocation to run with the next Flush.
+func (s *SnapCtlSession) Queue(args ...string) {
+	s.queued = append(s.queued, args)
+}
+
+// Flush runs the queued snapctl invocations in a single batch.
+func (s *SnapCtlSession) Flush() ([]SnapCtlOutput, error) {
+	if len(s.queued) == 0 {
+		return nil, nil
+	}
+	batch := s.queued
+	s.queued = nil
+	return s.client.RunSnapctlBatch(&SnapCtlOptions{
+		ContextID: s.contextID,
+		Batch:     batch,
+	})
+}
@@ -66,3 +66,79 @@ func (cs *clientSuite) TestClientRunSnapctl(c *check.C) {
 		"args":       []interface{}{"foo", "bar"},
 	})
 }
+
+func (cs *clientSuite) TestClientRunSnapctlBatch(c *check.C) {
+	cs.rsp = `{
+		"type": "sync",
+		"status-code": 200,
+		"result": {
+			"batch": [
+				{"stdout": "1\n", "stderr": ""},
+				{"stdout": "", "stderr": "warning"}
+			]
+		}
+	}`
+
+	outputs, err := cs.cli.RunSnapctlBatch(&client.SnapCtlOptions{
+		ContextID: "1234ABCD",
+		Batch:     [][]string{{"get", "a"}, {"set", "b=2"}},
+	})
+	c.Assert(err, check.IsNil)
+	c.Assert(outputs, check.HasLen, 2)
+	c.Check(string(outputs[0].Stdout), check.Equals, "1\n")
+	c.Check(string(outputs[1].Stderr), check.Equals, "warning")
+
+	c.Check(cs.req.Method, check.Equals, "POST")
+	c.Check(cs.req.URL.Path, check.Equals, "/v2/snapctl")
+	var body map[string]interface{}
+	c.Assert(json.NewDecoder(cs.req.Body).Decode(&body), check.IsNil)
+	c.Check(body, check.DeepEquals, map[string]interface{}{
+		"context-id": "1234ABCD",
+		"args":       nil,
+		"batch": []interface{}{
+			[]interface{}{"get", "a"},
+			[]interface{}{"set", "b=2"},
+		},
+	})
+}
+
+func (cs *clientSuite) TestClientRunSnapctlBatchWithArgs(c *check.C) {
+	_, err := cs.cli.RunSnapctlBatch(&client.SnapCtlOptions{
+		Args:  []string{"get", "a"},
+		Batch: [][]string{{"get", "b"}},
+	})
+	c.Check(err, check.ErrorMatches, "cannot run a snapctl batch with args")
+	c.Check(cs.req, check.IsNil)
+}
+
+func (cs *clientSuite) TestClientSnapCtlSession(c *check.C) {
+	cs.rsp = `{
+		"type": "sync",
+		"status-code": 200,
+		"result": {"batch": [{"stdout": "1\n"}, {"stdout": "2\n"}]}
+	}`
+
+	session := cs.cli.NewSnapCtlSession("1234ABCD")
+	outputs, err := session.Flush()
+	c.Assert(err, check.IsNil)
+	c.Check(outputs, check.HasLen, 0)
+	c.Check(cs.req, check.IsNil)
+
+	session.Queue("get", "a")
+	session.Queue("get", "b")
+	outputs, err = session.Flush()
+	c.Assert(err, check.IsNil)
+	c.Assert(outputs, check.HasLen, 2)
+	c.Check(string(outputs[1].Stdout), check.Equals, "2\n")
+
+	var body map[string]interface{}
+	c.Assert(json.NewDecoder(cs.req.Body).Decode(&body), check.IsNil)
+	c.Check(body["batch"], check.HasLen, 2)
+
+	// the queue was flushed
+	cs.req = nil
+	outputs, err = session.Flush()
+	c.Assert(err, check.IsNil)
+	c.Check(outputs, check.HasLen, 0)
+	c.Check(cs.req, check.IsNil)
+}
@@ -257,6 +257,20 @@ func antialias(snapApp string, args []string) (string, []string) {
 }
 
 func getSnapInfo(snapName string, revision snap.Revision) (info *snap.Info, err error) {
+	// the launch descriptor written when the snap was linked has all
+	// we need, use it to avoid reading and parsing snap.yaml
+	if revision.Unset() {
+		info, err = snap.ReadCurrentLaunchInfo(snapName)
+	} else {
+		info, err = snap.ReadLaunchInfo(snapName, revision)
+	}
+	if err == nil {
+		return info, nil
+	}
+	if err != snap.ErrStaleLaunchDescriptor {
+		logger.Debugf("cannot use launch descriptor of snap %q: %v", snapName, err)
+	}
+
 	if revision.Unset() {
 		info, err = snap.ReadCurrentInfo(snapName)
 	} else {
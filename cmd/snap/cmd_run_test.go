@@ -20,8 +20,10 @@
 package main_test
 
 import (
+	"encoding/json"
 	"errors"
 	"fmt"
+	"io/ioutil"
 	"os"
 	"os/user"
 	"path/filepath"
@@ -38,6 +40,7 @@ import (
 	"github.com/snapcore/snapd/snap"
 	"github.com/snapcore/snapd/snap/snaptest"
 	"github.com/snapcore/snapd/testutil"
+	"github.com/snapcore/snapd/wrappers"
 	"github.com/snapcore/snapd/x11"
 )
 
@@ -189,6 +192,53 @@ func (s *RunSuite) TestSnapRunAppIntegration(c *check.C) {
 	c.Check(execEnv, testutil.Contains, "SNAP_REVISION=x2")
 }
 
+func (s *RunSuite) TestSnapRunAppUsesLaunchDescriptor(c *check.C) {
+	defer mockSnapConfine(dirs.DistroLibExecDir)()
+
+	// mock installed snap and its launch descriptor
+	info := snaptest.MockSnapCurrent(c, string(mockYaml), &snap.SideInfo{
+		Revision: snap.R("x2"),
+	})
+	c.Assert(wrappers.AddSnapLaunchDescriptor(info), check.IsNil)
+	// tweak the descriptor to see it being used
+	data, err := ioutil.ReadFile(snap.LaunchDescriptorFile("snapname"))
+	c.Assert(err, check.IsNil)
+	var desc snap.LaunchDescriptor
+	c.Assert(json.Unmarshal(data, &desc), check.IsNil)
+	desc.Version = "from-descriptor"
+	data, err = json.Marshal(&desc)
+	c.Assert(err, check.IsNil)
+	c.Assert(ioutil.WriteFile(snap.LaunchDescriptorFile("snapname"), data, 0644), check.IsNil)
+
+	// redirect exec
+	execArgs := []string{}
+	execEnv := []string{}
+	restorer := snaprun.MockSyscallExec(func(arg0 string, args []string, envv []string) error {
+		execArgs = args
+		execEnv = envv
+		return nil
+	})
+	defer restorer()
+
+	// and run it!
+	_, err = snaprun.Parser(snaprun.Client()).ParseArgs([]string{"run", "--", "snapname.app", "--arg1"})
+	c.Assert(err, check.IsNil)
+	c.Check(execArgs, check.DeepEquals, []string{
+		filepath.Join(dirs.DistroLibExecDir, "snap-confine"),
+		"snap.snapname.app",
+		filepath.Join(dirs.CoreLibExecDir, "snap-exec"),
+		"snapname.app", "--arg1"})
+	c.Check(execEnv, testutil.Contains, "SNAP_REVISION=x2")
+	c.Check(execEnv, testutil.Contains, "SNAP_VERSION=from-descriptor")
+
+	// a stale descriptor is ignored
+	later := time.Now().Add(time.Hour)
+	c.Assert(os.Chtimes(filepath.Join(info.MountDir(), "meta", "snap.yaml"), later, later), check.IsNil)
+	_, err = snaprun.Parser(snaprun.Client()).ParseArgs([]string{"run", "--", "snapname.app", "--arg1"})
+	c.Assert(err, check.IsNil)
+	c.Check(execEnv, testutil.Contains, "SNAP_VERSION=1.0")
+}
+
 func (s *RunSuite) TestSnapRunClassicAppIntegration(c *check.C) {
 	defer mockSnapConfine(dirs.DistroLibExecDir)()
 
@@ -20,11 +20,15 @@
 package main
 
 import (
+	"bufio"
 	"fmt"
+	"io"
 	"os"
+	"strings"
 
 	"github.com/snapcore/snapd/client"
 	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/strutil/shlex"
 	"github.com/snapcore/snapd/xdgopenproxy"
 )
 
@@ -55,8 +59,22 @@ func main() {
 		os.Exit(0)
 	}
 
+	if len(os.Args) == 2 && os.Args[1] == "--session" {
+		if err := runSession(os.Stdin, os.Stdout); err != nil {
+			fmt.Fprintf(os.Stderr, "error: %s\n", err)
+			os.Exit(1)
+		}
+		os.Exit(0)
+	}
+
 	// no internal command, route via snapd
-	stdout, stderr, err := run()
+	var stdout, stderr []byte
+	var err error
+	if len(os.Args) == 2 && os.Args[1] == "--batch" {
+		stdout, stderr, err = runBatch(os.Stdin)
+	} else {
+		stdout, stderr, err = run()
+	}
 	if err != nil {
 		fmt.Fprintf(os.Stderr, "error: %s\n", err)
 		os.Exit(1)
@@ -71,16 +89,112 @@ func main() {
 	}
 }
 
-func run() (stdout, stderr []byte, err error) {
-	cli := client.New(&clientConfig)
-
+func contextID() string {
 	cookie := os.Getenv("SNAP_COOKIE")
 	// for compatibility, if re-exec is not enabled and facing older snapd.
 	if cookie == "" {
 		cookie = os.Getenv("SNAP_CONTEXT")
 	}
+	return cookie
+}
+
+func run() (stdout, stderr []byte, err error) {
+	cli := client.New(&clientConfig)
+
 	return cli.RunSnapctl(&client.SnapCtlOptions{
-		ContextID: cookie,
+		ContextID: contextID(),
 		Args:      os.Args[1:],
 	})
 }
+
+// readInvocation reads the next snapctl invocation, one per line with
+// shell-like quoting, skipping empty lines and comments.
+func readInvocation(scanner *bufio.Scanner) ([]string, error) {
+	for scanner.Scan() {
+		line := strings.TrimSpace(scanner.Text())
+		if line == "" || strings.HasPrefix(line, "#") {
+			continue
+		}
+		args, err := shlex.Split(line)
+		if err != nil {
+			return nil, fmt.Errorf("cannot parse %q: %v", line, err)
+		}
+		return args, nil
+	}
+	return nil, scanner.Err()
+}
+
+// runBatch runs all the invocations read from r in a single request
+// to snapd, configuration changes done outside of hooks are applied
+// together if they all succeed.
+func runBatch(r io.Reader) (stdout, stderr []byte, err error) {
+	var batch [][]string
+	scanner := bufio.NewScanner(r)
+	for {
+		args, err := readInvocation(scanner)
+		if err != nil {
+			return nil, nil, err
+		}
+		if args == nil {
+			break
+		}
+		batch = append(batch, args)
+	}
+	if len(batch) == 0 {
+		return nil, nil, fmt.Errorf("no snapctl invocations to run in the batch")
+	}
+
+	cli := client.New(&clientConfig)
+	outputs, err := cli.RunSnapctlBatch(&client.SnapCtlOptions{
+		ContextID: contextID(),
+		Batch:     batch,
+	})
+	if err != nil {
+		return nil, nil, err
+	}
+	for _, output := range outputs {
+		stdout = append(stdout, output.Stdout...)
+		stderr = append(stderr, output.Stderr...)
+	}
+	return stdout, stderr, nil
+}
+
+// runSession runs the invocations read from r one by one as they come,
+// reusing the connection to snapd, so that a hook can keep a snapctl
+// session around (e.g. as a coprocess) instead of starting snapctl for
+// every invocation.
+//
+// A reply is written to w for each invocation, made of a line with its
+// exit status and the lengths of its standard output and standard error,
+// followed by both:
+//
+//	<status> <stdout length> <stderr length>\n<stdout><stderr>
+//
+// A failing invocation gets a non-zero status with the error in its
+// standard error, the session carries on with the next one. The session
+// ends at the end of r.
+func runSession(r io.Reader, w io.Writer) error {
+	session := client.New(&clientConfig).NewSnapCtlSession(contextID())
+	scanner := bufio.NewScanner(r)
+	for {
+		args, err := readInvocation(scanner)
+		if scanErr := scanner.Err(); scanErr != nil {
+			return scanErr
+		}
+		if err == nil && args == nil {
+			return nil
+		}
+		var out, errOut []byte
+		if err == nil {
+			out, errOut, err = session.Run(args...)
+		}
+		status := 0
+		if err != nil {
+			status = 1
+			errOut = append(errOut, fmt.Sprintf("error: %s\n", err)...)
+		}
+		if _, err := fmt.Fprintf(w, "%d %d %d\n%s%s", status, len(out), len(errOut), out, errOut); err != nil {
+			return err
+		}
+	}
+}
@@ -20,6 +20,7 @@
 package main
 
 import (
+	"bytes"
 	"encoding/json"
 	"fmt"
 	"io/ioutil"
@@ -27,6 +28,7 @@ import (
 	"net/http/httptest"
 	"os"
 	"path/filepath"
+	"strings"
 	"testing"
 
 	"github.com/snapcore/snapd/client"
@@ -115,3 +117,104 @@ func (s *snapctlSuite) TestSnapctlHelp(c *C) {
 	_, _, err := run()
 	c.Check(err, IsNil)
 }
+
+type snapctlBatchSuite struct {
+	server   *httptest.Server
+	requests []client.SnapCtlOptions
+}
+
+var _ = Suite(&snapctlBatchSuite{})
+
+func (s *snapctlBatchSuite) SetUpTest(c *C) {
+	os.Setenv("SNAP_COOKIE", "snap-context-test")
+	s.requests = nil
+	s.server = httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		c.Assert(r.Method, Equals, "POST")
+		c.Assert(r.URL.Path, Equals, "/v2/snapctl")
+
+		var snapctlOptions client.SnapCtlOptions
+		c.Assert(json.NewDecoder(r.Body).Decode(&snapctlOptions), IsNil)
+		s.requests = append(s.requests, snapctlOptions)
+
+		if len(snapctlOptions.Args) == 1 && snapctlOptions.Args[0] == "fail" {
+			w.WriteHeader(400)
+			fmt.Fprintf(w, `{"type": "error", "status-code": 400, "result": {"message": "boom"}}`)
+			return
+		}
+		if len(snapctlOptions.Batch) == 0 {
+			fmt.Fprintf(w, `{"type": "sync", "result": {"stdout": "%s\n"}}`, strings.Join(snapctlOptions.Args, " "))
+			return
+		}
+		results := make([]string, len(snapctlOptions.Batch))
+		for i, args := range snapctlOptions.Batch {
+			results[i] = fmt.Sprintf(`{"stdout": "%s\n", "stderr": "%d"}`, strings.Join(args, " "), i)
+		}
+		fmt.Fprintf(w, `{"type": "sync", "result": {"batch": [%s]}}`, strings.Join(results, ","))
+	}))
+	clientConfig.BaseURL = s.server.URL
+}
+
+func (s *snapctlBatchSuite) TearDownTest(c *C) {
+	os.Unsetenv("SNAP_COOKIE")
+	clientConfig.BaseURL = ""
+	s.server.Close()
+}
+
+const snapctlInvocations = `
+# comments and empty lines are skipped
+get a
+
+set b=2 'c=two words'
+get -t "d"
+`
+
+func (s *snapctlBatchSuite) TestSnapctlBatch(c *C) {
+	stdout, stderr, err := runBatch(strings.NewReader(snapctlInvocations))
+	c.Assert(err, IsNil)
+	c.Check(string(stdout), Equals, "get a\nset b=2 c=two words\nget -t d\n")
+	c.Check(string(stderr), Equals, "012")
+
+	// all in a single request
+	c.Assert(s.requests, HasLen, 1)
+	c.Check(s.requests[0].ContextID, Equals, "snap-context-test")
+	c.Check(s.requests[0].Batch, DeepEquals, [][]string{
+		{"get", "a"},
+		{"set", "b=2", "c=two words"},
+		{"get", "-t", "d"},
+	})
+}
+
+func (s *snapctlBatchSuite) TestSnapctlBatchErrors(c *C) {
+	_, _, err := runBatch(strings.NewReader("# nothing\n"))
+	c.Check(err, ErrorMatches, "no snapctl invocations to run in the batch")
+	_, _, err = runBatch(strings.NewReader("get 'a\n"))
+	c.Check(err, ErrorMatches, `cannot parse "get 'a": .*`)
+	c.Check(s.requests, HasLen, 0)
+}
+
+func (s *snapctlBatchSuite) TestSnapctlSession(c *C) {
+	var stdout bytes.Buffer
+	err := runSession(strings.NewReader(snapctlInvocations), &stdout)
+	c.Assert(err, IsNil)
+	c.Check(stdout.String(), Equals, "0 6 0\nget a\n0 20 0\nset b=2 c=two words\n0 9 0\nget -t d\n")
+
+	// one request per invocation
+	c.Assert(s.requests, HasLen, 3)
+	for _, req := range s.requests {
+		c.Check(req.ContextID, Equals, "snap-context-test")
+		c.Check(req.Batch, HasLen, 0)
+	}
+	c.Check(s.requests[1].Args, DeepEquals, []string{"set", "b=2", "c=two words"})
+}
+
+func (s *snapctlBatchSuite) TestSnapctlSessionErrors(c *C) {
+	var stdout bytes.Buffer
+	err := runSession(strings.NewReader("get 'a\nfail\nget b\n"), &stdout)
+	c.Assert(err, IsNil)
+	// each failure is reported in its reply, and the session goes on
+	c.Check(stdout.String(), Equals, ""+
+		"1 0 69\nerror: cannot parse \"get 'a\": EOF found when expecting closing quote\n"+
+		"1 0 12\nerror: boom\n"+
+		"0 6 0\nget b\n")
+	c.Assert(s.requests, HasLen, 2)
+}
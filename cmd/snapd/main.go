@@ -53,6 +53,10 @@ func init() {
 func main() {
 	cmd.ExecInSnapdOrCoreSnap()
 
+	// talk to systemd over D-Bus instead of running systemctl for every
+	// operation, unless disabled
+	systemd.UseDBus(osutil.GetenvBool("SNAPD_SYSTEMD_DBUS", true))
+
 	ch := make(chan os.Signal, 2)
 	signal.Notify(ch, syscall.SIGINT, syscall.SIGTERM)
 	if err := run(ch); err != nil {
@@ -56,6 +56,7 @@ import (
 	"github.com/snapcore/snapd/overlord/auth"
 	"github.com/snapcore/snapd/overlord/configstate"
 	"github.com/snapcore/snapd/overlord/configstate/config"
+	"github.com/snapcore/snapd/overlord/hookstate"
 	"github.com/snapcore/snapd/overlord/hookstate/ctlcmd"
 	"github.com/snapcore/snapd/overlord/ifacestate"
 	"github.com/snapcore/snapd/overlord/servicestate"
@@ -694,7 +695,8 @@ func getSnapsInfo(c *Command, r *http.Request, user *auth.UserState) Response {
 		return InternalError("cannot list local snaps! %v", err)
 	}
 
-	results := make([]*json.RawMessage, len(found))
+	// the results are marshalled as they are written out
+	results := make([]*client.Snap, len(found))
 
 	for i, x := range found {
 		name := x.info.InstanceName()
@@ -706,15 +708,10 @@ func getSnapsInfo(c *Command, r *http.Request, user *auth.UserState) Response {
 			continue
 		}
 
-		data, err := json.Marshal(webify(mapLocal(x), url.String()))
-		if err != nil {
-			return InternalError("cannot serialize snap %q revision %s: %v", name, rev, err)
-		}
-		raw := json.RawMessage(data)
-		results[i] = &raw
+		results[i] = webify(mapLocal(x), url.String())
 	}
 
-	return SyncResponse(results, &Meta{Sources: []string{"local"}})
+	return syncListResponse(r, results, &Meta{Sources: []string{"local"}})
 }
 
 // licenseData holds details about the snap license, and may be
@@ -1691,7 +1688,7 @@ func getInterfaces(c *Command, r *http.Request, user *auth.UserState) Response {
 			Slots:   slots,
 		})
 	}
-	return SyncResponse(infoJSONs, nil)
+	return syncListResponse(r, infoJSONs, nil)
 }
 
 func getLegacyConnections(c *Command, r *http.Request, user *auth.UserState) Response {
@@ -1962,7 +1959,7 @@ func getChanges(c *Command, r *http.Request, user *auth.UserState) Response {
 		}
 		chgInfos = append(chgInfos, change2changeInfo(chg))
 	}
-	return SyncResponse(chgInfos, nil)
+	return syncListResponse(r, chgInfos, nil)
 }
 
 func abortChange(c *Command, r *http.Request, user *auth.UserState) Response {
@@ -2004,6 +2001,7 @@ func abortChange(c *Command, r *http.Request, user *auth.UserState) Response {
 var (
 	runSnapctlUcrednetGet = ucrednetGet
 	ctlcmdRun             = ctlcmd.Run
+	ctlcmdRunBatch        = ctlcmd.RunBatch
 )
 
 func convertBuyError(err error) Response {
@@ -2089,9 +2087,17 @@ func runSnapctl(c *Command, r *http.Request, user *auth.UserState) Response {
 		return BadRequest("cannot decode snapctl request: %s", err)
 	}
 
-	if len(snapctlOptions.Args) == 0 {
+	if len(snapctlOptions.Args) == 0 && len(snapctlOptions.Batch) == 0 {
 		return BadRequest("snapctl cannot run without args")
 	}
+	if len(snapctlOptions.Args) != 0 && len(snapctlOptions.Batch) != 0 {
+		return BadRequest("snapctl cannot run both args and a batch")
+	}
+	for _, args := range snapctlOptions.Batch {
+		if len(args) == 0 {
+			return BadRequest("snapctl cannot run without args")
+		}
+	}
 
 	_, uid, _, err := runSnapctlUcrednetGet(r.RemoteAddr)
 	if err != nil {
@@ -2101,6 +2107,9 @@ func runSnapctl(c *Command, r *http.Request, user *auth.UserState) Response {
 	// Ignore missing context error to allow 'snapctl -h' without a context;
 	// Actual context is validated later by get/set.
 	context, _ := c.d.overlord.HookManager().Context(snapctlOptions.ContextID)
+	if len(snapctlOptions.Batch) != 0 {
+		return runSnapctlBatch(context, snapctlOptions.Batch, uid)
+	}
 	stdout, stderr, err := ctlcmdRun(context, snapctlOptions.Args, uid)
 	if err != nil {
 		if e, ok := err.(*ctlcmd.ForbiddenCommandError); ok {
@@ -2129,6 +2138,37 @@ func runSnapctl(c *Command, r *http.Request, user *auth.UserState) Response {
 	return SyncResponse(result, nil)
 }
 
+// runSnapctlBatch runs the invocations of a batch one after the other
+// with the same context, their configuration changes are kept only once
+// they all succeeded, and for an ephemeral context applied together.
+func runSnapctlBatch(context *hookstate.Context, batch [][]string, uid uint32) Response {
+	outputs, err := ctlcmdRunBatch(context, batch, uid)
+	if err != nil {
+		if e, ok := err.(*ctlcmd.ForbiddenCommandError); ok {
+			return Forbidden(e.Error())
+		}
+		return BadRequest("error running snapctl (invocation %d of the batch): %s", len(outputs), err)
+	}
+
+	if context != nil && context.IsEphemeral() {
+		context.Lock()
+		defer context.Unlock()
+		if err := context.Done(); err != nil {
+			return BadRequest(i18n.G("set failed: %v"), err)
+		}
+	}
+
+	results := make([]map[string]string, len(outputs))
+	for i, output := range outputs {
+		results[i] = map[string]string{
+			"stdout": string(output.Stdout),
+			"stderr": string(output.Stderr),
+		}
+	}
+
+	return SyncResponse(map[string]interface{}{"batch": results}, nil)
+}
+
 // aliasAction is an action performed on aliases
 type aliasAction struct {
 	Action string `json:"action"`
@@ -2282,7 +2322,7 @@ func getAppsInfo(c *Command, r *http.Request, user *auth.UserState) Response {
 		return InternalError("%v", err)
 	}
 
-	return SyncResponse(clientAppInfos, nil)
+	return syncListResponse(r, clientAppInfos, nil)
 }
 
 func getLogs(c *Command, r *http.Request, user *auth.UserState) Response {
@@ -2319,15 +2359,14 @@ func getLogs(c *Command, r *http.Request, user *auth.UserState) Response {
 		serviceNames[i] = appInfo.ServiceName()
 	}
 
-	sysd := systemd.New(dirs.GlobalRootDir, systemd.SystemMode, progress.Null)
-	reader, err := sysd.LogReader(serviceNames, n, follow)
+	reader, err := systemd.NewJournalReader(serviceNames, n, follow)
 	if err != nil {
 		return InternalError("cannot get logs: %v", err)
 	}
 
-	return &journalLineReaderSeqResponse{
-		ReadCloser: reader,
-		follow:     follow,
+	return &journalReaderSeqResponse{
+		reader: reader,
+		follow: follow,
 	}
 }
 
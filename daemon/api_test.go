@@ -4419,12 +4419,13 @@ func (s *apiSuite) TestRevertSnapToRevisionClassic(c *check.C) {
 }
 
 func snapList(rawSnaps interface{}) []map[string]interface{} {
-	snaps := make([]map[string]interface{}, len(rawSnaps.([]*json.RawMessage)))
-	for i, raw := range rawSnaps.([]*json.RawMessage) {
-		err := json.Unmarshal([]byte(*raw), &snaps[i])
-		if err != nil {
-			panic(err)
-		}
+	data, err := json.Marshal(rawSnaps)
+	if err != nil {
+		panic(err)
+	}
+	var snaps []map[string]interface{}
+	if err := json.Unmarshal(data, &snaps); err != nil {
+		panic(err)
 	}
 	return snaps
 }
@@ -6487,6 +6488,68 @@ func (s *apiSuite) TestSnapctlForbiddenError(c *check.C) {
 	c.Assert(rsp.Status, check.Equals, 403)
 }
 
+func (s *apiSuite) TestSnapctlBatch(c *check.C) {
+	d := s.daemon(c)
+	st := d.overlord.State()
+	st.Lock()
+	st.Set("snap-cookies", map[string]string{"some-cookie": "some-snap"})
+	st.Unlock()
+
+	runSnapctlUcrednetGet = func(string) (int32, uint32, string, error) {
+		return 100, 0, dirs.SnapSocket, nil
+	}
+	defer func() { runSnapctlUcrednetGet = ucrednetGet }()
+
+	buf := bytes.NewBufferString(`{"context-id": "some-cookie", "batch": [["set", "a=1", "b=2"], ["get", "a"], ["set", "c=3"]]}`)
+	req, err := http.NewRequest("POST", "/v2/snapctl", buf)
+	c.Assert(err, check.IsNil)
+	rsp := runSnapctl(snapctlCmd, req, nil).(*resp)
+	c.Assert(rsp.Status, check.Equals, 200)
+	c.Check(rsp.Result, check.DeepEquals, map[string]interface{}{
+		"batch": []map[string]string{
+			{"stdout": "", "stderr": ""},
+			{"stdout": "1\n", "stderr": ""},
+			{"stdout": "", "stderr": ""},
+		},
+	})
+
+	st.Lock()
+	tr := config.NewTransaction(st)
+	var value int
+	c.Check(tr.Get("some-snap", "b", &value), check.IsNil)
+	c.Check(value, check.Equals, 2)
+	c.Check(tr.Get("some-snap", "c", &value), check.IsNil)
+	c.Check(value, check.Equals, 3)
+	st.Unlock()
+
+	// nothing is applied if an invocation fails
+	buf = bytes.NewBufferString(`{"context-id": "some-cookie", "batch": [["set", "d=4"], ["get", "--foo"]]}`)
+	req, err = http.NewRequest("POST", "/v2/snapctl", buf)
+	c.Assert(err, check.IsNil)
+	rsp = runSnapctl(snapctlCmd, req, nil).(*resp)
+	c.Assert(rsp.Status, check.Equals, 400)
+	c.Check(rsp.Result.(*errorResult).Message, check.Matches, `error running snapctl \(invocation 2 of the batch\): .*unknown flag.*`)
+
+	st.Lock()
+	defer st.Unlock()
+	tr = config.NewTransaction(st)
+	c.Check(config.IsNoOption(tr.Get("some-snap", "d", &value)), check.Equals, true)
+}
+
+func (s *apiSuite) TestSnapctlBatchBadRequests(c *check.C) {
+	_ = s.daemon(c)
+
+	for _, body := range []string{
+		`{"context-id": "some-context", "args": ["get", "a"], "batch": [["get", "b"]]}`,
+		`{"context-id": "some-context", "batch": [["get", "b"], []]}`,
+	} {
+		req, err := http.NewRequest("POST", "/v2/snapctl", bytes.NewBufferString(body))
+		c.Assert(err, check.IsNil)
+		rsp := runSnapctl(snapctlCmd, req, nil).(*resp)
+		c.Check(rsp.Status, check.Equals, 400, check.Commentf(body))
+	}
+}
+
 type appSuite struct {
 	apiBaseSuite
 	cmd *testutil.MockCmd
@@ -1150,3 +1150,68 @@ func (s *daemonSuite) TestDegradedModeReply(c *check.C) {
 	rec = doTestReq(c, cmd, "POST")
 	c.Check(rec.Code, check.Equals, 200)
 }
+
+// BenchmarkColdStartFirstSnapsResponse measures how long it takes a
+// cold started daemon to answer its first /v2/snaps request.
+func BenchmarkColdStartFirstSnapsResponse(b *testing.B) {
+	rootDir, err := ioutil.TempDir("", "snapd-cold-start-")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer os.RemoveAll(rootDir)
+	dirs.SetRootDir(rootDir)
+	defer dirs.SetRootDir("")
+	if err := os.MkdirAll(filepath.Dir(dirs.SnapStateFile), 0755); err != nil {
+		b.Fatal(err)
+	}
+
+	restoreBackends := ifacestate.MockSecurityBackends(nil)
+	defer restoreBackends()
+	systemdSdNotify = func(string) error { return nil }
+	defer func() { systemdSdNotify = systemd.SdNotify }()
+	oldCanAutoRefresh := snapstate.CanAutoRefresh
+	defer func() { snapstate.CanAutoRefresh = oldCanAutoRefresh }()
+
+	sockPath := filepath.Join(rootDir, "snapd.socket")
+	cli := &http.Client{Transport: &http.Transport{
+		Dial: func(_, _ string) (net.Conn, error) {
+			return net.Dial("unix", sockPath)
+		},
+		DisableKeepAlives: true,
+	}}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		d, err := New()
+		if err != nil {
+			b.Fatal(err)
+		}
+		d.addRoutes()
+		// don't talk to the store
+		snapstate.CanAutoRefresh = nil
+		l, err := net.Listen("unix", sockPath)
+		if err != nil {
+			b.Fatal(err)
+		}
+		d.snapdListener = &ucrednetListener{Listener: l}
+		if err := d.Start(); err != nil {
+			b.Fatal(err)
+		}
+
+		rsp, err := cli.Get("http://localhost/v2/snaps")
+		if err != nil {
+			b.Fatal(err)
+		}
+		ioutil.ReadAll(rsp.Body)
+		rsp.Body.Close()
+		if rsp.StatusCode != 200 {
+			b.Fatalf("unexpected status: %v", rsp.Status)
+		}
+
+		b.StopTimer()
+		if err := d.Stop(nil); err != nil {
+			b.Fatal(err)
+		}
+		b.StartTimer()
+	}
+}
@@ -21,6 +21,7 @@ package daemon
 
 import (
 	"bufio"
+	"bytes"
 	"encoding/json"
 	"fmt"
 	"io"
@@ -28,6 +29,7 @@ import (
 	"net"
 	"net/http"
 	"path/filepath"
+	"reflect"
 	"strconv"
 	"time"
 
@@ -38,6 +40,7 @@ import (
 	"github.com/snapcore/snapd/overlord/snapstate"
 	"github.com/snapcore/snapd/snap"
 	"github.com/snapcore/snapd/store"
+	"github.com/snapcore/snapd/strutil"
 	"github.com/snapcore/snapd/systemd"
 )
 
@@ -64,6 +67,10 @@ type resp struct {
 	Result interface{}  `json:"result,omitempty"`
 	*Meta
 	Maintenance *errorResult `json:"maintenance,omitempty"`
+
+	// fields restricts the fields of the elements of a list result,
+	// see syncListResponse
+	fields []string
 }
 
 func (r *resp) transmitMaintenance(kind errorKind, message string) {
@@ -120,7 +127,25 @@ func (r *resp) MarshalJSON() ([]byte, error) {
 	})
 }
 
+// the head and the tail of respJSON, around the result, used to stream
+// list results
+type respHeadJSON struct {
+	Type       ResponseType `json:"type"`
+	Status     int          `json:"status-code"`
+	StatusText string       `json:"status"`
+}
+
+type respTailJSON struct {
+	*Meta
+	Maintenance *errorResult `json:"maintenance,omitempty"`
+}
+
 func (r *resp) ServeHTTP(w http.ResponseWriter, _ *http.Request) {
+	if list := reflect.ValueOf(r.Result); list.Kind() == reflect.Slice && list.Type().Elem().Kind() != reflect.Uint8 {
+		r.serveList(w, list)
+		return
+	}
+
 	status := r.Status
 	bs, err := r.MarshalJSON()
 	if err != nil {
@@ -145,6 +170,117 @@ func (r *resp) ServeHTTP(w http.ResponseWriter, _ *http.Request) {
 	w.Write(bs)
 }
 
+// serveList writes the response with a list result, encoding its
+// elements one at a time straight to the writer instead of marshalling
+// the whole response in memory first.
+func (r *resp) serveList(w http.ResponseWriter, list reflect.Value) {
+	head, err := json.Marshal(respHeadJSON{
+		Type:       r.Type,
+		Status:     r.Status,
+		StatusText: http.StatusText(r.Status),
+	})
+	if err != nil {
+		logger.Panicf("cannot marshal response head: %v", err)
+	}
+	tail, err := json.Marshal(respTailJSON{
+		Meta:        r.Meta,
+		Maintenance: r.Maintenance,
+	})
+	if err != nil {
+		logger.Panicf("cannot marshal response tail: %v", err)
+	}
+
+	// encode the first element ahead of the status, so that the
+	// likely marshalling errors still get a proper error response
+	var first []byte
+	if list.Len() > 0 {
+		first, err = encodeListElement(list.Index(0).Interface(), r.fields)
+		if err != nil {
+			logger.Noticef("cannot marshal %T to JSON: %v", list.Index(0).Interface(), err)
+			InternalError("cannot marshal response: %v", err).ServeHTTP(w, nil)
+			return
+		}
+	}
+
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(r.Status)
+
+	// head and tail are JSON objects, the result goes in between
+	w.Write(head[:len(head)-1])
+	if list.IsNil() {
+		io.WriteString(w, `,"result":null`)
+	} else {
+		io.WriteString(w, `,"result":[`)
+		writeListElements(w, list, first, r.fields)
+		io.WriteString(w, "]")
+	}
+	if len(tail) > len("{}") {
+		io.WriteString(w, ",")
+		w.Write(tail[1:])
+	} else {
+		io.WriteString(w, "}")
+	}
+}
+
+// writeListElements writes the elements of the list, the first one
+// being already encoded as first.
+func writeListElements(w io.Writer, list reflect.Value, first []byte, fields []string) {
+	if list.Len() == 0 {
+		return
+	}
+	w.Write(first)
+	for i := 1; i < list.Len(); i++ {
+		elem, err := encodeListElement(list.Index(i).Interface(), fields)
+		if err != nil {
+			// the status is gone already, all that can be
+			// done is to not send a valid response
+			logger.Noticef("cannot marshal %T to JSON: %v", list.Index(i).Interface(), err)
+			panic(http.ErrAbortHandler)
+		}
+		io.WriteString(w, ",")
+		w.Write(elem)
+	}
+}
+
+// encodeListElement encodes v, restricted to the given fields if any.
+func encodeListElement(v interface{}, fields []string) ([]byte, error) {
+	var buf bytes.Buffer
+	if err := json.NewEncoder(&buf).Encode(v); err != nil {
+		return nil, err
+	}
+	elem := bytes.TrimSuffix(buf.Bytes(), []byte("\n"))
+	if fields != nil {
+		elem = projectFields(elem, fields)
+	}
+	return elem, nil
+}
+
+// projectFields returns the JSON object obj restricted to the given
+// fields, in the given order. Other values are returned as they are.
+func projectFields(obj []byte, fields []string) []byte {
+	var all map[string]json.RawMessage
+	if err := json.Unmarshal(obj, &all); err != nil || all == nil {
+		return obj
+	}
+	var buf bytes.Buffer
+	buf.WriteByte('{')
+	for _, field := range fields {
+		value, ok := all[field]
+		if !ok {
+			continue
+		}
+		if buf.Len() > 1 {
+			buf.WriteByte(',')
+		}
+		key, _ := json.Marshal(field)
+		buf.Write(key)
+		buf.WriteByte(':')
+		buf.Write(value)
+	}
+	buf.WriteByte('}')
+	return buf.Bytes()
+}
+
 type errorKind string
 
 const (
@@ -218,6 +354,20 @@ func SyncResponse(result interface{}, meta *Meta) Response {
 	}
 }
 
+// syncListResponse builds a "sync" response from the given list. The
+// fields of its elements are restricted to the ones given with the
+// "fields" query parameter of the request, if any, as a comma separated
+// list of field names.
+func syncListResponse(r *http.Request, list interface{}, meta *Meta) Response {
+	rsp := SyncResponse(list, meta)
+	if fields := r.URL.Query().Get("fields"); fields != "" {
+		if rsp, ok := rsp.(*resp); ok {
+			rsp.fields = strutil.CommaSeparatedList(fields)
+		}
+	}
+	return rsp
+}
+
 // AsyncResponse builds an "async" response from the given *Task
 func AsyncResponse(result map[string]interface{}, meta *Meta) Response {
 	return &resp{
@@ -287,33 +437,44 @@ func (f fileResponse) ServeHTTP(w http.ResponseWriter, r *http.Request) {
 	http.ServeFile(w, r, string(f))
 }
 
-// A journalLineReaderSeqResponse's ServeHTTP method reads lines (presumed to
-// be, each one on its own, a JSON dump of a systemd.Log, as output by
-// journalctl -o json) from an io.ReadCloser, loads that into a client.Log, and
-// outputs the json dump of that, padded with RS and LF to make it a valid
-// json-seq response.
+// A journalReaderSeqResponse's ServeHTTP method reads the entries of a
+// systemd.JournalReader, loads each into a client.Log, and outputs the
+// json dump of that, padded with RS and LF to make it a valid json-seq
+// response.
 //
-// The reader is always closed when done (this is important for
-// osutil.WatingStdoutPipe).
+// The reader is always closed when done (this is important when it
+// reads from journalctl), and stopped if the client goes away while
+// following.
 //
 // Tip: “jq” knows how to read this; “jq --seq” both reads and writes this.
-type journalLineReaderSeqResponse struct {
-	io.ReadCloser
+type journalReaderSeqResponse struct {
+	reader *systemd.JournalReader
 	follow bool
 }
 
-func (rr *journalLineReaderSeqResponse) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+func (rr *journalReaderSeqResponse) ServeHTTP(w http.ResponseWriter, r *http.Request) {
 	w.Header().Set("Content-Type", "application/json-seq")
 
 	flusher, hasFlusher := w.(http.Flusher)
 
+	if rr.follow {
+		done := make(chan struct{})
+		defer close(done)
+		go func() {
+			select {
+			case <-r.Context().Done():
+				rr.reader.Stop()
+			case <-done:
+			}
+		}()
+	}
+
 	var err error
-	dec := json.NewDecoder(rr)
 	writer := bufio.NewWriter(w)
 	enc := json.NewEncoder(writer)
 	for {
 		var log systemd.Log
-		if err = dec.Decode(&log); err != nil {
+		if log, err = rr.reader.Next(); err != nil {
 			break
 		}
 
@@ -346,7 +507,7 @@ func (rr *journalLineReaderSeqResponse) ServeHTTP(w http.ResponseWriter, r *http
 	if err := writer.Flush(); err != nil {
 		logger.Noticef("cannot stream response; problem writing: %v", err)
 	}
-	rr.Close()
+	rr.reader.Close()
 }
 
 type assertResponse struct {
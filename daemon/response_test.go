@@ -27,6 +27,8 @@ import (
 	"net/http/httptest"
 	"os"
 	"path/filepath"
+	"testing"
+	"time"
 
 	"gopkg.in/check.v1"
 )
@@ -137,3 +139,121 @@ func (responseSuite) TestErrorResponderDoesNotPrintfAlways(c *check.C) {
 
 	c.Check(v.Result.Message, check.Equals, "system memory below 1%.")
 }
+
+type listItem struct {
+	Name    string            `json:"name"`
+	Summary string            `json:"summary,omitempty"`
+	Data    map[string]string `json:"data,omitempty"`
+}
+
+func (responseSuite) TestRespStreamsList(c *check.C) {
+	stamp := time.Date(2019, 9, 1, 12, 0, 0, 0, time.UTC)
+	for _, rsp := range []*resp{
+		{Type: ResponseTypeSync, Status: 200, Result: []*listItem{{Name: "foo", Summary: "<foo>"}, nil, {Name: "bar"}}},
+		{Type: ResponseTypeSync, Status: 200, Result: []*listItem{}, Meta: &Meta{Sources: []string{"local"}}},
+		{Type: ResponseTypeSync, Status: 200, Result: []string(nil), Meta: &Meta{WarningCount: 2, WarningTimestamp: &stamp}},
+		{Type: ResponseTypeSync, Status: 200, Result: []int{1, 2}, Maintenance: &errorResult{Kind: errorKindDaemonRestart, Message: "restarting"}},
+	} {
+		rec := httptest.NewRecorder()
+		rsp.ServeHTTP(rec, nil)
+		c.Check(rec.Code, check.Equals, 200)
+		c.Check(rec.Header().Get("Content-Type"), check.Equals, "application/json")
+
+		// the same as marshalling the response in one go
+		expected, err := rsp.MarshalJSON()
+		c.Assert(err, check.IsNil)
+		c.Check(rec.Body.String(), check.Equals, string(expected))
+	}
+}
+
+func (responseSuite) TestRespListMarshalError(c *check.C) {
+	rsp := &resp{Type: ResponseTypeSync, Status: 200, Result: []interface{}{make(chan int), 1}}
+	rec := httptest.NewRecorder()
+	rsp.ServeHTTP(rec, nil)
+	c.Check(rec.Code, check.Equals, 500)
+
+	var v struct{ Result errorResult }
+	c.Assert(json.NewDecoder(rec.Body).Decode(&v), check.IsNil)
+	c.Check(v.Result.Message, check.Matches, "cannot marshal response: .*chan int.*")
+
+	// past the first element the status is sent already
+	rsp = &resp{Type: ResponseTypeSync, Status: 200, Result: []interface{}{1, make(chan int)}}
+	rec = httptest.NewRecorder()
+	c.Check(func() { rsp.ServeHTTP(rec, nil) }, check.Panics, http.ErrAbortHandler)
+	c.Check(rec.Code, check.Equals, 200)
+}
+
+func (responseSuite) TestRespListFields(c *check.C) {
+	req, err := http.NewRequest("GET", "/v2/foo?fields=summary,name,unknown", nil)
+	c.Assert(err, check.IsNil)
+	rsp := syncListResponse(req, []*listItem{
+		{Name: "foo", Summary: "foo summary", Data: map[string]string{"a": "b"}},
+		{Name: "bar"},
+		nil,
+	}, nil)
+
+	rec := httptest.NewRecorder()
+	rsp.ServeHTTP(rec, req)
+	c.Check(rec.Code, check.Equals, 200)
+	c.Check(rec.Body.String(), check.Equals, `{"type":"sync","status-code":200,"status":"OK","result":[{"summary":"foo summary","name":"foo"},{"name":"bar"},null]}`)
+
+	// without fields everything is there
+	req, err = http.NewRequest("GET", "/v2/foo", nil)
+	c.Assert(err, check.IsNil)
+	rsp = syncListResponse(req, []*listItem{{Name: "foo", Data: map[string]string{"a": "b"}}}, nil)
+	rec = httptest.NewRecorder()
+	rsp.ServeHTTP(rec, req)
+	c.Check(rec.Body.String(), check.Equals, `{"type":"sync","status-code":200,"status":"OK","result":[{"name":"foo","data":{"a":"b"}}]}`)
+}
+
+func benchmarkListItems() []*listItem {
+	items := make([]*listItem, 1000)
+	for i := range items {
+		items[i] = &listItem{
+			Name:    fmt.Sprintf("item-%d", i),
+			Summary: "a summary of the item, as long as a snap summary could be",
+			Data:    map[string]string{"revision": "42", "channel": "stable", "confinement": "strict"},
+		}
+	}
+	return items
+}
+
+// BenchmarkServeListBuffered serves a list response marshalled in one go,
+// as it used to be.
+func BenchmarkServeListBuffered(b *testing.B) {
+	rsp := &resp{Type: ResponseTypeSync, Status: 200, Result: benchmarkListItems()}
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		bs, err := rsp.MarshalJSON()
+		if err != nil {
+			b.Fatal(err)
+		}
+		ioutil.Discard.Write(bs)
+	}
+}
+
+func benchmarkServeList(b *testing.B, url string) {
+	items := benchmarkListItems()
+	req, err := http.NewRequest("GET", url, nil)
+	if err != nil {
+		b.Fatal(err)
+	}
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		rec := httptest.NewRecorder()
+		rec.Body = nil
+		syncListResponse(req, items, nil).ServeHTTP(rec, req)
+	}
+}
+
+// BenchmarkServeListStreamed serves a list response encoded one element
+// at a time.
+func BenchmarkServeListStreamed(b *testing.B) {
+	benchmarkServeList(b, "/v2/foo")
+}
+
+// BenchmarkServeListStreamedFields serves a list response restricted to
+// some of the fields of its elements.
+func BenchmarkServeListStreamedFields(b *testing.B) {
+	benchmarkServeList(b, "/v2/foo?fields=name")
+}
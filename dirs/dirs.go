@@ -65,6 +65,7 @@ var (
 	SnapTrustedAccountKey string
 	SnapAssertsSpoolDir   string
 	SnapSeqDir            string
+	SnapLaunchDir         string
 
 	SnapStateFile     string
 	SnapSystemKeyFile string
@@ -81,6 +82,7 @@ var (
 	SnapNamesFile       string
 	SnapSectionsFile    string
 	SnapCommandsDB      string
+	SnapCommandsIndex   string
 	SnapAuxStoreInfoDir string
 
 	SnapBinariesDir     string
@@ -245,6 +247,7 @@ func SetRootDir(rootdir string) {
 	SnapCookieDir = filepath.Join(rootdir, snappyDir, "cookie")
 	SnapAssertsSpoolDir = filepath.Join(rootdir, "run/snapd/auto-import")
 	SnapSeqDir = filepath.Join(rootdir, snappyDir, "sequence")
+	SnapLaunchDir = filepath.Join(rootdir, snappyDir, "launch")
 
 	SnapStateFile = filepath.Join(rootdir, snappyDir, "state.json")
 	SnapSystemKeyFile = filepath.Join(rootdir, snappyDir, "system-key")
@@ -253,6 +256,7 @@ func SetRootDir(rootdir string) {
 	SnapNamesFile = filepath.Join(SnapCacheDir, "names")
 	SnapSectionsFile = filepath.Join(SnapCacheDir, "sections")
 	SnapCommandsDB = filepath.Join(SnapCacheDir, "commands.db")
+	SnapCommandsIndex = filepath.Join(SnapCacheDir, "commands.idx")
 	SnapAuxStoreInfoDir = filepath.Join(SnapCacheDir, "aux")
 
 	SnapSeedDir = filepath.Join(rootdir, snappyDir, "seed")
@@ -54,3 +54,19 @@ func MockMkfsHandlers(mock map[string]MkfsFunc) (restore func()) {
 		mkfsHandlers = old
 	}
 }
+
+func MockRawBlockSize(size Size) (restore func()) {
+	old := rawBlockSize
+	rawBlockSize = size
+	return func() {
+		rawBlockSize = old
+	}
+}
+
+func MockMaxConcurrentFileOps(n int) (restore func()) {
+	old := maxConcurrentFileOps
+	maxConcurrentFileOps = n
+	return func() {
+		maxConcurrentFileOps = old
+	}
+}
@@ -29,6 +29,7 @@ import (
 	"path/filepath"
 	"sort"
 	"strings"
+	"sync"
 
 	"github.com/snapcore/snapd/logger"
 	"github.com/snapcore/snapd/osutil"
@@ -244,6 +245,62 @@ func makeStamp(stamp string) error {
 
 type mountLookupFunc func(ps *LaidOutStructure) (string, error)
 
+// maxConcurrentFileOps bounds the number of files compared or written in
+// parallel when updating a mounted filesystem structure.
+var maxConcurrentFileOps = 4
+
+// runConcurrently calls fn for each of the n items, using at most
+// maxConcurrentFileOps goroutines. No new calls are started once one has
+// failed. The error of the earliest failed item is returned.
+func runConcurrently(n int, fn func(i int) error) error {
+	workers := maxConcurrentFileOps
+	if workers > n {
+		workers = n
+	}
+	if workers < 1 {
+		workers = 1
+	}
+
+	errs := make([]error, n)
+	var failedMu sync.Mutex
+	failed := false
+
+	idx := make(chan int)
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range idx {
+				failedMu.Lock()
+				skip := failed
+				failedMu.Unlock()
+				if skip {
+					continue
+				}
+				if err := fn(i); err != nil {
+					errs[i] = err
+					failedMu.Lock()
+					failed = true
+					failedMu.Unlock()
+				}
+			}
+		}()
+	}
+	for i := 0; i < n; i++ {
+		idx <- i
+	}
+	close(idx)
+	wg.Wait()
+
+	for _, err := range errs {
+		if err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
 // MountedFilesystemUpdater assits in applying updates to a mounted filesystem.
 //
 // The update process is composed of 2 main passes, and an optional rollback:
@@ -262,6 +319,10 @@ type MountedFilesystemUpdater struct {
 	*MountedFilesystemWriter
 	backupDir   string
 	mountLookup mountLookupFunc
+
+	// digests of the update files, computed once
+	sourceDigestsMu sync.Mutex
+	sourceDigests   map[string][]byte
 }
 
 // NewMountedFilesystemUpdater returns an updater for given filesystem
@@ -283,6 +344,7 @@ func NewMountedFilesystemUpdater(rootDir string, ps *LaidOutStructure, backupDir
 		MountedFilesystemWriter: fw,
 		backupDir:               backupDir,
 		mountLookup:             mountLookup,
+		sourceDigests:           make(map[string][]byte),
 	}
 	return fu, nil
 }
@@ -336,15 +398,49 @@ func (f *MountedFilesystemUpdater) Update() error {
 
 	backupRoot := fsStructBackupPath(f.backupDir, f.ps)
 
+	writes := &fileWrites{}
 	for _, c := range f.ps.Content {
-		if err := f.updateVolumeContent(mount, &c, preserveInDst, backupRoot); err != nil {
+		if err := f.updateVolumeContent(mount, &c, preserveInDst, backupRoot, writes); err != nil {
 			return fmt.Errorf("cannot update content: %v", err)
 		}
 	}
 
+	// only files that differ from the update are written
+	err = runConcurrently(len(writes.entries), func(i int) error {
+		w := writes.entries[i]
+		return writeFileOrSymlink(w.srcPath, w.dstPath, preserveInDst)
+	})
+	if err != nil {
+		return fmt.Errorf("cannot update content: %v", err)
+	}
+
 	return nil
 }
 
+type fileWrite struct {
+	srcPath string
+	dstPath string
+}
+
+// fileWrites collects the files to be written by the update.
+type fileWrites struct {
+	entries []fileWrite
+	byDst   map[string]int
+}
+
+func (w *fileWrites) add(srcPath, dstPath string) {
+	if w.byDst == nil {
+		w.byDst = make(map[string]int)
+	}
+	if i, ok := w.byDst[dstPath]; ok {
+		// the last write to given destination wins
+		w.entries[i].srcPath = srcPath
+		return
+	}
+	w.byDst[dstPath] = len(w.entries)
+	w.entries = append(w.entries, fileWrite{srcPath: srcPath, dstPath: dstPath})
+}
+
 func (f *MountedFilesystemUpdater) sourceDirectoryEntries(source string) ([]os.FileInfo, error) {
 	srcPath := f.entrySourcePath(source)
 
@@ -373,7 +469,7 @@ func targetForSourceDir(source, target string) string {
 	return filepath.Join(target, filepath.Base(source))
 }
 
-func (f *MountedFilesystemUpdater) updateDirectory(dstRoot, source, target string, preserveInDst []string, backupDir string) error {
+func (f *MountedFilesystemUpdater) updateDirectory(dstRoot, source, target string, preserveInDst []string, backupDir string, writes *fileWrites) error {
 	fis, err := f.sourceDirectoryEntries(source)
 	if err != nil {
 		return fmt.Errorf("cannot list source directory %q: %v", source, err)
@@ -398,7 +494,7 @@ func (f *MountedFilesystemUpdater) updateDirectory(dstRoot, source, target strin
 			pDst += "/"
 			update = f.updateDirectory
 		}
-		if err := update(dstRoot, pSrc, pDst, preserveInDst, backupDir); err != nil {
+		if err := update(dstRoot, pSrc, pDst, preserveInDst, backupDir, writes); err != nil {
 			return err
 		}
 	}
@@ -406,7 +502,7 @@ func (f *MountedFilesystemUpdater) updateDirectory(dstRoot, source, target strin
 	return nil
 }
 
-func (f *MountedFilesystemUpdater) updateOrSkipFile(dstRoot, source, target string, preserveInDst []string, backupDir string) error {
+func (f *MountedFilesystemUpdater) updateOrSkipFile(dstRoot, source, target string, preserveInDst []string, backupDir string, writes *fileWrites) error {
 	srcPath := f.entrySourcePath(source)
 	dstPath, backupPath := f.entryDestPaths(dstRoot, source, target, backupDir)
 
@@ -431,10 +527,11 @@ func (f *MountedFilesystemUpdater) updateOrSkipFile(dstRoot, source, target stri
 		}
 	}
 
-	return writeFileOrSymlink(srcPath, dstPath, preserveInDst)
+	writes.add(srcPath, dstPath)
+	return nil
 }
 
-func (f *MountedFilesystemUpdater) updateVolumeContent(volumeRoot string, content *VolumeContent, preserveInDst []string, backupDir string) error {
+func (f *MountedFilesystemUpdater) updateVolumeContent(volumeRoot string, content *VolumeContent, preserveInDst []string, backupDir string, writes *fileWrites) error {
 	if err := checkContent(content); err != nil {
 		return err
 	}
@@ -442,9 +539,9 @@ func (f *MountedFilesystemUpdater) updateVolumeContent(volumeRoot string, conten
 	srcPath := f.entrySourcePath(content.Source)
 
 	if osutil.IsDirectory(srcPath) || strings.HasSuffix(content.Source, "/") {
-		return f.updateDirectory(volumeRoot, content.Source, content.Target, preserveInDst, backupDir)
+		return f.updateDirectory(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, writes)
 	} else {
-		return f.updateOrSkipFile(volumeRoot, content.Source, content.Target, preserveInDst, backupDir)
+		return f.updateOrSkipFile(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, writes)
 	}
 }
 
@@ -495,8 +592,23 @@ func (f *MountedFilesystemUpdater) Backup() error {
 		return fmt.Errorf("cannot map preserve entries for mount location %q: %v", mount, err)
 	}
 
+	// compare the existing files with the update up front, in parallel
+	var toCompare []*fileComparison
 	for _, c := range f.ps.Content {
-		if err := f.backupVolumeContent(mount, &c, preserveInDst, backupRoot); err != nil {
+		f.collectVolumeContentComparisons(mount, &c, preserveInDst, backupRoot, &toCompare)
+	}
+	runConcurrently(len(toCompare), func(i int) error {
+		cmp := toCompare[i]
+		cmp.same, cmp.err = f.sameContent(cmp.srcPath, cmp.dstPath)
+		return nil
+	})
+	compared := make(map[fileComparisonKey]*fileComparison, len(toCompare))
+	for _, cmp := range toCompare {
+		compared[fileComparisonKey{cmp.srcPath, cmp.dstPath}] = cmp
+	}
+
+	for _, c := range f.ps.Content {
+		if err := f.backupVolumeContent(mount, &c, preserveInDst, backupRoot, compared); err != nil {
 			return fmt.Errorf("cannot backup content: %v", err)
 		}
 	}
@@ -504,7 +616,129 @@ func (f *MountedFilesystemUpdater) Backup() error {
 	return nil
 }
 
-func (f *MountedFilesystemUpdater) backupOrCheckpointDirectory(dstRoot, source, target string, preserveInDst []string, backupDir string) error {
+// fileComparison is the outcome of comparing an existing file with its update.
+type fileComparison struct {
+	srcPath string
+	dstPath string
+
+	same bool
+	err  error
+}
+
+// fileComparisonKey identifies a comparison, different sources can be
+// written to the same destination.
+type fileComparisonKey struct {
+	srcPath string
+	dstPath string
+}
+
+// collectVolumeContentComparisons collects the existing files that would be
+// overwritten by the update of given content and have not been analyzed
+// yet. Problems with the content are ignored, those are reported when
+// doing the backup.
+func (f *MountedFilesystemUpdater) collectVolumeContentComparisons(volumeRoot string, content *VolumeContent, preserveInDst []string, backupDir string, out *[]*fileComparison) {
+	if checkContent(content) != nil {
+		return
+	}
+	srcPath := f.entrySourcePath(content.Source)
+	if osutil.IsDirectory(srcPath) || strings.HasSuffix(content.Source, "/") {
+		f.collectDirectoryComparisons(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, out)
+	} else {
+		f.collectFileComparison(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, out)
+	}
+}
+
+func (f *MountedFilesystemUpdater) collectDirectoryComparisons(dstRoot, source, target string, preserveInDst []string, backupDir string, out *[]*fileComparison) {
+	fis, err := f.sourceDirectoryEntries(source)
+	if err != nil {
+		return
+	}
+
+	target = targetForSourceDir(source, target)
+
+	for _, fi := range fis {
+		pSrc := filepath.Join(source, fi.Name())
+		pDst := filepath.Join(target, fi.Name())
+		if fi.IsDir() {
+			f.collectDirectoryComparisons(dstRoot, pSrc+"/", pDst+"/", preserveInDst, backupDir, out)
+		} else {
+			f.collectFileComparison(dstRoot, pSrc, pDst, preserveInDst, backupDir, out)
+		}
+	}
+}
+
+func (f *MountedFilesystemUpdater) collectFileComparison(dstRoot, source, target string, preserveInDst []string, backupDir string, out *[]*fileComparison) {
+	srcPath := f.entrySourcePath(source)
+	dstPath, backupPath := f.entryDestPaths(dstRoot, source, target, backupDir)
+
+	if osutil.IsSymlink(srcPath) || osutil.IsSymlink(dstPath) || !osutil.FileExists(dstPath) {
+		return
+	}
+	if osutil.FileExists(backupPath+".backup") || osutil.FileExists(backupPath+".same") {
+		return
+	}
+	if strutil.SortedListContains(preserveInDst, dstPath) {
+		return
+	}
+	*out = append(*out, &fileComparison{srcPath: srcPath, dstPath: dstPath})
+}
+
+// sourceDigest returns the digest of given update file.
+func (f *MountedFilesystemUpdater) sourceDigest(srcPath string) ([]byte, error) {
+	f.sourceDigestsMu.Lock()
+	digest, ok := f.sourceDigests[srcPath]
+	f.sourceDigestsMu.Unlock()
+	if ok {
+		return digest, nil
+	}
+
+	digest, _, err := osutil.FileDigest(srcPath, crypto.SHA1)
+	if err != nil {
+		return nil, err
+	}
+
+	f.sourceDigestsMu.Lock()
+	f.sourceDigests[srcPath] = digest
+	f.sourceDigestsMu.Unlock()
+	return digest, nil
+}
+
+// sameContent checks whether the existing file is identical to its update.
+func (f *MountedFilesystemUpdater) sameContent(srcPath, dstPath string) (bool, error) {
+	orig, err := os.Open(dstPath)
+	if err != nil {
+		return false, fmt.Errorf("cannot open destination file: %v", err)
+	}
+	defer orig.Close()
+
+	origFi, err := orig.Stat()
+	if err != nil {
+		return false, fmt.Errorf("cannot stat destination file: %v", err)
+	}
+	srcFi, err := os.Stat(srcPath)
+	if err != nil {
+		return false, fmt.Errorf("cannot stat update file: %v", err)
+	}
+	if origFi.Size() != srcFi.Size() {
+		// no need to look at the data
+		return false, nil
+	}
+
+	// digest of the currently present data
+	origHash := crypto.SHA1.New()
+	if _, err := io.Copy(origHash, orig); err != nil {
+		return false, fmt.Errorf("cannot checksum destination file: %v", err)
+	}
+	// digest of the update
+	updateDigest, err := f.sourceDigest(srcPath)
+	if err != nil {
+		return false, fmt.Errorf("cannot checksum update file: %v", err)
+	}
+
+	return bytes.Equal(origHash.Sum(nil), updateDigest), nil
+}
+
+func (f *MountedFilesystemUpdater) backupOrCheckpointDirectory(dstRoot, source, target string, preserveInDst []string, backupDir string, compared map[fileComparisonKey]*fileComparison) error {
 	fis, err := f.sourceDirectoryEntries(source)
 	if err != nil {
 		return fmt.Errorf("cannot backup directory %q: %v", source, err)
@@ -527,7 +761,7 @@ func (f *MountedFilesystemUpdater) backupOrCheckpointDirectory(dstRoot, source,
 		if err := f.checkpointPrefix(dstRoot, pDst, backupDir); err != nil {
 			return err
 		}
-		if err := backup(dstRoot, pSrc, pDst, preserveInDst, backupDir); err != nil {
+		if err := backup(dstRoot, pSrc, pDst, preserveInDst, backupDir, compared); err != nil {
 			return err
 		}
 	}
@@ -565,7 +799,7 @@ func (f *MountedFilesystemUpdater) checkpointPrefix(dstRoot, target string, back
 	return nil
 }
 
-func (f *MountedFilesystemUpdater) backupOrCheckpointFile(dstRoot, source, target string, preserveInDst []string, backupDir string) error {
+func (f *MountedFilesystemUpdater) backupOrCheckpointFile(dstRoot, source, target string, preserveInDst []string, backupDir string, compared map[fileComparisonKey]*fileComparison) error {
 	srcPath := f.entrySourcePath(source)
 	dstPath, backupPath := f.entryDestPaths(dstRoot, source, target, backupDir)
 
@@ -608,60 +842,50 @@ func (f *MountedFilesystemUpdater) backupOrCheckpointFile(dstRoot, source, targe
 		return nil
 	}
 
-	// try to find out whether the update and the existing file are
-	// identical
+	// find out whether the update and the existing file are identical
+	cmp := compared[fileComparisonKey{srcPath, dstPath}]
+	if cmp == nil {
+		// not compared up front
+		cmp = &fileComparison{srcPath: srcPath, dstPath: dstPath}
+		cmp.same, cmp.err = f.sameContent(srcPath, dstPath)
+	}
+	if cmp.err != nil {
+		return cmp.err
+	}
 
+	if cmp.same {
+		// mark that files are identical and update can be skipped, no
+		// backup is needed
+		if err := makeStamp(sameStamp); err != nil {
+			return fmt.Errorf("cannot create a checkpoint file: %v", err)
+		}
+		return nil
+	}
+
+	// update will overwrite existing file, make a backup copy
 	orig, err := os.Open(dstPath)
 	if err != nil {
 		return fmt.Errorf("cannot open destination file: %v", err)
 	}
+	defer orig.Close()
 
-	// backup of the original content
 	backup, err := newStampFile(backupName)
 	if err != nil {
 		return fmt.Errorf("cannot create backup file: %v", err)
 	}
-	// becomes a backup copy or a noop if canceled
-	defer backup.Commit()
+	// becomes a noop if committed
+	defer backup.Cancel()
 
-	// checksum the original data while it's being copied
-	origHash := crypto.SHA1.New()
-	htr := io.TeeReader(orig, origHash)
-
-	_, err = io.Copy(backup, htr)
-	if err != nil {
-		backup.Cancel()
+	if _, err := io.Copy(backup, orig); err != nil {
 		return fmt.Errorf("cannot backup original file: %v", err)
 	}
-
-	// digest of the update
-	updateDigest, _, err := osutil.FileDigest(srcPath, crypto.SHA1)
-	if err != nil {
-		backup.Cancel()
-		return fmt.Errorf("cannot checksum update file: %v", err)
-	}
-	// digest of the currently present data
-	origDigest := origHash.Sum(nil)
-
-	// TODO: look into comparing the streams directly
-	if bytes.Equal(origDigest, updateDigest) {
-		// mark that files are identical and update can be skipped, no
-		// backup is needed
-		if err := makeStamp(sameStamp); err != nil {
-			return fmt.Errorf("cannot create a checkpoint file: %v", err)
-		}
-
-		// makes the deferred commit a noop
-		backup.Cancel()
-		return nil
+	if err := backup.Commit(); err != nil {
+		return fmt.Errorf("cannot commit backup file: %v", err)
 	}
-
-	// update will overwrite existing file, a backup copy is created on
-	// Commit()
 	return nil
 }
 
-func (f *MountedFilesystemUpdater) backupVolumeContent(volumeRoot string, content *VolumeContent, preserveInDst []string, backupDir string) error {
+func (f *MountedFilesystemUpdater) backupVolumeContent(volumeRoot string, content *VolumeContent, preserveInDst []string, backupDir string, compared map[fileComparisonKey]*fileComparison) error {
 	if err := checkContent(content); err != nil {
 		return err
 	}
@@ -673,10 +897,10 @@ func (f *MountedFilesystemUpdater) backupVolumeContent(volumeRoot string, conten
 	}
 	if osutil.IsDirectory(srcPath) || strings.HasSuffix(content.Source, "/") {
 		// backup directory contents
-		return f.backupOrCheckpointDirectory(volumeRoot, content.Source, content.Target, preserveInDst, backupDir)
+		return f.backupOrCheckpointDirectory(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, compared)
 	} else {
 		// backup a file
-		return f.backupOrCheckpointFile(volumeRoot, content.Source, content.Target, preserveInDst, backupDir)
+		return f.backupOrCheckpointFile(volumeRoot, content.Source, content.Target, preserveInDst, backupDir, compared)
 	}
 }
 
@@ -24,6 +24,7 @@ import (
 	"os"
 	"path/filepath"
 	"strings"
+	"time"
 
 	. "gopkg.in/check.v1"
 
@@ -807,6 +808,47 @@ func (s *mountedfilesystemTestSuite) TestMountedUpdaterBackupSimple(c *C) {
 	c.Assert(err, IsNil)
 }
 
+func (s *mountedfilesystemTestSuite) TestMountedUpdaterBackupSameTargetDifferentSources(c *C) {
+	gd := []gadgetData{
+		{name: "foo-new", target: "foo-new", content: "new data"},
+		{name: "foo-same", target: "foo-same", content: "same"},
+	}
+	makeGadgetData(c, s.dir, gd)
+
+	outDir := filepath.Join(c.MkDir(), "out-dir")
+	makeExistingData(c, outDir, []gadgetData{
+		{target: "foo", content: "same"},
+	})
+
+	ps := &gadget.LaidOutStructure{
+		VolumeStructure: &gadget.VolumeStructure{
+			Size:       2048,
+			Filesystem: "ext4",
+			// the first source overwrites foo, the second one
+			// happens to be identical to it
+			Content: []gadget.VolumeContent{
+				{Source: "foo-new", Target: "/foo"},
+				{Source: "foo-same", Target: "/foo"},
+			},
+			Update: gadget.VolumeUpdate{
+				Edition: 1,
+			},
+		},
+	}
+
+	rw, err := gadget.NewMountedFilesystemUpdater(s.dir, ps, s.backup, func(to *gadget.LaidOutStructure) (string, error) {
+		return outDir, nil
+	})
+	c.Assert(err, IsNil)
+
+	err = rw.Backup()
+	c.Assert(err, IsNil)
+
+	// the comparison with the first source decides
+	c.Check(filepath.Join(s.backup, "struct-0/foo.backup"), testutil.FileEquals, "same")
+	c.Check(filepath.Join(s.backup, "struct-0/foo.same"), testutil.FileAbsent)
+}
+
 func (s *mountedfilesystemTestSuite) TestMountedUpdaterBackupWithDirectories(c *C) {
 	// some data for the gadget
 	gdWritten := []gadgetData{
@@ -1600,6 +1642,85 @@ func (s *mountedfilesystemTestSuite) TestMountedUpdaterSameFileSkipped(c *C) {
 	})
 }
 
+func (s *mountedfilesystemTestSuite) TestMountedUpdaterManyFilesOnlyChangedWritten(c *C) {
+	restore := gadget.MockMaxConcurrentFileOps(3)
+	defer restore()
+
+	var gd, existing []gadgetData
+	for i := 0; i < 20; i++ {
+		name := fmt.Sprintf("boot/file-%d", i)
+		content := fmt.Sprintf("update %d", i)
+		gd = append(gd, gadgetData{name: name, target: name, content: content})
+		switch i % 3 {
+		case 0:
+			// identical
+			existing = append(existing, gadgetData{target: name, content: content})
+		case 1:
+			// same size, different content
+			existing = append(existing, gadgetData{target: name, content: fmt.Sprintf("UPDATE %d", i)})
+		case 2:
+			// different size
+			existing = append(existing, gadgetData{target: name, content: "old"})
+		}
+	}
+	makeGadgetData(c, s.dir, gd)
+
+	outDir := filepath.Join(c.MkDir(), "out-dir")
+	makeExistingData(c, outDir, existing)
+	past := time.Now().Add(-time.Hour)
+	for _, en := range existing {
+		err := os.Chtimes(filepath.Join(outDir, en.target), past, past)
+		c.Assert(err, IsNil)
+	}
+
+	ps := &gadget.LaidOutStructure{
+		VolumeStructure: &gadget.VolumeStructure{
+			Size:       2048,
+			Filesystem: "ext4",
+			Content: []gadget.VolumeContent{
+				{Source: "/", Target: "/"},
+			},
+			Update: gadget.VolumeUpdate{
+				Edition: 1,
+			},
+		},
+	}
+
+	rw, err := gadget.NewMountedFilesystemUpdater(s.dir, ps, s.backup, func(to *gadget.LaidOutStructure) (string, error) {
+		return outDir, nil
+	})
+	c.Assert(err, IsNil)
+
+	err = rw.Backup()
+	c.Assert(err, IsNil)
+
+	for i, en := range existing {
+		backupPath := filepath.Join(s.backup, "struct-0", en.target)
+		if i%3 == 0 {
+			c.Check(backupPath+".same", testutil.FilePresent)
+			c.Check(backupPath+".backup", testutil.FileAbsent)
+		} else {
+			c.Check(backupPath+".same", testutil.FileAbsent)
+			c.Check(backupPath+".backup", testutil.FileEquals, en.content)
+		}
+	}
+
+	err = rw.Update()
+	c.Assert(err, IsNil)
+	verifyWrittenGadgetData(c, outDir, gd)
+
+	for i, en := range existing {
+		fi, err := os.Stat(filepath.Join(outDir, en.target))
+		c.Assert(err, IsNil)
+		// identical files were not touched
+		c.Check(fi.ModTime().Equal(past), Equals, i%3 == 0, Commentf("file %v", en.target))
+	}
+
+	err = rw.Rollback()
+	c.Assert(err, IsNil)
+	verifyWrittenGadgetData(c, outDir, existing)
+}
+
 func (s *mountedfilesystemTestSuite) TestMountedUpdaterLonePrefix(c *C) {
 	// some data for the gadget
 	gd := []gadgetData{
@@ -20,16 +20,26 @@ package gadget
 
 import (
 	"bytes"
-	"crypto"
-	_ "crypto/sha1"
 	"fmt"
 	"io"
+	"io/ioutil"
 	"os"
 	"path/filepath"
+	"strconv"
+	"strings"
+	"unsafe"
 
 	"github.com/snapcore/snapd/osutil"
 )
 
+// rawBlockSize is the size of the blocks in which raw content is compared
+// with the update and written out.
+var rawBlockSize = 1 * SizeMiB
+
+// rawDirectIOAlign is the alignment of offsets, sizes and buffers
+// required for direct IO.
+const rawDirectIOAlign = 4096
+
 // RawStructureWriter implements support for writing raw (bare) structures.
 type RawStructureWriter struct {
 	contentDir string
@@ -131,7 +141,57 @@ func rawContentBackupPath(backupDir string, ps *LaidOutStructure, pc *LaidOutCon
 	return filepath.Join(backupDir, fmt.Sprintf("struct-%v-%v", ps.Index, pc.Index))
 }
 
-func (r *RawStructureUpdater) backupOrCheckpointContent(disk io.ReadSeeker, pc *LaidOutContent) error {
+// rawBlockRange returns the offset relative to the content start and the
+// size of the given block of content.
+func rawBlockRange(pc *LaidOutContent, blockSize Size, block int) (offs int64, size int) {
+	start := Size(block) * blockSize
+	end := start + blockSize
+	if end > pc.Size {
+		end = pc.Size
+	}
+	return int64(start), int(end - start)
+}
+
+func writeChangedBlocks(path string, blockSize Size, blocks []int) error {
+	var buf bytes.Buffer
+	fmt.Fprintf(&buf, "%d\n", blockSize)
+	for _, block := range blocks {
+		fmt.Fprintf(&buf, "%d\n", block)
+	}
+	return osutil.AtomicWriteFile(path, buf.Bytes(), 0644, 0)
+}
+
+// readChangedBlocks loads the block size and the list of changed blocks
+// recorded during backup. No blocks are returned when the list is missing,
+// in which case the backup covers the whole content.
+func readChangedBlocks(path string) (blockSize Size, blocks []int, err error) {
+	data, err := ioutil.ReadFile(path)
+	if os.IsNotExist(err) {
+		return 0, nil, nil
+	}
+	if err != nil {
+		return 0, nil, fmt.Errorf("cannot read list of changed blocks: %v", err)
+	}
+	fields := strings.Fields(string(data))
+	if len(fields) == 0 {
+		return 0, nil, fmt.Errorf("cannot read list of changed blocks: empty file")
+	}
+	bs, err := strconv.ParseUint(fields[0], 10, 64)
+	if err != nil || bs == 0 {
+		return 0, nil, fmt.Errorf("cannot read list of changed blocks: invalid block size %q", fields[0])
+	}
+	blocks = make([]int, 0, len(fields)-1)
+	for _, field := range fields[1:] {
+		block, err := strconv.Atoi(field)
+		if err != nil || block < 0 {
+			return 0, nil, fmt.Errorf("cannot read list of changed blocks: invalid block %q", field)
+		}
+		blocks = append(blocks, block)
+	}
+	return Size(bs), blocks, nil
+}
+
+func (r *RawStructureUpdater) backupOrCheckpointContent(disk io.ReaderAt, pc *LaidOutContent) error {
 	backupPath := rawContentBackupPath(r.backupDir, r.ps, pc)
 	backupName := backupPath + ".backup"
 	sameName := backupPath + ".same"
@@ -142,50 +202,62 @@ func (r *RawStructureUpdater) backupOrCheckpointContent(disk io.ReadSeeker, pc *
 		return nil
 	}
 
-	if _, err := disk.Seek(int64(pc.StartOffset), io.SeekStart); err != nil {
-		return fmt.Errorf("cannot seek to structure's start offset: %v", err)
-	}
-
-	// copy out at most the size of updated content
-	lr := io.LimitReader(disk, int64(pc.Size))
-
-	// backup the original content
+	// backup the original content of the blocks that differ
 	backup, err := osutil.NewAtomicFile(backupName, 0644, 0, osutil.NoChown, osutil.NoChown)
 	if err != nil {
 		return fmt.Errorf("cannot create backup file: %v", err)
 	}
-	// becomes a noop if canceled
-	defer backup.Commit()
-
-	// checksum the original data while it's being copied
-	origHash := crypto.SHA1.New()
-	htr := io.TeeReader(lr, origHash)
-
-	_, err = io.CopyN(backup, htr, int64(pc.Size))
-	if err != nil {
-		defer backup.Cancel()
-		return fmt.Errorf("cannot backup original image: %v", err)
-	}
+	// becomes a noop if committed
+	defer backup.Cancel()
 
-	// digest of the update
-	updateDigest, _, err := osutil.FileDigest(filepath.Join(r.contentDir, pc.Image), crypto.SHA1)
-	if err != nil {
-		defer backup.Cancel()
-		return fmt.Errorf("cannot checksum update image: %v", err)
+	var img *os.File
+	defer func() {
+		if img != nil {
+			img.Close()
+		}
+	}()
+
+	blockSize := rawBlockSize
+	orig := make([]byte, blockSize)
+	update := make([]byte, blockSize)
+	var changed []int
+	for block := 0; Size(block)*blockSize < pc.Size; block++ {
+		offs, size := rawBlockRange(pc, blockSize, block)
+		if _, err := disk.ReadAt(orig[:size], int64(pc.StartOffset)+offs); err != nil {
+			return fmt.Errorf("cannot backup original image: %v", err)
+		}
+		if img == nil {
+			img, err = os.Open(filepath.Join(r.contentDir, pc.Image))
+			if err != nil {
+				return fmt.Errorf("cannot open update image: %v", err)
+			}
+		}
+		if _, err := img.ReadAt(update[:size], offs); err != nil {
+			return fmt.Errorf("cannot read update image: %v", err)
+		}
+		if bytes.Equal(orig[:size], update[:size]) {
+			continue
+		}
+		if _, err := backup.Write(orig[:size]); err != nil {
+			return fmt.Errorf("cannot backup original image: %v", err)
+		}
+		changed = append(changed, block)
 	}
-	// digest of the currently present data
-	origDigest := origHash.Sum(nil)
 
-	if bytes.Equal(origDigest, updateDigest) {
+	if len(changed) == 0 {
 		// files are identical, no update needed
 		if err := osutil.AtomicWriteFile(sameName, nil, 0644, 0); err != nil {
 			return fmt.Errorf("cannot create a checkpoint file: %v", err)
 		}
-
-		// makes the previous commit a noop
-		backup.Cancel()
+		return nil
 	}
 
+	if err := writeChangedBlocks(backupPath+".blocks", blockSize, changed); err != nil {
+		return fmt.Errorf("cannot create list of changed blocks: %v", err)
+	}
+	if err := backup.Commit(); err != nil {
+		return fmt.Errorf("cannot commit backup file: %v", err)
+	}
 	return nil
 }
 
@@ -208,10 +280,12 @@ func (r *RawStructureUpdater) matchDevice() (device string, shifted *LaidOutStru
 
 // Backup attempts to analyze and prepare a backup copy of data that will be
 // replaced during subsequent update. Backups are kept in the backup directory
-// passed to NewRawStructureUpdater(). Each region replaced by new content is
-// copied out to a separate file. Only differing regions are backed up. Analysis
-// and backup of each region is checkpointed. Regions that have been backed up
-// or determined to be identical will not be analyzed on subsequent calls.
+// passed to NewRawStructureUpdater(). The content is compared with the
+// update in blocks, the original data of each block that differs is copied
+// out to a separate file per region, along with the list of changed blocks.
+// Analysis and backup of each region is checkpointed. Regions that have been
+// backed up or determined to be identical will not be analyzed on subsequent
+// calls.
 func (r *RawStructureUpdater) Backup() error {
 	device, structForDevice, err := r.matchDevice()
 	if err != nil {
@@ -233,7 +307,104 @@ func (r *RawStructureUpdater) Backup() error {
 	return nil
 }
 
-func (r *RawStructureUpdater) rollbackDifferent(out io.WriteSeeker, pc *LaidOutContent) error {
+// rawDisk writes blocks of raw content to a device. Blocks suitably aligned
+// are written using direct IO when the device supports it, and verified by
+// reading them back from the device. The other blocks are not verified, as
+// reading them back would only return the page cache.
+type rawDisk struct {
+	*os.File
+	direct *os.File
+
+	buf    []byte
+	verify []byte
+}
+
+func openRawDisk(device string) (*rawDisk, error) {
+	f, err := os.OpenFile(device, os.O_RDWR, 0)
+	if err != nil {
+		return nil, err
+	}
+	disk := &rawDisk{File: f}
+	// not all devices and filesystems support direct IO, in which case
+	// only the regular file is used
+	if direct, err := openDirect(device); err == nil {
+		disk.direct = direct
+	}
+	return disk, nil
+}
+
+// alignedBuffer returns a buffer of given size whose start is aligned as
+// needed for direct IO.
+func alignedBuffer(size int) []byte {
+	buf := make([]byte, size+rawDirectIOAlign)
+	skip := 0
+	if rem := int(uintptr(unsafe.Pointer(&buf[0])) & (rawDirectIOAlign - 1)); rem != 0 {
+		skip = rawDirectIOAlign - rem
+	}
+	return buf[skip : skip+size]
+}
+
+// writeBlock writes the data at given offset of the device, and verifies it
+// by reading it back when written using direct IO.
+func (d *rawDisk) writeBlock(data []byte, offs int64) error {
+	f := d.File
+	if d.direct != nil && offs%rawDirectIOAlign == 0 && len(data)%rawDirectIOAlign == 0 {
+		f = d.direct
+		if len(d.buf) < len(data) {
+			d.buf = alignedBuffer(len(data))
+		}
+		data = d.buf[:copy(d.buf, data)]
+	}
+	if _, err := f.WriteAt(data, offs); err != nil {
+		return fmt.Errorf("cannot write block at offset 0x%x: %v", offs, err)
+	}
+	if f != d.direct {
+		return nil
+	}
+
+	if len(d.verify) < len(data) {
+		d.verify = alignedBuffer(len(data))
+	}
+	verify := d.verify[:len(data)]
+	if _, err := f.ReadAt(verify, offs); err != nil {
+		return fmt.Errorf("cannot read back block at offset 0x%x: %v", offs, err)
+	}
+	if !bytes.Equal(data, verify) {
+		return fmt.Errorf("cannot verify block written at offset 0x%x", offs)
+	}
+	return nil
+}
+
+// writeBlocks writes the given blocks of content read from the input. With
+// consecutive set the blocks are stored one after another in the input,
+// otherwise each is at its own offset within the content.
+func (d *rawDisk) writeBlocks(pc *LaidOutContent, blockSize Size, blocks []int, in io.ReaderAt, consecutive bool) error {
+	buf := make([]byte, blockSize)
+	inOffs := int64(0)
+	for _, block := range blocks {
+		offs, size := rawBlockRange(pc, blockSize, block)
+		if !consecutive {
+			inOffs = offs
+		}
+		if _, err := in.ReadAt(buf[:size], inOffs); err != nil {
+			return fmt.Errorf("cannot read image: %v", err)
+		}
+		if err := d.writeBlock(buf[:size], int64(pc.StartOffset)+offs); err != nil {
+			return err
+		}
+		inOffs += int64(size)
+	}
+	return nil
+}
+
+func (d *rawDisk) Close() error {
+	if d.direct != nil {
+		d.direct.Close()
+	}
+	return d.File.Close()
+}
+
+func (r *RawStructureUpdater) rollbackDifferent(disk *rawDisk, pc *LaidOutContent) error {
 	backupPath := rawContentBackupPath(r.backupDir, r.ps, pc)
 
 	if osutil.FileExists(backupPath + ".same") {
@@ -245,11 +416,24 @@ func (r *RawStructureUpdater) rollbackDifferent(out io.WriteSeeker, pc *LaidOutC
 	if err != nil {
 		return fmt.Errorf("cannot open backup image: %v", err)
 	}
+	defer backup.Close()
 
-	if err := writeRawStream(out, pc, backup); err != nil {
-		return fmt.Errorf("cannot restore backup: %v", err)
+	blockSize, blocks, err := readChangedBlocks(backupPath + ".blocks")
+	if err != nil {
+		return err
+	}
+	if blocks == nil {
+		// the backup covers the whole content
+		if err := writeRawStream(disk, pc, backup); err != nil {
+			return fmt.Errorf("cannot restore backup: %v", err)
+		}
+		return nil
 	}
 
+	// the backup holds the original data of changed blocks only
+	if err := disk.writeBlocks(pc, blockSize, blocks, backup, true); err != nil {
+		return fmt.Errorf("cannot restore backup: %v", err)
+	}
 	return nil
 }
 
@@ -260,7 +444,7 @@ func (r *RawStructureUpdater) Rollback() error {
 		return err
 	}
 
-	disk, err := os.OpenFile(device, os.O_WRONLY, 0)
+	disk, err := openRawDisk(device)
 	if err != nil {
 		return fmt.Errorf("cannot open device for writing: %v", err)
 	}
@@ -272,10 +456,13 @@ func (r *RawStructureUpdater) Rollback() error {
 		}
 	}
 
+	if err := disk.Sync(); err != nil {
+		return fmt.Errorf("cannot sync device: %v", err)
+	}
 	return nil
 }
 
-func (r *RawStructureUpdater) updateDifferent(disk io.WriteSeeker, pc *LaidOutContent) error {
+func (r *RawStructureUpdater) updateDifferent(disk *rawDisk, pc *LaidOutContent) error {
 	backupPath := rawContentBackupPath(r.backupDir, r.ps, pc)
 
 	if osutil.FileExists(backupPath + ".same") {
@@ -289,22 +476,34 @@ func (r *RawStructureUpdater) updateDifferent(disk io.WriteSeeker, pc *LaidOutCo
 		return fmt.Errorf("missing backup file")
 	}
 
-	if err := r.writeRawImage(disk, pc); err != nil {
+	blockSize, blocks, err := readChangedBlocks(backupPath + ".blocks")
+	if err != nil {
 		return err
 	}
+	if blocks == nil {
+		// no list of changed blocks, write the whole image
+		return r.writeRawImage(disk, pc)
+	}
 
-	return nil
+	img, err := os.Open(filepath.Join(r.contentDir, pc.Image))
+	if err != nil {
+		return fmt.Errorf("cannot open image file: %v", err)
+	}
+	defer img.Close()
+
+	return disk.writeBlocks(pc, blockSize, blocks, img, false)
 }
 
 // Update attempts to update the structure. The structure must have been
-// analyzed and backed up by a prior Backup() call.
+// analyzed and backed up by a prior Backup() call. Only the blocks found to
+// be different during the backup are written.
 func (r *RawStructureUpdater) Update() error {
 	device, structForDevice, err := r.matchDevice()
 	if err != nil {
 		return err
 	}
 
-	disk, err := os.OpenFile(device, os.O_WRONLY, 0)
+	disk, err := openRawDisk(device)
 	if err != nil {
 		return fmt.Errorf("cannot open device for writing: %v", err)
 	}
@@ -316,5 +515,8 @@ func (r *RawStructureUpdater) Update() error {
 		}
 	}
 
+	if err := disk.Sync(); err != nil {
+		return fmt.Errorf("cannot sync device: %v", err)
+	}
 	return nil
 }
@@ -21,6 +21,7 @@ package gadget_test
 import (
 	"errors"
 	"io"
+	"io/ioutil"
 	"os"
 	"path/filepath"
 
@@ -28,6 +29,7 @@ import (
 
 	"github.com/snapcore/snapd/gadget"
 	"github.com/snapcore/snapd/osutil"
+	"github.com/snapcore/snapd/testutil"
 )
 
 type rawTestSuite struct {
@@ -514,6 +516,119 @@ func (r *rawTestSuite) TestRawUpdaterBackupUpdateRestoreNoPartition(c *C) {
 	c.Check(osutil.FilesAreEqual(diskPath, pristinePath), Equals, true)
 }
 
+func (r *rawTestSuite) TestRawUpdaterBackupUpdateRestoreChangedBlocks(c *C) {
+	restore := gadget.MockRawBlockSize(4096)
+	defer restore()
+
+	diskPath := filepath.Join(r.dir, "disk.img")
+	mutateFile(c, diskPath, 32768, []mutateWrite{
+		{[]byte("foo foo foo"), 8192},
+		{[]byte("bar bar bar"), 8192 + 4096},
+		{[]byte("baz baz baz"), 8192 + 3*4096},
+	})
+
+	pristinePath := filepath.Join(r.dir, "pristine.img")
+	err := osutil.CopyFile(diskPath, pristinePath, 0)
+	c.Assert(err, IsNil)
+
+	// blocks 1 and 3 of the content differ, the last block is short
+	expectedPath := filepath.Join(r.dir, "expected.img")
+	mutateFile(c, expectedPath, 32768, []mutateWrite{
+		{[]byte("foo foo foo"), 8192},
+		{[]byte("xxx xxx xxx"), 8192 + 4096},
+		{[]byte("zzz zzz zzz"), 8192 + 3*4096},
+	})
+	mutateFile(c, filepath.Join(r.dir, "foo.img"), 3*4096+512, []mutateWrite{
+		{[]byte("foo foo foo"), 0},
+		{[]byte("xxx xxx xxx"), 4096},
+		{[]byte("zzz zzz zzz"), 3 * 4096},
+	})
+
+	ps := &gadget.LaidOutStructure{
+		VolumeStructure: &gadget.VolumeStructure{
+			Size: 16384,
+		},
+		StartOffset: 8192,
+		LaidOutContent: []gadget.LaidOutContent{
+			{
+				VolumeContent: &gadget.VolumeContent{
+					Image: "foo.img",
+				},
+				StartOffset: 8192,
+				Size:        3*4096 + 512,
+			},
+		},
+	}
+	ru, err := gadget.NewRawStructureUpdater(r.dir, ps, r.backup, func(to *gadget.LaidOutStructure) (string, gadget.Size, error) {
+		return diskPath, ps.StartOffset, nil
+	})
+	c.Assert(err, IsNil)
+
+	err = ru.Backup()
+	c.Assert(err, IsNil)
+
+	// only the changed blocks were backed up
+	contentBackupBasePath := gadget.RawContentBackupPath(r.backup, ps, &ps.LaidOutContent[0])
+	c.Check(getFileSize(c, contentBackupBasePath+".backup"), Equals, int64(4096+512))
+	c.Check(contentBackupBasePath+".blocks", testutil.FileEquals, "4096\n1\n3\n")
+
+	// a different block size when updating does not matter
+	restore = gadget.MockRawBlockSize(8192)
+	defer restore()
+
+	err = ru.Update()
+	c.Assert(err, IsNil)
+	c.Check(osutil.FilesAreEqual(diskPath, expectedPath), Equals, true)
+
+	err = ru.Rollback()
+	c.Assert(err, IsNil)
+	c.Check(osutil.FilesAreEqual(diskPath, pristinePath), Equals, true)
+}
+
+func (r *rawTestSuite) TestRawUpdaterBrokenChangedBlocks(c *C) {
+	diskPath := filepath.Join(r.dir, "disk.img")
+	makeSizedFile(c, diskPath, 2048, nil)
+	makeSizedFile(c, filepath.Join(r.dir, "foo.img"), 128, nil)
+
+	ps := &gadget.LaidOutStructure{
+		VolumeStructure: &gadget.VolumeStructure{
+			Size: 2048,
+		},
+		LaidOutContent: []gadget.LaidOutContent{
+			{
+				VolumeContent: &gadget.VolumeContent{
+					Image: "foo.img",
+				},
+				StartOffset: 128,
+				Size:        128,
+			},
+		},
+	}
+	ru, err := gadget.NewRawStructureUpdater(r.dir, ps, r.backup, func(to *gadget.LaidOutStructure) (string, gadget.Size, error) {
+		return diskPath, 0, nil
+	})
+	c.Assert(err, IsNil)
+
+	contentBackupBasePath := gadget.RawContentBackupPath(r.backup, ps, &ps.LaidOutContent[0])
+	makeSizedFile(c, contentBackupBasePath+".backup", 0, nil)
+	for _, tc := range []struct {
+		blocks string
+		err    string
+	}{
+		{"", "cannot read list of changed blocks: empty file"},
+		{"0\n1\n", `cannot read list of changed blocks: invalid block size "0"`},
+		{"4096\n-1\n", `cannot read list of changed blocks: invalid block "-1"`},
+	} {
+		err = ioutil.WriteFile(contentBackupBasePath+".blocks", []byte(tc.blocks), 0644)
+		c.Assert(err, IsNil)
+
+		err = ru.Update()
+		c.Check(err, ErrorMatches, `cannot update image #0 \("foo.img"@0x80\{128\}\): `+tc.err)
+		err = ru.Rollback()
+		c.Check(err, ErrorMatches, `cannot rollback image #0 \("foo.img"@0x80\{128\}\): `+tc.err)
+	}
+}
+
 func (r *rawTestSuite) TestRawUpdaterBackupErrors(c *C) {
 	diskPath := filepath.Join(r.dir, "disk.img")
 	ps := &gadget.LaidOutStructure{
@@ -556,7 +671,7 @@ func (r *rawTestSuite) TestRawUpdaterBackupErrors(c *C) {
 	makeSizedFile(c, diskPath, 2048, nil)
 
 	err = ru.Backup()
-	c.Assert(err, ErrorMatches, "cannot backup image .*: cannot checksum update image: .*")
+	c.Assert(err, ErrorMatches, "cannot backup image .*: cannot open update image: .*")
 	c.Check(osutil.FileExists(gadget.RawContentBackupPath(r.backup, ps, &ps.LaidOutContent[0])+".backup"), Equals, false)
 }
 
@@ -57,3 +57,11 @@ var (
 	ErrRevisionAndCohort = errRevisionAndCohort
 	ErrPathInBase        = errPathInBase
 )
+
+func MockMaxConcurrentDownloads(n int) (restore func()) {
+	old := maxConcurrentDownloads
+	maxConcurrentDownloads = n
+	return func() {
+		maxConcurrentDownloads = old
+	}
+}
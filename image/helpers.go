@@ -216,6 +216,11 @@ type DownloadOptions struct {
 	Basename  string
 
 	LeavePartialOnError bool
+
+	// Progress, if set, reports the progress of the download, the
+	// caller is then in charge of handling interruptions. Otherwise
+	// a progress bar is shown and an interruption stops the process.
+	Progress progress.Meter
 }
 
 var (
@@ -312,33 +317,51 @@ func (tsto *ToolingStore) DownloadSnap(name string, opts DownloadOptions) (targe
 		logger.Debugf("File exists but has wrong hash, ignoring (here).")
 	}
 
-	pb := progress.MakeProgressBar()
-	defer pb.Finished()
-
-	// Intercept sigint
-	c := make(chan os.Signal, 3)
-	signal.Notify(c, syscall.SIGINT)
-	go func() {
-		<-c
-		pb.Finished()
-		os.Exit(1)
-	}()
+	pb := opts.Progress
+	if pb == nil {
+		pb = progress.MakeProgressBar()
+		defer pb.Finished()
+		defer exitOnInterrupt(pb.Finished)()
+	}
 
 	dlOpts := &store.DownloadOptions{LeavePartialOnError: opts.LeavePartialOnError}
 	if err = sto.Download(context.TODO(), name, targetFn, &snap.DownloadInfo, pb, tsto.user, dlOpts); err != nil {
 		return "", nil, err
 	}
 
-	signal.Reset(syscall.SIGINT)
-
 	return targetFn, snap, nil
 }
 
+// exitOnInterrupt makes the process exit, after calling cleanup, when
+// interrupted with SIGINT until the returned function is called.
+func exitOnInterrupt(cleanup func()) (stop func()) {
+	c := make(chan os.Signal, 1)
+	done := make(chan struct{})
+	signal.Notify(c, syscall.SIGINT)
+	go func() {
+		select {
+		case <-c:
+			cleanup()
+			os.Exit(1)
+		case <-done:
+		}
+	}()
+	return func() {
+		signal.Stop(c)
+		close(done)
+	}
+}
+
 // AssertionFetcher creates an asserts.Fetcher for assertions against the given store using dlOpts for authorization, the fetcher will add assertions in the given database and after that also call save for each of them.
 func (tsto *ToolingStore) AssertionFetcher(db *asserts.Database, save func(asserts.Assertion) error) asserts.Fetcher {
-	retrieve := func(ref *asserts.Ref) (asserts.Assertion, error) {
-		return tsto.sto.Assertion(ref.Type, ref.PrimaryKey, tsto.user)
-	}
+	return tsto.assertionFetcher(db, tsto.retrieveAssertion, save)
+}
+
+func (tsto *ToolingStore) retrieveAssertion(ref *asserts.Ref) (asserts.Assertion, error) {
+	return tsto.sto.Assertion(ref.Type, ref.PrimaryKey, tsto.user)
+}
+
+func (tsto *ToolingStore) assertionFetcher(db *asserts.Database, retrieve func(*asserts.Ref) (asserts.Assertion, error), save func(asserts.Assertion) error) asserts.Fetcher {
 	save2 := func(a asserts.Assertion) error {
 		// for checking
 		err := db.Add(a)
@@ -359,7 +382,10 @@ func FetchAndCheckSnapAssertions(snapPath string, info *snap.Info, f asserts.Fet
 	if err != nil {
 		return nil, err
 	}
+	return fetchAndCheckSnapAssertions(sha3_384, size, info, f, db)
+}
 
+func fetchAndCheckSnapAssertions(sha3_384 string, size uint64, info *snap.Info, f asserts.Fetcher, db asserts.RODatabase) (*asserts.SnapDeclaration, error) {
 	// this assumes series "16"
 	if err := snapasserts.FetchSnapAssertions(f, sha3_384); err != nil {
 		return nil, fmt.Errorf("cannot fetch snap signatures/assertions: %v", err)
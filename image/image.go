@@ -27,6 +27,7 @@ import (
 	"path/filepath"
 	"sort"
 	"strings"
+	"sync"
 	"syscall"
 
 	"github.com/snapcore/snapd/asserts"
@@ -36,6 +37,7 @@ import (
 	"github.com/snapcore/snapd/bootloader"
 	"github.com/snapcore/snapd/dirs"
 	"github.com/snapcore/snapd/osutil"
+	"github.com/snapcore/snapd/progress"
 	"github.com/snapcore/snapd/release"
 	"github.com/snapcore/snapd/seed"
 	"github.com/snapcore/snapd/snap"
@@ -357,17 +359,48 @@ func acquireSnap(tsto *ToolingStore, name string, dlOpts *DownloadOptions, local
 type addingFetcher struct {
 	asserts.Fetcher
 	addedRefs []*asserts.Ref
+
+	tsto *ToolingStore
+
+	// assertions retrieved ahead of time, by unique ref
+	prefetchedMu sync.Mutex
+	prefetched   map[string]asserts.Assertion
 }
 
 func makeFetcher(tsto *ToolingStore, dlOpts *DownloadOptions, db *asserts.Database) *addingFetcher {
-	var f addingFetcher
+	f := &addingFetcher{
+		tsto:       tsto,
+		prefetched: make(map[string]asserts.Assertion),
+	}
 	save := func(a asserts.Assertion) error {
 		f.addedRefs = append(f.addedRefs, a.Ref())
 		return nil
 	}
-	f.Fetcher = tsto.AssertionFetcher(db, save)
-	return &f
+	retrieve := func(ref *asserts.Ref) (asserts.Assertion, error) {
+		f.prefetchedMu.Lock()
+		a := f.prefetched[ref.Unique()]
+		delete(f.prefetched, ref.Unique())
+		f.prefetchedMu.Unlock()
+		if a != nil {
+			return a, nil
+		}
+		return tsto.retrieveAssertion(ref)
+	}
+	f.Fetcher = tsto.assertionFetcher(db, retrieve, save)
+	return f
+}
 
+// prefetch retrieves the given assertion from the store ahead of it being
+// fetched. It can be called concurrently. Errors are ignored, they will be
+// reported when fetching the assertion.
+func (f *addingFetcher) prefetch(ref *asserts.Ref) {
+	a, err := f.tsto.retrieveAssertion(ref)
+	if err != nil {
+		return
+	}
+	f.prefetchedMu.Lock()
+	defer f.prefetchedMu.Unlock()
+	f.prefetched[ref.Unique()] = a
 }
 
 func installCloudConfig(gadgetDir string) error {
@@ -508,6 +541,15 @@ func setupSeed(tsto *ToolingStore, model *asserts.Model, opts *Options, local *l
 	snaps = append(snaps, reqSnaps...)
 	snaps = append(snaps, opts.Snaps...)
 
+	// download the snaps in the background, they are still added to
+	// the seed one after the other in order; the downloads share a
+	// progress bar and the handling of interruptions
+	seed.meter = &downloadsMeter{}
+	defer seed.meter.finished()
+	defer exitOnInterrupt(seed.meter.finished)()
+	seed.startAcquiring(snaps)
+	defer seed.stopAcquiring()
+
 	for _, snapName := range snaps {
 		if err := seed.add(snapName); err != nil {
 			return err
@@ -630,9 +672,14 @@ type imageSeed struct {
 	basesAndApps []string
 
 	snapSeedDir string
-	f           asserts.Fetcher
+	f           *addingFetcher
 	db          *asserts.Database
 
+	acquired      map[string]*acquiredSnap
+	acquiringStop chan struct{}
+	acquiring     sync.WaitGroup
+	meter         *downloadsMeter
+
 	entries seedEntriesByType
 
 	seen                             map[string]bool
@@ -643,6 +690,259 @@ type imageSeed struct {
 	needsCore16 []string
 }
 
+// maxConcurrentDownloads bounds the number of snaps downloaded in parallel
+// when preparing the seed.
+var maxConcurrentDownloads = 4
+
+// acquiredSnap is a snap downloaded or copied ahead of it being added to
+// the seed.
+type acquiredSnap struct {
+	done    chan struct{}
+	channel string
+
+	fn   string
+	info *snap.Info
+	err  error
+
+	// digest and size of the snap file, when from the store
+	sha3_384 string
+	size     uint64
+}
+
+var errAcquireStopped = fmt.Errorf("internal error: snap acquisition stopped")
+
+// downloadsMeter shows the progress of the concurrent downloads of the
+// seed snaps as a single progress bar, shown while any is in progress.
+type downloadsMeter struct {
+	mu      sync.Mutex
+	pb      progress.Meter
+	active  int
+	total   float64
+	current float64
+}
+
+// download returns the meter for one of the downloads.
+func (m *downloadsMeter) download() progress.Meter {
+	return &downloadMeter{m: m}
+}
+
+// update accounts for the changes in the total and current steps of
+// one of the downloads.
+func (m *downloadsMeter) update(deltaTotal, deltaCurrent float64) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	m.total += deltaTotal
+	m.current += deltaCurrent
+	if m.pb == nil {
+		return
+	}
+	if deltaTotal != 0 {
+		m.pb.SetTotal(m.total)
+	}
+	m.pb.Set(m.current)
+}
+
+func (m *downloadsMeter) start(label string, total float64) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	m.active++
+	m.total += total
+	if m.pb == nil {
+		m.pb = progress.MakeProgressBar()
+	}
+	if m.active > 1 {
+		label = fmt.Sprintf("%d snaps", m.active)
+	}
+	m.pb.Start(label, m.total)
+	m.pb.Set(m.current)
+}
+
+func (m *downloadsMeter) stop(total, current float64) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	m.active--
+	if m.active > 0 {
+		// count the download as complete
+		m.current += total - current
+		if m.pb != nil {
+			m.pb.Set(m.current)
+		}
+		return
+	}
+	m.finishedNoLock()
+}
+
+func (m *downloadsMeter) notify(msg string) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	if m.pb != nil {
+		m.pb.Notify(msg)
+	} else {
+		fmt.Fprintln(Stdout, msg)
+	}
+}
+
+// finished finishes the progress bar, if any is shown.
+func (m *downloadsMeter) finished() {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	m.finishedNoLock()
+}
+
+func (m *downloadsMeter) finishedNoLock() {
+	if m.pb != nil {
+		m.pb.Finished()
+		m.pb = nil
+	}
+	m.active = 0
+	m.total = 0
+	m.current = 0
+}
+
+// downloadMeter reports the progress of one download to a downloadsMeter.
+type downloadMeter struct {
+	progress.NullMeter
+	m *downloadsMeter
+
+	started bool
+	total   float64
+	current float64
+}
+
+func (d *downloadMeter) Start(label string, total float64) {
+	if d.started {
+		d.m.update(total-d.total, -d.current)
+	} else {
+		d.started = true
+		d.m.start(label, total)
+	}
+	d.total = total
+	d.current = 0
+}
+
+func (d *downloadMeter) Set(current float64) {
+	d.m.update(0, current-d.current)
+	d.current = current
+}
+
+func (d *downloadMeter) SetTotal(total float64) {
+	d.m.update(total-d.total, 0)
+	d.total = total
+}
+
+func (d *downloadMeter) Finished() {
+	if !d.started {
+		return
+	}
+	d.started = false
+	d.m.stop(d.total, d.current)
+	d.total = 0
+	d.current = 0
+}
+
+func (d *downloadMeter) Write(p []byte) (int, error) {
+	d.Set(d.current + float64(len(p)))
+	return len(p), nil
+}
+
+func (d *downloadMeter) Notify(msg string) {
+	d.m.notify(msg)
+}
+
+// startAcquiring starts downloading or copying the given snaps, and
+// retrieving the main assertions of the store ones, in the background using
+// at most maxConcurrentDownloads workers. The snaps are processed in the
+// given order.
+func (s *imageSeed) startAcquiring(snapNames []string) {
+	s.acquired = make(map[string]*acquiredSnap)
+	s.acquiringStop = make(chan struct{})
+
+	var names []string
+	for _, snapName := range snapNames {
+		name := s.local.Name(snapName)
+		if s.acquired[name] != nil {
+			continue
+		}
+		snapChannel, err := snapChannel(name, s.model, s.opts, s.local)
+		if err != nil {
+			// reported when adding the snap
+			continue
+		}
+		s.acquired[name] = &acquiredSnap{
+			done:    make(chan struct{}),
+			channel: snapChannel,
+		}
+		names = append(names, name)
+	}
+
+	queue := make(chan string, len(names))
+	for _, name := range names {
+		queue <- name
+	}
+	close(queue)
+
+	workers := maxConcurrentDownloads
+	if workers > len(names) {
+		workers = len(names)
+	}
+	for i := 0; i < workers; i++ {
+		s.acquiring.Add(1)
+		go func() {
+			defer s.acquiring.Done()
+			for name := range queue {
+				s.acquire(name, s.acquired[name])
+			}
+		}()
+	}
+}
+
+func (s *imageSeed) acquire(name string, a *acquiredSnap) {
+	defer close(a.done)
+
+	select {
+	case <-s.acquiringStop:
+		a.err = errAcquireStopped
+		return
+	default:
+	}
+
+	dlOpts := &DownloadOptions{
+		TargetDir: s.snapSeedDir,
+		Channel:   a.channel,
+		Progress:  s.meter.download(),
+	}
+	a.fn, a.info, a.err = acquireSnap(s.tsto, name, dlOpts, s.local)
+	if a.err != nil || a.info.SnapID == "" {
+		return
+	}
+
+	// digest the snap and retrieve its main assertions, they are
+	// fetched and checked when adding the snap
+	sha3_384, size, err := asserts.SnapFileSHA3_384(a.fn)
+	if err != nil {
+		return
+	}
+	a.sha3_384, a.size = sha3_384, size
+	s.f.prefetch(&asserts.Ref{
+		Type:       asserts.SnapRevisionType,
+		PrimaryKey: []string{sha3_384},
+	})
+	s.f.prefetch(&asserts.Ref{
+		Type:       asserts.SnapDeclarationType,
+		PrimaryKey: []string{release.Series, a.info.SnapID},
+	})
+}
+
+// stopAcquiring stops the background acquisition of snaps and waits for
+// the ongoing downloads to finish.
+func (s *imageSeed) stopAcquiring() {
+	if s.acquiringStop == nil {
+		return
+	}
+	close(s.acquiringStop)
+	s.acquiring.Wait()
+}
+
 func (s *imageSeed) add(snapName string) error {
 	model := s.model
 	opts := s.opts
@@ -665,11 +965,21 @@ func (s *imageSeed) add(snapName string) error {
 		return err
 	}
 
-	dlOpts := &DownloadOptions{
-		TargetDir: s.snapSeedDir,
-		Channel:   snapChannel,
+	var fn, sha3_384 string
+	var size uint64
+	var info *snap.Info
+	if a := s.acquired[name]; a != nil {
+		<-a.done
+		fn, info, err = a.fn, a.info, a.err
+		sha3_384, size = a.sha3_384, a.size
+	} else {
+		dlOpts := &DownloadOptions{
+			TargetDir: s.snapSeedDir,
+			Channel:   snapChannel,
+			Progress:  s.meter.download(),
+		}
+		fn, info, err = acquireSnap(s.tsto, name, dlOpts, local)
 	}
-	fn, info, err := acquireSnap(s.tsto, name, dlOpts, local)
 	if err != nil {
 		return err
 	}
@@ -695,7 +1005,12 @@ func (s *imageSeed) add(snapName string) error {
 
 	// if it comes from the store fetch the snap assertions too
 	if info.SnapID != "" {
-		snapDecl, err := FetchAndCheckSnapAssertions(fn, info, s.f, s.db)
+		var snapDecl *asserts.SnapDeclaration
+		if sha3_384 != "" {
+			snapDecl, err = fetchAndCheckSnapAssertions(sha3_384, size, info, s.f, s.db)
+		} else {
+			snapDecl, err = FetchAndCheckSnapAssertions(fn, info, s.f, s.db)
+		}
 		if err != nil {
 			return err
 		}
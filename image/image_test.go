@@ -27,7 +27,9 @@ import (
 	"net/url"
 	"os"
 	"path/filepath"
+	"sort"
 	"strings"
+	"sync"
 	"testing"
 	"time"
 
@@ -42,6 +44,7 @@ import (
 	"github.com/snapcore/snapd/osutil"
 	"github.com/snapcore/snapd/overlord/auth"
 	"github.com/snapcore/snapd/progress"
+	"github.com/snapcore/snapd/progress/progresstest"
 	"github.com/snapcore/snapd/seed"
 	"github.com/snapcore/snapd/seed/seedtest"
 	"github.com/snapcore/snapd/snap"
@@ -74,8 +77,10 @@ type imageSuite struct {
 	stdout *bytes.Buffer
 	stderr *bytes.Buffer
 
-	storeActions []*store.SnapAction
-	tsto         *image.ToolingStore
+	storeActionsMu sync.Mutex
+	storeActions   []*store.SnapAction
+	downloadMeters []progress.Meter
+	tsto           *image.ToolingStore
 
 	// SeedSnaps helps creating and making available seed snaps
 	// (it provides MakeAssertedSnap etc.) for the tests.
@@ -103,6 +108,9 @@ func (s *imageSuite) SetUpTest(c *C) {
 	s.stderr = &bytes.Buffer{}
 	image.Stderr = s.stderr
 	s.tsto = image.MockToolingStore(s)
+	// download one snap at a time unless a test wants otherwise, to
+	// keep the recorded store actions in order
+	s.AddCleanup(image.MockMaxConcurrentDownloads(1))
 
 	s.SeedSnaps = &seedtest.SeedSnaps{}
 	s.SetupAssertSigning("canonical", s)
@@ -138,6 +146,7 @@ func (s *imageSuite) TearDownTest(c *C) {
 	image.Stdout = os.Stdout
 	image.Stderr = os.Stderr
 	s.storeActions = nil
+	s.downloadMeters = nil
 }
 
 // interface for the store
@@ -154,7 +163,9 @@ func (s *imageSuite) SnapAction(_ context.Context, _ []*store.CurrentSnap, actio
 		return nil, fmt.Errorf("unexpected instance key in %q", actions[0].InstanceName)
 	}
 	// record
+	s.storeActionsMu.Lock()
 	s.storeActions = append(s.storeActions, actions[0])
+	s.storeActionsMu.Unlock()
 
 	if info := s.AssertedSnapInfo(actions[0].InstanceName); info != nil {
 		info.Channel = actions[0].Channel
@@ -164,7 +175,20 @@ func (s *imageSuite) SnapAction(_ context.Context, _ []*store.CurrentSnap, actio
 }
 
 func (s *imageSuite) Download(ctx context.Context, name, targetFn string, downloadInfo *snap.DownloadInfo, pbar progress.Meter, user *auth.UserState, dlOpts *store.DownloadOptions) error {
-	return osutil.CopyFile(s.AssertedSnap(name), targetFn, 0)
+	s.storeActionsMu.Lock()
+	s.downloadMeters = append(s.downloadMeters, pbar)
+	s.storeActionsMu.Unlock()
+
+	data, err := ioutil.ReadFile(s.AssertedSnap(name))
+	if err != nil {
+		return err
+	}
+	pbar.Start(name, float64(len(data)))
+	defer pbar.Finished()
+	if _, err := pbar.Write(data); err != nil {
+		return err
+	}
+	return ioutil.WriteFile(targetFn, data, 0644)
 }
 
 func (s *imageSuite) Assertion(assertType *asserts.AssertionType, primaryKey []string, user *auth.UserState) (asserts.Assertion, error) {
@@ -656,6 +680,111 @@ func (s *imageSuite) TestSetupSeed(c *C) {
 	c.Check(s.stderr.String(), Equals, "")
 }
 
+func (s *imageSuite) TestSetupSeedConcurrentDownloads(c *C) {
+	restore := image.MockTrusted(s.StoreSigning.Trusted)
+	defer restore()
+
+	model := s.Brands.Model("my-brand", "my-model", map[string]interface{}{
+		"architecture":   "amd64",
+		"gadget":         "pc18",
+		"kernel":         "pc-kernel",
+		"base":           "core18",
+		"required-snaps": []interface{}{"required-snap18", "snap-base-none", "other-base", "snap-req-other-base"},
+	})
+
+	gadgetUnpackDir := c.MkDir()
+	s.setupSnaps(c, gadgetUnpackDir, map[string]string{
+		"pc18":      "canonical",
+		"pc-kernel": "canonical",
+	})
+
+	prepare := func(concurrency int) (*seed.Seed, []string) {
+		restore := image.MockMaxConcurrentDownloads(concurrency)
+		defer restore()
+		s.storeActions = nil
+
+		rootdir := filepath.Join(c.MkDir(), "imageroot")
+		opts := &image.Options{
+			RootDir:         rootdir,
+			GadgetUnpackDir: gadgetUnpackDir,
+		}
+		local, err := image.LocalSnaps(s.tsto, opts)
+		c.Assert(err, IsNil)
+
+		err = image.SetupSeed(s.tsto, model, opts, local)
+		c.Assert(err, IsNil)
+
+		seedYaml, err := seed.ReadYaml(filepath.Join(rootdir, "var/lib/snapd/seed/seed.yaml"))
+		c.Assert(err, IsNil)
+
+		var downloaded []string
+		for _, a := range s.storeActions {
+			downloaded = append(downloaded, a.InstanceName)
+		}
+		sort.Strings(downloaded)
+		return seedYaml, downloaded
+	}
+
+	seqSeed, seqDownloaded := prepare(1)
+	c.Check(seqSeed.Snaps, HasLen, 8)
+
+	concSeed, concDownloaded := prepare(4)
+	// the seed is the same, in the same order
+	c.Check(concSeed, DeepEquals, seqSeed)
+	// and each snap was downloaded just once
+	c.Check(concDownloaded, DeepEquals, seqDownloaded)
+	c.Check(concDownloaded, DeepEquals, []string{"core18", "other-base", "pc-kernel", "pc18", "required-snap18", "snap-base-none", "snap-req-other-base", "snapd"})
+}
+
+func (s *imageSuite) TestSetupSeedConcurrentDownloadsProgress(c *C) {
+	restore := image.MockTrusted(s.StoreSigning.Trusted)
+	defer restore()
+	restore = image.MockMaxConcurrentDownloads(4)
+	defer restore()
+	pm := &progresstest.Meter{}
+	restore = progress.MockMeter(pm)
+	defer restore()
+
+	model := s.Brands.Model("my-brand", "my-model", map[string]interface{}{
+		"architecture":   "amd64",
+		"gadget":         "pc18",
+		"kernel":         "pc-kernel",
+		"base":           "core18",
+		"required-snaps": []interface{}{"required-snap18", "snap-base-none", "other-base", "snap-req-other-base"},
+	})
+
+	gadgetUnpackDir := c.MkDir()
+	s.setupSnaps(c, gadgetUnpackDir, map[string]string{
+		"pc18":      "canonical",
+		"pc-kernel": "canonical",
+	})
+
+	rootdir := filepath.Join(c.MkDir(), "imageroot")
+	opts := &image.Options{
+		RootDir:         rootdir,
+		GadgetUnpackDir: gadgetUnpackDir,
+	}
+	local, err := image.LocalSnaps(s.tsto, opts)
+	c.Assert(err, IsNil)
+
+	err = image.SetupSeed(s.tsto, model, opts, local)
+	c.Assert(err, IsNil)
+
+	// each download reported to a meter of its own
+	c.Assert(s.downloadMeters, HasLen, 8)
+	seen := make(map[progress.Meter]bool)
+	for _, pbar := range s.downloadMeters {
+		c.Check(pbar, Not(Equals), progress.Meter(pm))
+		seen[pbar] = true
+	}
+	c.Check(seen, HasLen, 8)
+	// all shown as a single progress bar, that completed
+	c.Assert(pm.Totals, Not(HasLen), 0)
+	c.Assert(pm.Values, Not(HasLen), 0)
+	c.Check(pm.Values[len(pm.Values)-1], Equals, pm.Totals[len(pm.Totals)-1])
+	c.Check(pm.Finishes > 0, Equals, true)
+}
+
 func (s *imageSuite) TestSetupSeedLocalCoreBrandKernel(c *C) {
 	restore := image.MockTrusted(s.StoreSigning.Trusted)
 	defer restore()
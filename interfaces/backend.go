@@ -96,3 +96,12 @@ type SecurityBackend interface {
 	// SandboxFeatures returns a list of tags that identify sandbox features.
 	SandboxFeatures() []string
 }
+
+// SecurityBackendSetupMany interface may be implemented by backends that can
+// optimize their operation when setting up multiple snaps at once.
+type SecurityBackendSetupMany interface {
+	// SetupMany creates and loads security artefacts of multiple snaps
+	// in one go. The opts slice holds the confinement options of the
+	// respective snaps.
+	SetupMany(snaps []*snap.Info, opts []ConfinementOptions, repo *Repository, tm timings.Measurer) []error
+}
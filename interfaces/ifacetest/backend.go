@@ -86,3 +86,25 @@ func (b *TestSecurityBackend) SandboxFeatures() []string {
 	}
 	return b.SandboxFeaturesCallback()
 }
+
+// TestSecurityBackendSetupMany is a security backend that implements SetupMany on top of TestSecurityBackend.
+type TestSecurityBackendSetupMany struct {
+	TestSecurityBackend
+
+	// SetupManyCalls stores information about all calls to SetupMany
+	SetupManyCalls []TestSetupManyCall
+}
+
+// TestSetupManyCall stores details about calls to TestSecurityBackendSetupMany.SetupMany
+type TestSetupManyCall struct {
+	// SnapInfos is a copy of the snapInfo arguments to a particular call to SetupMany
+	SnapInfos []*snap.Info
+	// Options is a copy of the confinement options to a particular call to SetupMany
+	Options []interfaces.ConfinementOptions
+}
+
+// SetupMany records information about the call.
+func (b *TestSecurityBackendSetupMany) SetupMany(snaps []*snap.Info, opts []interfaces.ConfinementOptions, repo *interfaces.Repository, tm timings.Measurer) []error {
+	b.SetupManyCalls = append(b.SetupManyCalls, TestSetupManyCall{SnapInfos: snaps, Options: opts})
+	return nil
+}
@@ -40,6 +40,9 @@ type Repository struct {
 	// Indexed by [snapName][plugName]
 	plugs map[string]map[string]*snap.PlugInfo
 	slots map[string]map[string]*snap.SlotInfo
+	// Indexed by [interfaceName], used to find auto-connection candidates
+	plugsByIface map[string]map[*snap.PlugInfo]bool
+	slotsByIface map[string]map[*snap.SlotInfo]bool
 	// given a slot and a plug, are they connected?
 	slotPlugs map[*snap.SlotInfo]map[*snap.PlugInfo]*Connection
 	// given a plug and a slot, are they connected?
@@ -54,6 +57,8 @@ func NewRepository() *Repository {
 		hotplugIfaces: make(map[string]Interface),
 		plugs:         make(map[string]map[string]*snap.PlugInfo),
 		slots:         make(map[string]map[string]*snap.SlotInfo),
+		plugsByIface:  make(map[string]map[*snap.PlugInfo]bool),
+		slotsByIface:  make(map[string]map[*snap.SlotInfo]bool),
 		slotPlugs:     make(map[*snap.SlotInfo]map[*snap.PlugInfo]*Connection),
 		plugSlots:     make(map[*snap.PlugInfo]map[*snap.SlotInfo]*Connection),
 	}
@@ -332,9 +337,27 @@ func (r *Repository) AddPlug(plug *snap.PlugInfo) error {
 		r.plugs[snapName] = make(map[string]*snap.PlugInfo)
 	}
 	r.plugs[snapName][plug.Name] = plug
+	r.indexPlug(plug)
 	return nil
 }
 
+func (r *Repository) indexPlug(plug *snap.PlugInfo) {
+	plugs := r.plugsByIface[plug.Interface]
+	if plugs == nil {
+		plugs = make(map[*snap.PlugInfo]bool)
+		r.plugsByIface[plug.Interface] = plugs
+	}
+	plugs[plug] = true
+}
+
+func (r *Repository) unindexPlug(plug *snap.PlugInfo) {
+	plugs := r.plugsByIface[plug.Interface]
+	delete(plugs, plug)
+	if len(plugs) == 0 {
+		delete(r.plugsByIface, plug.Interface)
+	}
+}
+
 // RemovePlug removes the named plug provided by a given snap.
 // The removed plug must exist and must not be used anywhere.
 func (r *Repository) RemovePlug(snapName, plugName string) error {
@@ -351,6 +374,7 @@ func (r *Repository) RemovePlug(snapName, plugName string) error {
 		return fmt.Errorf("cannot remove plug %q from snap %q, it is still connected", plugName, snapName)
 	}
 	delete(r.plugs[snapName], plugName)
+	r.unindexPlug(plug)
 	if len(r.plugs[snapName]) == 0 {
 		delete(r.plugs, snapName)
 	}
@@ -428,9 +452,27 @@ func (r *Repository) AddSlot(slot *snap.SlotInfo) error {
 		r.slots[snapName] = make(map[string]*snap.SlotInfo)
 	}
 	r.slots[snapName][slot.Name] = slot
+	r.indexSlot(slot)
 	return nil
 }
 
+func (r *Repository) indexSlot(slot *snap.SlotInfo) {
+	slots := r.slotsByIface[slot.Interface]
+	if slots == nil {
+		slots = make(map[*snap.SlotInfo]bool)
+		r.slotsByIface[slot.Interface] = slots
+	}
+	slots[slot] = true
+}
+
+func (r *Repository) unindexSlot(slot *snap.SlotInfo) {
+	slots := r.slotsByIface[slot.Interface]
+	delete(slots, slot)
+	if len(slots) == 0 {
+		delete(r.slotsByIface, slot.Interface)
+	}
+}
+
 // RemoveSlot removes a named slot from the given snap.
 // Removing a slot that doesn't exist returns an error.
 // Removing a slot that is connected to a plug returns an error.
@@ -448,6 +490,7 @@ func (r *Repository) RemoveSlot(snapName, slotName string) error {
 		return fmt.Errorf("cannot remove slot %q from snap %q, it is still connected", slotName, snapName)
 	}
 	delete(r.slots[snapName], slotName)
+	r.unindexSlot(slot)
 	if len(r.slots[snapName]) == 0 {
 		delete(r.slots, snapName)
 	}
@@ -1028,6 +1071,7 @@ func (r *Repository) AddSnap(snapInfo *snap.Info) error {
 			r.plugs[snapName] = make(map[string]*snap.PlugInfo)
 		}
 		r.plugs[snapName][plugName] = plugInfo
+		r.indexPlug(plugInfo)
 	}
 
 	for slotName, slotInfo := range snapInfo.Slots {
@@ -1038,6 +1082,7 @@ func (r *Repository) AddSnap(snapInfo *snap.Info) error {
 			r.slots[snapName] = make(map[string]*snap.SlotInfo)
 		}
 		r.slots[snapName][slotName] = slotInfo
+		r.indexSlot(slotInfo)
 	}
 	return nil
 }
@@ -1067,10 +1112,12 @@ func (r *Repository) RemoveSnap(snapName string) error {
 
 	for _, plug := range r.plugs[snapName] {
 		delete(r.plugSlots, plug)
+		r.unindexPlug(plug)
 	}
 	delete(r.plugs, snapName)
 	for _, slot := range r.slots[snapName] {
 		delete(r.slotPlugs, slot)
+		r.unindexSlot(slot)
 	}
 	delete(r.slots, snapName)
 
@@ -1121,23 +1168,18 @@ func (r *Repository) AutoConnectCandidateSlots(plugSnapName, plugName string, po
 		return nil
 	}
 
+	iface := plugInfo.Interface
+	connPlug := NewConnectedPlug(plugInfo, nil, nil)
 	var candidates []*snap.SlotInfo
-	for _, slotsForSnap := range r.slots {
-		for _, slotInfo := range slotsForSnap {
-			if slotInfo.Interface != plugInfo.Interface {
-				continue
-			}
-			iface := slotInfo.Interface
-
-			// declaration based checks disallow
-			ok, err := policyCheck(NewConnectedPlug(plugInfo, nil, nil), NewConnectedSlot(slotInfo, nil, nil))
-			if !ok || err != nil {
-				continue
-			}
+	for slotInfo := range r.slotsByIface[iface] {
+		// declaration based checks disallow
+		ok, err := policyCheck(connPlug, NewConnectedSlot(slotInfo, nil, nil))
+		if !ok || err != nil {
+			continue
+		}
 
-			if r.ifaces[iface].AutoConnect(plugInfo, slotInfo) {
-				candidates = append(candidates, slotInfo)
-			}
+		if r.ifaces[iface].AutoConnect(plugInfo, slotInfo) {
+			candidates = append(candidates, slotInfo)
 		}
 	}
 	return candidates
@@ -1154,23 +1196,18 @@ func (r *Repository) AutoConnectCandidatePlugs(slotSnapName, slotName string, po
 		return nil
 	}
 
+	iface := slotInfo.Interface
+	connSlot := NewConnectedSlot(slotInfo, nil, nil)
 	var candidates []*snap.PlugInfo
-	for _, plugsForSnap := range r.plugs {
-		for _, plugInfo := range plugsForSnap {
-			if slotInfo.Interface != plugInfo.Interface {
-				continue
-			}
-			iface := slotInfo.Interface
-
-			// declaration based checks disallow
-			ok, err := policyCheck(NewConnectedPlug(plugInfo, nil, nil), NewConnectedSlot(slotInfo, nil, nil))
-			if !ok || err != nil {
-				continue
-			}
+	for plugInfo := range r.plugsByIface[iface] {
+		// declaration based checks disallow
+		ok, err := policyCheck(NewConnectedPlug(plugInfo, nil, nil), connSlot)
+		if !ok || err != nil {
+			continue
+		}
 
-			if r.ifaces[iface].AutoConnect(plugInfo, slotInfo) {
-				candidates = append(candidates, plugInfo)
-			}
+		if r.ifaces[iface].AutoConnect(plugInfo, slotInfo) {
+			candidates = append(candidates, plugInfo)
 		}
 	}
 	return candidates
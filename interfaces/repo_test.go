@@ -21,6 +21,7 @@ package interfaces_test
 
 import (
 	"fmt"
+	"testing"
 
 	. "gopkg.in/check.v1"
 
@@ -1791,6 +1792,110 @@ plugs:
 	c.Assert(candidatePlugs, HasLen, 2)
 }
 
+func (s *RepositorySuite) TestAutoConnectCandidatesFollowRemovals(c *C) {
+	repo := s.emptyRepo
+	err := repo.AddInterface(&ifacetest.TestInterface{InterfaceName: "auto"})
+	c.Assert(err, IsNil)
+
+	policyCheck := func(plug *ConnectedPlug, slot *ConnectedSlot) (bool, error) {
+		return true, nil
+	}
+
+	producer1 := snaptest.MockInfo(c, `
+name: producer1
+version: 0
+slots:
+    auto:
+`, nil)
+	producer2 := snaptest.MockInfo(c, `
+name: producer2
+version: 0
+slots:
+    auto:
+    auto2:
+        interface: auto
+`, nil)
+	consumer := snaptest.MockInfo(c, `
+name: consumer
+version: 0
+plugs:
+    auto:
+`, nil)
+	for _, info := range []*snap.Info{producer1, producer2, consumer} {
+		c.Assert(repo.AddSnap(info), IsNil)
+	}
+
+	candidateSlots := repo.AutoConnectCandidateSlots("consumer", "auto", policyCheck)
+	c.Check(candidateSlots, HasLen, 3)
+
+	c.Assert(repo.RemoveSnap("producer1"), IsNil)
+	candidateSlots = repo.AutoConnectCandidateSlots("consumer", "auto", policyCheck)
+	c.Check(candidateSlots, HasLen, 2)
+
+	c.Assert(repo.RemoveSlot("producer2", "auto2"), IsNil)
+	candidateSlots = repo.AutoConnectCandidateSlots("consumer", "auto", policyCheck)
+	c.Assert(candidateSlots, HasLen, 1)
+	c.Check(candidateSlots[0].Name, Equals, "auto")
+
+	c.Assert(repo.RemovePlug("consumer", "auto"), IsNil)
+	candidatePlugs := repo.AutoConnectCandidatePlugs("producer2", "auto", policyCheck)
+	c.Check(candidatePlugs, HasLen, 0)
+
+	c.Assert(repo.AddPlug(&snap.PlugInfo{Snap: consumer, Name: "auto", Interface: "auto"}), IsNil)
+	candidatePlugs = repo.AutoConnectCandidatePlugs("producer2", "auto", policyCheck)
+	c.Check(candidatePlugs, HasLen, 1)
+}
+
+// BenchmarkAutoConnectCandidateSlots finds the auto-connection candidates
+// for a snap with 50 plugs on a system with 200 snaps.
+func BenchmarkAutoConnectCandidateSlots(b *testing.B) {
+	const numIfaces = 50
+	repo := NewRepository()
+	for i := 0; i < numIfaces; i++ {
+		if err := repo.AddInterface(&ifacetest.TestInterface{InterfaceName: fmt.Sprintf("iface%d", i)}); err != nil {
+			b.Fatal(err)
+		}
+	}
+	for i := 0; i < 200; i++ {
+		// each snap provides a few slots
+		yaml := fmt.Sprintf("name: producer%d\nversion: 0\nslots:\n", i)
+		for j := 0; j < 5; j++ {
+			yaml += fmt.Sprintf("  slot%d:\n    interface: iface%d\n", j, (i+j)%numIfaces)
+		}
+		info, err := snap.InfoFromSnapYaml([]byte(yaml))
+		if err != nil {
+			b.Fatal(err)
+		}
+		if err := repo.AddSnap(info); err != nil {
+			b.Fatal(err)
+		}
+	}
+	yaml := "name: consumer\nversion: 0\nplugs:\n"
+	for i := 0; i < numIfaces; i++ {
+		yaml += fmt.Sprintf("  plug%d:\n    interface: iface%d\n", i, i)
+	}
+	consumer, err := snap.InfoFromSnapYaml([]byte(yaml))
+	if err != nil {
+		b.Fatal(err)
+	}
+	if err := repo.AddSnap(consumer); err != nil {
+		b.Fatal(err)
+	}
+
+	policyCheck := func(plug *ConnectedPlug, slot *ConnectedSlot) (bool, error) {
+		return true, nil
+	}
+
+	b.ResetTimer()
+	for n := 0; n < b.N; n++ {
+		for i := 0; i < numIfaces; i++ {
+			if cands := repo.AutoConnectCandidateSlots("consumer", fmt.Sprintf("plug%d", i), policyCheck); len(cands) != 20 {
+				b.Fatalf("unexpected number of candidates: %d", len(cands))
+			}
+		}
+	}
+}
+
 // Tests for AddSnap and RemoveSnap
 
 type AddRemoveSuite struct {
@@ -27,14 +27,18 @@ package udev
 import (
 	"bytes"
 	"fmt"
+	"io/ioutil"
 	"os"
 	"path/filepath"
+	"regexp"
+	"sort"
 	"strings"
 
 	"github.com/snapcore/snapd/dirs"
 	"github.com/snapcore/snapd/interfaces"
 	"github.com/snapcore/snapd/osutil"
 	"github.com/snapcore/snapd/snap"
+	"github.com/snapcore/snapd/strutil"
 	"github.com/snapcore/snapd/timings"
 )
 
@@ -57,6 +61,63 @@ func snapRulesFilePath(snapName string) string {
 	return filepath.Join(dirs.SnapUdevRulesDir, rulesFileName)
 }
 
+// reloadRequest accumulates what needs to be re-triggered after one or
+// more rules files were changed, so that udev can be reloaded just once.
+type reloadRequest struct {
+	needed            bool
+	allDevices        bool
+	subsystemTriggers []string
+	matchedSubsystems []string
+}
+
+// ruleSubsystemRe matches the subsystem a udev rule is restricted to.
+var ruleSubsystemRe = regexp.MustCompile(`(?:^|[ ,])SUBSYSTEM=="([^"]+)"`)
+
+// addRules records that a rules file with the given content was added,
+// changed or removed. Devices of the subsystems matched by the tagging rules
+// will be re-triggered. If any of the rules is not restricted to a subsystem
+// all devices need to be re-triggered.
+func (r *reloadRequest) addRules(content []byte) {
+	r.needed = true
+	for _, line := range strings.Split(string(content), "\n") {
+		line = strings.TrimSpace(line)
+		// Skip comments and the snap-device-helper rules, the latter
+		// only act on devices that were tagged by other rules.
+		if line == "" || strings.HasPrefix(line, "#") || strings.HasPrefix(line, "TAG==") {
+			continue
+		}
+		m := ruleSubsystemRe.FindStringSubmatch(line)
+		if m == nil {
+			r.allDevices = true
+			continue
+		}
+		if !strutil.ListContains(r.matchedSubsystems, m[1]) {
+			r.matchedSubsystems = append(r.matchedSubsystems, m[1])
+		}
+	}
+}
+
+// addTriggers records the subsystem triggers requested by interfaces.
+func (r *reloadRequest) addTriggers(subsystemTriggers []string) {
+	for _, subsystem := range subsystemTriggers {
+		if !strutil.ListContains(r.subsystemTriggers, subsystem) {
+			r.subsystemTriggers = append(r.subsystemTriggers, subsystem)
+		}
+	}
+}
+
+// reload reloads the udev rules if any of the rules files changed.
+func (r *reloadRequest) reload() error {
+	if !r.needed {
+		return nil
+	}
+	// Without any device rules to go by (e.g. only rules commented out
+	// for non-strict snaps) be conservative and re-trigger everything.
+	allDevices := r.allDevices || len(r.matchedSubsystems) == 0
+	sort.Strings(r.matchedSubsystems)
+	return reloadRules(r.subsystemTriggers, r.matchedSubsystems, allDevices)
+}
+
 // Setup creates udev rules specific to a given snap.
 // If any of the rules are changed or removed then udev database is reloaded.
 //
@@ -64,6 +125,37 @@ func snapRulesFilePath(snapName string) string {
 //
 // If the method fails it should be re-tried (with a sensible strategy) by the caller.
 func (b *Backend) Setup(snapInfo *snap.Info, opts interfaces.ConfinementOptions, repo *interfaces.Repository, tm timings.Measurer) error {
+	var req reloadRequest
+	if err := b.setupRules(snapInfo, opts, repo, &req); err != nil {
+		return err
+	}
+	return req.reload()
+}
+
+// SetupMany creates udev rules for multiple snaps at once, the udev
+// database is reloaded at most once for all of them.
+//
+// The returned slice contains the errors encountered while writing the rules
+// of the individual snaps, or the error from reloading udev.
+func (b *Backend) SetupMany(snaps []*snap.Info, opts []interfaces.ConfinementOptions, repo *interfaces.Repository, tm timings.Measurer) []error {
+	var req reloadRequest
+	var errs []error
+	for i, snapInfo := range snaps {
+		if err := b.setupRules(snapInfo, opts[i], repo, &req); err != nil {
+			errs = append(errs, fmt.Errorf("cannot setup udev for snap %q: %s", snapInfo.InstanceName(), err))
+		}
+	}
+	// Reload even if some snaps failed, the rules of the others are
+	// already in place.
+	if err := req.reload(); err != nil {
+		errs = append(errs, err)
+	}
+	return errs
+}
+
+// setupRules writes the udev rules of the given snap and records in req
+// what needs to be reloaded if they changed.
+func (b *Backend) setupRules(snapInfo *snap.Info, opts interfaces.ConfinementOptions, repo *interfaces.Repository, req *reloadRequest) error {
 	snapName := snapInfo.InstanceName()
 	spec, err := repo.SnapSpecification(b.Name(), snapName)
 	if err != nil {
@@ -78,6 +170,12 @@ func (b *Backend) Setup(snapInfo *snap.Info, opts interfaces.ConfinementOptions,
 	}
 
 	rulesFilePath := snapRulesFilePath(snapInfo.InstanceName())
+	// The old rules are needed to know which devices need re-triggering
+	// once they are gone.
+	oldContent, err := ioutil.ReadFile(rulesFilePath)
+	if err != nil && !os.IsNotExist(err) {
+		return err
+	}
 
 	if len(content) == 0 {
 		// Make sure that the rules file gets removed when we don't have any
@@ -89,7 +187,8 @@ func (b *Backend) Setup(snapInfo *snap.Info, opts interfaces.ConfinementOptions,
 			// FIXME: somehow detect the interfaces that were
 			// disconnected and set subsystemTriggers appropriately.
 			// ATM, it is always going to be empty on disconnect.
-			return ReloadRules(subsystemTriggers)
+			req.addRules(oldContent)
+			req.addTriggers(subsystemTriggers)
 		}
 		return nil
 	}
@@ -126,7 +225,10 @@ func (b *Backend) Setup(snapInfo *snap.Info, opts interfaces.ConfinementOptions,
 	// FIXME: somehow detect the interfaces that were disconnected and set
 	// subsystemTriggers appropriately. ATM, it is always going to be empty
 	// on disconnect.
-	return ReloadRules(subsystemTriggers)
+	req.addRules(oldContent)
+	req.addRules(rulesFileState.Content)
+	req.addTriggers(subsystemTriggers)
+	return nil
 }
 
 // Remove removes udev rules specific to a given snap.
@@ -137,18 +239,23 @@ func (b *Backend) Setup(snapInfo *snap.Info, opts interfaces.ConfinementOptions,
 // If the method fails it should be re-tried (with a sensible strategy) by the caller.
 func (b *Backend) Remove(snapName string) error {
 	rulesFilePath := snapRulesFilePath(snapName)
-	err := os.Remove(rulesFilePath)
+	oldContent, err := ioutil.ReadFile(rulesFilePath)
 	if os.IsNotExist(err) {
 		// If file doesn't exist we avoid reloading the udev rules when we return here
 		return nil
 	} else if err != nil {
 		return err
 	}
+	if err := os.Remove(rulesFilePath); err != nil && !os.IsNotExist(err) {
+		return err
+	}
 
 	// FIXME: somehow detect the interfaces that were disconnected and set
 	// subsystemTriggers appropriately. ATM, it is always going to be empty
 	// on disconnect.
-	return ReloadRules(nil)
+	var req reloadRequest
+	req.addRules(oldContent)
+	return req.reload()
 }
 
 func (b *Backend) deriveContent(spec *Specification, snapInfo *snap.Info) (content []string) {
@@ -21,6 +21,7 @@ package udev_test
 
 import (
 	"bytes"
+	"fmt"
 	"os"
 	"path/filepath"
 
@@ -516,6 +517,86 @@ func (s *backendSuite) TestInstallingSnapWritesAndLoadsRulesWithInputJoystickSub
 	}
 }
 
+func (s *backendSuite) TestInstallingSnapTriggersOnlyMatchedSubsystems(c *C) {
+	s.Iface.UDevPermanentSlotCallback = func(spec *udev.Specification, slot *snap.SlotInfo) error {
+		spec.AddSnippet(`SUBSYSTEM=="tty", KERNEL=="ttyUSB[0-9]*"`)
+		spec.AddSnippet(`SUBSYSTEM=="usb", ATTR{idVendor}=="0525"`)
+		return nil
+	}
+	snapInfo := s.InstallSnap(c, interfaces.ConfinementOptions{}, "", ifacetest.SambaYamlV1, 0)
+	c.Check(s.udevadmCmd.Calls(), DeepEquals, [][]string{
+		{"udevadm", "control", "--reload-rules"},
+		{"udevadm", "trigger", "--subsystem-match=tty", "--subsystem-match=usb"},
+		// FIXME: temporary until spec.TriggerSubsystem() can
+		// be called during disconnect
+		{"udevadm", "trigger", "--property-match=ID_INPUT_JOYSTICK=1"},
+		{"udevadm", "settle", "--timeout=10"},
+	})
+
+	// devices matched by the removed rules are re-triggered too
+	s.udevadmCmd.ForgetCalls()
+	s.RemoveSnap(c, snapInfo)
+	c.Check(s.udevadmCmd.Calls(), DeepEquals, [][]string{
+		{"udevadm", "control", "--reload-rules"},
+		{"udevadm", "trigger", "--subsystem-match=tty", "--subsystem-match=usb"},
+		{"udevadm", "trigger", "--property-match=ID_INPUT_JOYSTICK=1"},
+		{"udevadm", "settle", "--timeout=10"},
+	})
+}
+
+func (s *backendSuite) TestInstallingSnapWithUnrestrictedRuleTriggersAll(c *C) {
+	s.Iface.UDevPermanentSlotCallback = func(spec *udev.Specification, slot *snap.SlotInfo) error {
+		spec.AddSnippet(`SUBSYSTEM=="tty", KERNEL=="ttyUSB[0-9]*"`)
+		spec.AddSnippet(`KERNEL=="rfkill"`)
+		return nil
+	}
+	snapInfo := s.InstallSnap(c, interfaces.ConfinementOptions{}, "", ifacetest.SambaYamlV1, 0)
+	c.Check(s.udevadmCmd.Calls(), DeepEquals, [][]string{
+		{"udevadm", "control", "--reload-rules"},
+		{"udevadm", "trigger", "--subsystem-nomatch=input"},
+		{"udevadm", "trigger", "--property-match=ID_INPUT_JOYSTICK=1"},
+		{"udevadm", "settle", "--timeout=10"},
+	})
+	s.RemoveSnap(c, snapInfo)
+}
+
+func (s *backendSuite) TestSetupManyReloadsOnce(c *C) {
+	subsystem := "tty"
+	s.Iface.UDevPermanentSlotCallback = func(spec *udev.Specification, slot *snap.SlotInfo) error {
+		spec.AddSnippet(fmt.Sprintf(`SUBSYSTEM=="%s", KERNEL=="foo"`, subsystem))
+		return nil
+	}
+	opts := interfaces.ConfinementOptions{}
+	snapInfo1 := s.InstallSnap(c, opts, "", ifacetest.SambaYamlV1, 0)
+	snapInfo2 := s.InstallSnap(c, opts, "samba_foo", ifacetest.SambaYamlV1, 0)
+	snapInfo3 := s.InstallSnap(c, opts, "samba_bar", ifacetest.SambaYamlV1, 0)
+
+	// change the rules of all the snaps
+	subsystem = "hidraw"
+	s.udevadmCmd.ForgetCalls()
+	setupMany, ok := s.Backend.(interfaces.SecurityBackendSetupMany)
+	c.Assert(ok, Equals, true)
+	errs := setupMany.SetupMany([]*snap.Info{snapInfo1, snapInfo2, snapInfo3}, []interfaces.ConfinementOptions{opts, opts, opts}, s.Repo, s.meas)
+	c.Assert(errs, HasLen, 0)
+	for _, name := range []string{"samba", "samba_foo", "samba_bar"} {
+		fname := filepath.Join(dirs.SnapUdevRulesDir, fmt.Sprintf("70-snap.%s.rules", name))
+		c.Check(fname, testutil.FileContains, `SUBSYSTEM=="hidraw"`)
+	}
+	// udev was reloaded just once
+	c.Check(s.udevadmCmd.Calls(), DeepEquals, [][]string{
+		{"udevadm", "control", "--reload-rules"},
+		{"udevadm", "trigger", "--subsystem-match=hidraw", "--subsystem-match=tty"},
+		{"udevadm", "trigger", "--property-match=ID_INPUT_JOYSTICK=1"},
+		{"udevadm", "settle", "--timeout=10"},
+	})
+
+	// nothing changed, nothing is reloaded
+	s.udevadmCmd.ForgetCalls()
+	errs = setupMany.SetupMany([]*snap.Info{snapInfo1, snapInfo2, snapInfo3}, []interfaces.ConfinementOptions{opts, opts, opts}, s.Repo, s.meas)
+	c.Assert(errs, HasLen, 0)
+	c.Check(s.udevadmCmd.Calls(), HasLen, 0)
+}
+
 func (s *backendSuite) TestSandboxFeatures(c *C) {
 	c.Assert(s.Backend.SandboxFeatures(), DeepEquals, []string{
 		"device-cgroup-v1",
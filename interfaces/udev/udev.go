@@ -33,17 +33,45 @@ import (
 //                   udevadm trigger --subsystem-match=input
 //                   udevadm trigger --property-match=ID_INPUT_JOYSTICK=1
 func ReloadRules(subsystemTriggers []string) error {
+	return reloadRules(subsystemTriggers, nil, true)
+}
+
+// reloadRules reloads the udev rule database and re-triggers devices.
+//
+// When allDevices is true all devices except the input subsystem are
+// re-triggered, otherwise only devices of the subsystems listed in
+// matchedSubsystems are, in a single udevadm call. The input subsystem is
+// never part of the default trigger, it is only triggered when present in
+// subsystemTriggers.
+func reloadRules(subsystemTriggers, matchedSubsystems []string, allDevices bool) error {
 	output, err := exec.Command("udevadm", "control", "--reload-rules").CombinedOutput()
 	if err != nil {
 		return fmt.Errorf("cannot reload udev rules: %s\nudev output:\n%s", err, string(output))
 	}
 
-	// By default, trigger for all events except the input subsystem since
-	// it can cause noticeable blocked input on, for example, classic
-	// desktop.
-	output, err = exec.Command("udevadm", "trigger", "--subsystem-nomatch=input").CombinedOutput()
-	if err != nil {
-		return fmt.Errorf("cannot run udev triggers: %s\nudev output:\n%s", err, string(output))
+	if allDevices {
+		// By default, trigger for all events except the input subsystem
+		// since it can cause noticeable blocked input on, for example,
+		// classic desktop.
+		output, err = exec.Command("udevadm", "trigger", "--subsystem-nomatch=input").CombinedOutput()
+		if err != nil {
+			return fmt.Errorf("cannot run udev triggers: %s\nudev output:\n%s", err, string(output))
+		}
+	} else {
+		args := []string{"trigger"}
+		for _, subsystem := range matchedSubsystems {
+			// see above, input is only triggered on request
+			if subsystem == "input" {
+				continue
+			}
+			args = append(args, "--subsystem-match="+subsystem)
+		}
+		if len(args) > 1 {
+			output, err = exec.Command("udevadm", args...).CombinedOutput()
+			if err != nil {
+				return fmt.Errorf("cannot run udev triggers: %s\nudev output:\n%s", err, string(output))
+			}
+		}
 	}
 
 	// FIXME: track if also should trigger the joystick property if it
@@ -0,0 +1,212 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package osutil
+
+import (
+	"os"
+	"path/filepath"
+	"syscall"
+
+	"github.com/snapcore/snapd/osutil/sys"
+)
+
+// syncfsThreshold is the number of files on a single filesystem from which on
+// an AtomicBatch flushes the whole filesystem with syncfs(2) instead of
+// calling fsync(2) on each file.
+const syncfsThreshold = 4
+
+var (
+	fileSync = (*os.File).Sync
+	fsSync   = syncfs
+)
+
+// An AtomicBatch writes a group of files, replacing each of them atomically
+// like AtomicWriteFile does, while paying the cost of making them durable
+// only once for the whole group.
+//
+// Files added to the batch are written to temporary files next to their
+// targets without being synced. Commit then makes all the temporary files
+// durable together, using a single syncfs(2) per filesystem when there are
+// enough files or fsync(2) on each file otherwise, renames them all into
+// place and finally syncs each of the affected directories once.
+//
+// The crash-safety contract is:
+//
+//  - once Commit returns successfully all the files of the batch are durable
+//  - each individual target file is at all times either in its previous
+//    state or has its complete new content, it is never seen partially
+//    written
+//  - the batch as a whole is *not* transactional: a crash (or a failure)
+//    in the middle of the rename phase can leave some of the targets with
+//    the new content and others with the old one
+//  - a crash before the rename phase completes may leave temporary files
+//    (ending with '~', see NewAtomicFile) behind
+//
+// Callers that need to be able to recover from a partially applied batch
+// must be able to re-apply it, as is the case for EnsureDirState.
+//
+// It is the caller's responsibility to call Cancel() to clean up on error.
+// Calling Cancel after a successful Commit does nothing, so it is always safe
+// to defer it.
+type AtomicBatch struct {
+	files     []*AtomicFile
+	committed bool
+}
+
+// NewAtomicBatch returns a new, empty, AtomicBatch.
+func NewAtomicBatch() *AtomicBatch {
+	return &AtomicBatch{}
+}
+
+// WriteFile adds a file with the given content and permissions to the batch.
+// The content is written to a temporary file straight away but is only put in
+// place, and made durable, on Commit.
+func (b *AtomicBatch) WriteFile(filename string, data []byte, perm os.FileMode, flags AtomicWriteFlags) error {
+	return b.WriteFileChown(filename, data, perm, flags, NoChown, NoChown)
+}
+
+// WriteFileChown is like WriteFile but also sets the ownership of the file,
+// see AtomicWriteFileChown.
+func (b *AtomicBatch) WriteFileChown(filename string, data []byte, perm os.FileMode, flags AtomicWriteFlags, uid sys.UserID, gid sys.GroupID) error {
+	aw, err := NewAtomicFile(filename, perm, flags, uid, gid)
+	if err != nil {
+		return err
+	}
+	if _, err := aw.Write(data); err != nil {
+		aw.Cancel()
+		return err
+	}
+	b.files = append(b.files, aw)
+	return nil
+}
+
+// Len returns the number of files in the batch.
+func (b *AtomicBatch) Len() int {
+	return len(b.files)
+}
+
+// Commit puts all the files of the batch in place and makes them durable.
+//
+// If Commit fails Cancel needs to be called to clean up the temporary files
+// that were not renamed yet.
+func (b *AtomicBatch) Commit() error {
+	if b.committed {
+		return nil
+	}
+
+	for _, aw := range b.files {
+		if aw.uid != NoChown || aw.gid != NoChown {
+			if err := chown(aw.File, aw.uid, aw.gid); err != nil {
+				return err
+			}
+		}
+	}
+
+	if !snapdUnsafeIO {
+		if err := syncFiles(b.files); err != nil {
+			return err
+		}
+	}
+
+	var dirs []string
+	seenDirs := make(map[string]bool)
+	for _, aw := range b.files {
+		if err := aw.Close(); err != nil {
+			return err
+		}
+		if err := os.Rename(aw.tmpname, aw.target); err != nil {
+			return err
+		}
+		aw.renamed = true
+		if dir := filepath.Dir(aw.target); !seenDirs[dir] {
+			seenDirs[dir] = true
+			dirs = append(dirs, dir)
+		}
+	}
+
+	if !snapdUnsafeIO {
+		for _, dir := range dirs {
+			if err := syncDir(dir); err != nil {
+				return err
+			}
+		}
+	}
+	b.committed = true
+
+	return nil
+}
+
+// Cancel removes the temporary files of the batch that were not put in place
+// yet.
+func (b *AtomicBatch) Cancel() error {
+	var firstErr error
+	for _, aw := range b.files {
+		if aw.renamed {
+			continue
+		}
+		if err := aw.Cancel(); err != nil && firstErr == nil {
+			firstErr = err
+		}
+	}
+	b.files = nil
+	return firstErr
+}
+
+// syncFiles makes the content of the given, still open, files durable.
+func syncFiles(files []*AtomicFile) error {
+	byDev := make(map[uint64][]*AtomicFile)
+	var devs []uint64
+	for _, aw := range files {
+		var st syscall.Stat_t
+		if err := syscall.Fstat(int(aw.Fd()), &st); err != nil {
+			return err
+		}
+		dev := uint64(st.Dev)
+		if _, ok := byDev[dev]; !ok {
+			devs = append(devs, dev)
+		}
+		byDev[dev] = append(byDev[dev], aw)
+	}
+	for _, dev := range devs {
+		onDev := byDev[dev]
+		if len(onDev) >= syncfsThreshold {
+			if err := fsSync(onDev[0].File); err == nil {
+				continue
+			}
+			// syncfs may not be available, fall back to fsync
+		}
+		for _, aw := range onDev {
+			if err := fileSync(aw.File); err != nil {
+				return err
+			}
+		}
+	}
+	return nil
+}
+
+func syncDir(dir string) error {
+	// XXX: if go switches to use aio_fsync, we need to open the dir for writing
+	d, err := os.Open(dir)
+	if err != nil {
+		return err
+	}
+	defer d.Close()
+	return fileSync(d)
+}
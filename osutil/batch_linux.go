@@ -0,0 +1,48 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package osutil
+
+import (
+	"os"
+	"runtime"
+	"syscall"
+)
+
+// sysSyncfs is the syncfs(2) system call number, the syscall package does not
+// define it for all the architectures.
+var sysSyncfs = map[string]uintptr{
+	"386":     344,
+	"amd64":   306,
+	"arm":     373,
+	"arm64":   267,
+	"ppc64le": 348,
+	"s390x":   338,
+}[runtime.GOARCH]
+
+// syncfs flushes all the data of the filesystem containing the given file.
+func syncfs(f *os.File) error {
+	if sysSyncfs == 0 {
+		return syscall.ENOSYS
+	}
+	if _, _, errno := syscall.Syscall(sysSyncfs, f.Fd(), 0, 0); errno != 0 {
+		return errno
+	}
+	return nil
+}
@@ -0,0 +1,204 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package osutil_test
+
+import (
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	. "gopkg.in/check.v1"
+
+	"github.com/snapcore/snapd/osutil"
+	"github.com/snapcore/snapd/testutil"
+)
+
+type batchSuite struct {
+	testutil.BaseTest
+
+	fileSyncs []string
+	fsSyncs   []string
+}
+
+var _ = Suite(&batchSuite{})
+
+func (s *batchSuite) SetUpTest(c *C) {
+	s.BaseTest.SetUpTest(c)
+	s.fileSyncs = nil
+	s.fsSyncs = nil
+	s.AddCleanup(osutil.SetUnsafeIO(false))
+	s.AddCleanup(osutil.MockFileSync(func(f *os.File) error {
+		s.fileSyncs = append(s.fileSyncs, f.Name())
+		return nil
+	}))
+	s.AddCleanup(osutil.MockFsSync(func(f *os.File) error {
+		s.fsSyncs = append(s.fsSyncs, f.Name())
+		return nil
+	}))
+}
+
+func (s *batchSuite) TestCommitFewFiles(c *C) {
+	dir := c.MkDir()
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
+
+	c.Assert(batch.WriteFile(filepath.Join(dir, "foo"), []byte("foo"), 0644, 0), IsNil)
+	c.Assert(batch.WriteFile(filepath.Join(dir, "bar"), []byte("bar"), 0600, 0), IsNil)
+	c.Check(batch.Len(), Equals, 2)
+
+	// nothing is in place before Commit
+	c.Check(filepath.Join(dir, "foo"), testutil.FileAbsent)
+	c.Check(filepath.Join(dir, "bar"), testutil.FileAbsent)
+
+	c.Assert(batch.Commit(), IsNil)
+	c.Check(filepath.Join(dir, "foo"), testutil.FileEquals, "foo")
+	c.Check(filepath.Join(dir, "bar"), testutil.FileEquals, "bar")
+	st, err := os.Stat(filepath.Join(dir, "bar"))
+	c.Assert(err, IsNil)
+	c.Check(st.Mode().Perm(), Equals, os.FileMode(0600))
+
+	// no temporary files are left behind
+	d, err := ioutil.ReadDir(dir)
+	c.Assert(err, IsNil)
+	c.Check(d, HasLen, 2)
+
+	// each file and the directory were synced once
+	c.Check(s.fileSyncs, HasLen, 3)
+	c.Check(s.fileSyncs[2], Equals, dir)
+	c.Check(s.fsSyncs, HasLen, 0)
+
+	// Cancel after Commit does nothing
+	c.Check(batch.Cancel(), IsNil)
+	c.Check(filepath.Join(dir, "foo"), testutil.FileEquals, "foo")
+}
+
+func (s *batchSuite) TestCommitManyFilesUsesSyncfs(c *C) {
+	dir1 := c.MkDir()
+	dir2 := c.MkDir()
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
+
+	for i := 0; i < 10; i++ {
+		dir := dir1
+		if i%2 == 1 {
+			dir = dir2
+		}
+		c.Assert(batch.WriteFile(filepath.Join(dir, fmt.Sprintf("file-%d", i)), []byte("content"), 0644, 0), IsNil)
+	}
+	c.Assert(batch.Commit(), IsNil)
+
+	for i := 0; i < 10; i++ {
+		dir := dir1
+		if i%2 == 1 {
+			dir = dir2
+		}
+		c.Check(filepath.Join(dir, fmt.Sprintf("file-%d", i)), testutil.FileEquals, "content")
+	}
+	// one syncfs for the filesystem and one fsync per directory
+	c.Check(s.fsSyncs, HasLen, 1)
+	c.Check(s.fileSyncs, DeepEquals, []string{dir1, dir2})
+}
+
+func (s *batchSuite) TestCommitManyFilesSyncfsFallback(c *C) {
+	restore := osutil.MockFsSync(func(f *os.File) error {
+		return fmt.Errorf("not supported")
+	})
+	defer restore()
+
+	dir := c.MkDir()
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
+	for i := 0; i < 5; i++ {
+		c.Assert(batch.WriteFile(filepath.Join(dir, fmt.Sprintf("file-%d", i)), nil, 0644, 0), IsNil)
+	}
+	c.Assert(batch.Commit(), IsNil)
+	// every file and the directory are synced
+	c.Check(s.fileSyncs, HasLen, 6)
+}
+
+func (s *batchSuite) TestCancel(c *C) {
+	dir := c.MkDir()
+	batch := osutil.NewAtomicBatch()
+
+	c.Assert(batch.WriteFile(filepath.Join(dir, "foo"), []byte("foo"), 0644, 0), IsNil)
+	c.Assert(batch.Cancel(), IsNil)
+
+	d, err := ioutil.ReadDir(dir)
+	c.Assert(err, IsNil)
+	c.Check(d, HasLen, 0)
+	c.Check(s.fileSyncs, HasLen, 0)
+}
+
+func (s *batchSuite) TestWriteFileError(c *C) {
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
+
+	err := batch.WriteFile(filepath.Join(c.MkDir(), "not-there", "foo"), nil, 0644, 0)
+	c.Assert(err, NotNil)
+	c.Check(batch.Len(), Equals, 0)
+}
+
+// benchmarkInstallFiles writes a snap-like set of unit files through a
+// filesystem where each fsync costs a millisecond, like slow eMMC storage.
+func benchmarkInstallFiles(b *testing.B, batched bool) {
+	restore := osutil.SetUnsafeIO(false)
+	defer restore()
+	slowSync := func(*os.File) error {
+		time.Sleep(time.Millisecond)
+		return nil
+	}
+	defer osutil.MockFileSync(slowSync)()
+	defer osutil.MockFsSync(slowSync)()
+
+	content := make(map[string]*osutil.FileState, 50)
+	for i := 0; i < 50; i++ {
+		content[fmt.Sprintf("snap.foo.svc%d.service", i)] = &osutil.FileState{
+			Content: []byte(fmt.Sprintf("[Unit]\nDescription=Service %d\n", i)),
+			Mode:    0644,
+		}
+	}
+
+	for n := 0; n < b.N; n++ {
+		dir, err := ioutil.TempDir("", "batch-benchmark")
+		if err != nil {
+			b.Fatal(err)
+		}
+		if batched {
+			_, _, err = osutil.EnsureDirState(dir, "snap.foo.*", content)
+		} else {
+			for name, fileState := range content {
+				err = osutil.AtomicWriteFile(filepath.Join(dir, name), fileState.Content, fileState.Mode, 0)
+				if err != nil {
+					break
+				}
+			}
+		}
+		os.RemoveAll(dir)
+		if err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkInstallFilesSlowSyncAtomicWriteFile(b *testing.B) { benchmarkInstallFiles(b, false) }
+func BenchmarkInstallFilesSlowSyncBatched(b *testing.B)         { benchmarkInstallFiles(b, true) }
@@ -187,3 +187,15 @@ func MockFindGid(mock func(name string) (uint64, error)) (restore func()) {
 	findGid = mock
 	return func() { findGid = old }
 }
+
+func MockFileSync(f func(*os.File) error) (restore func()) {
+	old := fileSync
+	fileSync = f
+	return func() { fileSync = old }
+}
+
+func MockFsSync(f func(*os.File) error) (restore func()) {
+	old := fsSync
+	fsSync = f
+	return func() { fsSync = old }
+}
@@ -166,7 +166,7 @@ func (aw *AtomicFile) Commit() error {
 		dir = d
 		defer dir.Close()
 
-		if err := aw.Sync(); err != nil {
+		if err := fileSync(aw.File); err != nil {
 			return err
 		}
 	}
@@ -181,7 +181,7 @@ func (aw *AtomicFile) Commit() error {
 	aw.renamed = true // it is now too late to Cancel()
 
 	if !snapdUnsafeIO {
-		return dir.Sync()
+		return fileSync(dir)
 	}
 
 	return nil
@@ -79,14 +79,19 @@ func EnsureDirStateGlobs(dir string, globs []string, content map[string]*FileSta
 			return nil, nil, fmt.Errorf("internal error: EnsureDirState got filename %q which doesn't match any glob patterns %q", baseName, globs)
 		}
 	}
-	// Change phase (create/change files described by content)
+	// Change phase (create/change files described by content). The changed
+	// files are written as one batch so that they are made durable together.
+	batch := NewAtomicBatch()
 	var firstErr error
 	for baseName, fileState := range content {
 		filePath := filepath.Join(dir, baseName)
-		err := EnsureFileState(filePath, fileState)
-		if err == ErrSameState {
+		equal, err := fileState.Equals(filePath)
+		if err == nil && equal {
 			continue
 		}
+		if err == nil {
+			err = batch.WriteFile(filePath, fileState.Content, fileState.Mode, 0)
+		}
 		if err != nil {
 			// On write failure, switch to erase mode. Desired content is set
 			// to nothing (no content) changed files are forgotten and the
@@ -99,6 +104,18 @@ func EnsureDirStateGlobs(dir string, globs []string, content map[string]*FileSta
 		}
 		changed = append(changed, baseName)
 	}
+	if firstErr == nil {
+		if err := batch.Commit(); err != nil {
+			// Some of the files may be in place already, erase them
+			// all as above.
+			firstErr = err
+			content = nil
+			changed = nil
+		}
+	}
+	// Get rid of any temporary files left behind on failure, they might
+	// match the globs.
+	batch.Cancel()
 	// Delete phase (remove files matching the glob that are not in content)
 	matches := make(map[string]bool)
 	for _, glob := range globs {
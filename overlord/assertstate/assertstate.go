@@ -29,6 +29,7 @@ import (
 	"github.com/snapcore/snapd/asserts"
 	"github.com/snapcore/snapd/asserts/snapasserts"
 	"github.com/snapcore/snapd/httputil"
+	"github.com/snapcore/snapd/logger"
 	"github.com/snapcore/snapd/overlord/snapstate"
 	"github.com/snapcore/snapd/overlord/state"
 	"github.com/snapcore/snapd/release"
@@ -67,6 +68,25 @@ func RefreshSnapDeclarations(s *state.State, userID int) error {
 		return nil
 	}
 	fetching := func(f asserts.Fetcher) error {
+		if bf, ok := f.(asserts.BulkFetcher); ok {
+			// retrieve all the declarations and their
+			// prerequisites together, failures are reported
+			// when fetching them one by one below
+			var refs []*asserts.Ref
+			for _, snapst := range snapStates {
+				info, err := snapst.CurrentInfo()
+				if err != nil || info.SnapID == "" {
+					continue
+				}
+				refs = append(refs, &asserts.Ref{
+					Type:       asserts.SnapDeclarationType,
+					PrimaryKey: []string{release.Series, info.SnapID},
+				})
+			}
+			if err := bf.Prefetch(refs); err != nil {
+				logger.Debugf("cannot prefetch snap-declarations: %v", err)
+			}
+		}
 		for _, snapst := range snapStates {
 			info, err := snapst.CurrentInfo()
 			if err != nil {
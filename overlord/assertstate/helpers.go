@@ -35,9 +35,13 @@ func userFromUserID(st *state.State, userID int) (*auth.UserState, error) {
 	return auth.User(st, userID)
 }
 
-func doFetch(s *state.State, userID int, deviceCtx snapstate.DeviceContext, fetching func(asserts.Fetcher) error) error {
-	// TODO: once we have a bulk assertion retrieval endpoint this approach will change
+// bulkAssertionStore is implemented by stores that can retrieve many
+// assertions at once.
+type bulkAssertionStore interface {
+	Assertions(refs []*asserts.Ref, user *auth.UserState) ([]asserts.Assertion, error)
+}
 
+func doFetch(s *state.State, userID int, deviceCtx snapstate.DeviceContext, fetching func(asserts.Fetcher) error) error {
 	db := cachedDB(s)
 
 	// this is a fallback in case of bugs, we ask the store
@@ -67,7 +71,14 @@ func doFetch(s *state.State, userID int, deviceCtx snapstate.DeviceContext, fetc
 	}
 
 	s.Unlock()
-	err = b.Fetch(db, retrieve, fetching)
+	if bulkSto, ok := sto.(bulkAssertionStore); ok {
+		retrieveMany := func(refs []*asserts.Ref) ([]asserts.Assertion, error) {
+			return bulkSto.Assertions(refs, user)
+		}
+		err = b.BulkFetch(db, retrieve, retrieveMany, fetching)
+	} else {
+		err = b.Fetch(db, retrieve, fetching)
+	}
 	s.Lock()
 	if err != nil {
 		return err
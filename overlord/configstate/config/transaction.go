@@ -42,6 +42,14 @@ type Transaction struct {
 	state    *state.State
 	pristine map[string]map[string]*json.RawMessage // snap => key => value
 	changes  map[string]map[string]interface{}
+
+	// pristineMaps caches the nested documents of the pristine
+	// configuration, which do not change until Commit, decoded as
+	// they get traversed; they are shared and must not be modified.
+	pristineMaps map[*json.RawMessage]map[string]*json.RawMessage
+	// merged caches the values of the changed top-level options
+	// merged with their pristine value, until they change again.
+	merged map[string]map[string]*json.RawMessage // snap => key => value
 }
 
 // NewTransaction creates a new configuration transaction initialized with the given state.
@@ -59,9 +67,83 @@ func NewTransaction(st *state.State) *Transaction {
 	} else if err != nil {
 		panic(fmt.Errorf("internal error: cannot unmarshal configuration: %v", err))
 	}
+	transaction.resetCaches()
 	return transaction
 }
 
+func (t *Transaction) resetCaches() {
+	t.pristineMaps = make(map[*json.RawMessage]map[string]*json.RawMessage)
+	t.merged = make(map[string]map[string]*json.RawMessage)
+}
+
+// pristineMap returns the map encoded by the given document of the
+// pristine configuration, decoding it only once per transaction.
+func (t *Transaction) pristineMap(raw *json.RawMessage) (map[string]*json.RawMessage, error) {
+	if m, ok := t.pristineMaps[raw]; ok {
+		return m, nil
+	}
+	m, err := decodeMap(raw)
+	if err != nil {
+		return nil, err
+	}
+	t.pristineMaps[raw] = m
+	return m, nil
+}
+
+func decodeMap(raw *json.RawMessage) (map[string]*json.RawMessage, error) {
+	var m map[string]*json.RawMessage
+	if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &m); err != nil {
+		return nil, err
+	}
+	return m, nil
+}
+
+// Clone returns a copy of the transaction, with the same pristine
+// configuration and pending changes, which can be modified in isolation
+// from it. Changes made to the copy can be brought back with Adopt.
+func (t *Transaction) Clone() *Transaction {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+
+	clone := &Transaction{state: t.state}
+	clone.pristine = make(map[string]map[string]*json.RawMessage, len(t.pristine))
+	for instanceName, config := range t.pristine {
+		clone.pristine[instanceName] = config
+	}
+	clone.changes = make(map[string]map[string]interface{}, len(t.changes))
+	for instanceName, config := range t.changes {
+		clone.changes[instanceName] = copyChanges(config)
+	}
+	clone.resetCaches()
+	return clone
+}
+
+// copyChanges copies the nested maps of changes, which get updated in
+// place, sharing the raw values they hold, which get replaced instead.
+func copyChanges(changes map[string]interface{}) map[string]interface{} {
+	out := make(map[string]interface{}, len(changes))
+	for k, v := range changes {
+		if m, ok := v.(map[string]interface{}); ok {
+			v = copyChanges(m)
+		}
+		out[k] = v
+	}
+	return out
+}
+
+// Adopt replaces the pending changes of the transaction with the ones of
+// the given copy of it, obtained with Clone. The copy must not be used
+// afterwards.
+func (t *Transaction) Adopt(clone *Transaction) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	clone.mu.Lock()
+	defer clone.mu.Unlock()
+
+	t.changes = clone.changes
+	t.merged = make(map[string]map[string]*json.RawMessage)
+}
+
 // State returns the system State
 func (t *Transaction) State() *state.State {
 	return t.state
@@ -129,8 +211,7 @@ func (t *Transaction) Set(instanceName, key string, value interface{}) error {
 	// Check whether it's trying to traverse a non-map from pristine. This
 	// would go unperceived by the configuration patching below.
 	if len(subkeys) > 1 {
-		var result interface{}
-		err = getFromConfig(instanceName, subkeys, 0, t.pristine[instanceName], &result)
+		_, err = lookup(instanceName, subkeys, t.pristine[instanceName], t.pristineMap)
 		if err != nil && !IsNoOption(err) {
 			return err
 		}
@@ -141,6 +222,9 @@ func (t *Transaction) Set(instanceName, key string, value interface{}) error {
 	}
 
 	t.changes[instanceName] = config
+	if len(subkeys) > 0 {
+		delete(t.merged[instanceName], subkeys[0])
+	}
 	return nil
 }
 
@@ -169,12 +253,52 @@ func (t *Transaction) Get(snapName, key string, result interface{}) error {
 		return err
 	}
 
-	// commit changes onto a copy of pristine configuration, so that get has a complete view of the config.
-	config := t.copyPristine(snapName)
-	applyChanges(config, t.changes[snapName])
+	if len(subkeys) == 0 {
+		// commit changes onto a copy of pristine configuration, so that get has a complete view of the config.
+		config := t.copyPristine(snapName)
+		t.applyChanges(config, t.changes[snapName])
+
+		purgeNulls(config)
+		return getRootFromConfig(snapName, config, result)
+	}
+
+	// only the requested top-level option is merged with its
+	// changes and only the documents on the path are decoded
+	top, isPristine := t.topLevel(snapName, subkeys[0])
+	decode := decodeMap
+	if isPristine {
+		decode = t.pristineMap
+	}
+	raw, err := lookup(snapName, subkeys, map[string]*json.RawMessage{subkeys[0]: top}, decode)
+	if err != nil {
+		return err
+	}
+	if bytes.Contains(*raw, jsonNull) {
+		raw = purgeNulls(raw).(*json.RawMessage)
+	}
+	if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &result); err != nil {
+		key := strings.Join(subkeys, ".")
+		return fmt.Errorf("internal error: cannot unmarshal snap %q option %q into %T: %s, json: %s", snapName, key, result, err, *raw)
+	}
+	return nil
+}
 
-	purgeNulls(config)
-	return getFromConfig(snapName, subkeys, 0, config, result)
+// topLevel returns the value of the given top-level option of the
+// snap as seen by the transaction and whether it is the pristine one.
+func (t *Transaction) topLevel(instanceName, key string) (raw *json.RawMessage, isPristine bool) {
+	change, ok := t.changes[instanceName][key]
+	if !ok {
+		return t.pristine[instanceName][key], true
+	}
+	if raw, ok := t.merged[instanceName][key]; ok {
+		return raw, false
+	}
+	raw = t.commitChange(t.pristine[instanceName][key], change)
+	if t.merged[instanceName] == nil {
+		t.merged[instanceName] = make(map[string]*json.RawMessage)
+	}
+	t.merged[instanceName][key] = raw
+	return raw, false
 }
 
 // GetMaybe unmarshals into result the cached value of the provided snap's configuration key.
@@ -189,44 +313,46 @@ func (t *Transaction) GetMaybe(instanceName, key string, result interface{}) err
 	return nil
 }
 
-func getFromConfig(instanceName string, subkeys []string, pos int, config map[string]*json.RawMessage, result interface{}) error {
-	// special case - get root document
-	if len(subkeys) == 0 {
-		if len(config) == 0 {
-			return &NoOptionError{SnapName: instanceName}
-		}
-		raw := jsonRaw(config)
-		if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &result); err != nil {
-			return fmt.Errorf("internal error: cannot unmarshal snap %q root document: %s", instanceName, err)
-		}
-		return nil
+func getRootFromConfig(instanceName string, config map[string]*json.RawMessage, result interface{}) error {
+	if len(config) == 0 {
+		return &NoOptionError{SnapName: instanceName}
 	}
-
-	raw, ok := config[subkeys[pos]]
-	if !ok {
-		return &NoOptionError{SnapName: instanceName, Key: strings.Join(subkeys[:pos+1], ".")}
+	raw := jsonRaw(config)
+	if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &result); err != nil {
+		return fmt.Errorf("internal error: cannot unmarshal snap %q root document: %s", instanceName, err)
 	}
+	return nil
+}
 
-	// There is a known problem with json raw messages representing nulls when they are stored in nested structures, such as
-	// config map inside our state. These are turned into nils and need to be handled explicitly.
-	if raw == nil {
-		m := json.RawMessage("null")
-		raw = &m
-	}
+var jsonNull = []byte("null")
 
-	if pos+1 == len(subkeys) {
-		if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &result); err != nil {
-			key := strings.Join(subkeys, ".")
-			return fmt.Errorf("internal error: cannot unmarshal snap %q option %q into %T: %s, json: %s", instanceName, key, result, err, *raw)
-		}
-		return nil
-	}
+// isNull returns whether raw represents a null value, nulls stand for
+// unset options.
+//
+// There is a known problem with json raw messages representing nulls when they are stored in nested structures, such as
+// config map inside our state. These are turned into nils and need to be handled explicitly.
+func isNull(raw *json.RawMessage) bool {
+	return raw == nil || bytes.Equal(bytes.TrimSpace(*raw), jsonNull)
+}
 
-	var configm map[string]*json.RawMessage
-	if err := jsonutil.DecodeWithNumber(bytes.NewReader(*raw), &configm); err != nil {
-		return fmt.Errorf("snap %q option %q is not a map", instanceName, strings.Join(subkeys[:pos+1], "."))
+// lookup returns the value of the option at the given key path in
+// config, decoding the documents along the path with decode.
+func lookup(instanceName string, subkeys []string, config map[string]*json.RawMessage, decode func(*json.RawMessage) (map[string]*json.RawMessage, error)) (*json.RawMessage, error) {
+	for pos, subkey := range subkeys {
+		raw := config[subkey]
+		if isNull(raw) {
+			return nil, &NoOptionError{SnapName: instanceName, Key: strings.Join(subkeys[:pos+1], ".")}
+		}
+		if pos+1 == len(subkeys) {
+			return raw, nil
+		}
+		configm, err := decode(raw)
+		if err != nil {
+			return nil, fmt.Errorf("snap %q option %q is not a map", instanceName, strings.Join(subkeys[:pos+1], "."))
+		}
+		config = configm
 	}
-	return getFromConfig(instanceName, subkeys, pos+1, configm, result)
+	panic("internal error: lookup without key")
 }
 
 // Commit applies to the state the configuration changes made in the transaction
@@ -248,15 +374,25 @@ func (t *Transaction) Commit() {
 	} else if err != nil {
 		panic(fmt.Errorf("internal error: cannot unmarshal configuration: %v", err))
 	}
+	t.resetCaches()
 
-	// Iterate through the write cache and save each item.
+	// Iterate through the write cache and save each item, only the
+	// changed options are re-encoded.
 	for instanceName, snapChanges := range t.changes {
 		config, ok := t.pristine[instanceName]
 		if !ok {
 			config = make(map[string]*json.RawMessage)
 		}
-		applyChanges(config, snapChanges)
-		purgeNulls(config)
+		t.applyChanges(config, snapChanges)
+		for k := range snapChanges {
+			if v := config[k]; v == nil || bytes.Contains(*v, jsonNull) {
+				if cfg := purgeNulls(v); cfg != nil {
+					config[k] = cfg.(*json.RawMessage)
+				} else {
+					delete(config, k)
+				}
+			}
+		}
 		t.pristine[instanceName] = config
 	}
 
@@ -264,11 +400,12 @@ func (t *Transaction) Commit() {
 
 	// The cache has been flushed, reset it.
 	t.changes = make(map[string]map[string]interface{})
+	t.resetCaches()
 }
 
-func applyChanges(config map[string]*json.RawMessage, changes map[string]interface{}) {
+func (t *Transaction) applyChanges(config map[string]*json.RawMessage, changes map[string]interface{}) {
 	for k, v := range changes {
-		config[k] = commitChange(config[k], v)
+		config[k] = t.commitChange(config[k], v)
 	}
 }
 
@@ -281,7 +418,9 @@ func jsonRaw(v interface{}) *json.RawMessage {
 	return &raw
 }
 
-func commitChange(pristine *json.RawMessage, change interface{}) *json.RawMessage {
+// commitChange returns the pristine document with the change applied,
+// the pristine documents are left untouched.
+func (t *Transaction) commitChange(pristine *json.RawMessage, change interface{}) *json.RawMessage {
 	switch change := change.(type) {
 	case *json.RawMessage:
 		return change
@@ -289,15 +428,20 @@ func commitChange(pristine *json.RawMessage, change interface{}) *json.RawMessag
 		if pristine == nil {
 			return jsonRaw(change)
 		}
-		var pristinem map[string]*json.RawMessage
-		if err := jsonutil.DecodeWithNumber(bytes.NewReader(*pristine), &pristinem); err != nil {
+		pristinem, err := t.pristineMap(pristine)
+		if err != nil {
 			// Not a map. Overwrite with the change.
 			return jsonRaw(change)
 		}
+		// copy-on-write, unchanged documents are shared
+		m := make(map[string]*json.RawMessage, len(pristinem)+len(change))
+		for k, v := range pristinem {
+			m[k] = v
+		}
 		for k, v := range change {
-			pristinem[k] = commitChange(pristinem[k], v)
+			m[k] = t.commitChange(pristinem[k], v)
 		}
-		return jsonRaw(pristinem)
+		return jsonRaw(m)
 	}
 	panic(fmt.Errorf("internal error: unexpected configuration type %T", change))
 }
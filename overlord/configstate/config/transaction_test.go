@@ -469,3 +469,124 @@ func (s *transactionSuite) TestPristineIsNotTainted(c *C) {
 	c.Assert(json.Unmarshal([]byte(*pristine["test-snap"]["foo"]), &data), IsNil)
 	c.Assert(data, DeepEquals, map[string]interface{}{"a": map[string]interface{}{"a": "a"}})
 }
+
+func (s *transactionSuite) TestGetSeesLaterChanges(c *C) {
+	s.state.Lock()
+	defer s.state.Unlock()
+
+	tr := config.NewTransaction(s.state)
+	c.Assert(tr.Set("test-snap", "foo.a", "a"), IsNil)
+	c.Assert(tr.Set("test-snap", "bar", "bar"), IsNil)
+	tr.Commit()
+
+	var result interface{}
+	tr = config.NewTransaction(s.state)
+	c.Assert(tr.Set("test-snap", "foo.b", "b"), IsNil)
+	c.Assert(tr.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"a": "a", "b": "b"})
+
+	// the merged value of foo is not reused once foo changes again
+	c.Assert(tr.Set("test-snap", "foo.a", nil), IsNil)
+	c.Assert(tr.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"b": "b"})
+	c.Assert(tr.Get("test-snap", "foo.a", &result), ErrorMatches, `snap "test-snap" has no "foo.a" configuration option`)
+
+	tr.Commit()
+
+	// only the changed options were rewritten
+	pristine := tr.PristineConfig()
+	c.Check(string(*pristine["test-snap"]["foo"]), Equals, `{"b":"b"}`)
+	c.Check(string(*pristine["test-snap"]["bar"]), Equals, `"bar"`)
+}
+
+func (s *transactionSuite) TestCloneAdopt(c *C) {
+	s.state.Lock()
+	defer s.state.Unlock()
+
+	tr := config.NewTransaction(s.state)
+	c.Assert(tr.Set("test-snap", "foo.a", "a"), IsNil)
+
+	var result interface{}
+	clone := tr.Clone()
+	c.Assert(clone.Set("test-snap", "foo.b", "b"), IsNil)
+	c.Assert(clone.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"a": "a", "b": "b"})
+
+	// the changes to the clone, also within nested maps, are not
+	// seen by the transaction until adopted
+	c.Assert(tr.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"a": "a"})
+
+	tr.Adopt(clone)
+	c.Assert(tr.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"a": "a", "b": "b"})
+
+	tr.Commit()
+	tr = config.NewTransaction(s.state)
+	c.Assert(tr.Get("test-snap", "foo", &result), IsNil)
+	c.Check(result, DeepEquals, map[string]interface{}{"a": "a", "b": "b"})
+}
+
+// bigConfig sets up a configuration document of about 1MB in the
+// given state.
+func bigConfig(st *state.State) {
+	tr := config.NewTransaction(st)
+	value := strings.Repeat("x", 1000)
+	for i := 0; i < 1000; i++ {
+		if err := tr.Set("test-snap", fmt.Sprintf("doc.key%d.value", i), value); err != nil {
+			panic(err)
+		}
+	}
+	if err := tr.Set("test-snap", "small", "small"); err != nil {
+		panic(err)
+	}
+	tr.Commit()
+}
+
+func BenchmarkGetNestedOptionOfBigDocument(b *testing.B) {
+	st := state.New(nil)
+	st.Lock()
+	defer st.Unlock()
+	bigConfig(st)
+
+	tr := config.NewTransaction(st)
+	var value string
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := tr.Get("test-snap", "doc.key500.value", &value); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkGetSmallOptionNextToBigDocument(b *testing.B) {
+	st := state.New(nil)
+	st.Lock()
+	defer st.Unlock()
+	bigConfig(st)
+
+	tr := config.NewTransaction(st)
+	var value string
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := tr.Get("test-snap", "small", &value); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkSetCommitSmallOptionNextToBigDocument(b *testing.B) {
+	st := state.New(nil)
+	st.Lock()
+	defer st.Unlock()
+	bigConfig(st)
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		tr := config.NewTransaction(st)
+		if err := tr.Set("test-snap", "small", i); err != nil {
+			b.Fatal(err)
+		}
+		tr.Commit()
+	}
+}
@@ -60,7 +60,7 @@ func switchDisableSSHService(serviceName, value string) error {
 		if err := ioutil.WriteFile(sshCanary, []byte("SSH has been disabled by snapd system configuration\n"), 0644); err != nil {
 			return err
 		}
-		return sysd.Stop(serviceName, 5*time.Minute)
+		return sysd.Stop([]string{serviceName}, 5*time.Minute)
 	case "false":
 		err := os.Remove(sshCanary)
 		if err != nil && !os.IsNotExist(err) {
@@ -94,7 +94,7 @@ func switchDisableService(serviceName, value string) error {
 		if err := sysd.Mask(serviceName); err != nil {
 			return err
 		}
-		return sysd.Stop(serviceName, 5*time.Minute)
+		return sysd.Stop([]string{serviceName}, 5*time.Minute)
 	case "false":
 		if err := sysd.Unmask(serviceName); err != nil {
 			return err
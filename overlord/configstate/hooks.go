@@ -63,6 +63,26 @@ func ContextTransaction(context *hookstate.Context) *config.Transaction {
 	return tr
 }
 
+// ScratchContextTransaction caches within the context a copy of its
+// transaction, so that configuration changes made through the context go
+// to the copy until the returned function is called. That function brings
+// the changes back to the transaction of the context if keep is true, and
+// drops them otherwise.
+//
+// The context must be locked by the caller, also when calling the returned
+// function.
+func ScratchContextTransaction(context *hookstate.Context) (done func(keep bool)) {
+	tr := ContextTransaction(context)
+	scratch := tr.Clone()
+	context.Cache(cachedTransaction{}, scratch)
+	return func(keep bool) {
+		if keep {
+			tr.Adopt(scratch)
+		}
+		context.Cache(cachedTransaction{}, tr)
+	}
+}
+
 func newConfigureHandler(context *hookstate.Context) hookstate.Handler {
 	return &configureHandler{context: context}
 }
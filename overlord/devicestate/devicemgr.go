@@ -58,6 +58,7 @@ type DeviceManager struct {
 
 	lastBecomeOperationalAttempt time.Time
 	becomeOperationalBackoff     time.Duration
+	becomeOperationalDeferred    time.Time
 	registered                   bool
 	reg                          chan struct{}
 }
@@ -244,7 +245,18 @@ func setClassicFallbackModel(st *state.State, device *auth.DeviceState) error {
 	return nil
 }
 
+// DeferUntil implements StateDeferrer.DeferUntil, the device does not
+// try to become operational, i.e. to get a serial, before the given
+// time.
+func (m *DeviceManager) DeferUntil(t time.Time) {
+	m.becomeOperationalDeferred = t
+}
+
 func (m *DeviceManager) ensureOperational() error {
+	if time.Now().Before(m.becomeOperationalDeferred) {
+		return nil
+	}
+
 	m.state.Lock()
 	defer m.state.Unlock()
 
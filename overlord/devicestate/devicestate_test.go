@@ -917,6 +917,36 @@ func (s *deviceMgrSuite) TestDoRequestSerialMaxTentatives(c *C) {
 	c.Check(chg.Err(), ErrorMatches, `(?s).*cannot retrieve request-id for making a request for a serial: unexpected status 501.*`)
 }
 
+func (s *deviceMgrSuite) TestDeviceRegistrationDeferred(c *C) {
+	s.state.Lock()
+	defer s.state.Unlock()
+
+	s.makeModelAssertionInState(c, "canonical", "pc", map[string]interface{}{
+		"architecture": "amd64",
+		"kernel":       "pc-kernel",
+		"gadget":       "pc",
+	})
+	devicestatetest.SetDevice(s.state, &auth.DeviceState{
+		Brand: "canonical",
+		Model: "pc",
+	})
+	devicestatetest.MockGadget(c, s.state, "pc", snap.R(2), nil)
+	s.state.Set("seeded", true)
+
+	// registration is held off until the deadline
+	s.mgr.DeferUntil(time.Now().Add(time.Hour))
+	s.state.Unlock()
+	s.se.Ensure()
+	s.state.Lock()
+	c.Check(s.findBecomeOperationalChange(), IsNil)
+
+	s.mgr.DeferUntil(time.Now())
+	s.state.Unlock()
+	s.se.Ensure()
+	s.state.Lock()
+	c.Check(s.findBecomeOperationalChange(), NotNil)
+}
+
 func (s *deviceMgrSuite) TestFullDeviceRegistrationPollHappy(c *C) {
 	r1 := devicestate.MockKeyLength(testKeyLength)
 	defer r1()
@@ -268,35 +268,127 @@ func populateStateFromSeedImpl(st *state.State, tm timings.Measurer) ([]*state.T
 		return nil, errs[0]
 	}
 
-	// now add/chain the tasksets in the right order, note that we
-	// only have tasksets that we did not already seeded
+	// everything else waits for the essential snaps to be installed
+	// and configured
+	var essentialTs *state.TaskSet
+	if len(tsAll) != 0 {
+		essentialTs = tsAll[len(tsAll)-1]
+	}
+
+	// now add the tasksets in the right order, note that we only
+	// have tasksets that we did not already seeded; a taskset waits
+	// only for the snaps it needs (its base, its default content
+	// providers and snapd), independent snaps are installed in
+	// parallel
 	sort.Stable(snap.ByType(infos))
-	for _, info := range infos {
-		ts := infoToTs[info]
-		tsAll = chainTs(tsAll, ts)
+	lanes := seedingLanes(infos, infoToTs)
+	for _, ts := range lanes {
+		if essentialTs != nil {
+			ts.WaitAll(essentialTs)
+		}
+		tsAll = append(tsAll, ts)
 	}
 
 	if len(tsAll) == 0 {
 		return nil, fmt.Errorf("cannot proceed, no snaps to seed")
 	}
 
-	ts := tsAll[len(tsAll)-1]
+	// the end of the seeding waits for all the lanes
+	if essentialTs != nil {
+		lanes = append(lanes, essentialTs)
+	}
 	endTs := state.NewTaskSet()
+	last := markSeeded
 	if model.Gadget() != "" {
 		// we have a gadget that could have interface
 		// connection instructions
 		gadgetConnect := st.NewTask("gadget-connect", "Connect plugs and slots as instructed by the gadget")
-		gadgetConnect.WaitAll(ts)
 		endTs.AddTask(gadgetConnect)
-		ts = endTs
+		markSeeded.WaitFor(gadgetConnect)
+		last = gadgetConnect
+	}
+	for _, ts := range lanes {
+		for _, t := range ts.Tasks() {
+			last.WaitFor(t)
+		}
 	}
-	markSeeded.WaitAll(ts)
 	endTs.AddTask(markSeeded)
 	tsAll = append(tsAll, endTs)
 
 	return tsAll, nil
 }
 
+// seedingLanes returns the tasksets of the given snaps, already sorted
+// by type, in an order respecting their dependencies and makes each
+// taskset wait for the tasksets of the snaps it depends on.
+func seedingLanes(infos []*snap.Info, infoToTs map[*snap.Info]*state.TaskSet) []*state.TaskSet {
+	byName := make(map[string]*snap.Info, len(infos))
+	var snapdInfo *snap.Info
+	for _, info := range infos {
+		byName[info.InstanceName()] = info
+		if info.GetType() == snap.TypeSnapd {
+			snapdInfo = info
+		}
+	}
+
+	deps := func(info *snap.Info) []*snap.Info {
+		var names []string
+		switch info.Base {
+		case "none":
+		case "":
+			if info.GetType() == snap.TypeApp || info.GetType() == snap.TypeGadget {
+				names = append(names, "core")
+			}
+		default:
+			names = append(names, info.Base)
+		}
+		names = append(names, snap.NeededDefaultProviders(info)...)
+
+		var needed []*snap.Info
+		if snapdInfo != nil && snapdInfo != info {
+			needed = append(needed, snapdInfo)
+		}
+		for _, name := range names {
+			// essential snaps are not in byName, all the lanes wait
+			// for them anyway
+			if dep := byName[name]; dep != nil && dep != info {
+				needed = append(needed, dep)
+			}
+		}
+		return needed
+	}
+
+	const (
+		visiting = 1
+		visited  = 2
+	)
+	marks := make(map[*snap.Info]int, len(infos))
+	lanes := make([]*state.TaskSet, 0, len(infos))
+	var visit func(info *snap.Info)
+	visit = func(info *snap.Info) {
+		if marks[info] != 0 {
+			return
+		}
+		marks[info] = visiting
+		ts := infoToTs[info]
+		for _, dep := range deps(info) {
+			visit(dep)
+			// a snap still being visited is part of a cycle
+			// (e.g. content providers of each other), do not
+			// order them
+			if marks[dep] == visited {
+				ts.WaitAll(infoToTs[dep])
+			}
+		}
+		marks[info] = visited
+		lanes = append(lanes, ts)
+	}
+	for _, info := range infos {
+		visit(info)
+	}
+	return lanes
+}
+
 func importAssertionsFromSeed(st *state.State) (*asserts.Model, error) {
 	// TODO: use some kind of context fo Device/SetDevice?
 	device, err := internal.Device(st)
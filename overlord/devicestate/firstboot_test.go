@@ -379,16 +379,22 @@ type: gadget`
 
 func checkOrder(c *C, tsAll []*state.TaskSet, snaps ...string) {
 	matched := 0
-	var prevTask *state.Task
+	earlier := make(map[*state.Task]bool)
 	for i, ts := range tsAll {
 		task0 := ts.Tasks()[0]
 		waitTasks := task0.WaitTasks()
 		if i == 0 {
 			c.Check(waitTasks, HasLen, 0)
 		} else {
-			c.Check(waitTasks, testutil.Contains, prevTask)
+			// tasksets only wait for tasksets before them
+			c.Check(waitTasks, Not(HasLen), 0)
+			for _, t := range waitTasks {
+				c.Check(earlier[t], Equals, true, Commentf("%s waits for later %s", task0.Summary(), t.Summary()))
+			}
+		}
+		for _, t := range ts.Tasks() {
+			earlier[t] = true
 		}
-		prevTask = task0
 		if task0.Kind() != "prerequisites" {
 			continue
 		}
@@ -416,6 +422,47 @@ func checkSeedTasks(c *C, tsAll []*state.TaskSet) {
 	c.Check(markSeededTask.WaitTasks(), DeepEquals, []*state.Task{gadgetConnectTask})
 }
 
+// criticalPath returns the length of the longest chain of tasks
+// waiting for each other, i.e. the number of tasks that must run one
+// after the other when seeding.
+func criticalPath(tsAll []*state.TaskSet) int {
+	lengths := make(map[*state.Task]int)
+	var pathTo func(t *state.Task) int
+	pathTo = func(t *state.Task) int {
+		if l, ok := lengths[t]; ok {
+			return l
+		}
+		l := 0
+		for _, wt := range t.WaitTasks() {
+			if wl := pathTo(wt); wl > l {
+				l = wl
+			}
+		}
+		lengths[t] = l + 1
+		return l + 1
+	}
+	longest := 0
+	for _, ts := range tsAll {
+		for _, t := range ts.Tasks() {
+			if l := pathTo(t); l > longest {
+				longest = l
+			}
+		}
+	}
+	return longest
+}
+
+func waitsFor(t *state.Task, ts *state.TaskSet) bool {
+	for _, wt := range t.WaitTasks() {
+		for _, other := range ts.Tasks() {
+			if wt == other {
+				return true
+			}
+		}
+	}
+	return false
+}
+
 func (s *FirstBootTestSuite) makeSeedChange(c *C, st *state.State) *state.Change {
 	coreFname, kernelFname, gadgetFname := s.makeCoreSnaps(c, "")
 
@@ -1334,6 +1381,118 @@ snaps:
 	checkOrder(c, tsAll, "snapd", "core18", "pc-kernel", "pc", "other-base", "snap-req-other-base")
 }
 
+func (s *FirstBootTestSuite) TestPopulateFromSeedIndependentSnapsInParallel(c *C) {
+	coreFname, kernelFname, gadgetFname := s.makeCoreSnaps(c, "")
+
+	s.WriteAssertions("developer.account", s.devAcct)
+
+	// add a model assertion and its chain
+	assertsChain := s.makeModelAssertionChain(c, "my-model", nil)
+	s.WriteAssertions("model.asserts", assertsChain...)
+
+	seedYaml := fmt.Sprintf(`
+snaps:
+ - name: core
+   file: %s
+ - name: pc-kernel
+   file: %s
+ - name: pc
+   file: %s
+`, coreFname, kernelFname, gadgetFname)
+	addLocal := func(snapYaml string) {
+		mockSnapFile := snaptest.MakeTestSnapWithFiles(c, snapYaml, nil)
+		name := strings.TrimPrefix(strings.SplitN(snapYaml, "\n", 2)[0], "name: ")
+		targetSnapFile := filepath.Join(dirs.SnapSeedDir, "snaps", filepath.Base(mockSnapFile))
+		c.Assert(os.Rename(mockSnapFile, targetSnapFile), IsNil)
+		seedYaml += fmt.Sprintf(" - name: %s\n   unasserted: true\n   file: %s\n", name, filepath.Base(targetSnapFile))
+	}
+
+	// a synthetic seed of 40 snaps, mostly independent apps, one of
+	// them using a base and one a content provider
+	const nApps = 36
+	for i := 0; i < nApps; i++ {
+		addLocal(fmt.Sprintf("name: app%d\nversion: 1.0", i))
+	}
+	addLocal("name: snap-req-other-base\nversion: 1.0\nbase: other-base")
+	addLocal("name: other-base\nversion: 1.0\ntype: base")
+	addLocal(`name: gnome-calculator
+version: 1.0
+plugs:
+ gtk-3-themes:
+  interface: content
+  default-provider: gtk-common-themes
+  target: $SNAP/data-dir/themes`)
+	addLocal(`name: gtk-common-themes
+version: 1.0
+slots:
+ gtk-3-themes:
+  interface: content
+  source:
+   read:
+    - $SNAP/share/themes/Adawaita`)
+	err := ioutil.WriteFile(filepath.Join(dirs.SnapSeedDir, "seed.yaml"), []byte(seedYaml), 0644)
+	c.Assert(err, IsNil)
+
+	// run the firstboot stuff
+	st := s.overlord.State()
+	st.Lock()
+	defer st.Unlock()
+	tsAll, err := devicestate.PopulateStateFromSeedImpl(st, s.perfTimings)
+	c.Assert(err, IsNil)
+
+	checkSeedTasks(c, tsAll)
+
+	byName := make(map[string]*state.TaskSet)
+	var essentialEnd *state.TaskSet
+	for _, ts := range tsAll {
+		task0 := ts.Tasks()[0]
+		if task0.Kind() != "prerequisites" {
+			if task0.Kind() == "run-hook" {
+				essentialEnd = ts
+			}
+			continue
+		}
+		snapsup, err := snapstate.TaskSnapSetup(task0)
+		c.Assert(err, IsNil)
+		byName[snapsup.InstanceName()] = ts
+	}
+	c.Assert(byName, HasLen, 3+nApps+4)
+	c.Assert(essentialEnd, NotNil)
+
+	// all snaps wait for the essential snaps
+	for name, ts := range byName {
+		if name == "core" || name == "pc-kernel" || name == "pc" {
+			continue
+		}
+		c.Check(waitsFor(ts.Tasks()[0], essentialEnd), Equals, true, Commentf("%s", name))
+	}
+	// independent snaps do not wait for each other
+	for i := 1; i < nApps; i++ {
+		app := byName[fmt.Sprintf("app%d", i)]
+		c.Check(waitsFor(app.Tasks()[0], byName[fmt.Sprintf("app%d", i-1)]), Equals, false)
+		c.Check(waitsFor(app.Tasks()[0], byName["other-base"]), Equals, false)
+	}
+	// but snaps wait for their base and their content providers,
+	// whatever their order in the seed
+	c.Check(waitsFor(byName["snap-req-other-base"].Tasks()[0], byName["other-base"]), Equals, true)
+	c.Check(waitsFor(byName["gnome-calculator"].Tasks()[0], byName["gtk-common-themes"]), Equals, true)
+
+	// the critical path is the essential snaps, the longest lane
+	// and the final gadget-connect and mark-seeded
+	essentialPath := criticalPath(tsAll[:len(tsAll)-nApps-5])
+	lane := len(byName["gnome-calculator"].Tasks()) + len(byName["gtk-common-themes"].Tasks())
+	if baseLane := len(byName["snap-req-other-base"].Tasks()) + len(byName["other-base"].Tasks()); baseLane > lane {
+		lane = baseLane
+	}
+	total := 0
+	for _, ts := range tsAll {
+		total += len(ts.Tasks())
+	}
+	path := criticalPath(tsAll)
+	c.Logf("seeding %d snaps: %d tasks, critical path of %d tasks", len(byName), total, path)
+	c.Check(path, Equals, essentialPath+lane+2)
+}
+
 func (s *FirstBootTestSuite) TestFirstbootGadgetBaseModelBaseMismatch(c *C) {
 	s.WriteAssertions("developer.account", s.devAcct)
 
@@ -37,6 +37,21 @@ func MockEnsureInterval(d time.Duration) (restore func()) {
 	return func() { ensureInterval = old }
 }
 
+// MockDeferredStartupDelay sets how long Loop defers the managers work for tests.
+func MockDeferredStartupDelay(d time.Duration) (restore func()) {
+	old := deferredStartupDelay
+	deferredStartupDelay = d
+	return func() { deferredStartupDelay = old }
+}
+
+// MockEnsureTimingsInterval sets how often at most the state engine saves
+// the ensure timings for tests.
+func MockEnsureTimingsInterval(d time.Duration) (restore func()) {
+	old := ensureTimingsInterval
+	ensureTimingsInterval = d
+	return func() { ensureTimingsInterval = old }
+}
+
 // MockPruneInterval sets the overlord prune interval for tests.
 func MockPruneInterval(prunei, prunew, abortw time.Duration) (restore func()) {
 	oldPruneInterval := pruneInterval
@@ -26,6 +26,7 @@ import (
 	"io"
 
 	"github.com/snapcore/snapd/logger"
+	"github.com/snapcore/snapd/overlord/configstate"
 	"github.com/snapcore/snapd/overlord/hookstate"
 
 	"github.com/jessevdk/go-flags"
@@ -143,3 +144,45 @@ func Run(context *hookstate.Context, args []string, uid uint32) (stdout, stderr
 	_, err = parser.ParseArgs(args)
 	return stdoutBuffer.Bytes(), stderrBuffer.Bytes(), err
 }
+
+// Output holds what a command wrote to its stdout and stderr.
+type Output struct {
+	Stdout []byte
+	Stderr []byte
+}
+
+// RunBatch runs the requested commands one after the other with the
+// same context, so that for an ephemeral context the configuration
+// changes of all of them end up in a single transaction. A command
+// asking for help gets its help text as stdout, as with snapctl. It
+// stops at the first failing command, returning the outputs of the
+// commands run so far, including the failing one, and its error.
+//
+// The configuration changes of the batch are made on a copy of the
+// transaction of the context, and only kept when every command succeeds.
+func RunBatch(context *hookstate.Context, batch [][]string, uid uint32) (outputs []Output, err error) {
+	if context != nil {
+		context.Lock()
+		done := configstate.ScratchContextTransaction(context)
+		context.Unlock()
+		defer func() {
+			context.Lock()
+			defer context.Unlock()
+			done(err == nil)
+		}()
+	}
+
+	outputs = make([]Output, 0, len(batch))
+	for _, args := range batch {
+		stdout, stderr, err := Run(context, args, uid)
+		if e, ok := err.(*flags.Error); ok && e.Type == flags.ErrHelp {
+			stdout = []byte(e.Error())
+			err = nil
+		}
+		outputs = append(outputs, Output{Stdout: stdout, Stderr: stderr})
+		if err != nil {
+			return outputs, err
+		}
+	}
+	return outputs, nil
+}
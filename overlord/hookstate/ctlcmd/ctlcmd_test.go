@@ -24,6 +24,8 @@ import (
 	"testing"
 
 	"github.com/jessevdk/go-flags"
+	"github.com/snapcore/snapd/overlord/configstate"
+	"github.com/snapcore/snapd/overlord/configstate/config"
 	"github.com/snapcore/snapd/overlord/hookstate"
 	"github.com/snapcore/snapd/overlord/hookstate/ctlcmd"
 	"github.com/snapcore/snapd/overlord/hookstate/hooktest"
@@ -110,3 +112,134 @@ func (s *ctlcmdSuite) TestHiddenCommand(c *C) {
 	// mock-hidden is not in the help message
 	c.Check(err.Error(), Not(testutil.Contains), "  mock-hidden\n")
 }
+
+func (s *ctlcmdSuite) TestRunBatch(c *C) {
+	st := state.New(nil)
+	setup := &hookstate.HookSetup{Snap: "test-snap"}
+	ctx, err := hookstate.NewContext(nil, st, setup, nil, "")
+	c.Assert(err, IsNil)
+
+	outputs, err := ctlcmd.RunBatch(ctx, [][]string{
+		{"set", "a=1"},
+		{"set", "b=two"},
+		{"get", "a"},
+		{"get", "b"},
+	}, 0)
+	c.Assert(err, IsNil)
+	c.Assert(outputs, HasLen, 4)
+	c.Check(string(outputs[2].Stdout), Equals, "1\n")
+	c.Check(string(outputs[3].Stdout), Equals, "two\n")
+
+	// nothing is committed before the context is done
+	st.Lock()
+	defer st.Unlock()
+	var value interface{}
+	tr := config.NewTransaction(st)
+	c.Check(config.IsNoOption(tr.Get("test-snap", "a", &value)), Equals, true)
+
+	c.Assert(ctx.Done(), IsNil)
+	tr = config.NewTransaction(st)
+	c.Assert(tr.Get("test-snap", "a", &value), IsNil)
+	c.Check(fmt.Sprint(value), Equals, "1")
+	c.Assert(tr.Get("test-snap", "b", &value), IsNil)
+	c.Check(value, Equals, "two")
+}
+
+func (s *ctlcmdSuite) TestRunBatchStopsAtError(c *C) {
+	outputs, err := ctlcmd.RunBatch(s.mockContext, [][]string{
+		{"get", "--foo"},
+		{"set", "a=1"},
+	}, 0)
+	c.Check(err, ErrorMatches, ".*unknown flag.*foo.*")
+	c.Check(outputs, HasLen, 1)
+}
+
+func (s *ctlcmdSuite) TestRunBatchHelp(c *C) {
+	outputs, err := ctlcmd.RunBatch(s.mockContext, [][]string{
+		{"set", "a=1"},
+		{"get", "--help"},
+		{"get", "a"},
+	}, 0)
+	c.Assert(err, IsNil)
+	c.Assert(outputs, HasLen, 3)
+	c.Check(string(outputs[1].Stdout), testutil.Contains, "Usage:")
+	c.Check(string(outputs[2].Stdout), Equals, "1\n")
+}
+
+func (s *ctlcmdSuite) TestRunBatchErrorKeepsNoChanges(c *C) {
+	_, err := ctlcmd.RunBatch(s.mockContext, [][]string{
+		{"set", "a=1"},
+	}, 0)
+	c.Assert(err, IsNil)
+
+	outputs, err := ctlcmd.RunBatch(s.mockContext, [][]string{
+		{"set", "a=2"},
+		{"set", "b=2"},
+		{"get", "--foo"},
+	}, 0)
+	c.Check(err, ErrorMatches, ".*unknown flag.*foo.*")
+	c.Check(outputs, HasLen, 3)
+
+	// the changes of the failed batch are dropped from the transaction
+	// of the hook, while the earlier ones are kept
+	s.mockContext.Lock()
+	defer s.mockContext.Unlock()
+	tr := configstate.ContextTransaction(s.mockContext)
+	var value interface{}
+	c.Assert(tr.Get("test-snap", "a", &value), IsNil)
+	c.Check(fmt.Sprint(value), Equals, "1")
+	c.Check(config.IsNoOption(tr.Get("test-snap", "b", &value)), Equals, true)
+}
+
+func setupBenchmarkGets() (*state.State, []string) {
+	st := state.New(nil)
+	st.Lock()
+	tr := config.NewTransaction(st)
+	keys := make([]string, 100)
+	for i := range keys {
+		keys[i] = fmt.Sprintf("key%d", i)
+		tr.Set("test-snap", keys[i], i)
+	}
+	tr.Commit()
+	st.Unlock()
+	return st, keys
+}
+
+// BenchmarkSnapctlGetSingle runs 100 "snapctl get" as separate
+// invocations, as many requests each with their own context.
+func BenchmarkSnapctlGetSingle(b *testing.B) {
+	st, keys := setupBenchmarkGets()
+	setup := &hookstate.HookSetup{Snap: "test-snap"}
+	b.ResetTimer()
+	for n := 0; n < b.N; n++ {
+		for _, key := range keys {
+			ctx, _ := hookstate.NewContext(nil, st, setup, nil, "")
+			if _, _, err := ctlcmd.Run(ctx, []string{"get", key}, 0); err != nil {
+				b.Fatal(err)
+			}
+			ctx.Lock()
+			ctx.Done()
+			ctx.Unlock()
+		}
+	}
+}
+
+// BenchmarkSnapctlGetBatch runs 100 "snapctl get" as a single batch.
+func BenchmarkSnapctlGetBatch(b *testing.B) {
+	st, keys := setupBenchmarkGets()
+	setup := &hookstate.HookSetup{Snap: "test-snap"}
+	batch := make([][]string, len(keys))
+	for i, key := range keys {
+		batch[i] = []string{"get", key}
+	}
+	b.ResetTimer()
+	for n := 0; n < b.N; n++ {
+		ctx, _ := hookstate.NewContext(nil, st, setup, nil, "")
+		if _, err := ctlcmd.RunBatch(ctx, batch, 0); err != nil {
+			b.Fatal(err)
+		}
+		ctx.Lock()
+		ctx.Done()
+		ctx.Unlock()
+	}
+}
@@ -89,6 +89,16 @@ func MockHotplugRetryTimeout(d time.Duration) (restore func()) {
 	return func() { hotplugRetryTimeout = old }
 }
 
+func MockHotplugDebounce(d time.Duration) (restore func()) {
+	old := hotplugDebounce
+	hotplugDebounce = d
+	return func() { hotplugDebounce = old }
+}
+
+func (m *InterfaceManager) FlushHotplugEvents() {
+	m.flushHotplugEvents()
+}
+
 func MockCreateUDevMonitor(new func(udevmonitor.DeviceAddedFunc, udevmonitor.DeviceRemovedFunc, udevmonitor.EnumerationDoneFunc) udevmonitor.Interface) (restore func()) {
 	old := createUDevMonitor
 	createUDevMonitor = new
@@ -105,6 +115,10 @@ func MockUDevInitRetryTimeout(t time.Duration) (restore func()) {
 	}
 }
 
+func (m *InterfaceManager) SetUDevRetryTimeout(t time.Time) {
+	m.udevRetryTimeout = t
+}
+
 // UpperCaseConnState returns a canned connection state map.
 // This allows us to keep connState private and still write some tests for it.
 func UpperCaseConnState() map[string]*connState {
@@ -1706,7 +1706,8 @@ func (m *InterfaceManager) doHotplugAddSlot(task *state.Task, _ *tomb.Tomb) erro
 // Sequence numbers control the order of execution of hotplug-related changes, which would otherwise be executed in
 // arbitrary order by task runner, leading to unexpected results if multiple events for same device are in flight
 // (e.g. plugging, followed by immediate unplugging, or snapd restart with pending hotplug changes).
-// The handler expects "hotplug-key" and "hotplug-seq" values set on own and other hotplug-related changes.
+// The handler expects "hotplug-key" and "hotplug-seq" values set on own and other hotplug-related changes, or,
+// for changes handling a burst of devices, on their "hotplug-seq-wait" tasks.
 func (m *InterfaceManager) doHotplugSeqWait(task *state.Task, _ *tomb.Tomb) error {
 	st := task.State()
 	st.Lock()
@@ -1717,9 +1718,14 @@ func (m *InterfaceManager) doHotplugSeqWait(task *state.Task, _ *tomb.Tomb) erro
 		return fmt.Errorf("internal error: task %q not in a hotplug change", task.Kind())
 	}
 
-	seq, hotplugKey, err := getHotplugChangeAttrs(chg)
-	if err != nil {
-		return err
+	var seq int
+	var hotplugKey snap.HotplugKey
+	if task.Get("hotplug-key", &hotplugKey) != nil || task.Get("hotplug-seq", &seq) != nil {
+		var err error
+		seq, hotplugKey, err = getHotplugChangeAttrs(chg)
+		if err != nil {
+			return err
+		}
 	}
 
 	for _, otherChg := range st.Changes() {
@@ -1732,16 +1738,18 @@ func (m *InterfaceManager) doHotplugSeqWait(task *state.Task, _ *tomb.Tomb) erro
 			continue
 		}
 
-		otherSeq, otherKey, err := getHotplugChangeAttrs(otherChg)
+		otherKeys, err := hotplugSeqKeys(otherChg)
 		if err != nil {
 			return err
 		}
 
 		// conflict with retry if there another change affecting same device and has lower sequence number
-		if hotplugKey == otherKey && otherSeq < seq {
-			task.Logf("Waiting processing of earlier hotplug event change %q affecting device with hotplug key %q", otherChg.Kind(), hotplugKey)
-			// TODO: consider introducing a new task that runs last and does EnsureBefore(0) for hotplug changes
-			return &state.Retry{After: hotplugRetryTimeout}
+		for _, other := range otherKeys {
+			if hotplugKey == other.hotplugKey && other.seq < seq {
+				task.Logf("Waiting processing of earlier hotplug event change %q affecting device with hotplug key %q", otherChg.Kind(), hotplugKey)
+				// TODO: consider introducing a new task that runs last and does EnsureBefore(0) for hotplug changes
+				return &state.Retry{After: hotplugRetryTimeout}
+			}
 		}
 	}
 
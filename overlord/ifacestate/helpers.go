@@ -369,6 +369,23 @@ func (m *InterfaceManager) setupSecurityByBackend(task *state.Task, snaps []*sna
 	// Setup all affected snaps, start with the most important security
 	// backend and run it for all snaps. See LP: 1802581
 	for _, backend := range m.repo.Backends() {
+		if setupMany, ok := backend.(interfaces.SecurityBackendSetupMany); ok && len(snaps) > 1 {
+			// Backends that can set up many snaps at once do so,
+			// e.g. to reload their rules just once.
+			st.Unlock()
+			var errs []error
+			timings.Run(tm, "setup-security-backend", fmt.Sprintf("setup security backend %q for %d snaps", backend.Name(), len(snaps)), func(nesttm timings.Measurer) {
+				errs = setupMany.SetupMany(snaps, opts, m.repo, nesttm)
+			})
+			st.Lock()
+			if len(errs) > 0 {
+				for _, err := range errs {
+					task.Errorf("cannot setup %s: %s", backend.Name(), err)
+				}
+				return errs[0]
+			}
+			continue
+		}
 		for i, snapInfo := range snaps {
 			st.Unlock()
 			var err error
@@ -455,6 +472,32 @@ type autoConnectChecker struct {
 	deviceCtx snapstate.DeviceContext
 	cache     map[string]*asserts.SnapDeclaration
 	baseDecl  *asserts.BaseDeclaration
+
+	storeAs     *asserts.Store
+	storeLoaded bool
+
+	// policy check results, see autoConnectCheckKey
+	checked   map[autoConnectCheckKey]bool
+	plugAttrs map[plugOrSlot]string
+	slotAttrs map[plugOrSlot]string
+}
+
+type plugOrSlot struct {
+	snap *snap.Info
+	name string
+}
+
+// autoConnectCheckKey captures everything the auto-connection policy
+// check of a plug and slot pair depends on, besides the base
+// declaration, model and store which are fixed for a checker.
+type autoConnectCheckKey struct {
+	iface        string
+	plugSnapID   string
+	plugSnapType snap.Type
+	plugAttrs    string
+	slotSnapID   string
+	slotSnapType snap.Type
+	slotAttrs    string
 }
 
 func newAutoConnectChecker(s *state.State, deviceCtx snapstate.DeviceContext) (*autoConnectChecker, error) {
@@ -467,6 +510,9 @@ func newAutoConnectChecker(s *state.State, deviceCtx snapstate.DeviceContext) (*
 		deviceCtx: deviceCtx,
 		cache:     make(map[string]*asserts.SnapDeclaration),
 		baseDecl:  baseDecl,
+		checked:   make(map[autoConnectCheckKey]bool),
+		plugAttrs: make(map[plugOrSlot]string),
+		slotAttrs: make(map[plugOrSlot]string),
 	}, nil
 }
 
@@ -483,18 +529,83 @@ func (c *autoConnectChecker) snapDeclaration(snapID string) (*asserts.SnapDeclar
 	return snapDecl, nil
 }
 
-func (c *autoConnectChecker) check(plug *interfaces.ConnectedPlug, slot *interfaces.ConnectedSlot) (bool, error) {
+func (c *autoConnectChecker) store() (*asserts.Store, error) {
+	if c.storeLoaded {
+		return c.storeAs, nil
+	}
 	modelAs := c.deviceCtx.Model()
-
-	var storeAs *asserts.Store
 	if modelAs.Store() != "" {
-		var err error
-		storeAs, err = assertstate.Store(c.st, modelAs.Store())
+		storeAs, err := assertstate.Store(c.st, modelAs.Store())
 		if err != nil && !asserts.IsNotFound(err) {
-			return false, err
+			return nil, err
+		}
+		c.storeAs = storeAs
+	}
+	c.storeLoaded = true
+	return c.storeAs, nil
+}
+
+// encodeAttrs returns a canonical encoding of static attributes, or
+// false if they cannot be encoded.
+func encodeAttrs(attrs map[string]interface{}) (string, bool) {
+	if len(attrs) == 0 {
+		return "", true
+	}
+	// encoding/json sorts map keys
+	b, err := json.Marshal(attrs)
+	if err != nil {
+		return "", false
+	}
+	return string(b), true
+}
+
+// checkKey returns the key to memoise the policy check of the pair, or
+// false if the check cannot be memoised. Auto-connection candidates
+// carry only static attributes.
+func (c *autoConnectChecker) checkKey(plug *interfaces.ConnectedPlug, slot *interfaces.ConnectedSlot) (autoConnectCheckKey, bool) {
+	plugRef := plugOrSlot{snap: plug.Snap(), name: plug.Name()}
+	plugAttrs, ok := c.plugAttrs[plugRef]
+	if !ok {
+		plugAttrs, ok = encodeAttrs(plug.StaticAttrs())
+		if !ok {
+			return autoConnectCheckKey{}, false
+		}
+		c.plugAttrs[plugRef] = plugAttrs
+	}
+	slotRef := plugOrSlot{snap: slot.Snap(), name: slot.Name()}
+	slotAttrs, ok := c.slotAttrs[slotRef]
+	if !ok {
+		slotAttrs, ok = encodeAttrs(slot.StaticAttrs())
+		if !ok {
+			return autoConnectCheckKey{}, false
+		}
+		c.slotAttrs[slotRef] = slotAttrs
+	}
+
+	return autoConnectCheckKey{
+		iface:        plug.Interface(),
+		plugSnapID:   plug.Snap().SnapID,
+		plugSnapType: plug.Snap().GetType(),
+		plugAttrs:    plugAttrs,
+		slotSnapID:   slot.Snap().SnapID,
+		slotSnapType: slot.Snap().GetType(),
+		slotAttrs:    slotAttrs,
+	}, true
+}
+
+func (c *autoConnectChecker) check(plug *interfaces.ConnectedPlug, slot *interfaces.ConnectedSlot) (bool, error) {
+	key, memoise := c.checkKey(plug, slot)
+	if memoise {
+		if ok, seen := c.checked[key]; seen {
+			return ok, nil
 		}
 	}
 
+	storeAs, err := c.store()
+	if err != nil {
+		return false, err
+	}
+
 	var plugDecl *asserts.SnapDeclaration
 	if plug.Snap().SnapID != "" {
 		var err error
@@ -522,11 +633,15 @@ func (c *autoConnectChecker) check(plug *interfaces.ConnectedPlug, slot *interfa
 		Slot:                slot,
 		SlotSnapDeclaration: slotDecl,
 		BaseDeclaration:     c.baseDecl,
-		Model:               modelAs,
+		Model:               c.deviceCtx.Model(),
 		Store:               storeAs,
 	}
 
-	return ic.CheckAutoConnect() == nil, nil
+	ok := ic.CheckAutoConnect() == nil
+	if memoise {
+		c.checked[key] = ok
+	}
+	return ok, nil
 }
 
 type connectChecker struct {
@@ -949,6 +1064,72 @@ func addHotplugSeqWaitTask(hotplugChange *state.Change, hotplugKey snap.HotplugK
 	hotplugChange.AddTask(seqControl)
 }
 
+// addHotplugDeviceTasks adds the tasks handling one device to a hotplug change
+// that may handle other devices of the same burst of hotplug events. The tasks
+// wait for their own "hotplug-seq-wait" task, which carries the hotplug key and
+// sequence number of the device, and for the tasks of any earlier device of the
+// change with the same hotplug key. Each device gets a lane of its own so that
+// failing to handle one of them does not undo the others.
+func addHotplugDeviceTasks(hotplugChange *state.Change, ts *state.TaskSet, hotplugKey snap.HotplugKey, hotplugSeq int) {
+	st := hotplugChange.State()
+	if err := hotplugChange.Get("hotplug-key", new(snap.HotplugKey)); err == state.ErrNoState {
+		setHotplugChangeAttrs(hotplugChange, hotplugSeq, hotplugKey)
+	}
+	seqControl := st.NewTask("hotplug-seq-wait", fmt.Sprintf("Serialize hotplug change for hotplug key %q", hotplugKey))
+	seqControl.Set("hotplug-key", hotplugKey)
+	seqControl.Set("hotplug-seq", hotplugSeq)
+	// waiting for the latest earlier device is enough as they are chained
+	var previous *state.Task
+	for _, t := range hotplugChange.Tasks() {
+		if t.Kind() != "hotplug-seq-wait" {
+			continue
+		}
+		var otherKey snap.HotplugKey
+		if err := t.Get("hotplug-key", &otherKey); err == nil && otherKey == hotplugKey {
+			previous = t
+		}
+	}
+	if previous != nil {
+		seqControl.WaitAll(state.NewTaskSet(previous.HaltTasks()...))
+	}
+	ts.WaitFor(seqControl)
+	lane := st.NewLane()
+	ts.JoinLane(lane)
+	seqControl.JoinLane(lane)
+	hotplugChange.AddAll(ts)
+	hotplugChange.AddTask(seqControl)
+}
+
+type hotplugSeqKey struct {
+	seq        int
+	hotplugKey snap.HotplugKey
+}
+
+// hotplugSeqKeys returns the sequence numbers and hotplug keys of all the
+// devices handled by the hotplug change.
+func hotplugSeqKeys(chg *state.Change) ([]hotplugSeqKey, error) {
+	var keys []hotplugSeqKey
+	for _, t := range chg.Tasks() {
+		if t.Kind() != "hotplug-seq-wait" {
+			continue
+		}
+		var k hotplugSeqKey
+		if t.Get("hotplug-key", &k.hotplugKey) != nil || t.Get("hotplug-seq", &k.seq) != nil {
+			continue
+		}
+		keys = append(keys, k)
+	}
+	if len(keys) == 0 {
+		// change not handling a burst of devices
+		seq, hotplugKey, err := getHotplugChangeAttrs(chg)
+		if err != nil {
+			return nil, err
+		}
+		keys = append(keys, hotplugSeqKey{seq: seq, hotplugKey: hotplugKey})
+	}
+	return keys, nil
+}
+
 type HotplugSlotInfo struct {
 	Name        string                 `json:"name"`
 	Interface   string                 `json:"interface"`
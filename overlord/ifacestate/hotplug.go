@@ -23,6 +23,7 @@ import (
 	"crypto/sha256"
 	"fmt"
 	"strings"
+	"time"
 	"unicode"
 
 	"github.com/snapcore/snapd/features"
@@ -104,12 +105,230 @@ func defaultDeviceKey(devinfo *hotplug.HotplugDeviceInfo, keyVersion int) (snap.
 	return snap.HotplugKey(fmt.Sprintf("%x%x", keyVersion, key.Sum(nil))), nil
 }
 
+var (
+	// hotplugDebounce is for how long hotplug events are held once one
+	// arrives, so that a burst of them (e.g. from plugging a USB hub) is
+	// handled together.
+	hotplugDebounce = 250 * time.Millisecond
+	// hotplugDebounceMax bounds how long the first event of a burst can
+	// be held.
+	hotplugDebounceMax = 2 * time.Second
+)
+
+type hotplugEvent struct {
+	added   bool
+	devinfo *hotplug.HotplugDeviceInfo
+}
+
 // hotplugDeviceAdded gets called when a device is added to the system.
 func (m *InterfaceManager) hotplugDeviceAdded(devinfo *hotplug.HotplugDeviceInfo) {
+	m.queueHotplugEvent(hotplugEvent{added: true, devinfo: devinfo})
+}
+
+// hotplugDeviceRemoved gets called when a device is removed from the system.
+func (m *InterfaceManager) hotplugDeviceRemoved(devinfo *hotplug.HotplugDeviceInfo) {
+	m.queueHotplugEvent(hotplugEvent{added: false, devinfo: devinfo})
+}
+
+// queueHotplugEvent holds the event for hotplugDebounce, restarting the wait
+// with every new event of the burst, up to hotplugDebounceMax.
+func (m *InterfaceManager) queueHotplugEvent(ev hotplugEvent) {
+	if hotplugDebounce == 0 {
+		m.handleHotplugEvents([]hotplugEvent{ev})
+		return
+	}
+
+	m.hotplugEventsMu.Lock()
+	defer m.hotplugEventsMu.Unlock()
+
+	now := time.Now()
+	if len(m.hotplugEvents) == 0 {
+		m.hotplugBurstStart = now
+	}
+	m.hotplugEvents = append(m.hotplugEvents, ev)
+
+	delay := hotplugDebounce
+	if left := m.hotplugBurstStart.Add(hotplugDebounceMax).Sub(now); left < delay {
+		delay = left
+	}
+	if m.hotplugTimer == nil {
+		m.hotplugTimer = time.AfterFunc(delay, m.flushHotplugEvents)
+	} else {
+		m.hotplugTimer.Reset(delay)
+	}
+}
+
+// flushHotplugEvents handles the held hotplug events right away.
+func (m *InterfaceManager) flushHotplugEvents() {
+	m.hotplugHandleMu.Lock()
+	defer m.hotplugHandleMu.Unlock()
+
+	m.hotplugEventsMu.Lock()
+	events := m.hotplugEvents
+	m.hotplugEvents = nil
+	if m.hotplugTimer != nil {
+		m.hotplugTimer.Stop()
+		m.hotplugTimer = nil
+	}
+	m.hotplugEventsMu.Unlock()
+
+	m.handleHotplugEvents(events)
+}
+
+// discardHotplugEvents drops the held hotplug events, the devices will be
+// enumerated again on the next start of the udev monitor.
+func (m *InterfaceManager) discardHotplugEvents() {
+	m.hotplugEventsMu.Lock()
+	defer m.hotplugEventsMu.Unlock()
+	m.hotplugEvents = nil
+	if m.hotplugTimer != nil {
+		m.hotplugTimer.Stop()
+		m.hotplugTimer = nil
+	}
+}
+
+// coalesceHotplugEvents drops the devices that were both added and removed
+// within the burst of events, unless tracked reports that the device was
+// already known, in which case its removal must still be handled.
+func coalesceHotplugEvents(events []hotplugEvent, tracked func(devinfo *hotplug.HotplugDeviceInfo) bool) []hotplugEvent {
+	// index of the pending add event by device path
+	added := make(map[string]int)
+	dropped := make(map[int]bool)
+	for i, ev := range events {
+		devPath := ev.devinfo.DevicePath()
+		if ev.added {
+			if !tracked(ev.devinfo) {
+				added[devPath] = i
+			}
+			continue
+		}
+		if j, ok := added[devPath]; ok {
+			dropped[j] = true
+			dropped[i] = true
+			delete(added, devPath)
+		}
+	}
+	if len(dropped) == 0 {
+		return events
+	}
+	coalesced := make([]hotplugEvent, 0, len(events)-len(dropped))
+	for i, ev := range events {
+		if !dropped[i] {
+			coalesced = append(coalesced, ev)
+		}
+	}
+	return coalesced
+}
+
+// hotplugDevice holds the tasks handling one device in a burst of events.
+type hotplugDevice struct {
+	summary    string
+	ts         *state.TaskSet
+	hotplugKey snap.HotplugKey
+	seq        int
+}
+
+// hotplugBurst collects the tasks for a burst of hotplug events so that
+// they end up in a single change per interface and kind of event.
+type hotplugBurst struct {
+	kinds          []string
+	devices        map[string][]hotplugDevice
+	batchSummaries map[string]string
+}
+
+func newHotplugBurst() *hotplugBurst {
+	return &hotplugBurst{
+		devices:        make(map[string][]hotplugDevice),
+		batchSummaries: make(map[string]string),
+	}
+}
+
+// add records the tasks of a device for the change of the given kind;
+// summary is used when the change ends up handling just this device,
+// batchSummary (formatted with the number of devices) otherwise.
+func (b *hotplugBurst) add(kind, summary, batchSummary string, ts *state.TaskSet, hotplugKey snap.HotplugKey, seq int) {
+	if _, ok := b.devices[kind]; !ok {
+		b.kinds = append(b.kinds, kind)
+		b.batchSummaries[kind] = batchSummary
+	}
+	b.devices[kind] = append(b.devices[kind], hotplugDevice{
+		summary:    summary,
+		ts:         ts,
+		hotplugKey: hotplugKey,
+		seq:        seq,
+	})
+}
+
+// commit creates the changes for the burst.
+func (b *hotplugBurst) commit(st *state.State) {
+	for _, kind := range b.kinds {
+		devices := b.devices[kind]
+		summary := devices[0].summary
+		if len(devices) > 1 {
+			summary = fmt.Sprintf(b.batchSummaries[kind], len(devices))
+		}
+		chg := st.NewChange(kind, summary)
+		for _, dev := range devices {
+			addHotplugDeviceTasks(chg, dev.ts, dev.hotplugKey, dev.seq)
+		}
+	}
+	if len(b.kinds) != 0 {
+		st.EnsureBefore(0)
+	}
+}
+
+// hotplugDeviceTracked returns whether the device is known to the manager,
+// either from an earlier event or because it has a hotplug slot.
+func (m *InterfaceManager) hotplugDeviceTracked(devinfo *hotplug.HotplugDeviceInfo) bool {
+	if len(m.hotplugDevicePaths[devinfo.DevicePath()]) != 0 {
+		return true
+	}
+	defaultKey, err := defaultDeviceKey(devinfo, deviceKeyVersion)
+	if err != nil {
+		// play safe
+		return true
+	}
+	for _, iface := range m.repo.AllHotplugInterfaces() {
+		key, err := deviceKey(devinfo, iface, defaultKey)
+		if err != nil {
+			return true
+		}
+		if key == "" {
+			continue
+		}
+		if slot, err := m.repo.SlotForHotplugKey(iface.Name(), key); err != nil || slot != nil {
+			return true
+		}
+	}
+	return false
+}
+
+// handleHotplugEvents creates the changes for a burst of hotplug events.
+func (m *InterfaceManager) handleHotplugEvents(events []hotplugEvent) {
 	st := m.state
 	st.Lock()
 	defer st.Unlock()
 
+	events = coalesceHotplugEvents(events, m.hotplugDeviceTracked)
+	if len(events) == 0 {
+		return
+	}
+
+	burst := newHotplugBurst()
+	for _, ev := range events {
+		if ev.added {
+			m.addHotplugDevice(ev.devinfo, burst)
+		} else {
+			m.removeHotplugDevice(ev.devinfo, burst)
+		}
+	}
+	burst.commit(st)
+}
+
+// addHotplugDevice handles a device added to the system.
+func (m *InterfaceManager) addHotplugDevice(devinfo *hotplug.HotplugDeviceInfo, burst *hotplugBurst) {
+	st := m.state
+
 	if _, err := systemSnapInfo(st); err != nil {
 		logger.Noticef("system snap not available, hotplug events ignored")
 		return
@@ -229,20 +448,16 @@ InterfacesLoop:
 		setHotplugAttrs(hotplugConnect, iface.Name(), key)
 		hotplugConnect.WaitFor(hotplugAdd)
 
-		chg := st.NewChange(fmt.Sprintf("hotplug-add-slot-%s", iface), fmt.Sprintf("Add hotplug slot of interface %q for device %s with hotplug key %q", devinfo.ShortString(), iface.Name(), key.ShortString()))
-		chg.AddTask(hotplugAdd)
-		chg.AddTask(hotplugConnect)
-		addHotplugSeqWaitTask(chg, key, seq)
-
-		st.EnsureBefore(0)
+		burst.add(fmt.Sprintf("hotplug-add-slot-%s", iface),
+			fmt.Sprintf("Add hotplug slot of interface %q for device %s with hotplug key %q", devinfo.ShortString(), iface.Name(), key.ShortString()),
+			fmt.Sprintf("Add hotplug slots of interface %q for %%d devices", iface.Name()),
+			state.NewTaskSet(hotplugAdd, hotplugConnect), key, seq)
 	}
 }
 
-// hotplugDeviceRemoved gets called when a device is removed from the system.
-func (m *InterfaceManager) hotplugDeviceRemoved(devinfo *hotplug.HotplugDeviceInfo) {
+// removeHotplugDevice handles a device removed from the system.
+func (m *InterfaceManager) removeHotplugDevice(devinfo *hotplug.HotplugDeviceInfo, burst *hotplugBurst) {
 	st := m.state
-	st.Lock()
-	defer st.Unlock()
 
 	hotplugFeature, err := m.hotplugEnabled()
 	if err != nil {
@@ -254,7 +469,6 @@ func (m *InterfaceManager) hotplugDeviceRemoved(devinfo *hotplug.HotplugDeviceIn
 	devs := m.hotplugDevicePaths[devPath]
 	delete(m.hotplugDevicePaths, devPath)
 
-	var changed bool
 	for _, dev := range devs {
 		hotplugKey := dev.hotplugKey
 		ifaceName := dev.ifaceName
@@ -281,19 +495,18 @@ func (m *InterfaceManager) hotplugDeviceRemoved(devinfo *hotplug.HotplugDeviceIn
 		}
 
 		ts := removeDevice(st, ifaceName, hotplugKey)
-		chg := st.NewChange(fmt.Sprintf("hotplug-remove-%s", ifaceName), fmt.Sprintf("Remove hotplug connections and slots of device %s with interface %q", devinfo.ShortString(), ifaceName))
-		chg.AddAll(ts)
-		addHotplugSeqWaitTask(chg, hotplugKey, seq)
-		changed = true
-	}
-
-	if changed {
-		st.EnsureBefore(0)
+		burst.add(fmt.Sprintf("hotplug-remove-%s", ifaceName),
+			fmt.Sprintf("Remove hotplug connections and slots of device %s with interface %q", devinfo.ShortString(), ifaceName),
+			fmt.Sprintf("Remove hotplug connections and slots of %%d devices with interface %q", ifaceName),
+			ts, hotplugKey, seq)
 	}
 }
 
 // hotplugEnumerationDone gets called when initial enumeration on startup is finished.
 func (m *InterfaceManager) hotplugEnumerationDone() {
+	// handle the enumerated devices first
+	m.flushHotplugEvents()
+
 	st := m.state
 	st.Lock()
 	defer st.Unlock()
@@ -148,6 +148,9 @@ func (s *hotplugSuite) SetUpTest(c *C) {
 	restoreTimeout := ifacestate.MockUDevInitRetryTimeout(0 * time.Second)
 	s.BaseTest.AddCleanup(restoreTimeout)
 
+	// handle hotplug events right away, unless a test wants bursts
+	s.BaseTest.AddCleanup(ifacestate.MockHotplugDebounce(0))
+
 	s.udevMon = &udevMonitorMock{}
 	restoreCreate := ifacestate.MockCreateUDevMonitor(func(add udevmonitor.DeviceAddedFunc, remove udevmonitor.DeviceRemovedFunc, done udevmonitor.EnumerationDoneFunc) udevmonitor.Interface {
 		s.udevMon.AddDevice = add
@@ -337,6 +340,108 @@ func (s *hotplugSuite) TestHotplugAddBasic(c *C) {
 	c.Check(s.handledByGadgetCalled, Equals, 0)
 }
 
+func (s *hotplugSuite) TestHotplugEventsBurst(c *C) {
+	s.MockModel(c, nil)
+	// hold the events until explicitly flushed
+	restore := ifacestate.MockHotplugDebounce(time.Hour)
+	defer restore()
+
+	var devPaths []string
+	for i := 0; i < 8; i++ {
+		devPath := fmt.Sprintf("a/path/%d", i)
+		di, err := hotplug.NewHotplugDeviceInfo(map[string]string{"DEVPATH": devPath, "ACTION": "add", "SUBSYSTEM": "foo"})
+		c.Assert(err, IsNil)
+		s.udevMon.AddDevice(di)
+		devPaths = append(devPaths, filepath.Join(dirs.SysfsDir, devPath))
+	}
+	// a device that goes away within the burst
+	flaky, err := hotplug.NewHotplugDeviceInfo(map[string]string{"DEVPATH": "flaky/path", "ACTION": "add", "SUBSYSTEM": "foo"})
+	c.Assert(err, IsNil)
+	s.udevMon.AddDevice(flaky)
+	s.udevMon.RemoveDevice(flaky)
+
+	st := s.state
+	st.Lock()
+	c.Check(st.Changes(), HasLen, 0)
+	st.Unlock()
+
+	s.mgr.FlushHotplugEvents()
+
+	st.Lock()
+	defer st.Unlock()
+
+	// a single change per interface for the whole burst
+	changes := st.Changes()
+	c.Assert(changes, HasLen, 2)
+	kinds := make(map[string]bool)
+	for _, chg := range changes {
+		kinds[chg.Kind()] = true
+		c.Check(chg.Summary(), Matches, `Add hotplug slots of interface "test-[ab]" for 8 devices`)
+
+		var seen []string
+		var seqWaits []*state.Task
+		for _, t := range chg.Tasks() {
+			switch t.Kind() {
+			case "hotplug-add-slot":
+				var di hotplug.HotplugDeviceInfo
+				c.Assert(t.Get("device-info", &di), IsNil)
+				seen = append(seen, di.DevicePath())
+			case "hotplug-seq-wait":
+				seqWaits = append(seqWaits, t)
+			}
+		}
+		// the flaky device was never handled
+		c.Check(seen, DeepEquals, devPaths)
+		c.Assert(seqWaits, HasLen, 8)
+		// devices with the same hotplug key are handled in order
+		for i := 1; i < len(seqWaits); i++ {
+			c.Check(seqWaits[i].WaitTasks(), HasLen, 2)
+		}
+		// each device is handled in a lane of its own, so that an
+		// error with one of them does not abort the others
+		lanes := make(map[int]int)
+		for _, t := range chg.Tasks() {
+			c.Assert(t.Lanes(), HasLen, 1)
+			lanes[t.Lanes()[0]]++
+		}
+		c.Check(lanes, HasLen, 8)
+		for _, n := range lanes {
+			c.Check(n, Equals, 3)
+		}
+	}
+	c.Check(kinds, DeepEquals, map[string]bool{"hotplug-add-slot-test-a": true, "hotplug-add-slot-test-b": true})
+}
+
+func (s *hotplugSuite) TestHotplugEventsBurstKnownDeviceRemoved(c *C) {
+	s.MockModel(c, nil)
+
+	di, err := hotplug.NewHotplugDeviceInfo(map[string]string{"DEVPATH": "a/path", "ACTION": "add", "SUBSYSTEM": "foo"})
+	c.Assert(err, IsNil)
+	s.udevMon.AddDevice(di)
+	c.Assert(s.o.Settle(5*time.Second), IsNil)
+
+	// the known device shows up again and goes away within a burst
+	restore := ifacestate.MockHotplugDebounce(time.Hour)
+	defer restore()
+	s.udevMon.AddDevice(di)
+	s.udevMon.RemoveDevice(di)
+	s.mgr.FlushHotplugEvents()
+
+	st := s.state
+	st.Lock()
+	defer st.Unlock()
+
+	// its removal was not dropped
+	kinds := make(map[string]bool)
+	for _, chg := range st.Changes() {
+		if !chg.Status().Ready() {
+			kinds[chg.Kind()] = true
+		}
+	}
+	c.Check(kinds["hotplug-remove-test-a"], Equals, true)
+	c.Check(kinds["hotplug-remove-test-b"], Equals, true)
+}
+
 func (s *hotplugSuite) TestHotplugConnectWithGadgetSlot(c *C) {
 	s.MockModel(c, map[string]interface{}{
 		"gadget": "the-gadget",
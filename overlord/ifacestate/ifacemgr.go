@@ -56,6 +56,14 @@ type InterfaceManager struct {
 	// maps sysfs path -> [(interface name, device key)...]
 	hotplugDevicePaths map[string][]deviceData
 
+	// hotplug events held to be handled together as a burst
+	hotplugEventsMu   sync.Mutex
+	hotplugEvents     []hotplugEvent
+	hotplugBurstStart time.Time
+	hotplugTimer      *time.Timer
+	// serializes handling bursts of hotplug events
+	hotplugHandleMu sync.Mutex
+
 	// extras
 	extraInterfaces []interfaces.Interface
 	extraBackends   []interfaces.SecurityBackend
@@ -190,13 +198,17 @@ func (m *InterfaceManager) Ensure() error {
 	}
 
 	// don't initialize udev monitor until we have a system snap so that we
-	// can attach hotplug interfaces to it.
+	// can attach hotplug interfaces to it, look for it again as often
+	// as initialization is retried.
+	now := time.Now()
 	if !checkSystemSnapIsPresent(m.state) {
+		if retry := now.Add(udevInitRetryTimeout); retry.After(m.udevRetryTimeout) {
+			m.udevRetryTimeout = retry
+		}
 		return nil
 	}
 
 	// retry udev monitor initialization every 5 minutes
-	now := time.Now()
 	if now.After(m.udevRetryTimeout) {
 		err := m.initUDevMonitor()
 		if err != nil {
@@ -207,6 +219,35 @@ func (m *InterfaceManager) Ensure() error {
 	return nil
 }
 
+// DeferUntil implements StateDeferrer.DeferUntil, the udev monitor is
+// not initialized and hotplug devices are not enumerated before the
+// given time.
+func (m *InterfaceManager) DeferUntil(t time.Time) {
+	if m.udevRetryTimeout.Before(t) {
+		m.udevRetryTimeout = t
+	}
+}
+
+// NextEnsure implements StateEnsureScheduler. Ensure has nothing to do
+// once the udev monitor runs, or until its initialization, or looking
+// for a system snap, is retried.
+func (m *InterfaceManager) NextEnsure() time.Time {
+	if m.udevMonitorDisabled {
+		return time.Time{}
+	}
+	m.udevMonMu.Lock()
+	udevMon := m.udevMon
+	m.udevMonMu.Unlock()
+	if udevMon != nil {
+		return time.Time{}
+	}
+	if m.udevRetryTimeout.IsZero() {
+		// not tried yet
+		return time.Now()
+	}
+	return m.udevRetryTimeout
+}
+
 // Stop implements StateStopper. It stops the udev monitor,
 // if running.
 func (m *InterfaceManager) Stop() {
@@ -219,6 +260,7 @@ func (m *InterfaceManager) Stop() {
 	if err := udevMon.Stop(); err != nil {
 		logger.Noticef("Cannot stop udev monitor: %s", err)
 	}
+	m.discardHotplugEvents()
 	m.udevMonMu.Lock()
 	defer m.udevMonMu.Unlock()
 	m.udevMon = nil
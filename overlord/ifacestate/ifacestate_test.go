@@ -3008,6 +3008,30 @@ func (s *interfaceManagerSuite) TestDoSetupSnapSecurityReloadsConnectionsWhenInv
 	c.Check(s.secBackend.SetupCalls[1].Options, Equals, interfaces.ConfinementOptions{})
 }
 
+func (s *interfaceManagerSuite) TestDoSetupSnapSecurityUsesSetupManyForAffectedSnaps(c *C) {
+	s.MockModel(c, nil)
+
+	secBackend := &ifacetest.TestSecurityBackendSetupMany{
+		TestSecurityBackend: ifacetest.TestSecurityBackend{BackendName: "fancy"},
+	}
+	s.mockSecBackend(c, secBackend)
+	s.mockIfaces(c, &ifacetest.TestInterface{InterfaceName: "test"}, &ifacetest.TestInterface{InterfaceName: "test2"})
+	snapInfo := s.mockSnap(c, consumerYaml)
+	s.mockSnap(c, producerYaml)
+	s.testDoSetupSnapSecurityReloadsConnectionsWhenInvokedOn(c, snapInfo.InstanceName(), snapInfo.Revision)
+
+	// The backend set up both snaps in one go
+	c.Check(secBackend.SetupCalls, HasLen, 0)
+	c.Assert(secBackend.SetupManyCalls, HasLen, 1)
+	c.Assert(secBackend.SetupManyCalls[0].SnapInfos, HasLen, 2)
+	c.Check(secBackend.SetupManyCalls[0].SnapInfos[0].InstanceName(), Equals, "consumer")
+	c.Check(secBackend.SetupManyCalls[0].SnapInfos[1].InstanceName(), Equals, "producer")
+	c.Check(secBackend.SetupManyCalls[0].Options, DeepEquals, []interfaces.ConfinementOptions{{}, {}})
+
+	// Other backends are still set up one snap at a time
+	c.Assert(s.secBackend.SetupCalls, HasLen, 2)
+}
+
 func (s *interfaceManagerSuite) testDoSetupSnapSecurityReloadsConnectionsWhenInvokedOn(c *C, snapName string, revision snap.Revision) {
 	s.state.Lock()
 	s.state.Set("conns", map[string]interface{}{
@@ -5674,6 +5698,95 @@ func (s *interfaceManagerSuite) TestUDevMonitorInitErrors(c *C) {
 	c.Assert(u.StopCalls, Equals, 1)
 }
 
+func (s *interfaceManagerSuite) TestUDevMonitorNextEnsure(c *C) {
+	u := udevMonitorMock{
+		ConnectError: fmt.Errorf("Connect failed"),
+	}
+	st := s.state
+	st.Lock()
+	snapstate.Set(s.state, "core", &snapstate.SnapState{
+		Active: true,
+		Sequence: []*snap.SideInfo{
+			{RealName: "core", Revision: snap.R(1)},
+		},
+		Current:  snap.R(1),
+		SnapType: "os",
+	})
+	st.Unlock()
+
+	restoreTimeout := ifacestate.MockUDevInitRetryTimeout(5 * time.Minute)
+	defer restoreTimeout()
+
+	restoreCreate := ifacestate.MockCreateUDevMonitor(func(udevmonitor.DeviceAddedFunc, udevmonitor.DeviceRemovedFunc, udevmonitor.EnumerationDoneFunc) udevmonitor.Interface {
+		return &u
+	})
+	defer restoreCreate()
+
+	mgr, err := ifacestate.Manager(s.state, nil, s.o.TaskRunner(), nil, nil)
+	c.Assert(err, IsNil)
+	s.o.AddManager(mgr)
+	c.Assert(s.o.StartUp(), IsNil)
+
+	// not tried yet
+	c.Check(mgr.NextEnsure().After(time.Now()), Equals, false)
+
+	t0 := time.Now()
+	c.Assert(s.se.Ensure(), ErrorMatches, ".*Connect failed.*")
+	c.Assert(u.ConnectCalls, Equals, 1)
+
+	// the retry is scheduled, Ensure is skipped until then
+	c.Check(mgr.NextEnsure().After(t0.Add(4*time.Minute)), Equals, true)
+	c.Assert(s.se.Ensure(), IsNil)
+	c.Assert(u.ConnectCalls, Equals, 1)
+
+	// the monitor runs, there is nothing left to do
+	u.ConnectError = nil
+	mgr.SetUDevRetryTimeout(time.Now())
+	c.Assert(s.se.Ensure(), IsNil)
+	c.Assert(u.ConnectCalls, Equals, 2)
+	c.Check(mgr.NextEnsure().IsZero(), Equals, true)
+
+	s.se.Stop()
+}
+
+func (s *interfaceManagerSuite) TestUDevMonitorDeferred(c *C) {
+	u := udevMonitorMock{}
+	st := s.state
+	st.Lock()
+	snapstate.Set(s.state, "core", &snapstate.SnapState{
+		Active: true,
+		Sequence: []*snap.SideInfo{
+			{RealName: "core", Revision: snap.R(1)},
+		},
+		Current:  snap.R(1),
+		SnapType: "os",
+	})
+	st.Unlock()
+
+	restoreCreate := ifacestate.MockCreateUDevMonitor(func(udevmonitor.DeviceAddedFunc, udevmonitor.DeviceRemovedFunc, udevmonitor.EnumerationDoneFunc) udevmonitor.Interface {
+		return &u
+	})
+	defer restoreCreate()
+
+	mgr, err := ifacestate.Manager(s.state, nil, s.o.TaskRunner(), nil, nil)
+	c.Assert(err, IsNil)
+	s.o.AddManager(mgr)
+	c.Assert(s.o.StartUp(), IsNil)
+
+	// hotplug enumeration is held off until the deadline
+	until := time.Now().Add(time.Hour)
+	mgr.DeferUntil(until)
+	c.Check(mgr.NextEnsure().Equal(until), Equals, true)
+	c.Assert(s.se.Ensure(), IsNil)
+	c.Assert(u.ConnectCalls, Equals, 0)
+
+	mgr.DeferUntil(time.Now())
+	c.Assert(s.se.Ensure(), IsNil)
+	c.Assert(u.ConnectCalls, Equals, 1)
+
+	s.se.Stop()
+}
+
 func (s *interfaceManagerSuite) TestUDevMonitorInitWaitsForCore(c *C) {
 	restoreTimeout := ifacestate.MockUDevInitRetryTimeout(0 * time.Second)
 	defer restoreTimeout()
@@ -5694,6 +5807,12 @@ func (s *interfaceManagerSuite) TestUDevMonitorInitWaitsForCore(c *C) {
 		c.Assert(s.se.Ensure(), IsNil)
 		c.Assert(udevMonitorCreated, Equals, false)
 	}
+	// the system snap is looked for again later, not on every pass
+	restoreTimeout = ifacestate.MockUDevInitRetryTimeout(time.Hour)
+	c.Assert(s.se.Ensure(), IsNil)
+	c.Check(mgr.NextEnsure().After(time.Now().Add(30*time.Minute)), Equals, true)
+	restoreTimeout()
+	mgr.SetUDevRetryTimeout(time.Now())
 
 	// core snap appears in the system
 	st := s.state
@@ -64,6 +64,10 @@ var (
 	defaultCachedDownloads = 5
 
 	configstateInit = configstate.Init
+
+	// deferredStartupDelay is how long after the ensure loop starts
+	// the managers hold off the work not needed to serve requests
+	deferredStartupDelay = 10 * time.Second
 )
 
 // Overlord is the central manager of a snappy system, keeping
@@ -127,6 +131,9 @@ func New(restartBehavior RestartBehavior) (*Overlord, error) {
 		return nil, err
 	}
 
+	perfTimings := timings.New(map[string]string{"startup": "overlord"})
+	newManagers := perfTimings.StartSpan("new-managers", "create the state managers")
+
 	o.stateEng = NewStateEngine(s)
 	o.runner = state.NewTaskRunner(s)
 
@@ -177,6 +184,9 @@ func New(restartBehavior RestartBehavior) (*Overlord, error) {
 	// the shared task runner should be added last!
 	o.stateEng.AddManager(o.runner)
 
+	newManagers.Stop()
+	o.stateEng.addStartupTimings(perfTimings)
+
 	s.Lock()
 	defer s.Unlock()
 	// setting up the store
@@ -349,6 +359,16 @@ func (o *Overlord) ensureBefore(d time.Duration) {
 	}
 }
 
+// ensureAtNextDeadline makes sure the next Ensure happens no later than
+// the earliest deadline of the managers.
+func (o *Overlord) ensureAtNextDeadline() {
+	next := o.stateEng.NextEnsure()
+	if next.IsZero() {
+		return
+	}
+	o.ensureBefore(next.Sub(time.Now()))
+}
+
 func (o *Overlord) requestRestart(t state.RestartType) {
 	if o.restartBehavior == nil {
 		logger.Noticef("restart requested but no behavior set")
@@ -358,8 +378,13 @@ func (o *Overlord) requestRestart(t state.RestartType) {
 }
 
 // Loop runs a loop in a goroutine to ensure the current state regularly through StateEngine Ensure.
+// The work of the managers that is not needed to serve requests, like
+// catalog refreshes, hotplug enumeration, registration or snapshot
+// housekeeping, is held off for a while so that it does not compete
+// with the first requests.
 func (o *Overlord) Loop() {
 	o.ensureTimerSetup()
+	o.stateEng.DeferUntil(time.Now().Add(deferredStartupDelay))
 	o.loopTomb.Go(func() error {
 		for {
 			// TODO: pass a proper context into Ensure
@@ -368,6 +393,7 @@ func (o *Overlord) Loop() {
 			// continue to the next Ensure() try for now
 			o.stateEng.Ensure()
 			o.ensureDidRun()
+			o.ensureAtNextDeadline()
 			select {
 			case <-o.loopTomb.Dying():
 				return nil
@@ -388,7 +414,8 @@ func (o *Overlord) ensureDidRun() {
 
 func (o *Overlord) CanStandby() bool {
 	run := atomic.LoadInt32(&o.ensureRun)
-	return run != 0
+	// let the deferred work run before going to standby
+	return run != 0 && !o.stateEng.Deferring()
 }
 
 // Stop stops the ensure loop and the managers under the StateEngine.
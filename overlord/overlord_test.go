@@ -515,6 +515,95 @@ func (ovs *overlordSuite) TestEnsureLoopMediatedEnsureBeforeOutsideEnsure(c *C)
 	}
 }
 
+type scheduledWitnessManager struct {
+	witnessManager
+	next time.Time
+}
+
+func (wm *scheduledWitnessManager) NextEnsure() time.Time {
+	return wm.next
+}
+
+func (ovs *overlordSuite) TestEnsureLoopWakesAtManagerDeadline(c *C) {
+	restoreIntv := overlord.MockEnsureInterval(10 * time.Minute)
+	defer restoreIntv()
+	o := overlord.Mock()
+
+	witness := &scheduledWitnessManager{
+		witnessManager: witnessManager{
+			state:          o.State(),
+			expectedEnsure: 2,
+			ensureCalled:   make(chan struct{}),
+		},
+	}
+	// due right away and then again shortly after
+	witness.next = time.Now()
+	witness.ensureCallback = func(*state.State) error {
+		witness.next = time.Now().Add(50 * time.Millisecond)
+		return nil
+	}
+	o.AddManager(witness)
+
+	c.Assert(o.StartUp(), IsNil)
+
+	o.Loop()
+	defer o.Stop()
+
+	select {
+	case <-witness.ensureCalled:
+	case <-time.After(2 * time.Second):
+		c.Fatal("Ensure calls not happening")
+	}
+}
+
+type deferringWitnessManager struct {
+	witnessManager
+	deferredUntil time.Time
+}
+
+func (wm *deferringWitnessManager) DeferUntil(t time.Time) {
+	wm.deferredUntil = t
+}
+
+func (ovs *overlordSuite) TestEnsureLoopDefersWork(c *C) {
+	restoreIntv := overlord.MockEnsureInterval(10 * time.Minute)
+	defer restoreIntv()
+	restoreDelay := overlord.MockDeferredStartupDelay(50 * time.Millisecond)
+	defer restoreDelay()
+	o := overlord.Mock()
+
+	witness := &deferringWitnessManager{
+		witnessManager: witnessManager{
+			state:          o.State(),
+			expectedEnsure: 2,
+			ensureCalled:   make(chan struct{}),
+		},
+	}
+	o.AddManager(witness)
+
+	c.Assert(o.StartUp(), IsNil)
+
+	t0 := time.Now()
+	o.Loop()
+	defer o.Stop()
+
+	c.Check(witness.deferredUntil.After(t0), Equals, true)
+
+	// the loop wakes up for the deferred work
+	select {
+	case <-witness.ensureCalled:
+	case <-time.After(2 * time.Second):
+		c.Fatal("Ensure calls not happening")
+	}
+	c.Check(time.Now().Before(witness.deferredUntil), Equals, false)
+
+	// and only then can go to standby
+	for i := 0; i < 100 && !o.CanStandby(); i++ {
+		time.Sleep(10 * time.Millisecond)
+	}
+	c.Check(o.CanStandby(), Equals, true)
+}
+
 func (ovs *overlordSuite) TestEnsureLoopPrune(c *C) {
 	restoreIntv := overlord.MockPruneInterval(200*time.Millisecond, 1000*time.Millisecond, 1000*time.Millisecond)
 	defer restoreIntv()
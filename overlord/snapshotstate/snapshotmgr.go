@@ -57,6 +57,8 @@ type SnapshotManager struct {
 	state *state.State
 
 	lastForgetExpiredSnapshotTime time.Time
+	// deferredUntil holds off the expiration of snapshots after startup
+	deferredUntil time.Time
 }
 
 // Manager returns a new SnapshotManager
@@ -77,10 +79,25 @@ func Manager(st *state.State, runner *state.TaskRunner) *SnapshotManager {
 	return manager
 }
 
+// DeferUntil is part of the overlord.StateDeferrer interface.
+func (mgr *SnapshotManager) DeferUntil(t time.Time) {
+	mgr.deferredUntil = t
+}
+
+// NextEnsure is part of the overlord.StateEnsureScheduler interface.
+func (mgr *SnapshotManager) NextEnsure() time.Time {
+	next := mgr.lastForgetExpiredSnapshotTime.Add(autoExpirationInterval)
+	if next.Before(mgr.deferredUntil) {
+		return mgr.deferredUntil
+	}
+	return next
+}
+
 // Ensure is part of the overlord.StateManager interface.
 func (mgr *SnapshotManager) Ensure() error {
 	// process expired snapshots once a day.
-	if time.Now().After(mgr.lastForgetExpiredSnapshotTime.Add(autoExpirationInterval)) {
+	now := time.Now()
+	if now.After(mgr.lastForgetExpiredSnapshotTime.Add(autoExpirationInterval)) && !now.Before(mgr.deferredUntil) {
 		return mgr.forgetExpiredSnapshots()
 	}
 	return nil
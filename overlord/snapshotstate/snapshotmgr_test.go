@@ -164,6 +164,24 @@ func (snapshotSuite) TestEnsureForgetsSnapshotsRunsRegularly(c *check.C) {
 	c.Check(backendIterCalls, check.Equals, 2)
 }
 
+func (snapshotSuite) TestNextEnsure(c *check.C) {
+	st := state.New(nil)
+	runner := state.NewTaskRunner(st)
+	mgr := snapshotstate.Manager(st, runner)
+
+	// never run, due right away
+	c.Check(mgr.NextEnsure().Before(time.Now()), check.Equals, true)
+
+	t := time.Now()
+	mgr.SetLastForgetExpiredSnapshotTime(t)
+	c.Check(mgr.NextEnsure().Equal(t.Add(24*time.Hour)), check.Equals, true)
+
+	// housekeeping deferred past the next expiration
+	until := t.Add(48 * time.Hour)
+	mgr.DeferUntil(until)
+	c.Check(mgr.NextEnsure().Equal(until), check.Equals, true)
+}
+
 func (snapshotSuite) testEnsureForgetSnapshotsConflict(c *check.C, snapshotTaskKind string) {
 	removeCalled := 0
 	restoreOsRemove := snapshotstate.MockOsRemove(func(string) error {
@@ -43,7 +43,7 @@ type StoreService interface {
 	SnapAction(ctx context.Context, currentSnaps []*store.CurrentSnap, actions []*store.SnapAction, user *auth.UserState, opts *store.RefreshOptions) ([]*snap.Info, error)
 
 	Sections(ctx context.Context, user *auth.UserState) ([]string, error)
-	WriteCatalogs(ctx context.Context, names io.Writer, adder store.SnapAdder) error
+	WriteCatalogs(ctx context.Context, names io.Writer, adder store.SnapAdder, validators *store.CatalogValidators) error
 
 	Download(context.Context, string, string, *snap.DownloadInfo, progress.Meter, *auth.UserState, *store.DownloadOptions) error
 	DownloadStream(context.Context, string, *snap.DownloadInfo, *auth.UserState) (io.ReadCloser, error)
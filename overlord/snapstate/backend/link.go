@@ -119,6 +119,14 @@ func (b Backend) LinkSnap(info *snap.Info, model *asserts.Model, tm timings.Meas
 		}
 	}
 
+	// the launch descriptor is only an optimization for "snap run",
+	// which falls back to reading snap.yaml without it; write it
+	// before switching the current symlinks so that it is ready when
+	// the new revision becomes current
+	if err := wrappers.AddSnapLaunchDescriptor(info); err != nil {
+		logger.Noticef("Cannot write launch descriptor of %q: %v", info.InstanceName(), err)
+	}
+
 	if err := updateCurrentSymlinks(info); err != nil {
 		return err
 	}
@@ -189,6 +197,10 @@ func (b Backend) UnlinkSnap(info *snap.Info, meter progress.Meter) error {
 	// remove generated services, binaries etc
 	err1 := removeGeneratedWrappers(info, meter)
 
+	if err := wrappers.RemoveSnapLaunchDescriptor(info); err != nil {
+		logger.Noticef("Cannot remove launch descriptor of %q: %v", info.InstanceName(), err)
+	}
+
 	// and finally remove current symlinks
 	err2 := removeCurrentSymlinks(info)
 
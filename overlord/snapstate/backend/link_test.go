@@ -89,6 +89,7 @@ apps:
 	l, err = filepath.Glob(filepath.Join(dirs.SnapServicesDir, "*.service"))
 	c.Assert(err, IsNil)
 	c.Assert(l, HasLen, 1)
+	c.Check(snap.LaunchDescriptorFile("hello"), testutil.FilePresent)
 
 	// undo will remove
 	err = s.be.UnlinkSnap(info, progress.Null)
@@ -100,6 +101,7 @@ apps:
 	l, err = filepath.Glob(filepath.Join(dirs.SnapServicesDir, "*.service"))
 	c.Assert(err, IsNil)
 	c.Assert(l, HasLen, 0)
+	c.Check(snap.LaunchDescriptorFile("hello"), testutil.FileAbsent)
 }
 
 func (s *linkSuite) TestLinkDoUndoCurrentSymlink(c *C) {
@@ -46,6 +46,8 @@ type catalogRefresh struct {
 	state *state.State
 
 	nextCatalogRefresh time.Time
+	// deferredUntil holds off the first refresh after startup
+	deferredUntil time.Time
 }
 
 func newCatalogRefresh(st *state.State) *catalogRefresh {
@@ -54,6 +56,15 @@ func newCatalogRefresh(st *state.State) *catalogRefresh {
 
 // Ensure will ensure that the catalog refresh happens
 func (r *catalogRefresh) Ensure() error {
+	// nextCatalogRefresh and deferredUntil are only used by Ensure
+	// itself, don't take the state lock until it is due
+	if time.Now().Before(r.deferredUntil) {
+		return nil
+	}
+	if !r.nextCatalogRefresh.IsZero() && time.Now().Before(r.nextCatalogRefresh) {
+		return nil
+	}
+
 	r.state.Lock()
 	defer r.state.Unlock()
 
@@ -101,9 +112,23 @@ func (r *catalogRefresh) Ensure() error {
 	return err
 }
 
-var newCmdDB = advisor.Create
+var (
+	newCmdDB       = advisor.Update
+	ensureCmdIndex = advisor.EnsureIndex
+)
 
 func refreshCatalogs(st *state.State, theStore StoreService) error {
+	// the validators identify the catalog that was last written, they
+	// are only meaningful while its names file and commands database
+	// are still around
+	var validators store.CatalogValidators
+	if osutil.FileExists(dirs.SnapNamesFile) && osutil.FileExists(dirs.SnapCommandsDB) {
+		err := st.Get("catalog-validators", &validators)
+		if err != nil && err != state.ErrNoState {
+			return err
+		}
+	}
+
 	st.Unlock()
 	defer st.Lock()
 
@@ -141,8 +166,27 @@ func refreshCatalogs(st *state.State, theStore StoreService) error {
 	defer cmdDB.Rollback()
 
 	timings.Run(perfTimings, "write-catalogs", "query store for catalogs", func(tm timings.Measurer) {
-		err = theStore.WriteCatalogs(auth.EnsureContextTODO(), namesFile, cmdDB)
+		err = theStore.WriteCatalogs(auth.EnsureContextTODO(), namesFile, cmdDB, &validators)
 	})
+	if err == store.ErrCatalogNotModified {
+		logger.Debugf("Catalog not modified since the last refresh.")
+		// nothing to rewrite, only record when the catalog was
+		// last known to be current, the next refresh is scheduled
+		// from that after a restart
+		now := time.Now()
+		if err := os.Chtimes(dirs.SnapNamesFile, now, now); err != nil {
+			return err
+		}
+		// the commands index is not sent by the store, write it
+		// again if it went missing
+		if err := ensureCmdIndex(); err != nil {
+			logger.Noticef("cannot write the commands index: %v", err)
+		}
+		st.Lock()
+		perfTimings.Save(st)
+		st.Unlock()
+		return nil
+	}
 	if err != nil {
 		return err
 	}
@@ -155,6 +199,9 @@ func refreshCatalogs(st *state.State, theStore StoreService) error {
 	}
 
 	st.Lock()
+	if err1 == nil {
+		st.Set("catalog-validators", validators)
+	}
 	perfTimings.Save(st)
 	st.Unlock()
 
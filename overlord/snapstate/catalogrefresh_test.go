@@ -45,9 +45,10 @@ type catalogStore struct {
 
 	ops     []string
 	tooMany bool
+	etag    string
 }
 
-func (r *catalogStore) WriteCatalogs(ctx context.Context, w io.Writer, a store.SnapAdder) error {
+func (r *catalogStore) WriteCatalogs(ctx context.Context, w io.Writer, a store.SnapAdder, validators *store.CatalogValidators) error {
 	if ctx == nil || !auth.IsEnsureContext(ctx) {
 		panic("Ensure marked context required")
 	}
@@ -55,6 +56,10 @@ func (r *catalogStore) WriteCatalogs(ctx context.Context, w io.Writer, a store.S
 	if r.tooMany {
 		return store.ErrTooManyRequests
 	}
+	if r.etag != "" && validators.ETag == r.etag {
+		return store.ErrCatalogNotModified
+	}
+	validators.ETag = r.etag
 	w.Write([]byte("pkg1\npkg2"))
 	a.AddSnap("foo", "1.0", "foo summary", []string{"foo", "meh"})
 	a.AddSnap("bar", "2.0", "bar summray", []string{"bar", "meh"})
@@ -133,6 +138,66 @@ func (s *catalogRefreshTestSuite) TestCatalogRefresh(c *C) {
 	})
 }
 
+func (s *catalogRefreshTestSuite) TestCatalogRefreshNotModified(c *C) {
+	s.store.etag = `"catalog-1"`
+
+	cr7 := snapstate.NewCatalogRefresh(s.state)
+	c.Assert(cr7.Ensure(), IsNil)
+	c.Check(s.store.ops, DeepEquals, []string{"sections", "write-catalog"})
+
+	names, err := ioutil.ReadFile(dirs.SnapNamesFile)
+	c.Assert(err, IsNil)
+	cmds, err := ioutil.ReadFile(dirs.SnapCommandsDB)
+	c.Assert(err, IsNil)
+	t0 := time.Now().Add(-time.Hour)
+	c.Assert(os.Chtimes(dirs.SnapNamesFile, t0, t0), IsNil)
+
+	// the next refresh finds the catalog unchanged
+	snapstate.MockCatalogRefreshNextRefresh(cr7, time.Now().Add(-time.Minute))
+	c.Assert(cr7.Ensure(), IsNil)
+	c.Check(s.store.ops, DeepEquals, []string{"sections", "write-catalog", "sections", "write-catalog"})
+
+	// nothing was rewritten
+	c.Check(dirs.SnapNamesFile, testutil.FileEquals, names)
+	c.Check(dirs.SnapCommandsDB, testutil.FileEquals, cmds)
+	// but the names file records when the catalog was last current
+	st, err := os.Stat(dirs.SnapNamesFile)
+	c.Assert(err, IsNil)
+	c.Check(st.ModTime().After(t0), Equals, true)
+}
+
+func (s *catalogRefreshTestSuite) TestCatalogRefreshNotModifiedWritesMissingIndex(c *C) {
+	s.store.etag = `"catalog-1"`
+
+	cr7 := snapstate.NewCatalogRefresh(s.state)
+	c.Assert(cr7.Ensure(), IsNil)
+	index, err := ioutil.ReadFile(dirs.SnapCommandsIndex)
+	c.Assert(err, IsNil)
+
+	c.Assert(os.Remove(dirs.SnapCommandsIndex), IsNil)
+	snapstate.MockCatalogRefreshNextRefresh(cr7, time.Now().Add(-time.Minute))
+	c.Assert(cr7.Ensure(), IsNil)
+	c.Check(s.store.ops, DeepEquals, []string{"sections", "write-catalog", "sections", "write-catalog"})
+
+	c.Check(dirs.SnapCommandsIndex, testutil.FileEquals, index)
+}
+
+func (s *catalogRefreshTestSuite) TestCatalogRefreshIgnoresValidatorsWithoutCatalog(c *C) {
+	s.store.etag = `"catalog-1"`
+
+	cr7 := snapstate.NewCatalogRefresh(s.state)
+	c.Assert(cr7.Ensure(), IsNil)
+
+	// the catalog went away, it is fetched in full again
+	c.Assert(os.Remove(dirs.SnapCommandsDB), IsNil)
+	snapstate.MockCatalogRefreshNextRefresh(cr7, time.Now().Add(-time.Minute))
+	c.Assert(cr7.Ensure(), IsNil)
+
+	dump, err := advisor.DumpCommands()
+	c.Assert(err, IsNil)
+	c.Check(dump, HasLen, 3)
+}
+
 func (s *catalogRefreshTestSuite) TestCatalogRefreshTooMany(c *C) {
 	s.store.tooMany = true
 
@@ -166,6 +231,17 @@ func (s *catalogRefreshTestSuite) TestCatalogRefreshNotNeeded(c *C) {
 	c.Check(osutil.FileExists(dirs.SnapNamesFile), Equals, false)
 }
 
+func (s *catalogRefreshTestSuite) TestCatalogRefreshDeferred(c *C) {
+	cr7 := snapstate.NewCatalogRefresh(s.state)
+	snapstate.MockCatalogRefreshDeferredUntil(cr7, time.Now().Add(1*time.Hour))
+	err := cr7.Ensure()
+	c.Check(err, IsNil)
+	c.Check(s.store.ops, HasLen, 0)
+	c.Check(osutil.FileExists(dirs.SnapNamesFile), Equals, false)
+	// the refresh was not scheduled yet
+	c.Check(snapstate.NextCatalogRefresh(cr7).IsZero(), Equals, true)
+}
+
 func (s *catalogRefreshTestSuite) TestCatalogRefreshNewEnough(c *C) {
 	// write a fake sections file just to have it
 	c.Assert(os.MkdirAll(filepath.Dir(dirs.SnapNamesFile), 0755), IsNil)
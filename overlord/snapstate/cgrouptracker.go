@@ -0,0 +1,210 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package snapstate
+
+import (
+	"bufio"
+	"bytes"
+	"os"
+	"path/filepath"
+	"sync"
+	"syscall"
+	"unsafe"
+
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/osutil"
+)
+
+type cgroupState int
+
+const (
+	// the cgroup of the security tag does not exist
+	cgroupAbsent cgroupState = iota + 1
+	// the cgroup of the security tag exists, its processes need to
+	// be listed
+	cgroupPresent
+)
+
+// cgroupTracker keeps track of which security tags have processes in
+// their pids cgroup, so that the refresh checks need not read the
+// cgroup.procs file of every app and hook of a snap.
+//
+// It is driven by inotify events on the pids cgroup directory, which
+// are consumed whenever the tracker is asked about a security tag, so
+// that cgroup.procs is only read for the cgroups that exist.
+//
+// The pids controller of cgroup v1, where the cgroups of snaps live,
+// has no cgroup.events file, and nothing there notifies of a cgroup
+// becoming empty: the release agent is a system wide setting and the
+// cgroups created for the snaps are kept once their processes exited.
+// So only the apps and hooks that never ran since boot are spared
+// reading cgroup.procs, the others have it read on every check.
+type cgroupTracker struct {
+	mu sync.Mutex
+
+	dir string
+	// fd is the inotify instance, or -1
+	fd int
+	// dirWd is the watch of dir, or -1
+	dirWd int32
+	// tags holds what is known of the cgroup of the security tags,
+	// tags missing from it need to be looked at
+	tags map[string]cgroupState
+}
+
+func newCgroupTracker(dir string) *cgroupTracker {
+	fd, err := syscall.InotifyInit1(syscall.IN_NONBLOCK | syscall.IN_CLOEXEC)
+	if err != nil {
+		fd = -1
+	}
+	return &cgroupTracker{
+		dir:   dir,
+		fd:    fd,
+		dirWd: -1,
+		tags:  make(map[string]cgroupState),
+	}
+}
+
+func (t *cgroupTracker) close() {
+	if t.fd >= 0 {
+		syscall.Close(t.fd)
+		t.fd = -1
+	}
+}
+
+var (
+	cgroupTrackerMu  sync.Mutex
+	theCgroupTracker *cgroupTracker
+)
+
+// currentCgroupTracker returns the tracker of the pids cgroups.
+func currentCgroupTracker() *cgroupTracker {
+	cgroupTrackerMu.Lock()
+	defer cgroupTrackerMu.Unlock()
+	if theCgroupTracker == nil || theCgroupTracker.dir != dirs.PidsCgroupDir {
+		if theCgroupTracker != nil {
+			theCgroupTracker.close()
+		}
+		theCgroupTracker = newCgroupTracker(dirs.PidsCgroupDir)
+	}
+	return theCgroupTracker
+}
+
+// pids returns the PIDs in the cgroup of the given security tag.
+func (t *cgroupTracker) pids(securityTag string) ([]int, error) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+
+	t.sync()
+	st, ok := t.tags[securityTag]
+	if !ok {
+		st = t.probe(securityTag)
+	}
+	if st == cgroupAbsent {
+		return nil, nil
+	}
+	return readCgroupPids(filepath.Join(t.dir, securityTag, "cgroup.procs"))
+}
+
+// probe looks at whether the cgroup of the given security tag exists.
+func (t *cgroupTracker) probe(securityTag string) cgroupState {
+	cgroupDir := filepath.Join(t.dir, securityTag)
+	if !osutil.IsDirectory(cgroupDir) {
+		// the cgroup could be created unnoticed without a
+		// watch on the directory, don't remember it
+		if t.dirWd >= 0 {
+			t.tags[securityTag] = cgroupAbsent
+		}
+		return cgroupAbsent
+	}
+	t.tags[securityTag] = cgroupPresent
+	return cgroupPresent
+}
+
+// sync applies the pending inotify events.
+func (t *cgroupTracker) sync() {
+	if t.fd < 0 {
+		return
+	}
+	if t.dirWd < 0 {
+		const mask = syscall.IN_CREATE | syscall.IN_DELETE | syscall.IN_MOVED_FROM | syscall.IN_MOVED_TO | syscall.IN_DELETE_SELF | syscall.IN_MOVE_SELF
+		if wd, err := syscall.InotifyAddWatch(t.fd, t.dir, mask); err == nil {
+			t.dirWd = int32(wd)
+		}
+	}
+	var buf [64 * (syscall.SizeofInotifyEvent + syscall.NAME_MAX + 1)]byte
+	for {
+		n, err := syscall.Read(t.fd, buf[:])
+		if err == syscall.EINTR {
+			continue
+		}
+		if err != nil || n <= 0 {
+			// EAGAIN once all the events were read
+			return
+		}
+		for off := 0; off+syscall.SizeofInotifyEvent <= n; {
+			ev := (*syscall.InotifyEvent)(unsafe.Pointer(&buf[off]))
+			nameOff := off + syscall.SizeofInotifyEvent
+			off = nameOff + int(ev.Len)
+			if off > n {
+				break
+			}
+			name := string(bytes.TrimRight(buf[nameOff:off], "\x00"))
+			t.handleEvent(ev.Wd, ev.Mask, name)
+		}
+	}
+}
+
+func (t *cgroupTracker) handleEvent(wd int32, mask uint32, name string) {
+	if mask&syscall.IN_Q_OVERFLOW != 0 {
+		// events were lost, start over
+		t.tags = make(map[string]cgroupState)
+		return
+	}
+	if wd != t.dirWd {
+		return
+	}
+	switch {
+	case mask&syscall.IN_IGNORED != 0:
+		// the directory went away
+		t.dirWd = -1
+		t.tags = make(map[string]cgroupState)
+	case mask&syscall.IN_MOVE_SELF != 0:
+		syscall.InotifyRmWatch(t.fd, uint32(wd))
+		t.dirWd = -1
+		t.tags = make(map[string]cgroupState)
+	case mask&(syscall.IN_DELETE|syscall.IN_MOVED_FROM) != 0:
+		t.tags[name] = cgroupAbsent
+	case mask&(syscall.IN_CREATE|syscall.IN_MOVED_TO) != 0:
+		delete(t.tags, name)
+	}
+}
+
+func readCgroupPids(procsFile string) ([]int, error) {
+	file, err := os.Open(procsFile)
+	if os.IsNotExist(err) {
+		return nil, nil
+	}
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+	return parsePids(bufio.NewReader(file))
+}
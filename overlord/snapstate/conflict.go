@@ -90,6 +90,105 @@ func affectedSnaps(t *state.Task) ([]string, error) {
 	return nil, nil
 }
 
+// conflictIndex maps snaps to the tasks affecting them. It is cached in
+// the state and brought up to date incrementally by conflict checks, so
+// that they don't need to decode the setup of every task of every
+// change each time. Whether a change is still in progress is only
+// checked for the changes touching the snaps of interest.
+type conflictIndex struct {
+	// affected snaps by task ID
+	affected map[string][]string
+	// IDs of the tasks affecting each snap
+	bySnap map[string]map[string]bool
+	// IDs of the tasks indexed so far for each change, in the order
+	// they were added to the change
+	changeTasks map[string][]string
+}
+
+type conflictIndexKey struct{}
+
+func cachedConflictIndex(st *state.State) *conflictIndex {
+	idx, _ := st.Cached(conflictIndexKey{}).(*conflictIndex)
+	if idx == nil {
+		idx = &conflictIndex{
+			affected:    make(map[string][]string),
+			bySnap:      make(map[string]map[string]bool),
+			changeTasks: make(map[string][]string),
+		}
+		st.Cache(conflictIndexKey{}, idx)
+	}
+	return idx
+}
+
+func (idx *conflictIndex) addTask(t *state.Task) error {
+	snaps, err := affectedSnaps(t)
+	if err != nil {
+		return err
+	}
+	tid := t.ID()
+	idx.affected[tid] = snaps
+	for _, snap := range snaps {
+		tids := idx.bySnap[snap]
+		if tids == nil {
+			tids = make(map[string]bool)
+			idx.bySnap[snap] = tids
+		}
+		tids[tid] = true
+	}
+	return nil
+}
+
+func (idx *conflictIndex) dropChange(chgID string) {
+	for _, tid := range idx.changeTasks[chgID] {
+		for _, snap := range idx.affected[tid] {
+			tids := idx.bySnap[snap]
+			delete(tids, tid)
+			if len(tids) == 0 {
+				delete(idx.bySnap, snap)
+			}
+		}
+		delete(idx.affected, tid)
+	}
+	delete(idx.changeTasks, chgID)
+}
+
+// update indexes the tasks added to changes since the last update and
+// forgets the changes that were pruned. Like the conflict checks, it does
+// not fail because of the tasks of the ignored change or of
+// become-operational changes, those are never reported as conflicting.
+func (idx *conflictIndex) update(changes []*state.Change, ignoreChangeID string) error {
+	present := make(map[string]bool, len(changes))
+	for _, chg := range changes {
+		chgID := chg.ID()
+		present[chgID] = true
+		if chg.Kind() == "become-operational" {
+			continue
+		}
+		indexed := idx.changeTasks[chgID]
+		if chg.TaskCount() == len(indexed) {
+			continue
+		}
+		// tasks are only ever appended to a change
+		for _, t := range chg.Tasks()[len(indexed):] {
+			if err := idx.addTask(t); err != nil && !chg.Status().Ready() {
+				if ignoreChangeID != "" && chgID == ignoreChangeID {
+					// index it once it is not ignored anymore
+					break
+				}
+				return err
+			}
+			indexed = append(indexed, t.ID())
+			idx.changeTasks[chgID] = indexed
+		}
+	}
+	for chgID := range idx.changeTasks {
+		if !present[chgID] {
+			idx.dropChange(chgID)
+		}
+	}
+	return nil
+}
+
 // CheckChangeConflictMany ensures that for the given instanceNames no other
 // changes that alters the snaps (like remove, install, refresh) are in
 // progress. If a conflict is detected an error is returned.
@@ -97,19 +196,19 @@ func affectedSnaps(t *state.Task) ([]string, error) {
 // It's like CheckChangeConflict, but for multiple snaps, and does not
 // check snapst.
 func CheckChangeConflictMany(st *state.State, instanceNames []string, ignoreChangeID string) error {
-	snapMap := make(map[string]bool, len(instanceNames))
-	for _, k := range instanceNames {
-		snapMap[k] = true
-	}
-
-	for _, chg := range st.Changes() {
+	changes := st.Changes()
+	for _, chg := range changes {
+		kind := chg.Kind()
+		if kind != "transition-ubuntu-core" && kind != "remodel" {
+			continue
+		}
 		if chg.Status().Ready() {
 			continue
 		}
-		if chg.Kind() == "transition-ubuntu-core" {
+		if kind == "transition-ubuntu-core" {
 			return &ChangeConflictError{Message: "ubuntu-core to core transition in progress, no other changes allowed until this is done", ChangeKind: "transition-ubuntu-core"}
 		}
-		if chg.Kind() == "remodel" {
+		if kind == "remodel" {
 			if ignoreChangeID != "" && chg.ID() == ignoreChangeID {
 				continue
 			}
@@ -117,32 +216,33 @@ func CheckChangeConflictMany(st *state.State, instanceNames []string, ignoreChan
 		}
 	}
 
-	for _, task := range st.Tasks() {
-		chg := task.Change()
-		if chg == nil || chg.Status().Ready() {
-			continue
-		}
-		if ignoreChangeID != "" && chg.ID() == ignoreChangeID {
-			continue
-		}
-		if chg.Kind() == "become-operational" {
-			// become-operational will be retried until success
-			// and on its own just runs a hook on gadget:
-			// do not make it interfere with user requests
-			// TODO: consider a use vs change modeling of
-			// conflicts
-			continue
-		}
-
-		snaps, err := affectedSnaps(task)
-		if err != nil {
-			return err
-		}
+	idx := cachedConflictIndex(st)
+	if err := idx.update(changes, ignoreChangeID); err != nil {
+		return err
+	}
 
-		for _, snap := range snaps {
-			if snapMap[snap] {
-				return &ChangeConflictError{Snap: snap, ChangeKind: chg.Kind()}
+	for _, snap := range instanceNames {
+		for tid := range idx.bySnap[snap] {
+			task := st.Task(tid)
+			if task == nil {
+				continue
+			}
+			chg := task.Change()
+			if chg == nil || chg.Status().Ready() {
+				continue
+			}
+			if ignoreChangeID != "" && chg.ID() == ignoreChangeID {
+				continue
+			}
+			if chg.Kind() == "become-operational" {
+				// become-operational will be retried until success
+				// and on its own just runs a hook on gadget:
+				// do not make it interfere with user requests
+				// TODO: consider a use vs change modeling of
+				// conflicts
+				continue
 			}
+			return &ChangeConflictError{Snap: snap, ChangeKind: chg.Kind()}
 		}
 	}
 
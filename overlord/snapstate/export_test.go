@@ -138,6 +138,10 @@ func MockCatalogRefreshNextRefresh(cr *catalogRefresh, when time.Time) {
 	cr.nextCatalogRefresh = when
 }
 
+func MockCatalogRefreshDeferredUntil(cr *catalogRefresh, when time.Time) {
+	cr.deferredUntil = when
+}
+
 func NextCatalogRefresh(cr *catalogRefresh) time.Time {
 	return cr.nextCatalogRefresh
 }
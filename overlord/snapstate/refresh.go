@@ -23,14 +23,11 @@ import (
 	"bufio"
 	"fmt"
 	"io"
-	"os"
-	"path/filepath"
 	"sort"
 	"strconv"
 	"strings"
 
 	"github.com/snapcore/snapd/cmd/snaplock"
-	"github.com/snapcore/snapd/dirs"
 	"github.com/snapcore/snapd/snap"
 )
 
@@ -202,16 +199,8 @@ func parsePids(reader io.Reader) ([]int, error) {
 
 // pidsOfSecurityTag returns a list of PIDs belonging to a given security tag.
 //
-// The list is obtained from a pids cgroup.
+// The list is obtained from a pids cgroup, which is only read when the
+// cgroup tracker does not know it to be missing or empty.
 func pidsOfSecurityTag(securityTag string) ([]int, error) {
-	fname := filepath.Join(dirs.PidsCgroupDir, securityTag, "cgroup.procs")
-	file, err := os.Open(fname)
-	if os.IsNotExist(err) {
-		return nil, nil
-	}
-	if err != nil {
-		return nil, err
-	}
-	defer file.Close()
-	return parsePids(bufio.NewReader(file))
+	return currentCgroupTracker().pids(securityTag)
 }
@@ -161,3 +161,40 @@ func (s *refreshSuite) TestHardNothingRunningRefreshCheck(c *C) {
 	c.Check(err.Error(), Equals, `snap "foo" has running hooks (configure)`)
 	c.Check(err.(*snapstate.BusySnapError).Pids(), DeepEquals, []int{105})
 }
+
+func (s *refreshSuite) TestRefreshCheckCgroupV1(c *C) {
+	// The cgroups of the v1 pids controller are kept after their
+	// processes exited: the list of processes is read on every check.
+	writePids(c, s.appPath, []int{101})
+	err := snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Assert(err, NotNil)
+	c.Check(err.(*snapstate.BusySnapError).Pids(), DeepEquals, []int{101})
+
+	writePids(c, s.appPath, nil)
+	err = snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Check(err, IsNil)
+
+	writePids(c, s.appPath, []int{102})
+	err = snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Assert(err, NotNil)
+	c.Check(err.(*snapstate.BusySnapError).Pids(), DeepEquals, []int{102})
+}
+
+func (s *refreshSuite) TestRefreshCheckFollowsCgroupRemoval(c *C) {
+	writePids(c, s.appPath, []int{101})
+	writePids(c, s.hookPath, []int{105})
+	err := snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Assert(err, NotNil)
+	c.Check(err.(*snapstate.BusySnapError).Pids(), DeepEquals, []int{101, 105})
+
+	c.Assert(os.RemoveAll(s.appPath), IsNil)
+	c.Assert(os.RemoveAll(s.hookPath), IsNil)
+	err = snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Check(err, IsNil)
+
+	// and created again
+	writePids(c, s.appPath, []int{102})
+	err = snapstate.SoftNothingRunningRefreshCheck(s.info)
+	c.Assert(err, NotNil)
+	c.Check(err.(*snapstate.BusySnapError).Pids(), DeepEquals, []int{102})
+}
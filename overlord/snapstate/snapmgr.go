@@ -430,6 +430,12 @@ func (m *SnapManager) StartUp() error {
 	return nil
 }
 
+// DeferUntil implements StateDeferrer.DeferUntil, the catalogs are not
+// refreshed before the given time.
+func (m *SnapManager) DeferUntil(t time.Time) {
+	m.catalogRefresh.deferredUntil = t
+}
+
 func (m *SnapManager) CanStandby() bool {
 	if n, err := NumSnaps(m.state); err == nil && n == 0 {
 		return true
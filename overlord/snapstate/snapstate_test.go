@@ -12899,6 +12899,95 @@ func (s *snapmgrTestSuite) TestConflictMany(c *C) {
 	}
 }
 
+func (s *snapmgrTestSuite) TestConflictManyFollowsChanges(c *C) {
+	s.state.Lock()
+	defer s.state.Unlock()
+
+	newSetupTask := func(instanceName string) *state.Task {
+		t := s.state.NewTask("link-snap", "...")
+		t.Set("snap-setup", &snapstate.SnapSetup{
+			SideInfo: &snap.SideInfo{RealName: instanceName},
+		})
+		return t
+	}
+
+	chg1 := s.state.NewChange("install", "...")
+	chg1.AddTask(newSetupTask("a-snap"))
+	c.Check(snapstate.CheckChangeConflictMany(s.state, []string{"b-snap"}, ""), IsNil)
+	err := snapstate.CheckChangeConflictMany(s.state, []string{"a-snap"}, "")
+	c.Check(err, ErrorMatches, `snap "a-snap" has "install" change in progress`)
+	c.Check(snapstate.CheckChangeConflictMany(s.state, []string{"a-snap"}, chg1.ID()), IsNil)
+
+	// tasks added to a change after a check are taken into account
+	chg1.AddTask(newSetupTask("b-snap"))
+	err = snapstate.CheckChangeConflictMany(s.state, []string{"b-snap"}, "")
+	c.Check(err, ErrorMatches, `snap "b-snap" has "install" change in progress`)
+
+	// and so are new changes
+	chg2 := s.state.NewChange("refresh", "...")
+	chg2.AddTask(newSetupTask("c-snap"))
+	err = snapstate.CheckChangeConflictMany(s.state, []string{"c-snap"}, "")
+	c.Check(err, ErrorMatches, `snap "c-snap" has "refresh" change in progress`)
+
+	// ready changes don't conflict
+	chg1.SetStatus(state.DoneStatus)
+	c.Check(snapstate.CheckChangeConflictMany(s.state, []string{"a-snap", "b-snap"}, ""), IsNil)
+
+	// pruned changes are forgotten
+	chg2.SetStatus(state.DoneStatus)
+	s.state.Prune(-time.Hour, time.Hour, 100)
+	c.Check(s.state.Change(chg1.ID()), IsNil)
+	c.Check(snapstate.CheckChangeConflictMany(s.state, []string{"a-snap", "b-snap", "c-snap"}, ""), IsNil)
+}
+
+func (s *snapmgrTestSuite) TestConflictManyIgnoresBrokenTasksOfSkippedChanges(c *C) {
+	s.state.Lock()
+	defer s.state.Unlock()
+
+	newBrokenTask := func() *state.Task {
+		t := s.state.NewTask("link-snap", "...")
+		t.Set("snap-setup-task", "missing")
+		return t
+	}
+
+	chg1 := s.state.NewChange("install", "...")
+	chg1.AddTask(newBrokenTask())
+	chg2 := s.state.NewChange("become-operational", "...")
+	chg2.AddTask(newBrokenTask())
+
+	// neither the ignored change nor become-operational are looked at
+	c.Check(snapstate.CheckChangeConflictMany(s.state, []string{"a-snap"}, chg1.ID()), IsNil)
+	// but the broken task is reported once the change is not ignored
+	err := snapstate.CheckChangeConflictMany(s.state, []string{"a-snap"}, "")
+	c.Check(err, ErrorMatches, `internal error: cannot obtain snap setup from task: \.\.\.`)
+}
+
+func BenchmarkCheckChangeConflictMany(b *testing.B) {
+	st := state.New(nil)
+	st.Lock()
+	defer st.Unlock()
+
+	// 50 in-flight changes with a few tasks each
+	for i := 0; i < 50; i++ {
+		instanceName := fmt.Sprintf("snap-%d", i)
+		chg := st.NewChange("refresh-snap", "...")
+		for _, kind := range []string{"prerequisites", "download-snap", "mount-snap", "link-snap", "auto-connect"} {
+			t := st.NewTask(kind, "...")
+			t.Set("snap-setup", &snapstate.SnapSetup{
+				SideInfo: &snap.SideInfo{RealName: instanceName},
+			})
+			chg.AddTask(t)
+		}
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := snapstate.CheckChangeConflictMany(st, []string{"other-snap"}, ""); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
 func (s *snapmgrTestSuite) TestConflictManyRemodeling(c *C) {
 	s.state.Lock()
 	defer s.state.Unlock()
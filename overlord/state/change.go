@@ -477,6 +477,12 @@ func (c *Change) Tasks() []*Task {
 	return c.state.tasksIn(c.taskIDs)
 }
 
+// TaskCount returns the number of tasks this state change depends on.
+func (c *Change) TaskCount() int {
+	c.state.reading()
+	return len(c.taskIDs)
+}
+
 // LaneTasks returns all tasks from given lanes the state change depends on.
 func (c *Change) LaneTasks(lanes ...int) []*Task {
 	laneLookup := make(map[int]bool)
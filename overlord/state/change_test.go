@@ -125,6 +125,7 @@ func (cs *changeSuite) TestAddAll(c *C) {
 
 	tasks := chg.Tasks()
 	c.Check(tasks, DeepEquals, []*state.Task{t1, t2})
+	c.Check(chg.TaskCount(), Equals, 2)
 	c.Check(t1.Change(), Equals, chg)
 	c.Check(t2.Change(), Equals, chg)
 }
@@ -21,9 +21,13 @@ package overlord
 
 import (
 	"fmt"
+	"sort"
+	"strings"
 	"sync"
+	"time"
 
 	"github.com/snapcore/snapd/logger"
+	"github.com/snapcore/snapd/timings"
 
 	"github.com/snapcore/snapd/overlord/state"
 )
@@ -43,6 +47,26 @@ type StateStarterUp interface {
 	StartUp() error
 }
 
+// StateEnsureScheduler is optionally implemented by StateManagers that
+// know when their Ensure has something to do next, their Ensure is
+// skipped until then.
+type StateEnsureScheduler interface {
+	// NextEnsure returns the time from which Ensure has something
+	// to do again. A zero time means only once an event makes the
+	// manager due: the manager must then return a time not after
+	// now and request an ensure via State.EnsureBefore.
+	NextEnsure() time.Time
+}
+
+// StateDeferrer is optionally implemented by StateManagers that have
+// initialization or housekeeping which is not needed to serve requests,
+// and which can be held off for a while after startup.
+type StateDeferrer interface {
+	// DeferUntil asks the manager not to perform its deferrable
+	// work before the given time.
+	DeferUntil(t time.Time)
+}
+
 // StateWaiter is optionally implemented by StateManagers that have running
 // activities that can be waited.
 type StateWaiter interface {
@@ -70,11 +94,32 @@ type StateEngine struct {
 	state     *state.State
 	stopped   bool
 	startedUp bool
+	// deferredUntil is set while the work deferred by DeferUntil
+	// has not been given its Ensure yet
+	deferredUntil time.Time
 	// managers in use
 	mgrLock  sync.Mutex
 	managers []StateManager
+	// ensureStats holds the durations of the Ensure of each manager
+	// since ensureStatsSince
+	ensureStats      map[string]*ensureStats
+	ensureStatsSince time.Time
+	// startupTimings are held until startup is over to be saved
+	// in one go
+	startupTimings []*timings.Timings
 }
 
+// ensureStats accumulates the durations of the Ensure calls of a manager.
+type ensureStats struct {
+	count int
+	total time.Duration
+	max   time.Duration
+}
+
+// ensureTimingsInterval is how often at most the slowest Ensure of
+// the managers is saved in the timings.
+var ensureTimingsInterval = 6 * time.Hour
+
 // NewStateEngine returns a new state engine.
 func NewStateEngine(s *state.State) *StateEngine {
 	return &StateEngine{
@@ -96,6 +141,8 @@ func (e *startupError) Error() string {
 }
 
 // StartUp asks all managers to perform any expensive initialization. It is a noop after the first invocation.
+// The duration of each StartUp is recorded in the timings, which are saved
+// with the first Ensure that is not holding off the deferred work.
 func (se *StateEngine) StartUp() error {
 	se.mgrLock.Lock()
 	defer se.mgrLock.Unlock()
@@ -103,21 +150,35 @@ func (se *StateEngine) StartUp() error {
 		return nil
 	}
 	se.startedUp = true
+	perfTimings := timings.New(map[string]string{"startup": "state-engine"})
 	var errs []error
 	for _, m := range se.managers {
 		if starterUp, ok := m.(StateStarterUp); ok {
-			err := starterUp.StartUp()
+			name := managerName(m)
+			var err error
+			timings.Run(perfTimings, name, fmt.Sprintf("startup %s", name), func(timings.Measurer) {
+				err = starterUp.StartUp()
+			})
 			if err != nil {
 				errs = append(errs, err)
 			}
 		}
 	}
+	se.startupTimings = append(se.startupTimings, perfTimings)
 	if len(errs) != 0 {
 		return &startupError{errs}
 	}
 	return nil
 }
 
+// addStartupTimings holds the given startup timings to be saved along
+// with the ones of StartUp.
+func (se *StateEngine) addStartupTimings(perfTimings *timings.Timings) {
+	se.mgrLock.Lock()
+	defer se.mgrLock.Unlock()
+	se.startupTimings = append(se.startupTimings, perfTimings)
+}
+
 type ensureError struct {
 	errs []error
 }
@@ -134,6 +195,10 @@ func (e *ensureError) Error() string {
 // that request, and report whether they found any critical issues. They
 // must not perform long running activities during that operation, though.
 // These should be performed in properly tracked changes and tasks.
+//
+// Managers implementing StateEnsureScheduler are skipped while they are
+// not due. The duration of each Ensure is accounted for in memory, the
+// slowest ones are saved in the timings every ensureTimingsInterval.
 func (se *StateEngine) Ensure() error {
 	se.mgrLock.Lock()
 	defer se.mgrLock.Unlock()
@@ -144,19 +209,159 @@ func (se *StateEngine) Ensure() error {
 		return fmt.Errorf("state engine already stopped")
 	}
 	var errs []error
+	now := time.Now()
 	for _, m := range se.managers {
+		if !due(m, now) {
+			continue
+		}
+		t0 := time.Now()
 		err := m.Ensure()
+		se.recordEnsure(managerName(m), time.Since(t0))
 		if err != nil {
 			logger.Noticef("state ensure error: %v", err)
 			errs = append(errs, err)
 		}
 	}
+	if !se.deferredUntil.IsZero() && !now.Before(se.deferredUntil) {
+		// the deferred work had its chance
+		se.deferredUntil = time.Time{}
+	}
+	if se.deferredUntil.IsZero() && len(se.startupTimings) != 0 {
+		// startup is over, save its timings with a single write
+		se.state.Lock()
+		for _, perfTimings := range se.startupTimings {
+			perfTimings.Save(se.state)
+		}
+		se.state.Unlock()
+		se.startupTimings = nil
+	}
+	se.saveEnsureTimings(now)
 	if len(errs) != 0 {
 		return &ensureError{errs}
 	}
 	return nil
 }
 
+func (se *StateEngine) recordEnsure(name string, d time.Duration) {
+	if se.ensureStats == nil {
+		se.ensureStats = make(map[string]*ensureStats)
+	}
+	stats := se.ensureStats[name]
+	if stats == nil {
+		stats = &ensureStats{}
+		se.ensureStats[name] = stats
+	}
+	stats.count++
+	stats.total += d
+	if d > stats.max {
+		stats.max = d
+	}
+	if d >= timings.DurationThreshold {
+		logger.Debugf("ensure of %s took %v", name, d)
+	}
+}
+
+// saveEnsureTimings saves the slowest Ensure of each manager since the
+// last time, once every ensureTimingsInterval, as saving the state is
+// not free.
+func (se *StateEngine) saveEnsureTimings(now time.Time) {
+	if se.ensureStatsSince.IsZero() {
+		se.ensureStatsSince = now
+	}
+	if now.Sub(se.ensureStatsSince) < ensureTimingsInterval {
+		return
+	}
+	perfTimings := timings.New(map[string]string{"ensure": "state-engine"})
+	names := make([]string, 0, len(se.ensureStats))
+	for name := range se.ensureStats {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	slow := false
+	for _, name := range names {
+		stats := se.ensureStats[name]
+		if stats.max < timings.DurationThreshold {
+			continue
+		}
+		summary := fmt.Sprintf("slowest of %d ensure %s, %v in total", stats.count, name, stats.total)
+		perfTimings.AddSpan(name, summary, se.ensureStatsSince, stats.max)
+		slow = true
+	}
+	se.ensureStats = nil
+	se.ensureStatsSince = now
+	if !slow {
+		return
+	}
+	se.state.Lock()
+	perfTimings.Save(se.state)
+	se.state.Unlock()
+}
+
+func due(m StateManager, now time.Time) bool {
+	scheduler, ok := m.(StateEnsureScheduler)
+	if !ok {
+		return true
+	}
+	next := scheduler.NextEnsure()
+	return !next.IsZero() && !now.Before(next)
+}
+
+func managerName(m StateManager) string {
+	return strings.TrimPrefix(fmt.Sprintf("%T", m), "*")
+}
+
+// ensureDeadlineSlack is how far in the future a deadline must be to be
+// returned by NextEnsure, the managers already due were just given their
+// chance and must not make the loop spin.
+const ensureDeadlineSlack = 10 * time.Millisecond
+
+// NextEnsure returns the earliest upcoming time at which one of the
+// managers implementing StateEnsureScheduler is due, or the deferred
+// work is to be performed, or a zero time if there is no such deadline.
+// The other managers are due at every Ensure.
+func (se *StateEngine) NextEnsure() time.Time {
+	se.mgrLock.Lock()
+	defer se.mgrLock.Unlock()
+	now := time.Now().Add(ensureDeadlineSlack)
+	var next time.Time
+	if se.deferredUntil.After(now) {
+		next = se.deferredUntil
+	}
+	for _, m := range se.managers {
+		scheduler, ok := m.(StateEnsureScheduler)
+		if !ok {
+			continue
+		}
+		t := scheduler.NextEnsure()
+		if t.After(now) && (next.IsZero() || t.Before(next)) {
+			next = t
+		}
+	}
+	return next
+}
+
+// DeferUntil asks the managers implementing StateDeferrer to hold off
+// their deferrable work until the given time, an Ensure is due then if
+// there are any.
+func (se *StateEngine) DeferUntil(t time.Time) {
+	se.mgrLock.Lock()
+	defer se.mgrLock.Unlock()
+	for _, m := range se.managers {
+		if deferrer, ok := m.(StateDeferrer); ok {
+			deferrer.DeferUntil(t)
+			se.deferredUntil = t
+		}
+	}
+}
+
+// Deferring returns whether the work held off by DeferUntil has yet to
+// be given its Ensure.
+func (se *StateEngine) Deferring() bool {
+	se.mgrLock.Lock()
+	defer se.mgrLock.Unlock()
+	return !se.deferredUntil.IsZero()
+}
+
 // AddManager adds the provided manager to take part in state operations.
 func (se *StateEngine) AddManager(m StateManager) {
 	se.mgrLock.Lock()
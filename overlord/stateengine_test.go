@@ -21,11 +21,13 @@ package overlord_test
 
 import (
 	"errors"
+	"time"
 
 	. "gopkg.in/check.v1"
 
 	"github.com/snapcore/snapd/overlord"
 	"github.com/snapcore/snapd/overlord/state"
+	"github.com/snapcore/snapd/timings"
 )
 
 type stateEngineSuite struct{}
@@ -156,6 +158,205 @@ func (ses *stateEngineSuite) TestEnsureError(c *C) {
 	c.Check(calls, DeepEquals, []string{"ensure:mgr1", "ensure:mgr2"})
 }
 
+type fakeScheduledManager struct {
+	fakeManager
+	next  time.Time
+	sleep time.Duration
+}
+
+func (fm *fakeScheduledManager) NextEnsure() time.Time {
+	return fm.next
+}
+
+func (fm *fakeScheduledManager) Ensure() error {
+	time.Sleep(fm.sleep)
+	return fm.fakeManager.Ensure()
+}
+
+var _ overlord.StateEnsureScheduler = (*fakeScheduledManager)(nil)
+
+func (ses *stateEngineSuite) TestEnsureSkipsManagersNotDue(c *C) {
+	s := state.New(nil)
+	se := overlord.NewStateEngine(s)
+
+	calls := []string{}
+
+	now := time.Now()
+	mgr1 := &fakeManager{name: "mgr1", calls: &calls}
+	due := &fakeScheduledManager{fakeManager: fakeManager{name: "due", calls: &calls}, next: now.Add(-time.Minute)}
+	later := &fakeScheduledManager{fakeManager: fakeManager{name: "later", calls: &calls}, next: now.Add(time.Hour)}
+	idle := &fakeScheduledManager{fakeManager: fakeManager{name: "idle", calls: &calls}}
+
+	se.AddManager(mgr1)
+	se.AddManager(due)
+	se.AddManager(later)
+	se.AddManager(idle)
+
+	c.Assert(se.StartUp(), IsNil)
+	calls = []string{}
+
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(calls, DeepEquals, []string{"ensure:mgr1", "ensure:due"})
+
+	// an event made idle due
+	idle.next = time.Now()
+	calls = []string{}
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(calls, DeepEquals, []string{"ensure:mgr1", "ensure:due", "ensure:idle"})
+}
+
+func (ses *stateEngineSuite) TestNextEnsure(c *C) {
+	s := state.New(nil)
+	se := overlord.NewStateEngine(s)
+
+	calls := []string{}
+	se.AddManager(&fakeManager{name: "mgr1", calls: &calls})
+	c.Check(se.NextEnsure().IsZero(), Equals, true)
+
+	now := time.Now()
+	se.AddManager(&fakeScheduledManager{next: now.Add(-time.Minute)})
+	se.AddManager(&fakeScheduledManager{})
+	c.Check(se.NextEnsure().IsZero(), Equals, true)
+
+	// managers due about now must not make the loop spin
+	se.AddManager(&fakeScheduledManager{next: time.Now().Add(time.Millisecond)})
+	c.Check(se.NextEnsure().IsZero(), Equals, true)
+
+	se.AddManager(&fakeScheduledManager{next: now.Add(time.Hour)})
+	se.AddManager(&fakeScheduledManager{next: now.Add(time.Minute)})
+	c.Check(se.NextEnsure().Equal(now.Add(time.Minute)), Equals, true)
+}
+
+func (ses *stateEngineSuite) TestEnsureRecordsTimings(c *C) {
+	s := state.New(nil)
+	se := overlord.NewStateEngine(s)
+
+	calls := []string{}
+	slow := &fakeScheduledManager{fakeManager: fakeManager{name: "slow", calls: &calls}, next: time.Now(), sleep: 2 * timings.DurationThreshold}
+	se.AddManager(slow)
+	se.AddManager(&fakeManager{name: "fast", calls: &calls})
+	c.Assert(se.StartUp(), IsNil)
+
+	ensureTimings := func() []*timings.TimingsInfo {
+		s.Lock()
+		defer s.Unlock()
+		allTimings, err := timings.Get(s, -1, func(tags map[string]string) bool {
+			return tags["ensure"] == "state-engine"
+		})
+		c.Assert(err, IsNil)
+		return allTimings
+	}
+
+	// slow passes are only accounted for in memory at first
+	c.Assert(se.Ensure(), IsNil)
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(ensureTimings(), HasLen, 0)
+
+	// and saved in one go once the interval is over
+	restore := overlord.MockEnsureTimingsInterval(0)
+	defer restore()
+	c.Assert(se.Ensure(), IsNil)
+	allTimings := ensureTimings()
+	c.Assert(allTimings, HasLen, 1)
+	c.Assert(allTimings[0].NestedTimings, HasLen, 1)
+	c.Check(allTimings[0].NestedTimings[0].Label, Equals, "overlord_test.fakeScheduledManager")
+	c.Check(allTimings[0].NestedTimings[0].Summary, Matches, "slowest of 3 ensure overlord_test.fakeScheduledManager, .* in total")
+	c.Check(allTimings[0].NestedTimings[0].Duration >= 2*timings.DurationThreshold, Equals, true)
+
+	// fast passes are not recorded
+	slow.next = time.Now().Add(time.Hour)
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(ensureTimings(), HasLen, 1)
+}
+
+type fakeSlowStarter struct {
+	fakeManager
+	sleep time.Duration
+}
+
+func (fm *fakeSlowStarter) StartUp() error {
+	time.Sleep(fm.sleep)
+	return fm.fakeManager.StartUp()
+}
+
+func (ses *stateEngineSuite) TestStartUpRecordsTimings(c *C) {
+	s := state.New(nil)
+	se := overlord.NewStateEngine(s)
+
+	calls := []string{}
+	se.AddManager(&fakeSlowStarter{fakeManager: fakeManager{name: "slow", calls: &calls}, sleep: 2 * timings.DurationThreshold})
+	se.AddManager(&fakeDeferringManager{fakeManager: fakeManager{name: "fast", calls: &calls}})
+	c.Assert(se.StartUp(), IsNil)
+	c.Check(calls, DeepEquals, []string{"startup:slow", "startup:fast"})
+
+	startupTimings := func() []*timings.TimingsInfo {
+		s.Lock()
+		defer s.Unlock()
+		allTimings, err := timings.Get(s, -1, func(tags map[string]string) bool {
+			return tags["startup"] == "state-engine"
+		})
+		c.Assert(err, IsNil)
+		return allTimings
+	}
+
+	// the timings are held while the deferred work is pending
+	c.Check(startupTimings(), HasLen, 0)
+	se.DeferUntil(time.Now().Add(time.Hour))
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(startupTimings(), HasLen, 0)
+
+	// and saved once it had its Ensure
+	se.DeferUntil(time.Now())
+	c.Assert(se.Ensure(), IsNil)
+	allTimings := startupTimings()
+	c.Assert(allTimings, HasLen, 1)
+	c.Assert(allTimings[0].NestedTimings, HasLen, 1)
+	c.Check(allTimings[0].NestedTimings[0].Label, Equals, "overlord_test.fakeSlowStarter")
+	c.Check(allTimings[0].NestedTimings[0].Summary, Equals, "startup overlord_test.fakeSlowStarter")
+}
+
+type fakeDeferringManager struct {
+	fakeManager
+	deferredUntil time.Time
+}
+
+func (fm *fakeDeferringManager) DeferUntil(t time.Time) {
+	fm.deferredUntil = t
+}
+
+var _ overlord.StateDeferrer = (*fakeDeferringManager)(nil)
+
+func (ses *stateEngineSuite) TestDeferUntil(c *C) {
+	s := state.New(nil)
+	se := overlord.NewStateEngine(s)
+
+	calls := []string{}
+	se.AddManager(&fakeManager{name: "mgr1", calls: &calls})
+	c.Assert(se.StartUp(), IsNil)
+
+	// nothing is deferred without managers that can defer work
+	until := time.Now().Add(time.Hour)
+	se.DeferUntil(until)
+	c.Check(se.Deferring(), Equals, false)
+	c.Check(se.NextEnsure().IsZero(), Equals, true)
+
+	mgr2 := &fakeDeferringManager{fakeManager: fakeManager{name: "mgr2", calls: &calls}}
+	se.AddManager(mgr2)
+	se.DeferUntil(until)
+	c.Check(mgr2.deferredUntil.Equal(until), Equals, true)
+	c.Check(se.Deferring(), Equals, true)
+	c.Check(se.NextEnsure().Equal(until), Equals, true)
+
+	// an Ensure before the deadline leaves the deferred work pending
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(se.Deferring(), Equals, true)
+
+	se.DeferUntil(time.Now())
+	c.Assert(se.Ensure(), IsNil)
+	c.Check(se.Deferring(), Equals, false)
+	c.Check(se.NextEnsure().IsZero(), Equals, true)
+}
+
 func (ses *stateEngineSuite) TestStop(c *C) {
 	s := state.New(nil)
 	se := overlord.NewStateEngine(s)
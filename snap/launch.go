@@ -0,0 +1,252 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package snap
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+
+	"github.com/snapcore/snapd/dirs"
+)
+
+// launchDescriptorFormat is bumped whenever the launch descriptor
+// changes incompatibly, descriptors of another format are ignored.
+const launchDescriptorFormat = 1
+
+// ErrStaleLaunchDescriptor is returned when a launch descriptor is
+// missing or does not describe the current revision of a snap anymore.
+var ErrStaleLaunchDescriptor = errors.New("launch descriptor is missing or stale")
+
+// LaunchDescriptor holds what is needed to start the apps and hooks of
+// the current revision of a snap, it is written when the snap is linked
+// so that "snap run" does not have to read and parse its snap.yaml.
+type LaunchDescriptor struct {
+	Format int `json:"format"`
+
+	InstanceName string          `json:"instance-name"`
+	Revision     Revision        `json:"revision"`
+	Version      string          `json:"version,omitempty"`
+	Type         Type            `json:"type"`
+	Base         string          `json:"base,omitempty"`
+	Confinement  ConfinementType `json:"confinement"`
+
+	Apps  map[string]*LaunchEntry `json:"apps,omitempty"`
+	Hooks map[string]*LaunchEntry `json:"hooks,omitempty"`
+
+	// SnapYaml identifies the snap.yaml the descriptor was built from.
+	SnapYaml LaunchFileStamp `json:"snap-yaml"`
+}
+
+// LaunchEntry describes how to launch an app or a hook.
+type LaunchEntry struct {
+	SecurityTag  string   `json:"security-tag"`
+	Command      string   `json:"command,omitempty"`
+	CommandChain []string `json:"command-chain,omitempty"`
+	PlugsDesktop bool     `json:"plugs-desktop,omitempty"`
+}
+
+// LaunchFileStamp identifies a version of a file by its size and
+// modification time.
+type LaunchFileStamp struct {
+	Size    int64 `json:"size"`
+	ModTime int64 `json:"mtime"`
+}
+
+func launchFileStamp(path string) (LaunchFileStamp, error) {
+	fi, err := os.Stat(path)
+	if err != nil {
+		return LaunchFileStamp{}, err
+	}
+	return LaunchFileStamp{Size: fi.Size(), ModTime: fi.ModTime().UnixNano()}, nil
+}
+
+// LaunchDescriptorFile returns the path of the launch descriptor of the
+// given snap instance.
+func LaunchDescriptorFile(instanceName string) string {
+	return filepath.Join(dirs.SnapLaunchDir, instanceName+".json")
+}
+
+func plugsDesktop(plugs map[string]*PlugInfo) bool {
+	for _, plug := range plugs {
+		if plug.Interface == "desktop" {
+			return true
+		}
+	}
+	return false
+}
+
+// NewLaunchDescriptor returns the launch descriptor of the given
+// mounted snap revision.
+func NewLaunchDescriptor(info *Info) (*LaunchDescriptor, error) {
+	stamp, err := launchFileStamp(filepath.Join(info.MountDir(), "meta", "snap.yaml"))
+	if err != nil {
+		return nil, err
+	}
+	desc := &LaunchDescriptor{
+		Format:       launchDescriptorFormat,
+		InstanceName: info.InstanceName(),
+		Revision:     info.Revision,
+		Version:      info.Version,
+		Type:         info.SnapType,
+		Base:         info.Base,
+		Confinement:  info.Confinement,
+		SnapYaml:     stamp,
+	}
+	if len(info.Apps) != 0 {
+		desc.Apps = make(map[string]*LaunchEntry, len(info.Apps))
+		for name, app := range info.Apps {
+			desc.Apps[name] = &LaunchEntry{
+				SecurityTag:  app.SecurityTag(),
+				Command:      app.Command,
+				CommandChain: app.CommandChain,
+				PlugsDesktop: plugsDesktop(app.Plugs),
+			}
+		}
+	}
+	if len(info.Hooks) != 0 {
+		desc.Hooks = make(map[string]*LaunchEntry, len(info.Hooks))
+		for name, hook := range info.Hooks {
+			desc.Hooks[name] = &LaunchEntry{
+				SecurityTag:  hook.SecurityTag(),
+				CommandChain: hook.CommandChain,
+				PlugsDesktop: plugsDesktop(hook.Plugs),
+			}
+		}
+	}
+	return desc, nil
+}
+
+// Info returns the subset of the snap information, as needed to launch
+// its apps and hooks, recorded in the launch descriptor.
+func (desc *LaunchDescriptor) Info() *Info {
+	snapName, instanceKey := SplitInstanceName(desc.InstanceName)
+	info := &Info{
+		SuggestedName: snapName,
+		InstanceKey:   instanceKey,
+		Version:       desc.Version,
+		SnapType:      desc.Type,
+		Base:          desc.Base,
+		Confinement:   desc.Confinement,
+		SideInfo: SideInfo{
+			RealName: snapName,
+			Revision: desc.Revision,
+		},
+		Apps:  make(map[string]*AppInfo, len(desc.Apps)),
+		Hooks: make(map[string]*HookInfo, len(desc.Hooks)),
+	}
+	desktopPlug := func() map[string]*PlugInfo {
+		return map[string]*PlugInfo{
+			"desktop": {Snap: info, Name: "desktop", Interface: "desktop"},
+		}
+	}
+	for name, entry := range desc.Apps {
+		app := &AppInfo{
+			Snap:         info,
+			Name:         name,
+			Command:      entry.Command,
+			CommandChain: entry.CommandChain,
+		}
+		if entry.PlugsDesktop {
+			app.Plugs = desktopPlug()
+		}
+		info.Apps[name] = app
+	}
+	for name, entry := range desc.Hooks {
+		hook := &HookInfo{
+			Snap:         info,
+			Name:         name,
+			CommandChain: entry.CommandChain,
+		}
+		if entry.PlugsDesktop {
+			hook.Plugs = desktopPlug()
+		}
+		info.Hooks[name] = hook
+	}
+	return info
+}
+
+// ReadLaunchDescriptor reads the launch descriptor of the given revision
+// of the given snap instance. It returns ErrStaleLaunchDescriptor if the
+// descriptor is missing or does not match the mounted snap.yaml of the
+// revision.
+func ReadLaunchDescriptor(instanceName string, revision Revision) (*LaunchDescriptor, error) {
+	data, err := ioutil.ReadFile(LaunchDescriptorFile(instanceName))
+	if os.IsNotExist(err) {
+		return nil, ErrStaleLaunchDescriptor
+	}
+	if err != nil {
+		return nil, err
+	}
+	var desc LaunchDescriptor
+	if err := json.Unmarshal(data, &desc); err != nil {
+		return nil, fmt.Errorf("cannot decode launch descriptor of snap %q: %v", instanceName, err)
+	}
+	if desc.Format != launchDescriptorFormat || desc.InstanceName != instanceName || desc.Revision != revision {
+		return nil, ErrStaleLaunchDescriptor
+	}
+	stamp, err := launchFileStamp(filepath.Join(MountDir(instanceName, revision), "meta", "snap.yaml"))
+	if err != nil || stamp != desc.SnapYaml {
+		return nil, ErrStaleLaunchDescriptor
+	}
+	return &desc, nil
+}
+
+// ReadLaunchInfo returns the snap information needed to launch the apps
+// and hooks of the given revision of the given snap from its launch
+// descriptor. It returns ErrStaleLaunchDescriptor if the descriptor is
+// missing or stale, ReadInfo should be used then.
+func ReadLaunchInfo(instanceName string, revision Revision) (*Info, error) {
+	desc, err := ReadLaunchDescriptor(instanceName, revision)
+	if err != nil {
+		return nil, err
+	}
+	info := desc.Info()
+	// the security tags are what the security profiles were
+	// generated for, they must not have changed
+	for name, app := range info.Apps {
+		if app.SecurityTag() != desc.Apps[name].SecurityTag {
+			return nil, ErrStaleLaunchDescriptor
+		}
+	}
+	for name, hook := range info.Hooks {
+		if hook.SecurityTag() != desc.Hooks[name].SecurityTag {
+			return nil, ErrStaleLaunchDescriptor
+		}
+	}
+	return info, nil
+}
+
+// ReadCurrentLaunchInfo is like ReadLaunchInfo for the current revision
+// of the given snap.
+func ReadCurrentLaunchInfo(instanceName string) (*Info, error) {
+	realFn, err := os.Readlink(filepath.Join(dirs.SnapMountDir, instanceName, "current"))
+	if err != nil {
+		return nil, ErrStaleLaunchDescriptor
+	}
+	revision, err := ParseRevision(filepath.Base(realFn))
+	if err != nil {
+		return nil, ErrStaleLaunchDescriptor
+	}
+	return ReadLaunchInfo(instanceName, revision)
+}
@@ -0,0 +1,140 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package snap_test
+
+import (
+	"encoding/json"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"time"
+
+	. "gopkg.in/check.v1"
+
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/snap"
+	"github.com/snapcore/snapd/snap/snaptest"
+)
+
+type launchSuite struct{}
+
+var _ = Suite(&launchSuite{})
+
+func (s *launchSuite) SetUpTest(c *C) {
+	dirs.SetRootDir(c.MkDir())
+}
+
+func (s *launchSuite) TearDownTest(c *C) {
+	dirs.SetRootDir("")
+}
+
+const launchYaml = `name: foo
+version: 1.2
+base: core18
+confinement: classic
+apps:
+  app:
+    command: bin/app
+    command-chain: [bin/chain]
+    plugs: [desktop]
+  cli:
+    command: bin/cli
+hooks:
+  configure:
+`
+
+func writeLaunchDescriptor(c *C, info *snap.Info) *snap.LaunchDescriptor {
+	desc, err := snap.NewLaunchDescriptor(info)
+	c.Assert(err, IsNil)
+	data, err := json.Marshal(desc)
+	c.Assert(err, IsNil)
+	c.Assert(os.MkdirAll(dirs.SnapLaunchDir, 0755), IsNil)
+	c.Assert(ioutil.WriteFile(snap.LaunchDescriptorFile(info.InstanceName()), data, 0644), IsNil)
+	return desc
+}
+
+func (s *launchSuite) TestReadCurrentLaunchInfo(c *C) {
+	info := snaptest.MockSnapInstanceCurrent(c, "foo_bar", launchYaml, &snap.SideInfo{Revision: snap.R(7)})
+	writeLaunchDescriptor(c, info)
+
+	linfo, err := snap.ReadCurrentLaunchInfo("foo_bar")
+	c.Assert(err, IsNil)
+	c.Check(linfo.InstanceName(), Equals, "foo_bar")
+	c.Check(linfo.SnapName(), Equals, "foo")
+	c.Check(linfo.InstanceKey, Equals, "bar")
+	c.Check(linfo.Revision, Equals, snap.R(7))
+	c.Check(linfo.Version, Equals, "1.2")
+	c.Check(linfo.Base, Equals, "core18")
+	c.Check(linfo.NeedsClassic(), Equals, true)
+	c.Check(linfo.MountDir(), Equals, info.MountDir())
+
+	c.Assert(linfo.Apps, HasLen, 2)
+	app := linfo.Apps["app"]
+	c.Check(app.SecurityTag(), Equals, "snap.foo_bar.app")
+	c.Check(app.Command, Equals, "bin/app")
+	c.Check(app.CommandChain, DeepEquals, []string{"bin/chain"})
+	c.Check(app.Plugs["desktop"].Interface, Equals, "desktop")
+	c.Check(linfo.Apps["cli"].Plugs, HasLen, 0)
+	c.Assert(linfo.Hooks, HasLen, 1)
+	c.Check(linfo.Hooks["configure"].SecurityTag(), Equals, "snap.foo_bar.hook.configure")
+
+	linfo, err = snap.ReadLaunchInfo("foo_bar", snap.R(7))
+	c.Assert(err, IsNil)
+	c.Check(linfo.Revision, Equals, snap.R(7))
+}
+
+func (s *launchSuite) TestReadLaunchInfoStale(c *C) {
+	info := snaptest.MockSnap(c, launchYaml, &snap.SideInfo{Revision: snap.R(7)})
+
+	// no descriptor
+	_, err := snap.ReadLaunchInfo("foo", snap.R(7))
+	c.Check(err, Equals, snap.ErrStaleLaunchDescriptor)
+	// no current revision
+	writeLaunchDescriptor(c, info)
+	_, err = snap.ReadCurrentLaunchInfo("foo")
+	c.Check(err, Equals, snap.ErrStaleLaunchDescriptor)
+
+	// another revision
+	_, err = snap.ReadLaunchInfo("foo", snap.R(8))
+	c.Check(err, Equals, snap.ErrStaleLaunchDescriptor)
+
+	// snap.yaml changed
+	snapYaml := filepath.Join(info.MountDir(), "meta", "snap.yaml")
+	later := time.Now().Add(time.Hour)
+	c.Assert(os.Chtimes(snapYaml, later, later), IsNil)
+	_, err = snap.ReadLaunchInfo("foo", snap.R(7))
+	c.Check(err, Equals, snap.ErrStaleLaunchDescriptor)
+
+	// another format
+	desc := writeLaunchDescriptor(c, info)
+	_, err = snap.ReadLaunchInfo("foo", snap.R(7))
+	c.Check(err, IsNil)
+	desc.Format = 0
+	data, err := json.Marshal(desc)
+	c.Assert(err, IsNil)
+	c.Assert(ioutil.WriteFile(snap.LaunchDescriptorFile("foo"), data, 0644), IsNil)
+	_, err = snap.ReadLaunchInfo("foo", snap.R(7))
+	c.Check(err, Equals, snap.ErrStaleLaunchDescriptor)
+
+	// garbage
+	c.Assert(ioutil.WriteFile(snap.LaunchDescriptorFile("foo"), []byte("{"), 0644), IsNil)
+	_, err = snap.ReadLaunchInfo("foo", snap.R(7))
+	c.Check(err, ErrorMatches, `cannot decode launch descriptor of snap "foo": .*`)
+}
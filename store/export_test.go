@@ -191,3 +191,11 @@ func MockRatelimitReader(f func(r io.Reader, bucket *ratelimit.Bucket) io.Reader
 		ratelimitReader = oldRatelimitReader
 	}
 }
+
+func MockMaxConcurrentAssertionFetches(n int) (restore func()) {
+	old := maxConcurrentAssertionFetches
+	maxConcurrentAssertionFetches = n
+	return func() {
+		maxConcurrentAssertionFetches = old
+	}
+}
@@ -740,8 +740,22 @@ type SnapAdder interface {
 	AddSnap(snapName, version, summary string, commands []string) error
 }
 
+// ErrCatalogNotModified is returned by WriteCatalogs when the catalog
+// did not change since the version identified by the given validators.
+var ErrCatalogNotModified = errors.New("commands catalog not modified")
+
+// CatalogValidators identify a version of the commands catalog, they
+// are used to request the catalog only if it changed.
+type CatalogValidators struct {
+	ETag         string `json:"etag,omitempty"`
+	LastModified string `json:"last-modified,omitempty"`
+}
+
 func decodeCatalog(resp *http.Response, names io.Writer, db SnapAdder) error {
 	const what = "decode new commands catalog"
+	if resp.StatusCode == 304 {
+		return nil
+	}
 	if resp.StatusCode != 200 {
 		return respToError(resp, what)
 	}
@@ -1272,7 +1286,12 @@ func (s *Store) Sections(ctx context.Context, user *auth.UserState) ([]string, e
 
 // WriteCatalogs queries the "commands" endpoint and writes the
 // command names into the given io.Writer.
-func (s *Store) WriteCatalogs(ctx context.Context, names io.Writer, adder SnapAdder) error {
+//
+// If validators are given and not empty the catalog is requested only
+// if it changed since the version they identify, otherwise
+// ErrCatalogNotModified is returned and nothing is written. On success
+// the validators are updated to identify the written catalog.
+func (s *Store) WriteCatalogs(ctx context.Context, names io.Writer, adder SnapAdder, validators *CatalogValidators) error {
 	u := *s.endpointURL(commandsEndpPath, nil)
 
 	q := u.Query()
@@ -1289,6 +1308,14 @@ func (s *Store) WriteCatalogs(ctx context.Context, names io.Writer, adder SnapAd
 		Accept:         halJsonContentType,
 		DeviceAuthNeed: deviceAuthCustomStoreOnly,
 	}
+	if validators != nil {
+		if validators.ETag != "" {
+			reqOptions.addHeader("If-None-Match", validators.ETag)
+		}
+		if validators.LastModified != "" {
+			reqOptions.addHeader("If-Modified-Since", validators.LastModified)
+		}
+	}
 
 	// do not log body for catalog updates (its huge)
 	client := httputil.NewHTTPClient(&httputil.ClientOptions{
@@ -1307,10 +1334,18 @@ func (s *Store) WriteCatalogs(ctx context.Context, names io.Writer, adder SnapAd
 	if err != nil {
 		return err
 	}
+	if resp.StatusCode == 304 {
+		return ErrCatalogNotModified
+	}
 	if resp.StatusCode != 200 {
 		return respToError(resp, "refresh commands catalog")
 	}
 
+	if validators != nil {
+		validators.ETag = resp.Header.Get("ETag")
+		validators.LastModified = resp.Header.Get("Last-Modified")
+	}
+
 	return nil
 }
 
@@ -1830,6 +1865,57 @@ func (s *Store) Assertion(assertType *asserts.AssertionType, primaryKey []string
 	return asrt, err
 }
 
+// maxConcurrentAssertionFetches bounds the number of assertion
+// requests issued in parallel by Assertions.
+var maxConcurrentAssertionFetches = 8
+
+// Assertions retrieves the assertions for the given references. The
+// assertion service has no bulk endpoint, so the assertions are
+// fetched with concurrent requests. Assertions that cannot be found
+// are skipped, any other error is returned.
+func (s *Store) Assertions(refs []*asserts.Ref, user *auth.UserState) ([]asserts.Assertion, error) {
+	n := len(refs)
+	if n == 0 {
+		return nil, nil
+	}
+	workers := maxConcurrentAssertionFetches
+	if workers > n {
+		workers = n
+	}
+
+	results := make([]asserts.Assertion, n)
+	errs := make([]error, n)
+	indexes := make(chan int, n)
+	for i := range refs {
+		indexes <- i
+	}
+	close(indexes)
+
+	var wg sync.WaitGroup
+	wg.Add(workers)
+	for w := 0; w < workers; w++ {
+		go func() {
+			defer wg.Done()
+			for i := range indexes {
+				results[i], errs[i] = s.Assertion(refs[i].Type, refs[i].PrimaryKey, user)
+			}
+		}()
+	}
+	wg.Wait()
+
+	found := make([]asserts.Assertion, 0, n)
+	for i, err := range errs {
+		if asserts.IsNotFound(err) {
+			continue
+		}
+		if err != nil {
+			return nil, err
+		}
+		found = append(found, results[i])
+	}
+	return found, nil
+}
+
 // SuggestedCurrency retrieves the cached value for the store's suggested currency
 func (s *Store) SuggestedCurrency() string {
 	s.mu.Lock()
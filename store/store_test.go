@@ -2882,7 +2882,7 @@ func (s *storeTestSuite) testSnapCommands(c *C, onClassic bool) {
 	defer db.Rollback()
 
 	var bufNames bytes.Buffer
-	err = sto.WriteCatalogs(s.ctx, &bufNames, db)
+	err = sto.WriteCatalogs(s.ctx, &bufNames, db, nil)
 	c.Assert(err, IsNil)
 	db.Commit()
 	c.Check(bufNames.String(), Equals, "bar\nfoo\n")
@@ -2898,6 +2898,74 @@ func (s *storeTestSuite) testSnapCommands(c *C, onClassic bool) {
 	c.Check(n, Equals, 1)
 }
 
+func (s *storeTestSuite) TestSnapCommandsNotModified(c *C) {
+	c.Assert(os.MkdirAll(dirs.SnapCacheDir, 0755), IsNil)
+
+	const etag = `"catalog-1"`
+	const lastModified = "Mon, 07 Oct 2019 10:00:00 GMT"
+	n := 0
+	mockServer := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		c.Check(r.URL.Path, Equals, "/api/v1/snaps/names")
+		n++
+
+		if r.Header.Get("If-None-Match") == etag {
+			c.Check(r.Header.Get("If-Modified-Since"), Equals, lastModified)
+			w.WriteHeader(304)
+			return
+		}
+		c.Check(r.Header.Get("If-None-Match"), Equals, "")
+		c.Check(r.Header.Get("If-Modified-Since"), Equals, "")
+
+		w.Header().Set("Content-Type", "application/hal+json")
+		w.Header().Set("ETag", etag)
+		w.Header().Set("Last-Modified", lastModified)
+		w.WriteHeader(200)
+		io.WriteString(w, mockNamesJSON)
+	}))
+	c.Assert(mockServer, NotNil)
+	defer mockServer.Close()
+
+	serverURL, _ := url.Parse(mockServer.URL)
+	dauthCtx := &testDauthContext{c: c, device: s.device}
+	sto := store.New(&store.Config{StoreBaseURL: serverURL}, dauthCtx)
+
+	// a first refresh gets the whole catalog and its validators
+	var validators store.CatalogValidators
+	db, err := advisor.Update()
+	c.Assert(err, IsNil)
+	var bufNames bytes.Buffer
+	err = sto.WriteCatalogs(s.ctx, &bufNames, db, &validators)
+	c.Assert(err, IsNil)
+	c.Assert(db.Commit(), IsNil)
+	c.Check(bufNames.String(), Equals, "bar\nfoo\n")
+	c.Check(validators, Equals, store.CatalogValidators{ETag: etag, LastModified: lastModified})
+
+	dbContent, err := ioutil.ReadFile(dirs.SnapCommandsDB)
+	c.Assert(err, IsNil)
+
+	// the catalog did not change, nothing gets written
+	db, err = advisor.Update()
+	c.Assert(err, IsNil)
+	bufNames.Reset()
+	err = sto.WriteCatalogs(s.ctx, &bufNames, db, &validators)
+	c.Assert(err, Equals, store.ErrCatalogNotModified)
+	c.Assert(db.Rollback(), IsNil)
+	c.Check(bufNames.String(), Equals, "")
+	c.Check(validators, Equals, store.CatalogValidators{ETag: etag, LastModified: lastModified})
+	c.Check(dirs.SnapCommandsDB, testutil.FileEquals, dbContent)
+
+	// the same catalog fetched again unconditionally changes nothing
+	// in the commands database either
+	db, err = advisor.Update()
+	c.Assert(err, IsNil)
+	err = sto.WriteCatalogs(s.ctx, &bufNames, db, nil)
+	c.Assert(err, IsNil)
+	c.Assert(db.Commit(), IsNil)
+	c.Check(dirs.SnapCommandsDB, testutil.FileEquals, dbContent)
+
+	c.Check(n, Equals, 3)
+}
+
 func (s *storeTestSuite) TestSnapCommandsTooMany(c *C) {
 	c.Assert(os.MkdirAll(dirs.SnapCacheDir, 0755), IsNil)
 
@@ -2927,7 +2995,7 @@ func (s *storeTestSuite) TestSnapCommandsTooMany(c *C) {
 	defer db.Rollback()
 
 	var bufNames bytes.Buffer
-	err = sto.WriteCatalogs(s.ctx, &bufNames, db)
+	err = sto.WriteCatalogs(s.ctx, &bufNames, db, nil)
 	c.Assert(err, Equals, store.ErrTooManyRequests)
 	db.Commit()
 	c.Check(bufNames.String(), Equals, "")
@@ -3596,6 +3664,101 @@ func (s *storeTestSuite) TestAssertion500(c *C) {
 	c.Assert(n, Equals, 5)
 }
 
+func (s *storeTestSuite) TestAssertionsConcurrent(c *C) {
+	restore := store.MockMaxConcurrentAssertionFetches(4)
+	defer restore()
+
+	var mu sync.Mutex
+	requests := 0
+	inFlight := 0
+	maxInFlight := 0
+	mockServer := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		assertRequest(c, r, "GET", "/api/v1/snaps/assertions/.*")
+		mu.Lock()
+		requests++
+		inFlight++
+		if inFlight > maxInFlight {
+			maxInFlight = inFlight
+		}
+		mu.Unlock()
+		defer func() {
+			mu.Lock()
+			inFlight--
+			mu.Unlock()
+		}()
+		time.Sleep(20 * time.Millisecond)
+
+		if strings.HasSuffix(r.URL.Path, "/missing") {
+			w.Header().Set("Content-Type", "application/problem+json")
+			w.WriteHeader(404)
+			io.WriteString(w, `{"status": 404,"title": "not found"}`)
+			return
+		}
+		io.WriteString(w, testAssertion)
+	}))
+
+	c.Assert(mockServer, NotNil)
+	defer mockServer.Close()
+
+	mockServerURL, _ := url.Parse(mockServer.URL)
+	cfg := store.Config{
+		AssertionsBaseURL: mockServerURL,
+	}
+	sto := store.New(&cfg, nil)
+
+	var refs []*asserts.Ref
+	for i := 0; i < 12; i++ {
+		refs = append(refs, &asserts.Ref{
+			Type:       asserts.SnapDeclarationType,
+			PrimaryKey: []string{"16", fmt.Sprintf("snapid%d", i)},
+		})
+	}
+	refs = append(refs, &asserts.Ref{
+		Type:       asserts.SnapDeclarationType,
+		PrimaryKey: []string{"16", "missing"},
+	})
+
+	as, err := sto.Assertions(refs, nil)
+	c.Assert(err, IsNil)
+	// the missing one is skipped
+	c.Check(as, HasLen, 12)
+	for _, a := range as {
+		c.Check(a.Type(), Equals, asserts.SnapDeclarationType)
+	}
+	c.Check(requests, Equals, 13)
+	c.Check(maxInFlight > 1, Equals, true)
+	c.Check(maxInFlight <= 4, Equals, true)
+}
+
+func (s *storeTestSuite) TestAssertionsError(c *C) {
+	mockServer := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		assertRequest(c, r, "GET", "/api/v1/snaps/assertions/.*")
+		if strings.HasSuffix(r.URL.Path, "/broken") {
+			w.Header().Set("Content-Type", "application/problem+json")
+			w.WriteHeader(400)
+			io.WriteString(w, `{"status": 400,"title": "bad request", "detail": "broken"}`)
+			return
+		}
+		io.WriteString(w, testAssertion)
+	}))
+
+	c.Assert(mockServer, NotNil)
+	defer mockServer.Close()
+
+	mockServerURL, _ := url.Parse(mockServer.URL)
+	cfg := store.Config{
+		AssertionsBaseURL: mockServerURL,
+	}
+	sto := store.New(&cfg, nil)
+
+	refs := []*asserts.Ref{
+		{Type: asserts.SnapDeclarationType, PrimaryKey: []string{"16", "snapidfoo"}},
+		{Type: asserts.SnapDeclarationType, PrimaryKey: []string{"16", "broken"}},
+	}
+	_, err := sto.Assertions(refs, nil)
+	c.Check(err, ErrorMatches, `assertion service error: \[bad request\] "broken"`)
+}
+
 func (s *storeTestSuite) TestSuggestedCurrency(c *C) {
 	suggestedCurrency := "GBP"
 
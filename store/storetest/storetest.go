@@ -85,7 +85,7 @@ func (Store) Assertion(*asserts.AssertionType, []string, *auth.UserState) (asser
 	panic("Store.Assertion not expected")
 }
 
-func (Store) WriteCatalogs(context.Context, io.Writer, store.SnapAdder) error {
+func (Store) WriteCatalogs(context.Context, io.Writer, store.SnapAdder, *store.CatalogValidators) error {
 	panic("fakeStore.WriteCatalogs not expected")
 }
 
@@ -0,0 +1,493 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package systemd
+
+import (
+	"fmt"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/godbus/dbus"
+
+	"github.com/snapcore/snapd/logger"
+)
+
+const (
+	systemdBusName      = "org.freedesktop.systemd1"
+	systemdObjectPath   = dbus.ObjectPath("/org/freedesktop/systemd1")
+	systemdManagerIface = "org.freedesktop.systemd1.Manager"
+	systemdUnitIface    = "org.freedesktop.systemd1.Unit"
+)
+
+var (
+	dbusMu      sync.Mutex
+	dbusEnabled bool
+	dbusConn    *dbus.Conn
+
+	// dbusSystemBus returns a connection to the bus where the systemd
+	// manager is found.
+	dbusSystemBus = systemBusPrivate
+)
+
+// UseDBus makes New return a Systemd that talks to the systemd manager over
+// D-Bus instead of running systemctl, when possible. Operations that cannot
+// be done over D-Bus, or that fail at the D-Bus level, fall back to
+// systemctl.
+func UseDBus(enabled bool) {
+	dbusMu.Lock()
+	defer dbusMu.Unlock()
+	dbusEnabled = enabled
+}
+
+func systemBusPrivate() (*dbus.Conn, error) {
+	// use a private connection so that only the signals this package
+	// subscribes to are delivered to it
+	conn, err := dbus.SystemBusPrivate()
+	if err != nil {
+		return nil, err
+	}
+	if err := conn.Auth(nil); err != nil {
+		conn.Close()
+		return nil, err
+	}
+	if err := conn.Hello(); err != nil {
+		conn.Close()
+		return nil, err
+	}
+	return conn, nil
+}
+
+// sharedDBusConn returns the connection shared by all D-Bus backed Systemd
+// instances, establishing it and subscribing to the manager signals on first
+// use.
+func sharedDBusConn() (*dbus.Conn, error) {
+	dbusMu.Lock()
+	defer dbusMu.Unlock()
+	if dbusConn != nil {
+		return dbusConn, nil
+	}
+	conn, err := dbusSystemBus()
+	if err != nil {
+		return nil, err
+	}
+	if err := subscribe(conn); err != nil {
+		conn.Close()
+		return nil, err
+	}
+	dbusConn = conn
+	return conn, nil
+}
+
+func subscribe(conn *dbus.Conn) error {
+	rule := fmt.Sprintf("type='signal',sender='%s',path='%s',interface='%s',member='JobRemoved'", systemdBusName, systemdObjectPath, systemdManagerIface)
+	if err := conn.BusObject().Call("org.freedesktop.DBus.AddMatch", 0, rule).Err; err != nil {
+		return err
+	}
+	// systemd only emits job signals to subscribed clients
+	return conn.Object(systemdBusName, systemdObjectPath).Call(systemdManagerIface+".Subscribe", 0).Err
+}
+
+// newDBusSystemd returns a D-Bus backed Systemd for the given systemd, or
+// nil if one cannot be used for it.
+func newDBusSystemd(s *systemd) Systemd {
+	dbusMu.Lock()
+	enabled := dbusEnabled
+	dbusMu.Unlock()
+	// only the system instance managing the running system is supported,
+	// systemctl --root works on the unit files of another tree
+	if !enabled || s.mode != SystemMode || filepath.Clean(s.rootDir) != "/" {
+		return nil
+	}
+	conn, err := sharedDBusConn()
+	if err != nil {
+		logger.Debugf("cannot use systemd over D-Bus, using systemctl: %v", err)
+		return nil
+	}
+	return &dbusSystemd{systemd: s, conn: conn}
+}
+
+// dbusSystemd implements Systemd talking to the systemd manager over D-Bus.
+//
+// The operations that are not implemented here are inherited from the
+// systemctl based implementation.
+type dbusSystemd struct {
+	*systemd
+	conn *dbus.Conn
+}
+
+func (s *dbusSystemd) manager() dbus.BusObject {
+	return s.conn.Object(systemdBusName, systemdObjectPath)
+}
+
+// fallback logs that the D-Bus call for the operation failed, the caller
+// then uses systemctl instead.
+func (s *dbusSystemd) fallback(op string, err error) {
+	logger.Debugf("cannot %s over D-Bus, using systemctl: %v", op, err)
+}
+
+// DaemonReload reloads systemd's configuration.
+func (s *dbusSystemd) DaemonReload() error {
+	return daemonReloads[s.mode].do(func() error {
+		daemonReloadLock.Lock()
+		defer daemonReloadLock.Unlock()
+
+		if err := s.manager().Call(systemdManagerIface+".Reload", 0).Err; err != nil {
+			s.fallback("daemon-reload", err)
+			return s.daemonReloadNoLock()
+		}
+		return nil
+	})
+}
+
+// Enable the given service or services
+func (s *dbusSystemd) Enable(serviceNames ...string) error {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	var carriesInstallInfo bool
+	var changes [][]interface{}
+	if err := s.manager().Call(systemdManagerIface+".EnableUnitFiles", 0, serviceNames, false, false).Store(&carriesInstallInfo, &changes); err != nil {
+		s.fallback("enable", err)
+		return s.systemd.Enable(serviceNames...)
+	}
+	return s.reloadUnitFiles()
+}
+
+// Disable the given service or services
+func (s *dbusSystemd) Disable(serviceNames ...string) error {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	var changes [][]interface{}
+	if err := s.manager().Call(systemdManagerIface+".DisableUnitFiles", 0, serviceNames, false).Store(&changes); err != nil {
+		s.fallback("disable", err)
+		return s.systemd.Disable(serviceNames...)
+	}
+	return s.reloadUnitFiles()
+}
+
+// reloadUnitFiles makes the manager pick up the unit file changes done by
+// EnableUnitFiles and DisableUnitFiles, as systemctl enable and disable do.
+// Like them it does not take daemonReloadLock, which callers generating
+// mount units already hold.
+func (s *dbusSystemd) reloadUnitFiles() error {
+	if err := s.manager().Call(systemdManagerIface+".Reload", 0).Err; err != nil {
+		s.fallback("daemon-reload", err)
+		_, err := s.systemctl("daemon-reload")
+		return err
+	}
+	return nil
+}
+
+// submitJobs queues a job of the given manager method for each of the
+// units, returning the paths of the jobs.
+func (s *dbusSystemd) submitJobs(method string, unitNames []string) (map[dbus.ObjectPath]string, error) {
+	jobs := make(map[dbus.ObjectPath]string, len(unitNames))
+	for _, name := range unitNames {
+		var job dbus.ObjectPath
+		if err := s.manager().Call(systemdManagerIface+"."+method, 0, name, "replace").Store(&job); err != nil {
+			return nil, err
+		}
+		jobs[job] = name
+	}
+	return jobs, nil
+}
+
+// jobRemoved is the outcome of a job, as reported by the JobRemoved signal.
+type jobRemoved struct {
+	job    dbus.ObjectPath
+	unit   string
+	result string
+}
+
+// watchJobs delivers the outcome of the finished jobs, it must be set up
+// before submitting the jobs to not miss any of them. The returned function
+// stops watching.
+func (s *dbusSystemd) watchJobs() (<-chan jobRemoved, func()) {
+	signals := make(chan *dbus.Signal, 64)
+	s.conn.Signal(signals)
+	removed := make(chan jobRemoved, 64)
+	done := make(chan struct{})
+	unwatched := make(chan struct{})
+	go func() {
+		for {
+			select {
+			case sig := <-signals:
+				if sig.Name != systemdManagerIface+".JobRemoved" || len(sig.Body) != 4 {
+					continue
+				}
+				var r jobRemoved
+				r.job, _ = sig.Body[1].(dbus.ObjectPath)
+				r.unit, _ = sig.Body[2].(string)
+				r.result, _ = sig.Body[3].(string)
+				select {
+				case removed <- r:
+				case <-done:
+				}
+			case <-done:
+				// godbus blocks delivering to a full channel
+				// while holding the lock RemoveSignal needs, keep
+				// discarding the signals until it returned
+				for {
+					select {
+					case <-signals:
+					case <-unwatched:
+						return
+					}
+				}
+			}
+		}
+	}()
+	return removed, func() {
+		close(done)
+		s.conn.RemoveSignal(signals)
+		close(unwatched)
+	}
+}
+
+// waitJobs waits for all the given jobs to finish, or for the timeout to
+// expire if it is not zero.
+func (s *dbusSystemd) waitJobs(action string, jobs map[dbus.ObjectPath]string, removed <-chan jobRemoved, timeout time.Duration) error {
+	var giveup <-chan time.Time
+	if timeout > 0 {
+		t := time.NewTimer(timeout)
+		defer t.Stop()
+		giveup = t.C
+	}
+	notify := time.NewTicker(stopNotifyDelay)
+	defer notify.Stop()
+
+	var failed []string
+	for len(jobs) > 0 {
+		select {
+		case r := <-removed:
+			unit, ok := jobs[r.job]
+			if !ok {
+				// not one of ours
+				continue
+			}
+			delete(jobs, r.job)
+			if r.result != "done" {
+				failed = append(failed, fmt.Sprintf("%s (%s)", unit, r.result))
+			}
+		case <-giveup:
+			pending := make([]string, 0, len(jobs))
+			for _, unit := range jobs {
+				pending = append(pending, unit)
+			}
+			sort.Strings(pending)
+			return &Timeout{action: action, services: pending}
+		case <-notify.C:
+			for _, unit := range jobs {
+				s.reporter.Notify(fmt.Sprintf("Waiting for %s to %s.", unit, action))
+			}
+		}
+	}
+	if len(failed) > 0 {
+		sort.Strings(failed)
+		return &Error{cmd: []string{action}, exitCode: 1, msg: []byte(fmt.Sprintf("job failed for %s", strings.Join(failed, ", ")))}
+	}
+	return nil
+}
+
+// runJobs submits a job for each of the units in one go and waits for all of
+// them to complete.
+func (s *dbusSystemd) runJobs(method, action string, unitNames []string, timeout time.Duration) (submitted bool, err error) {
+	removed, stop := s.watchJobs()
+	defer stop()
+
+	jobs, err := s.submitJobs(method, unitNames)
+	if err != nil {
+		return false, err
+	}
+	return true, s.waitJobs(action, jobs, removed, timeout)
+}
+
+// Start the given service or services, waiting for their jobs to complete.
+func (s *dbusSystemd) Start(serviceNames ...string) error {
+	submitted, err := s.runJobs("StartUnit", "start", serviceNames, 0)
+	if err != nil && !submitted {
+		s.fallback("start", err)
+		return s.systemd.Start(serviceNames...)
+	}
+	return err
+}
+
+// StartNoBlock starts the given service or services non-blocking
+func (s *dbusSystemd) StartNoBlock(serviceNames ...string) error {
+	if _, err := s.submitJobs("StartUnit", serviceNames); err != nil {
+		s.fallback("start", err)
+		return s.systemd.StartNoBlock(serviceNames...)
+	}
+	return nil
+}
+
+// Stop the given services, and wait until they have all stopped.
+func (s *dbusSystemd) Stop(serviceNames []string, timeout time.Duration) error {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	submitted, err := s.runJobs("StopUnit", "stop", serviceNames, timeout)
+	if err != nil && !submitted {
+		s.fallback("stop", err)
+		return s.systemd.Stop(serviceNames, timeout)
+	}
+	return err
+}
+
+// Restart the service, waiting for it to stop before starting it again.
+func (s *dbusSystemd) Restart(serviceName string, timeout time.Duration) error {
+	if err := s.Stop([]string{serviceName}, timeout); err != nil {
+		return err
+	}
+	return s.Start(serviceName)
+}
+
+// unitProperty returns a property of the given unit, loading it if needed.
+func (s *dbusSystemd) unitProperty(unitName, iface, property string) (interface{}, error) {
+	var unitPath dbus.ObjectPath
+	if err := s.manager().Call(systemdManagerIface+".LoadUnit", 0, unitName).Store(&unitPath); err != nil {
+		return nil, err
+	}
+	v, err := s.conn.Object(systemdBusName, unitPath).GetProperty(iface + "." + property)
+	if err != nil {
+		return nil, err
+	}
+	return v.Value(), nil
+}
+
+func (s *dbusSystemd) unitStringProperty(unitName, iface, property string) (string, error) {
+	v, err := s.unitProperty(unitName, iface, property)
+	if err != nil {
+		return "", err
+	}
+	str, ok := v.(string)
+	if !ok {
+		return "", fmt.Errorf("unexpected type %T of property %s of unit %q", v, property, unitName)
+	}
+	return str, nil
+}
+
+// IsEnabled checkes whether the given service is enabled
+func (s *dbusSystemd) IsEnabled(serviceName string) (bool, error) {
+	var state string
+	err := s.manager().Call(systemdManagerIface+".GetUnitFileState", 0, serviceName).Store(&state)
+	if err == nil {
+		// same as the exit status of "systemctl is-enabled"
+		switch state {
+		case "enabled", "enabled-runtime", "static", "indirect", "generated", "transient", "alias":
+			return true, nil
+		case "disabled":
+			return false, nil
+		}
+		err = fmt.Errorf("unit file state %q", state)
+	}
+	// let systemctl produce the same errors as before
+	s.fallback("is-enabled", err)
+	return s.systemd.IsEnabled(serviceName)
+}
+
+// IsEnabledMany checks whether the given services are enabled
+func (s *dbusSystemd) IsEnabledMany(serviceNames ...string) ([]bool, error) {
+	enabled := make([]bool, len(serviceNames))
+	for i, name := range serviceNames {
+		var err error
+		if enabled[i], err = s.IsEnabled(name); err != nil {
+			return nil, err
+		}
+	}
+	return enabled, nil
+}
+
+// IsActive checkes whether the given service is Active
+func (s *dbusSystemd) IsActive(serviceName string) (bool, error) {
+	state, err := s.unitStringProperty(serviceName, systemdUnitIface, "ActiveState")
+	if err == nil {
+		// same as the exit status of "systemctl is-active"
+		switch state {
+		case "active", "reloading":
+			return true, nil
+		case "inactive":
+			return false, nil
+		}
+		err = fmt.Errorf("active state %q", state)
+	}
+	// let systemctl produce the same errors as before
+	s.fallback("is-active", err)
+	return s.systemd.IsActive(serviceName)
+}
+
+// Status fetches the status of given units. Statuses are returned in the same
+// order as unit names passed in argument.
+func (s *dbusSystemd) Status(unitNames ...string) ([]*UnitStatus, error) {
+	sts := make([]*UnitStatus, 0, len(unitNames))
+	for _, name := range unitNames {
+		st, err := s.unitStatus(name)
+		if err != nil {
+			// let systemctl produce the same errors as before
+			s.fallback("get status", err)
+			return s.systemd.Status(unitNames...)
+		}
+		sts = append(sts, st)
+	}
+	return sts, nil
+}
+
+func (s *dbusSystemd) unitStatus(unitName string) (*UnitStatus, error) {
+	st := &UnitStatus{}
+	var err error
+	if st.UnitName, err = s.unitStringProperty(unitName, systemdUnitIface, "Id"); err != nil {
+		return nil, err
+	}
+	if st.UnitName != unitName {
+		return nil, fmt.Errorf("queried status of %q but got status of %q", unitName, st.UnitName)
+	}
+	activeState, err := s.unitStringProperty(unitName, systemdUnitIface, "ActiveState")
+	if err != nil {
+		return nil, err
+	}
+	// made to match “systemctl is-active” behaviour, at least at systemd 229
+	st.Active = activeState == "active" || activeState == "reloading"
+	unitFileState, err := s.unitStringProperty(unitName, systemdUnitIface, "UnitFileState")
+	if err != nil {
+		return nil, err
+	}
+	if unitFileState == "" {
+		return nil, fmt.Errorf("empty unit file state")
+	}
+	// "static" means it can't be disabled
+	st.Enabled = unitFileState == "enabled" || unitFileState == "static"
+
+	// in service units, Type is the daemon type
+	// in mount units, Type is the fs type
+	switch filepath.Ext(unitName) {
+	case ".service":
+		st.Daemon, err = s.unitStringProperty(unitName, "org.freedesktop.systemd1.Service", "Type")
+	case ".mount":
+		st.Daemon, err = s.unitStringProperty(unitName, "org.freedesktop.systemd1.Mount", "Type")
+	}
+	if err != nil {
+		return nil, err
+	}
+	return st, nil
+}
@@ -0,0 +1,350 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package systemd_test
+
+import (
+	"fmt"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/godbus/dbus"
+	. "gopkg.in/check.v1"
+
+	"github.com/snapcore/snapd/systemd"
+	"github.com/snapcore/snapd/testutil"
+)
+
+// mockManager is a minimal stand-in for the systemd manager D-Bus API
+type mockManager struct {
+	conn *dbus.Conn
+
+	mu        sync.Mutex
+	calls     []string
+	jobID     uint32
+	jobResult map[string]string
+	active    map[string]string
+	enabled   map[string]string
+
+	failReload bool
+	// flood is how many jobs of others finish after each job
+	flood int
+}
+
+func (m *mockManager) record(call string) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	m.calls = append(m.calls, call)
+}
+
+func (m *mockManager) Subscribe() *dbus.Error {
+	m.record("Subscribe")
+	return nil
+}
+
+func (m *mockManager) Reload() *dbus.Error {
+	m.record("Reload")
+	if m.failReload {
+		return dbus.MakeFailedError(fmt.Errorf("reload failed"))
+	}
+	return nil
+}
+
+func (m *mockManager) queueJob(unit string) dbus.ObjectPath {
+	m.mu.Lock()
+	m.jobID++
+	job := dbus.ObjectPath(fmt.Sprintf("/org/freedesktop/systemd1/job/%d", m.jobID))
+	id := m.jobID
+	result := m.jobResult[unit]
+	if result == "" {
+		result = "done"
+	}
+	m.mu.Unlock()
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		m.conn.Emit("/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager.JobRemoved", id, job, unit, result)
+		for i := 0; i < m.flood; i++ {
+			other := dbus.ObjectPath(fmt.Sprintf("/org/freedesktop/systemd1/job/other%d", i))
+			m.conn.Emit("/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager.JobRemoved", uint32(0), other, "other.service", "done")
+		}
+	}()
+	return job
+}
+
+func (m *mockManager) StartUnit(unit, mode string) (dbus.ObjectPath, *dbus.Error) {
+	m.record("StartUnit " + unit)
+	return m.queueJob(unit), nil
+}
+
+func (m *mockManager) StopUnit(unit, mode string) (dbus.ObjectPath, *dbus.Error) {
+	m.record("StopUnit " + unit)
+	return m.queueJob(unit), nil
+}
+
+func (m *mockManager) EnableUnitFiles(files []string, runtime, force bool) (bool, [][]interface{}, *dbus.Error) {
+	m.record("EnableUnitFiles " + strings.Join(files, " "))
+	return true, nil, nil
+}
+
+func (m *mockManager) DisableUnitFiles(files []string, runtime bool) ([][]interface{}, *dbus.Error) {
+	m.record("DisableUnitFiles " + strings.Join(files, " "))
+	return nil, nil
+}
+
+func (m *mockManager) GetUnitFileState(unit string) (string, *dbus.Error) {
+	m.record("GetUnitFileState " + unit)
+	m.mu.Lock()
+	defer m.mu.Unlock()
+	return m.enabled[unit], nil
+}
+
+func (m *mockManager) LoadUnit(unit string) (dbus.ObjectPath, *dbus.Error) {
+	m.record("LoadUnit " + unit)
+	path := dbus.ObjectPath("/org/freedesktop/systemd1/unit/" + strings.NewReplacer(".", "_2e", "-", "_2d").Replace(unit))
+	m.conn.Export(&mockUnit{m: m, name: unit}, path, "org.freedesktop.DBus.Properties")
+	return path, nil
+}
+
+type mockUnit struct {
+	m    *mockManager
+	name string
+}
+
+func (u *mockUnit) Get(iface, property string) (dbus.Variant, *dbus.Error) {
+	u.m.mu.Lock()
+	defer u.m.mu.Unlock()
+	switch iface + "." + property {
+	case "org.freedesktop.systemd1.Unit.Id":
+		return dbus.MakeVariant(u.name), nil
+	case "org.freedesktop.systemd1.Unit.ActiveState":
+		return dbus.MakeVariant(u.m.active[u.name]), nil
+	case "org.freedesktop.systemd1.Unit.UnitFileState":
+		return dbus.MakeVariant(u.m.enabled[u.name]), nil
+	case "org.freedesktop.systemd1.Service.Type":
+		return dbus.MakeVariant("simple"), nil
+	}
+	return dbus.Variant{}, &dbus.ErrMsgUnknownInterface
+}
+
+type dbusSuite struct {
+	testutil.BaseTest
+	testutil.DBusTest
+
+	mgr           *mockManager
+	systemctlArgs [][]string
+	rep           *testreporter
+}
+
+var _ = Suite(&dbusSuite{})
+
+func (s *dbusSuite) SetUpTest(c *C) {
+	s.BaseTest.SetUpTest(c)
+	s.DBusTest.SetUpTest(c)
+
+	// the mock manager has a connection of its own
+	conn, err := dbus.SessionBusPrivate()
+	c.Assert(err, IsNil)
+	c.Assert(conn.Auth(nil), IsNil)
+	c.Assert(conn.Hello(), IsNil)
+	s.AddCleanup(func() { conn.Close() })
+	reply, err := conn.RequestName("org.freedesktop.systemd1", dbus.NameFlagDoNotQueue)
+	c.Assert(err, IsNil)
+	c.Assert(reply, Equals, dbus.RequestNameReplyPrimaryOwner)
+
+	s.mgr = &mockManager{
+		conn:      conn,
+		jobResult: make(map[string]string),
+		active:    make(map[string]string),
+		enabled:   make(map[string]string),
+	}
+	c.Assert(conn.Export(s.mgr, "/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager"), IsNil)
+
+	s.AddCleanup(systemd.MockDBusSystemBus(func() (*dbus.Conn, error) {
+		conn, err := dbus.SessionBusPrivate()
+		if err != nil {
+			return nil, err
+		}
+		if err := conn.Auth(nil); err != nil {
+			return nil, err
+		}
+		return conn, conn.Hello()
+	}))
+	systemd.UseDBus(true)
+	s.AddCleanup(func() { systemd.UseDBus(false) })
+
+	s.systemctlArgs = nil
+	s.AddCleanup(systemd.MockSystemctl(func(args ...string) ([]byte, error) {
+		s.systemctlArgs = append(s.systemctlArgs, args)
+		return nil, nil
+	}))
+	s.rep = new(testreporter)
+}
+
+func (s *dbusSuite) TearDownTest(c *C) {
+	s.DBusTest.TearDownTest(c)
+	s.BaseTest.TearDownTest(c)
+}
+
+func (s *dbusSuite) TestStartManyWaitsForAllJobs(c *C) {
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	err := sysd.Start("foo.service", "bar.service", "baz.socket")
+	c.Assert(err, IsNil)
+
+	c.Check(s.mgr.calls, DeepEquals, []string{
+		"Subscribe",
+		"StartUnit foo.service",
+		"StartUnit bar.service",
+		"StartUnit baz.socket",
+	})
+	// systemctl was not used
+	c.Check(s.systemctlArgs, HasLen, 0)
+}
+
+func (s *dbusSuite) TestStartUnrelatedJobsFlood(c *C) {
+	// the jobs of others finishing meanwhile do not hang Start
+	// once it stops watching the jobs
+	s.mgr.flood = 500
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	for i := 0; i < 3; i++ {
+		done := make(chan error, 1)
+		go func() {
+			done <- sysd.Start("foo.service")
+		}()
+		select {
+		case err := <-done:
+			c.Assert(err, IsNil)
+		case <-time.After(5 * time.Second):
+			c.Fatal("Start did not return")
+		}
+	}
+}
+
+func (s *dbusSuite) TestStartJobFailed(c *C) {
+	s.mgr.jobResult["bar.service"] = "failed"
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	err := sysd.Start("foo.service", "bar.service")
+	c.Assert(err, ErrorMatches, `.*job failed for bar.service \(failed\)`)
+	c.Check(s.systemctlArgs, HasLen, 0)
+}
+
+func (s *dbusSuite) TestStopAndReload(c *C) {
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	c.Assert(sysd.Stop([]string{"foo.service"}, time.Second), IsNil)
+	c.Assert(sysd.DaemonReload(), IsNil)
+
+	c.Check(s.mgr.calls, DeepEquals, []string{
+		"Subscribe",
+		"StopUnit foo.service",
+		"Reload",
+	})
+	c.Check(s.systemctlArgs, HasLen, 0)
+}
+
+func (s *dbusSuite) TestEnableDisableIsEnabled(c *C) {
+	s.mgr.enabled["foo.service"] = "enabled"
+	s.mgr.enabled["bar.service"] = "disabled"
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	c.Assert(sysd.Enable("bar.service"), IsNil)
+	c.Assert(sysd.Disable("foo.service"), IsNil)
+	enabled, err := sysd.IsEnabled("foo.service")
+	c.Assert(err, IsNil)
+	c.Check(enabled, Equals, true)
+	enabled, err = sysd.IsEnabled("bar.service")
+	c.Assert(err, IsNil)
+	c.Check(enabled, Equals, false)
+
+	c.Check(s.mgr.calls, DeepEquals, []string{
+		"Subscribe",
+		"EnableUnitFiles bar.service",
+		"Reload",
+		"DisableUnitFiles foo.service",
+		"Reload",
+		"GetUnitFileState foo.service",
+		"GetUnitFileState bar.service",
+	})
+	c.Check(s.systemctlArgs, HasLen, 0)
+}
+
+func (s *dbusSuite) TestEnableReloadFallback(c *C) {
+	s.mgr.failReload = true
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	c.Assert(sysd.Enable("foo.service"), IsNil)
+	c.Check(s.mgr.calls, DeepEquals, []string{
+		"Subscribe",
+		"EnableUnitFiles foo.service",
+		"Reload",
+	})
+	// the unit files were enabled over D-Bus, only the reload is
+	// done with systemctl
+	c.Check(s.systemctlArgs, DeepEquals, [][]string{{"daemon-reload"}})
+}
+
+func (s *dbusSuite) TestIsActiveAndStatus(c *C) {
+	s.mgr.active["foo.service"] = "active"
+	s.mgr.enabled["foo.service"] = "enabled"
+	s.mgr.active["bar.socket"] = "inactive"
+	s.mgr.enabled["bar.socket"] = "disabled"
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	active, err := sysd.IsActive("foo.service")
+	c.Assert(err, IsNil)
+	c.Check(active, Equals, true)
+	active, err = sysd.IsActive("bar.socket")
+	c.Assert(err, IsNil)
+	c.Check(active, Equals, false)
+
+	sts, err := sysd.Status("foo.service", "bar.socket")
+	c.Assert(err, IsNil)
+	c.Check(sts, DeepEquals, []*systemd.UnitStatus{
+		{Daemon: "simple", UnitName: "foo.service", Enabled: true, Active: true},
+		{UnitName: "bar.socket", Enabled: false, Active: false},
+	})
+	c.Check(s.systemctlArgs, HasLen, 0)
+}
+
+func (s *dbusSuite) TestFallbackToSystemctl(c *C) {
+	// no D-Bus for other root directories
+	sysd := systemd.New("/some/root", systemd.SystemMode, s.rep)
+	c.Assert(sysd.Enable("foo.service"), IsNil)
+	c.Check(s.systemctlArgs, DeepEquals, [][]string{{"--root", "/some/root", "enable", "foo.service"}})
+	c.Check(s.mgr.calls, HasLen, 0)
+
+	// nor for user instances
+	s.systemctlArgs = nil
+	sysd = systemd.New("/", systemd.UserMode, s.rep)
+	c.Assert(sysd.Start("foo.service"), IsNil)
+	c.Check(s.systemctlArgs, DeepEquals, [][]string{{"--user", "start", "foo.service"}})
+	c.Check(s.mgr.calls, HasLen, 0)
+}
+
+func (s *dbusSuite) TestFallbackWhenNoBus(c *C) {
+	restore := systemd.MockDBusSystemBus(func() (*dbus.Conn, error) {
+		return nil, fmt.Errorf("no bus")
+	})
+	defer restore()
+
+	sysd := systemd.New("/", systemd.SystemMode, s.rep)
+	c.Assert(sysd.Start("foo.service"), IsNil)
+	c.Check(s.systemctlArgs, DeepEquals, [][]string{{"start", "foo.service"}})
+}
@@ -21,6 +21,8 @@ package systemd
 
 import (
 	"io"
+
+	"github.com/godbus/dbus"
 )
 
 var (
@@ -47,6 +49,11 @@ func MockJournalStdoutPath(path string) func() {
 	}
 }
 
+// JournalReaderFiles returns how many journal files the reader has open.
+func JournalReaderFiles(jr *JournalReader) int {
+	return len(jr.files)
+}
+
 func (e *Error) SetExitCode(i int) {
 	e.exitCode = i
 }
@@ -54,3 +61,26 @@ func (e *Error) SetExitCode(i int) {
 func (e *Error) SetMsg(msg []byte) {
 	e.msg = msg
 }
+
+func MockDBusSystemBus(f func() (*dbus.Conn, error)) (restore func()) {
+	old := dbusSystemBus
+	dbusSystemBus = f
+	return func() {
+		dbusMu.Lock()
+		if dbusConn != nil {
+			dbusConn.Close()
+			dbusConn = nil
+		}
+		dbusMu.Unlock()
+		dbusSystemBus = old
+	}
+}
+
+// DaemonReloadWaiters returns how many daemon-reload requests to the given
+// instance are waiting for the one in progress to finish.
+func DaemonReloadWaiters(mode InstanceMode) int {
+	g := daemonReloads[mode]
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	return g.waiting
+}
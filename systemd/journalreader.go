@@ -0,0 +1,1176 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package systemd
+
+import (
+	"bytes"
+	"encoding/binary"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"io/ioutil"
+	"math/bits"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"syscall"
+	"unsafe"
+
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/logger"
+	"github.com/snapcore/snapd/osutil"
+)
+
+// The journal files are read as described in
+// https://systemd.io/JOURNAL_FILE_FORMAT/. Only what is needed to find
+// the entries of some units is used: the data hash table, to find the
+// data objects of their unit fields, and the lists of entries of those
+// data objects. Compressed payloads are not decoded, reading is handed
+// over to journalctl when an entry to return has one.
+//
+// The objects are read with pread into buffers of their own, as needed,
+// rather than through a mapping of the files: journald writes to the
+// files behind the back of the reader, and reading through a mapping
+// of a file truncated meanwhile faults. A file cut short is not
+// readable anymore, reading is handed over to journalctl then too.
+
+var journalSignature = []byte("LPKSHHRH")
+
+const (
+	// journalHeaderMinSize is the size of the header fields used,
+	// all the supported journal files have them
+	journalHeaderMinSize = 208
+
+	journalObjectHeaderSize = 16
+
+	// journalLargeRead is the size from which the size of an object
+	// is checked against the one of the file before being allocated
+	journalLargeRead = 1 << 20
+
+	journalObjectData       = 1
+	journalObjectEntry      = 3
+	journalObjectEntryArray = 6
+
+	journalIncompatibleCompressedXZ   = 1 << 0
+	journalIncompatibleCompressedLZ4  = 1 << 1
+	journalIncompatibleKeyedHash      = 1 << 2
+	journalIncompatibleCompressedZSTD = 1 << 3
+	journalIncompatibleCompact        = 1 << 4
+
+	journalIncompatibleKnown = journalIncompatibleCompressedXZ | journalIncompatibleCompressedLZ4 |
+		journalIncompatibleKeyedHash | journalIncompatibleCompressedZSTD | journalIncompatibleCompact
+
+	// the flags of the data objects with a compressed payload
+	journalObjectCompressed = 1<<0 | 1<<1 | 1<<2
+)
+
+var (
+	errJournalUnsupported = errors.New("unsupported journal")
+	errJournalCorrupt     = errors.New("corrupt journal file")
+	errJournalCompressed  = errors.New("compressed journal field")
+	// errJournalIncomplete is returned for the files journald is
+	// creating, which have no header yet
+	errJournalIncomplete = errors.New("incomplete journal file")
+
+	errJournalFound = errors.New("found")
+)
+
+// journalEntryArray is an entry array object of a list of entries.
+type journalEntryArray struct {
+	offset uint64
+	// first is the index in the list of the first entry of the array
+	first int
+	n     int
+}
+
+// journalEntryList is the list of the entries referencing a data
+// object, sorted by offset as entries are only ever appended.
+type journalEntryList struct {
+	dataOff uint64
+	// cond, if not 0, is the offset of a data object the entries must
+	// also reference to match
+	cond uint64
+
+	arrays []journalEntryArray
+	// next is the index of the first entry after the position of the
+	// file, once positioned
+	next       int
+	positioned bool
+}
+
+// journalFileID identifies a journal file whatever it is renamed to.
+type journalFileID struct {
+	dev, ino uint64
+}
+
+// journalFile is an open journal file.
+type journalFile struct {
+	fileID journalFileID
+	f      *os.File
+	// header is the beginning of the header of the file, as read
+	// when opening it
+	header  []byte
+	compact bool
+	keyed   bool
+	// archived is set for the files journald rotated, which do not
+	// change anymore
+	archived bool
+	// lookedUp is set once the entry lists were looked up
+	lookedUp bool
+
+	seqnumID string
+
+	// lists are the lists of entries matched, by data object payload
+	lists map[string]*journalEntryList
+	// after is the position of the reader in the file, the entries
+	// after that offset are still to be read
+	after uint64
+}
+
+func openJournalFile(path string, fileID journalFileID) (*journalFile, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	header := make([]byte, journalHeaderMinSize)
+	if _, err := f.ReadAt(header, 0); err != nil {
+		f.Close()
+		if err == io.EOF {
+			return nil, errJournalIncomplete
+		}
+		return nil, err
+	}
+	if !bytes.Equal(header[:len(journalSignature)], journalSignature) {
+		err := errJournalUnsupported
+		if bytes.Equal(header[:len(journalSignature)], make([]byte, len(journalSignature))) {
+			err = errJournalIncomplete
+		}
+		f.Close()
+		return nil, err
+	}
+	incompatible := binary.LittleEndian.Uint32(header[12:])
+	if incompatible&^journalIncompatibleKnown != 0 || binary.LittleEndian.Uint64(header[88:]) < journalHeaderMinSize {
+		f.Close()
+		return nil, errJournalUnsupported
+	}
+	return &journalFile{
+		fileID:   fileID,
+		f:        f,
+		header:   header,
+		compact:  incompatible&journalIncompatibleCompact != 0,
+		keyed:    incompatible&journalIncompatibleKeyedHash != 0,
+		seqnumID: hex.EncodeToString(header[72:88]),
+		lists:    make(map[string]*journalEntryList),
+	}, nil
+}
+
+func (jf *journalFile) close() {
+	jf.f.Close()
+}
+
+func (jf *journalFile) uint64At(off int) uint64 {
+	return binary.LittleEndian.Uint64(jf.header[off:])
+}
+
+// bytes reads the n bytes at the given offset of the file.
+func (jf *journalFile) bytes(off, n uint64) ([]byte, error) {
+	end := off + n
+	if end < off || int64(end) < 0 {
+		return nil, errJournalCorrupt
+	}
+	if n >= journalLargeRead {
+		st, err := jf.f.Stat()
+		if err != nil {
+			return nil, err
+		}
+		if end > uint64(st.Size()) {
+			return nil, errJournalCorrupt
+		}
+	}
+	buf := make([]byte, n)
+	if _, err := jf.f.ReadAt(buf, int64(off)); err != nil {
+		if err == io.EOF {
+			// the file was truncated
+			return nil, errJournalCorrupt
+		}
+		return nil, err
+	}
+	return buf, nil
+}
+
+// objectPrefix returns the first n bytes of the object of the given
+// type at the given offset, which must be at least that big.
+func (jf *journalFile) objectPrefix(off uint64, typ byte, n uint64) ([]byte, error) {
+	obj, err := jf.bytes(off, n)
+	if err != nil {
+		return nil, err
+	}
+	if obj[0] != typ || binary.LittleEndian.Uint64(obj[8:]) < n {
+		return nil, errJournalCorrupt
+	}
+	return obj, nil
+}
+
+// object returns the object of the given type at the given offset.
+func (jf *journalFile) object(off uint64, typ byte, minSize uint64) ([]byte, error) {
+	obj, err := jf.objectPrefix(off, typ, minSize)
+	if err != nil {
+		return nil, err
+	}
+	size := binary.LittleEndian.Uint64(obj[8:])
+	if size == minSize {
+		return obj, nil
+	}
+	rest, err := jf.bytes(off+minSize, size-minSize)
+	if err != nil {
+		return nil, err
+	}
+	return append(obj, rest...), nil
+}
+
+// offsetSize is the size of the offsets in entry array objects.
+func (jf *journalFile) offsetSize() int {
+	if jf.compact {
+		return 4
+	}
+	return 8
+}
+
+func (jf *journalFile) dataPayloadOffset() int {
+	if jf.compact {
+		return 72
+	}
+	return 64
+}
+
+func (jf *journalFile) hash(payload []byte) uint64 {
+	if jf.keyed {
+		return siphash24(payload, jf.header[24:40])
+	}
+	return jenkinsHash64(payload)
+}
+
+// findData returns the offset of the data object with the given
+// payload, or 0 if there is none.
+func (jf *journalFile) findData(payload []byte) (uint64, error) {
+	tableOff := jf.uint64At(104)
+	buckets := jf.uint64At(112) / 16
+	if buckets == 0 {
+		return 0, nil
+	}
+	h := jf.hash(payload)
+	item, err := jf.bytes(tableOff+(h%buckets)*16, 16)
+	if err != nil {
+		return 0, err
+	}
+	payloadOff := jf.dataPayloadOffset()
+	for off := binary.LittleEndian.Uint64(item); off != 0; {
+		obj, err := jf.objectPrefix(off, journalObjectData, uint64(payloadOff))
+		if err != nil {
+			return 0, err
+		}
+		// only the payloads that can match are read
+		size := binary.LittleEndian.Uint64(obj[8:])
+		if binary.LittleEndian.Uint64(obj[16:]) == h && obj[1]&journalObjectCompressed == 0 && size == uint64(payloadOff+len(payload)) {
+			data, err := jf.object(off, journalObjectData, uint64(payloadOff))
+			if err != nil {
+				return 0, err
+			}
+			if bytes.Equal(data[payloadOff:], payload) {
+				return off, nil
+			}
+		}
+		next := binary.LittleEndian.Uint64(obj[24:])
+		if next != 0 && next <= off {
+			// chained objects are appended
+			return 0, errJournalCorrupt
+		}
+		off = next
+	}
+	return 0, nil
+}
+
+// entry returns the entry object at the given offset.
+func (jf *journalFile) entry(off uint64) ([]byte, error) {
+	return jf.object(off, journalObjectEntry, 64)
+}
+
+// entryData calls f with the offset of each data object of the entry.
+func (jf *journalFile) entryData(entry []byte, f func(dataOff uint64) error) error {
+	itemSize := 16
+	if jf.compact {
+		itemSize = 4
+	}
+	for p := 64; p+itemSize <= len(entry); p += itemSize {
+		var off uint64
+		if jf.compact {
+			off = uint64(binary.LittleEndian.Uint32(entry[p:]))
+		} else {
+			off = binary.LittleEndian.Uint64(entry[p:])
+		}
+		if err := f(off); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// accepts returns whether the entry at the given offset matches the
+// condition of the list.
+func (jf *journalFile) accepts(l *journalEntryList, off uint64) (bool, error) {
+	if l.cond == 0 {
+		return true, nil
+	}
+	entry, err := jf.entry(off)
+	if err != nil {
+		return false, err
+	}
+	err = jf.entryData(entry, func(dataOff uint64) error {
+		if dataOff == l.cond {
+			return errJournalFound
+		}
+		return nil
+	})
+	if err == errJournalFound {
+		return true, nil
+	}
+	return false, err
+}
+
+// realtime returns the wallclock time of the entry at the given offset,
+// in microseconds.
+func (jf *journalFile) realtime(off uint64) (uint64, error) {
+	entry, err := jf.entry(off)
+	if err != nil {
+		return 0, err
+	}
+	return binary.LittleEndian.Uint64(entry[24:]), nil
+}
+
+// log returns the entry at the given offset, with the fields
+// journalctl -o json adds.
+func (jf *journalFile) log(off uint64) (Log, error) {
+	entry, err := jf.entry(off)
+	if err != nil {
+		return nil, err
+	}
+	payloadOff := jf.dataPayloadOffset()
+	log := make(Log, 24)
+	err = jf.entryData(entry, func(dataOff uint64) error {
+		obj, err := jf.object(dataOff, journalObjectData, uint64(payloadOff))
+		if err != nil {
+			return err
+		}
+		if obj[1]&journalObjectCompressed != 0 {
+			return errJournalCompressed
+		}
+		payload := obj[payloadOff:]
+		if eq := bytes.IndexByte(payload, '='); eq > 0 {
+			log[string(payload[:eq])] = string(payload[eq+1:])
+		}
+		return nil
+	})
+	if err != nil {
+		return nil, err
+	}
+	seqnum := binary.LittleEndian.Uint64(entry[16:])
+	realtime := binary.LittleEndian.Uint64(entry[24:])
+	monotonic := binary.LittleEndian.Uint64(entry[32:])
+	bootID := hex.EncodeToString(entry[40:56])
+	xorHash := binary.LittleEndian.Uint64(entry[56:])
+	log["__CURSOR"] = fmt.Sprintf("s=%s;i=%x;b=%s;m=%x;t=%x;x=%x", jf.seqnumID, seqnum, bootID, monotonic, realtime, xorHash)
+	log["__REALTIME_TIMESTAMP"] = strconv.FormatUint(realtime, 10)
+	log["__MONOTONIC_TIMESTAMP"] = strconv.FormatUint(monotonic, 10)
+	log["_BOOT_ID"] = bootID
+	return log, nil
+}
+
+// tailCursor returns a cursor for the last entry of the file, or "".
+func (jf *journalFile) tailCursor() string {
+	if jf.uint64At(152) == 0 {
+		return ""
+	}
+	return fmt.Sprintf("s=%s;i=%x;b=%s;m=%x;t=%x", jf.seqnumID, jf.uint64At(160), hex.EncodeToString(jf.header[56:72]), jf.uint64At(200), jf.uint64At(192))
+}
+
+// len returns the number of entries in the list.
+func (l *journalEntryList) len(jf *journalFile) (int, error) {
+	obj, err := jf.objectPrefix(l.dataOff, journalObjectData, 64)
+	if err != nil {
+		return 0, err
+	}
+	return int(binary.LittleEndian.Uint64(obj[56:])), nil
+}
+
+// entryOffset returns the offset of the i-th entry of the list, which
+// must be one of the first len entries. The first entry is referenced
+// by the data object itself, the others by a chain of entry arrays.
+func (l *journalEntryList) entryOffset(jf *journalFile, i int) (uint64, error) {
+	if i == 0 {
+		obj, err := jf.objectPrefix(l.dataOff, journalObjectData, 64)
+		if err != nil {
+			return 0, err
+		}
+		return binary.LittleEndian.Uint64(obj[40:]), nil
+	}
+	offsetSize := jf.offsetSize()
+	for len(l.arrays) == 0 || i >= l.arrays[len(l.arrays)-1].first+l.arrays[len(l.arrays)-1].n {
+		var next uint64
+		first := 1
+		if len(l.arrays) == 0 {
+			obj, err := jf.objectPrefix(l.dataOff, journalObjectData, 64)
+			if err != nil {
+				return 0, err
+			}
+			next = binary.LittleEndian.Uint64(obj[48:])
+		} else {
+			last := l.arrays[len(l.arrays)-1]
+			obj, err := jf.objectPrefix(last.offset, journalObjectEntryArray, 24)
+			if err != nil {
+				return 0, err
+			}
+			next = binary.LittleEndian.Uint64(obj[16:])
+			first = last.first + last.n
+		}
+		if next == 0 {
+			return 0, errJournalCorrupt
+		}
+		obj, err := jf.objectPrefix(next, journalObjectEntryArray, 24)
+		if err != nil {
+			return 0, err
+		}
+		n := int((binary.LittleEndian.Uint64(obj[8:]) - 24) / uint64(offsetSize))
+		if n == 0 {
+			return 0, errJournalCorrupt
+		}
+		l.arrays = append(l.arrays, journalEntryArray{offset: next, first: first, n: n})
+	}
+	k := sort.Search(len(l.arrays), func(k int) bool {
+		return i < l.arrays[k].first+l.arrays[k].n
+	})
+	a := l.arrays[k]
+	// only the item is read, the array can be big
+	item, err := jf.bytes(a.offset+24+uint64((i-a.first)*offsetSize), uint64(offsetSize))
+	if err != nil {
+		return 0, err
+	}
+	var off uint64
+	if jf.compact {
+		off = uint64(binary.LittleEndian.Uint32(item))
+	} else {
+		off = binary.LittleEndian.Uint64(item)
+	}
+	if off == 0 {
+		return 0, errJournalCorrupt
+	}
+	return off, nil
+}
+
+// search returns the index of the first entry of the list whose offset
+// is at least off.
+func (l *journalEntryList) search(jf *journalFile, n int, off uint64) (int, error) {
+	var err error
+	i := sort.Search(n, func(i int) bool {
+		if err != nil {
+			return true
+		}
+		var entryOff uint64
+		entryOff, err = l.entryOffset(jf, i)
+		return entryOff >= off
+	})
+	return i, err
+}
+
+// lookup finds the lists of entries of the given payloads, they are
+// looked up again when the file changes for the ones not found yet.
+func (jf *journalFile) lookup(payloads []journalPayload) error {
+	for _, p := range payloads {
+		if jf.lists[p.data] != nil {
+			continue
+		}
+		dataOff, err := jf.findData([]byte(p.data))
+		if err != nil {
+			return err
+		}
+		if dataOff == 0 {
+			continue
+		}
+		l := &journalEntryList{dataOff: dataOff}
+		if p.cond != "" {
+			l.cond, err = jf.findData([]byte(p.cond))
+			if err != nil {
+				return err
+			}
+			if l.cond == 0 {
+				continue
+			}
+		}
+		jf.lists[p.data] = l
+	}
+	return nil
+}
+
+// nextMatch returns the offset of the first matching entry after the
+// position of the file, or 0 if there is none.
+func (jf *journalFile) nextMatch() (uint64, error) {
+	var best uint64
+	for _, l := range jf.lists {
+		n, err := l.len(jf)
+		if err != nil {
+			return 0, err
+		}
+		if !l.positioned {
+			if l.next, err = l.search(jf, n, jf.after+1); err != nil {
+				return 0, err
+			}
+			l.positioned = true
+		}
+		for ; l.next < n; l.next++ {
+			off, err := l.entryOffset(jf, l.next)
+			if err != nil {
+				return 0, err
+			}
+			if off <= jf.after {
+				continue
+			}
+			if best != 0 && off >= best {
+				break
+			}
+			ok, err := jf.accepts(l, off)
+			if err != nil {
+				return 0, err
+			}
+			if ok {
+				best = off
+				break
+			}
+		}
+	}
+	return best, nil
+}
+
+// prevMatch returns the offset of the last matching entry before the
+// given offset, or 0 if there is none.
+func (jf *journalFile) prevMatch(before uint64) (uint64, error) {
+	var best uint64
+	for _, l := range jf.lists {
+		n, err := l.len(jf)
+		if err != nil {
+			return 0, err
+		}
+		i, err := l.search(jf, n, before)
+		if err != nil {
+			return 0, err
+		}
+		for i--; i >= 0; i-- {
+			off, err := l.entryOffset(jf, i)
+			if err != nil {
+				return 0, err
+			}
+			if off <= best {
+				break
+			}
+			ok, err := jf.accepts(l, off)
+			if err != nil {
+				return 0, err
+			}
+			if ok {
+				best = off
+				break
+			}
+		}
+	}
+	return best, nil
+}
+
+// journalPayload is the payload of a data object whose entries match,
+// if they also reference the data object with the cond payload.
+type journalPayload struct {
+	data string
+	cond string
+}
+
+// journalPayloads returns the payloads of the entries of the given
+// units, as journalctl -u selects them: the entries logged by the units
+// and the ones logged about them by systemd or by the coredump handler.
+func journalPayloads(units []string) []journalPayload {
+	payloads := make([]journalPayload, 0, 4*len(units))
+	for _, unit := range units {
+		payloads = append(payloads,
+			journalPayload{data: "_SYSTEMD_UNIT=" + unit},
+			journalPayload{data: "UNIT=" + unit, cond: "_PID=1"},
+			journalPayload{data: "OBJECT_SYSTEMD_UNIT=" + unit, cond: "_UID=0"},
+			journalPayload{data: "COREDUMP_UNIT=" + unit, cond: "_UID=0"},
+		)
+	}
+	return payloads
+}
+
+// A JournalReader reads the journal entries of some services.
+//
+// It reads the journal files directly, which spares running journalctl
+// and decoding its JSON output. When a journal file is in a format it
+// does not support, or an entry has compressed fields, it hands reading
+// over to journalctl, from the last entry it returned.
+type JournalReader struct {
+	svcs   []string
+	n      int
+	follow bool
+
+	payloads []journalPayload
+	dirs     []string
+	files    []*journalFile
+	// incomplete is set while some file has yet to be opened once
+	// journald wrote its header
+	incomplete bool
+	// cursor is the cursor of the last entry returned, if any
+	cursor string
+
+	// epfd waits for the inotify instance watching dirs, and for Stop
+	// writing to wakeW
+	epfd      int
+	inotifyFd int
+	wakeR     int
+	wakeW     int
+
+	// stream is the output of journalctl, once reading is handed over
+	stream io.ReadCloser
+	dec    *json.Decoder
+
+	mu      sync.Mutex
+	stopped bool
+}
+
+// NewJournalReader returns a reader of the last n journal entries of the
+// given services, or of all of them if n is negative, followed by the
+// entries they log next if follow is set.
+func NewJournalReader(svcs []string, n int, follow bool) (*JournalReader, error) {
+	jr := &JournalReader{
+		svcs:      svcs,
+		n:         n,
+		follow:    follow,
+		epfd:      -1,
+		inotifyFd: -1,
+		wakeR:     -1,
+		wakeW:     -1,
+	}
+	err := jr.open()
+	if err == nil {
+		return jr, nil
+	}
+	if err != errJournalUnsupported {
+		logger.Noticef("cannot read the journal files, using journalctl: %v", err)
+	}
+	if err := jr.handOver(); err != nil {
+		return nil, err
+	}
+	return jr, nil
+}
+
+func (jr *JournalReader) open() error {
+	machineID, err := ioutil.ReadFile(filepath.Join(dirs.GlobalRootDir, "/etc/machine-id"))
+	if err != nil {
+		return errJournalUnsupported
+	}
+	for _, dir := range []string{"/run/log/journal", "/var/log/journal"} {
+		dir = filepath.Join(dirs.GlobalRootDir, dir, strings.TrimSpace(string(machineID)))
+		if osutil.IsDirectory(dir) {
+			jr.dirs = append(jr.dirs, dir)
+		}
+	}
+	if len(jr.dirs) == 0 {
+		return errJournalUnsupported
+	}
+	jr.payloads = journalPayloads(jr.svcs)
+	if jr.follow {
+		// watch before listing the files, not to miss the ones
+		// created in between
+		if err := jr.watch(); err != nil {
+			return err
+		}
+	}
+	if err := jr.refresh(); err != nil {
+		return err
+	}
+	if len(jr.files) == 0 {
+		return errJournalUnsupported
+	}
+	return jr.seek()
+}
+
+func (jr *JournalReader) watch() error {
+	var err error
+	jr.inotifyFd, err = syscall.InotifyInit1(syscall.IN_CLOEXEC)
+	if err != nil {
+		return err
+	}
+	for _, dir := range jr.dirs {
+		// journald truncates the files it appended to, to trigger
+		// IN_MODIFY, as their mapping is written to; the files
+		// removed or moved away are closed
+		const mask = syscall.IN_CREATE | syscall.IN_MODIFY | syscall.IN_MOVED_TO | syscall.IN_DELETE | syscall.IN_MOVED_FROM
+		if _, err := syscall.InotifyAddWatch(jr.inotifyFd, dir, mask); err != nil {
+			return err
+		}
+	}
+	var wake [2]int
+	if err := syscall.Pipe2(wake[:], syscall.O_CLOEXEC); err != nil {
+		return err
+	}
+	jr.wakeR, jr.wakeW = wake[0], wake[1]
+	jr.epfd, err = syscall.EpollCreate1(syscall.EPOLL_CLOEXEC)
+	if err != nil {
+		return err
+	}
+	for _, fd := range []int{jr.inotifyFd, jr.wakeR} {
+		if err := syscall.EpollCtl(jr.epfd, syscall.EPOLL_CTL_ADD, fd, &syscall.EpollEvent{Events: syscall.EPOLLIN, Fd: int32(fd)}); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// refresh opens the journal files not seen yet, closes the ones that
+// are gone, and looks up the entry lists not found yet.
+func (jr *JournalReader) refresh() error {
+	present := make(map[journalFileID]bool, len(jr.files))
+	jr.incomplete = false
+	for _, dir := range jr.dirs {
+		paths, err := filepath.Glob(filepath.Join(dir, "*.journal"))
+		if err != nil {
+			return err
+		}
+		for _, path := range paths {
+			var st syscall.Stat_t
+			if err := syscall.Stat(path, &st); err != nil {
+				// removed meanwhile
+				continue
+			}
+			// files are renamed when rotated
+			fileID := journalFileID{dev: uint64(st.Dev), ino: uint64(st.Ino)}
+			present[fileID] = true
+			// journald archives the files by renaming them to
+			// a name with the sequence number ID, @ separated
+			archived := strings.ContainsRune(filepath.Base(path), '@')
+			if jf := jr.file(fileID); jf != nil {
+				if archived && !jf.archived {
+					// look up what was appended last
+					jf.archived = true
+					jf.lookedUp = false
+				}
+				continue
+			}
+			jf, err := openJournalFile(path, fileID)
+			if err == errJournalIncomplete {
+				// to be looked at again once journald wrote
+				// its header
+				jr.incomplete = true
+				continue
+			}
+			if os.IsNotExist(err) {
+				// removed meanwhile
+				continue
+			}
+			if err != nil {
+				return err
+			}
+			jf.archived = archived
+			jr.files = append(jr.files, jf)
+		}
+	}
+	files := jr.files[:0]
+	for _, jf := range jr.files {
+		if present[jf.fileID] {
+			files = append(files, jf)
+		} else {
+			jf.close()
+		}
+	}
+	jr.files = files
+	return jr.lookup()
+}
+
+// lookup looks up the entry lists not found yet in the files that may
+// have gained them.
+func (jr *JournalReader) lookup() error {
+	for _, jf := range jr.files {
+		if jf.archived && jf.lookedUp {
+			continue
+		}
+		if err := jf.lookup(jr.payloads); err != nil {
+			return err
+		}
+		jf.lookedUp = true
+	}
+	return nil
+}
+
+func (jr *JournalReader) file(fileID journalFileID) *journalFile {
+	for _, jf := range jr.files {
+		if jf.fileID == fileID {
+			return jf
+		}
+	}
+	return nil
+}
+
+// seek positions the files before the last n matching entries, merged
+// by time as journalctl does.
+func (jr *JournalReader) seek() error {
+	if jr.n < 0 {
+		return nil
+	}
+	prev := make([]uint64, len(jr.files))
+	prevTime := make([]uint64, len(jr.files))
+	first := make([]uint64, len(jr.files))
+	for k, jf := range jr.files {
+		off, err := jf.prevMatch(^uint64(0))
+		if err != nil {
+			return err
+		}
+		prev[k] = off
+		if off != 0 {
+			if prevTime[k], err = jf.realtime(off); err != nil {
+				return err
+			}
+		}
+	}
+	for found := 0; found < jr.n; found++ {
+		k := -1
+		for i := range jr.files {
+			if prev[i] != 0 && (k < 0 || prevTime[i] > prevTime[k]) {
+				k = i
+			}
+		}
+		if k < 0 {
+			break
+		}
+		jf := jr.files[k]
+		first[k] = prev[k]
+		off, err := jf.prevMatch(prev[k])
+		if err != nil {
+			return err
+		}
+		prev[k] = off
+		if off != 0 {
+			if prevTime[k], err = jf.realtime(off); err != nil {
+				return err
+			}
+		}
+	}
+	var tail *journalFile
+	none := true
+	for k, jf := range jr.files {
+		if first[k] != 0 {
+			jf.after = first[k] - 1
+			none = false
+		} else {
+			// the entries appended next come after the tail object
+			jf.after = jf.uint64At(136)
+		}
+		if tail == nil || jf.uint64At(192) > tail.uint64At(192) {
+			tail = jf
+		}
+	}
+	if none {
+		// nothing to return before what gets logged next
+		jr.cursor = tail.tailCursor()
+	}
+	return nil
+}
+
+// nextNative returns the next entry from the journal files, or nil if
+// there is none yet.
+func (jr *JournalReader) nextNative() (Log, error) {
+	var best *journalFile
+	var bestOff, bestTime uint64
+	for _, jf := range jr.files {
+		off, err := jf.nextMatch()
+		if err != nil {
+			return nil, err
+		}
+		if off == 0 {
+			continue
+		}
+		t, err := jf.realtime(off)
+		if err != nil {
+			return nil, err
+		}
+		if best == nil || t < bestTime {
+			best, bestOff, bestTime = jf, off, t
+		}
+	}
+	if best == nil {
+		return nil, nil
+	}
+	log, err := best.log(bestOff)
+	if err != nil {
+		return nil, err
+	}
+	best.after = bestOff
+	jr.cursor = log["__CURSOR"]
+	return log, nil
+}
+
+// wait waits for the journal files to change, or for Stop.
+func (jr *JournalReader) wait() error {
+	var events [2]syscall.EpollEvent
+	for {
+		_, err := syscall.EpollWait(jr.epfd, events[:], -1)
+		if err == syscall.EINTR {
+			continue
+		}
+		if err != nil {
+			return err
+		}
+		break
+	}
+	if jr.isStopped() {
+		return io.EOF
+	}
+	var buf [64 * (syscall.SizeofInotifyEvent + syscall.NAME_MAX + 1)]byte
+	n, err := syscall.Read(jr.inotifyFd, buf[:])
+	if err != nil {
+		return err
+	}
+	// the set of files only changes with events other than the ones
+	// of journald appending to the files
+	rescan := false
+	for off := 0; off+syscall.SizeofInotifyEvent <= n; {
+		ev := (*syscall.InotifyEvent)(unsafe.Pointer(&buf[off]))
+		off += syscall.SizeofInotifyEvent + int(ev.Len)
+		if ev.Mask&^syscall.IN_MODIFY != 0 {
+			rescan = true
+		}
+	}
+	if rescan || jr.incomplete {
+		return jr.refresh()
+	}
+	return jr.lookup()
+}
+
+// handOver hands reading over to journalctl, after the last entry
+// returned if any.
+func (jr *JournalReader) handOver() error {
+	jr.mu.Lock()
+	jr.closeFiles()
+	jr.mu.Unlock()
+
+	var err error
+	if jr.cursor == "" {
+		jr.stream, err = jctl(jr.svcs, jr.n, jr.follow)
+	} else {
+		jr.stream, err = jctlAfterCursor(jr.svcs, jr.cursor, jr.follow)
+	}
+	if err != nil {
+		return err
+	}
+	jr.dec = json.NewDecoder(jr.stream)
+	return nil
+}
+
+// Next returns the next journal entry, or io.EOF if there are no more.
+// When following the journal, it waits for the services to log more
+// entries, until Stop is called.
+func (jr *JournalReader) Next() (Log, error) {
+	for !jr.isStopped() {
+		if jr.dec != nil {
+			var log Log
+			if err := jr.dec.Decode(&log); err != nil {
+				return nil, err
+			}
+			return log, nil
+		}
+		log, err := jr.nextNative()
+		if err == nil && log == nil {
+			if !jr.follow {
+				return nil, io.EOF
+			}
+			err = jr.wait()
+		}
+		switch err {
+		case nil:
+			if log != nil {
+				return log, nil
+			}
+		case errJournalCorrupt:
+			logger.Noticef("cannot read the journal files, using journalctl: %v", err)
+			fallthrough
+		case errJournalCompressed, errJournalUnsupported:
+			if err := jr.handOver(); err != nil {
+				return nil, err
+			}
+		default:
+			return nil, err
+		}
+	}
+	return nil, io.EOF
+}
+
+func (jr *JournalReader) isStopped() bool {
+	jr.mu.Lock()
+	defer jr.mu.Unlock()
+	return jr.stopped
+}
+
+// Stop makes Next return io.EOF instead of waiting for more entries. It
+// can be called while Next is waiting.
+func (jr *JournalReader) Stop() {
+	jr.mu.Lock()
+	defer jr.mu.Unlock()
+	if jr.stopped {
+		return
+	}
+	jr.stopped = true
+	if jr.wakeW >= 0 {
+		syscall.Write(jr.wakeW, []byte{0})
+	}
+}
+
+func (jr *JournalReader) closeFiles() {
+	for _, jf := range jr.files {
+		jf.close()
+	}
+	jr.files = nil
+	for _, fd := range []*int{&jr.epfd, &jr.inotifyFd, &jr.wakeR, &jr.wakeW} {
+		if *fd >= 0 {
+			syscall.Close(*fd)
+			*fd = -1
+		}
+	}
+}
+
+// Close releases the journal files, or stops journalctl.
+func (jr *JournalReader) Close() error {
+	jr.mu.Lock()
+	jr.closeFiles()
+	jr.mu.Unlock()
+	if jr.stream != nil {
+		return jr.stream.Close()
+	}
+	return nil
+}
+
+// jenkinsHash64 is the hash of the data objects of the journal files
+// without keyed hashes, Bob Jenkins' lookup3 hashlittle2.
+func jenkinsHash64(data []byte) uint64 {
+	a := 0xdeadbeef + uint32(len(data))
+	b, c := a, a
+	for len(data) > 12 {
+		a += binary.LittleEndian.Uint32(data)
+		b += binary.LittleEndian.Uint32(data[4:])
+		c += binary.LittleEndian.Uint32(data[8:])
+		a -= c
+		a ^= bits.RotateLeft32(c, 4)
+		c += b
+		b -= a
+		b ^= bits.RotateLeft32(a, 6)
+		a += c
+		c -= b
+		c ^= bits.RotateLeft32(b, 8)
+		b += a
+		a -= c
+		a ^= bits.RotateLeft32(c, 16)
+		c += b
+		b -= a
+		b ^= bits.RotateLeft32(a, 19)
+		a += c
+		c -= b
+		c ^= bits.RotateLeft32(b, 4)
+		b += a
+		data = data[12:]
+	}
+	if len(data) == 0 {
+		return uint64(c)<<32 | uint64(b)
+	}
+	var tail [12]byte
+	copy(tail[:], data)
+	a += binary.LittleEndian.Uint32(tail[:])
+	b += binary.LittleEndian.Uint32(tail[4:])
+	c += binary.LittleEndian.Uint32(tail[8:])
+	c ^= b
+	c -= bits.RotateLeft32(b, 14)
+	a ^= c
+	a -= bits.RotateLeft32(c, 11)
+	b ^= a
+	b -= bits.RotateLeft32(a, 25)
+	c ^= b
+	c -= bits.RotateLeft32(b, 16)
+	a ^= c
+	a -= bits.RotateLeft32(c, 4)
+	b ^= a
+	b -= bits.RotateLeft32(a, 14)
+	c ^= b
+	c -= bits.RotateLeft32(b, 24)
+	return uint64(c)<<32 | uint64(b)
+}
+
+// siphash24 is the hash of the data objects of the journal files with
+// keyed hashes, keyed with the file ID.
+func siphash24(data, key []byte) uint64 {
+	k0 := binary.LittleEndian.Uint64(key)
+	k1 := binary.LittleEndian.Uint64(key[8:])
+	v0 := k0 ^ 0x736f6d6570736575
+	v1 := k1 ^ 0x646f72616e646f6d
+	v2 := k0 ^ 0x6c7967656e657261
+	v3 := k1 ^ 0x7465646279746573
+	round := func() {
+		v0 += v1
+		v1 = bits.RotateLeft64(v1, 13)
+		v1 ^= v0
+		v0 = bits.RotateLeft64(v0, 32)
+		v2 += v3
+		v3 = bits.RotateLeft64(v3, 16)
+		v3 ^= v2
+		v0 += v3
+		v3 = bits.RotateLeft64(v3, 21)
+		v3 ^= v0
+		v2 += v1
+		v1 = bits.RotateLeft64(v1, 17)
+		v1 ^= v2
+		v2 = bits.RotateLeft64(v2, 32)
+	}
+	b := uint64(len(data)) << 56
+	for ; len(data) >= 8; data = data[8:] {
+		m := binary.LittleEndian.Uint64(data)
+		v3 ^= m
+		round()
+		round()
+		v0 ^= m
+	}
+	var tail [8]byte
+	copy(tail[:], data)
+	b |= binary.LittleEndian.Uint64(tail[:])
+	v3 ^= b
+	round()
+	round()
+	v0 ^= b
+	v2 ^= 0xff
+	round()
+	round()
+	round()
+	round()
+	return v0 ^ v1 ^ v2 ^ v3
+}
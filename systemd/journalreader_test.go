@@ -0,0 +1,323 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package systemd_test
+
+import (
+	"bytes"
+	"compress/gzip"
+	"io"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+
+	. "gopkg.in/check.v1"
+
+	"github.com/snapcore/snapd/dirs"
+	. "github.com/snapcore/snapd/systemd"
+)
+
+// The journal files in testdata were written by journald 252, for
+// services running in the cgroups of the units below. compact.journal,
+// in the compact format with keyed hashes, holds hello 1 and hello 2
+// from testSvc, other 1 from other.service, bye 1 from testOther and
+// hello 3 from testSvc. compact-early.journal is the same file before
+// other 1 was logged. legacy.journal holds the same logs in the format
+// of systemd before 246. compressed.journal holds the logs of
+// compact.journal followed by a compressed 2000 bytes message and
+// hello 4 from testSvc.
+const (
+	testMachineID = "67e3d13727e94486a0cd8c0d55eeb41b"
+	testSvc       = "snap.test-snap.svc.service"
+	testOther     = "snap.test-snap.other.service"
+)
+
+type journalReaderSuite struct {
+	journalDir string
+	jctlArgs   [][]string
+}
+
+var _ = Suite(&journalReaderSuite{})
+
+func (s *journalReaderSuite) SetUpTest(c *C) {
+	dirs.SetRootDir(c.MkDir())
+	c.Assert(os.MkdirAll(filepath.Join(dirs.GlobalRootDir, "/etc"), 0755), IsNil)
+	c.Assert(ioutil.WriteFile(filepath.Join(dirs.GlobalRootDir, "/etc/machine-id"), []byte(testMachineID+"\n"), 0644), IsNil)
+	s.journalDir = filepath.Join(dirs.GlobalRootDir, "/run/log/journal", testMachineID)
+	c.Assert(os.MkdirAll(s.journalDir, 0755), IsNil)
+	s.jctlArgs = nil
+}
+
+func (s *journalReaderSuite) TearDownTest(c *C) {
+	dirs.SetRootDir("")
+}
+
+func (s *journalReaderSuite) testJournal(c *C, name string) []byte {
+	f, err := os.Open(filepath.Join("testdata", name+".journal.gz"))
+	c.Assert(err, IsNil)
+	defer f.Close()
+	r, err := gzip.NewReader(f)
+	c.Assert(err, IsNil)
+	data, err := ioutil.ReadAll(r)
+	c.Assert(err, IsNil)
+	return data
+}
+
+func (s *journalReaderSuite) installJournal(c *C, name, as string) string {
+	path := filepath.Join(s.journalDir, as)
+	c.Assert(ioutil.WriteFile(path, s.testJournal(c, name), 0640), IsNil)
+	return path
+}
+
+func (s *journalReaderSuite) mockJournalctl(output string) (restore func()) {
+	return MockOsutilStreamCommand(func(name string, args ...string) (io.ReadCloser, error) {
+		s.jctlArgs = append(s.jctlArgs, append([]string{name}, args...))
+		return ioutil.NopCloser(strings.NewReader(output)), nil
+	})
+}
+
+func readMessages(c *C, jr *JournalReader, max int) []string {
+	var msgs []string
+	for len(msgs) < max {
+		log, err := jr.Next()
+		if err == io.EOF {
+			break
+		}
+		c.Assert(err, IsNil)
+		msgs = append(msgs, log.SID()+": "+log.Message())
+	}
+	return msgs
+}
+
+func (s *journalReaderSuite) testRead(c *C, name string) {
+	s.installJournal(c, name, "system.journal")
+	restore := s.mockJournalctl("")
+	defer restore()
+
+	for _, t := range []struct {
+		svcs []string
+		n    int
+		msgs []string
+	}{
+		{[]string{testSvc}, 10, []string{"test-snap.svc: hello 1", "test-snap.svc: hello 2", "test-snap.svc: hello 3"}},
+		{[]string{testSvc}, 2, []string{"test-snap.svc: hello 2", "test-snap.svc: hello 3"}},
+		{[]string{testSvc}, 0, nil},
+		{[]string{testSvc, testOther}, 2, []string{"test-snap.other: bye 1", "test-snap.svc: hello 3"}},
+		{[]string{testOther, testSvc}, -1, []string{"test-snap.svc: hello 1", "test-snap.svc: hello 2", "test-snap.other: bye 1", "test-snap.svc: hello 3"}},
+		{[]string{"snap.test-snap.missing.service"}, 10, nil},
+	} {
+		jr, err := NewJournalReader(t.svcs, t.n, false)
+		c.Assert(err, IsNil)
+		c.Check(readMessages(c, jr, 100), DeepEquals, t.msgs, Commentf("%v %d", t.svcs, t.n))
+		c.Check(jr.Close(), IsNil)
+	}
+	// all read natively
+	c.Check(s.jctlArgs, HasLen, 0)
+}
+
+func (s *journalReaderSuite) TestReadCompact(c *C) {
+	s.testRead(c, "compact")
+}
+
+func (s *journalReaderSuite) TestReadLegacy(c *C) {
+	s.testRead(c, "legacy")
+}
+
+func (s *journalReaderSuite) TestReadFields(c *C) {
+	s.installJournal(c, "compact", "system.journal")
+
+	jr, err := NewJournalReader([]string{testSvc}, 1, false)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	log, err := jr.Next()
+	c.Assert(err, IsNil)
+	c.Check(log.Message(), Equals, "hello 3")
+	c.Check(log["_SYSTEMD_UNIT"], Equals, testSvc)
+	c.Check(log["_TRANSPORT"], Equals, "stdout")
+	c.Check(log.PID(), Not(Equals), "-")
+	t, err := log.Time()
+	c.Assert(err, IsNil)
+	c.Check(t.Year(), Equals, 2026)
+	c.Check(log["__CURSOR"], Matches, `s=[0-9a-f]{32};i=8;b=[0-9a-f]{32};m=[0-9a-f]+;t=[0-9a-f]+;x=[0-9a-f]+`)
+}
+
+func (s *journalReaderSuite) TestReadMultipleFiles(c *C) {
+	// a rotated file and the one it was rotated to
+	s.installJournal(c, "legacy", "system@0000-0001.journal")
+	s.installJournal(c, "compact", "system.journal")
+
+	jr, err := NewJournalReader([]string{testOther}, -1, false)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	c.Check(readMessages(c, jr, 100), DeepEquals, []string{"test-snap.other: bye 1", "test-snap.other: bye 1"})
+}
+
+func (s *journalReaderSuite) TestFollow(c *C) {
+	path := s.installJournal(c, "compact-early", "system.journal")
+
+	jr, err := NewJournalReader([]string{testSvc}, 1, true)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	c.Check(readMessages(c, jr, 1), DeepEquals, []string{"test-snap.svc: hello 2"})
+
+	done := make(chan bool)
+	go func() {
+		defer close(done)
+		// what journald does: write through the mapping, then
+		// truncate the file to its size to trigger IN_MODIFY
+		f, err := os.OpenFile(path, os.O_WRONLY, 0)
+		if !c.Check(err, IsNil) {
+			return
+		}
+		defer f.Close()
+		data := s.testJournal(c, "compact")
+		_, err = f.WriteAt(data, 0)
+		c.Check(err, IsNil)
+		c.Check(f.Truncate(int64(len(data))), IsNil)
+	}()
+	c.Check(readMessages(c, jr, 1), DeepEquals, []string{"test-snap.svc: hello 3"})
+	<-done
+
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		jr.Stop()
+	}()
+	c.Check(readMessages(c, jr, 1), HasLen, 0)
+}
+
+func (s *journalReaderSuite) TestFollowNewUnit(c *C) {
+	path := s.installJournal(c, "compact-early", "system.journal")
+
+	jr, err := NewJournalReader([]string{testOther}, 0, true)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+
+	go func() {
+		f, err := os.OpenFile(path, os.O_WRONLY, 0)
+		if !c.Check(err, IsNil) {
+			return
+		}
+		defer f.Close()
+		data := s.testJournal(c, "compact")
+		_, err = f.WriteAt(data, 0)
+		c.Check(err, IsNil)
+		c.Check(f.Truncate(int64(len(data))), IsNil)
+	}()
+	// the unit is looked up again in the online file
+	c.Check(readMessages(c, jr, 1), DeepEquals, []string{"test-snap.other: bye 1"})
+}
+
+func (s *journalReaderSuite) TestFollowNewFile(c *C) {
+	s.installJournal(c, "legacy", "system.journal")
+
+	jr, err := NewJournalReader([]string{testOther}, 0, true)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+
+	go func() {
+		c.Check(os.Rename(filepath.Join(s.journalDir, "system.journal"), filepath.Join(s.journalDir, "system@0000-0001.journal")), IsNil)
+		s.installJournal(c, "compact", "system.journal")
+	}()
+	c.Check(readMessages(c, jr, 1), DeepEquals, []string{"test-snap.other: bye 1"})
+}
+
+func (s *journalReaderSuite) TestFollowRemovedFile(c *C) {
+	s.installJournal(c, "legacy", "system@0000-0001.journal")
+	s.installJournal(c, "compact", "system.journal")
+
+	jr, err := NewJournalReader([]string{testOther}, 0, true)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	c.Check(JournalReaderFiles(jr), Equals, 2)
+
+	// vacuuming removes the archived files, renaming keeps them
+	c.Assert(os.Remove(filepath.Join(s.journalDir, "system@0000-0001.journal")), IsNil)
+	c.Assert(os.Rename(filepath.Join(s.journalDir, "system.journal"), filepath.Join(s.journalDir, "system@0000-0002.journal")), IsNil)
+	go func() {
+		time.Sleep(10 * time.Millisecond)
+		jr.Stop()
+	}()
+	c.Check(readMessages(c, jr, 1), HasLen, 0)
+	c.Check(JournalReaderFiles(jr), Equals, 1)
+}
+
+func (s *journalReaderSuite) TestHandOverTruncated(c *C) {
+	path := s.installJournal(c, "compact", "system.journal")
+	restore := s.mockJournalctl(`{"MESSAGE": "hello 2", "SYSLOG_IDENTIFIER": "test-snap.svc"}
+`)
+	defer restore()
+
+	jr, err := NewJournalReader([]string{testSvc}, -1, false)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	c.Check(readMessages(c, jr, 1), DeepEquals, []string{"test-snap.svc: hello 1"})
+
+	// the objects are gone, the header is left
+	c.Assert(os.Truncate(path, 1024), IsNil)
+	c.Check(readMessages(c, jr, 100), DeepEquals, []string{"test-snap.svc: hello 2"})
+	c.Assert(s.jctlArgs, HasLen, 1)
+	args := s.jctlArgs[0]
+	c.Check(args[:7], DeepEquals, []string{"journalctl", "-o", "json", "--no-pager", "--no-tail", "--after-cursor", args[6]})
+	c.Check(args[6], Matches, `s=[0-9a-f]{32};i=4;.*`)
+}
+
+func (s *journalReaderSuite) TestHandOverCompressed(c *C) {
+	s.installJournal(c, "compressed", "system.journal")
+	restore := s.mockJournalctl(`{"MESSAGE": "xxxx", "SYSLOG_IDENTIFIER": "test-snap.svc"}
+{"MESSAGE": "hello 4", "SYSLOG_IDENTIFIER": "test-snap.svc"}
+`)
+	defer restore()
+
+	jr, err := NewJournalReader([]string{testSvc}, 3, false)
+	c.Assert(err, IsNil)
+	defer jr.Close()
+	c.Check(readMessages(c, jr, 100), DeepEquals, []string{"test-snap.svc: hello 3", "test-snap.svc: xxxx", "test-snap.svc: hello 4"})
+	c.Assert(s.jctlArgs, HasLen, 1)
+	args := s.jctlArgs[0]
+	c.Check(args[:7], DeepEquals, []string{"journalctl", "-o", "json", "--no-pager", "--no-tail", "--after-cursor", args[6]})
+	c.Check(args[6], Matches, `s=[0-9a-f]{32};i=8;.*`)
+	c.Check(args[7:], DeepEquals, []string{"-u", testSvc})
+}
+
+func (s *journalReaderSuite) TestFallbackUnsupported(c *C) {
+	var calls []string
+	restore := MockJournalctl(func(svcs []string, n int, follow bool) (io.ReadCloser, error) {
+		calls = append(calls, strings.Join(svcs, ","))
+		return ioutil.NopCloser(strings.NewReader(`{"MESSAGE": "hi"}` + "\n")), nil
+	})
+	defer restore()
+
+	// not a journal file
+	c.Assert(ioutil.WriteFile(filepath.Join(s.journalDir, "system.journal"), bytes.Repeat([]byte("not a journal\n"), 100), 0640), IsNil)
+	jr, err := NewJournalReader([]string{testSvc}, 10, false)
+	c.Assert(err, IsNil)
+	c.Check(readMessages(c, jr, 100), DeepEquals, []string{"-: hi"})
+	c.Check(jr.Close(), IsNil)
+
+	// no journal files
+	c.Assert(os.RemoveAll(s.journalDir), IsNil)
+	jr, err = NewJournalReader([]string{testSvc}, 10, false)
+	c.Assert(err, IsNil)
+	c.Check(readMessages(c, jr, 100), DeepEquals, []string{"-: hi"})
+	c.Check(jr.Close(), IsNil)
+
+	c.Check(calls, DeepEquals, []string{testSvc, testSvc})
+}
@@ -43,8 +43,8 @@ import (
 )
 
 var (
-	// the output of "show" must match this for Stop to be done:
-	isStopDone = regexp.MustCompile(`(?m)\AActiveState=(?:failed|inactive)$`).Match
+	// the state of each unit in the output of "show --property=ActiveState"
+	activeStateRe = regexp.MustCompile(`(?m)^ActiveState=(.*)$`)
 
 	// how much time should Stop wait between calls to show
 	stopCheckDelay = 250 * time.Millisecond
@@ -60,8 +60,71 @@ var (
 	// See https://github.com/systemd/systemd/issues/10872 for the
 	// upstream systemd bug
 	daemonReloadLock extMutex
+
+	// daemonReloads coalesces the daemon-reload requests made to each
+	// instance of systemd
+	daemonReloads = map[InstanceMode]*reloadGroup{
+		SystemMode: newReloadGroup(),
+		UserMode:   newReloadGroup(),
+	}
 )
 
+// reloadGroup coalesces concurrent daemon-reload requests. A request made
+// while a reload is running cannot be served by it, as the reload might
+// have started before the unit files of the request were written, so all
+// the requests that arrive in the meantime share the next reload instead.
+type reloadGroup struct {
+	mu   sync.Mutex
+	cond *sync.Cond
+
+	// requested and completed count the requests made and the requests
+	// covered by a finished reload
+	requested uint64
+	completed uint64
+	running   bool
+	waiting   int
+	// err is the outcome of the last reload
+	err error
+}
+
+func newReloadGroup() *reloadGroup {
+	g := &reloadGroup{}
+	g.cond = sync.NewCond(&g.mu)
+	return g
+}
+
+// do waits for a reload started after the call, running it with the given
+// function if no other caller is doing so already.
+func (g *reloadGroup) do(reload func() error) error {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+
+	g.requested++
+	req := g.requested
+	for g.running {
+		g.waiting++
+		g.cond.Wait()
+		g.waiting--
+	}
+	if g.completed >= req {
+		// someone else did the reload for us
+		return g.err
+	}
+
+	// all the requests made up to now are covered by this reload
+	upto := g.requested
+	g.running = true
+	g.mu.Unlock()
+	err := reload()
+	g.mu.Lock()
+	g.running = false
+	g.completed = upto
+	g.err = err
+	g.cond.Broadcast()
+
+	return err
+}
+
 // mu is a sync.Mutex that also supports to check if the lock is taken
 type extMutex struct {
 	lock sync.Mutex
@@ -160,18 +223,35 @@ func MockJournalctl(f func(svcs []string, n int, follow bool) (io.ReadCloser, er
 	}
 }
 
+// jctlAfterCursor calls journalctl to get the JSON logs of the given
+// services that follow the entry with the given cursor.
+var jctlAfterCursor = func(svcs []string, cursor string, follow bool) (io.ReadCloser, error) {
+	args := make([]string, 0, 2*len(svcs)+7)
+	args = append(args, "-o", "json", "--no-pager", "--no-tail", "--after-cursor", cursor)
+	if follow {
+		args = append(args, "-f")
+	}
+
+	for i := range svcs {
+		args = append(args, "-u", svcs[i])
+	}
+
+	return osutilStreamCommand("journalctl", args...)
+}
+
 // Systemd exposes a minimal interface to manage systemd via the systemctl command.
 type Systemd interface {
 	DaemonReload() error
-	Enable(service string) error
-	Disable(service string) error
+	Enable(service ...string) error
+	Disable(service ...string) error
 	Start(service ...string) error
 	StartNoBlock(service ...string) error
-	Stop(service string, timeout time.Duration) error
+	Stop(services []string, timeout time.Duration) error
 	Kill(service, signal, who string) error
 	Restart(service string, timeout time.Duration) error
 	Status(units ...string) ([]*UnitStatus, error)
 	IsEnabled(service string) (bool, error)
+	IsEnabledMany(services ...string) ([]bool, error)
 	IsActive(service string) (bool, error)
 	LogReader(services []string, n int, follow bool) (io.ReadCloser, error)
 	AddMountUnitFile(name, revision, what, where, fstype string) (string, error)
@@ -202,8 +282,15 @@ type reporter interface {
 }
 
 // New returns a Systemd that uses the given rootDir
+//
+// If enabled with UseDBus, the returned Systemd talks to the systemd manager
+// over D-Bus when possible.
 func New(rootDir string, mode InstanceMode, rep reporter) Systemd {
-	return &systemd{rootDir: rootDir, mode: mode, reporter: rep}
+	s := &systemd{rootDir: rootDir, mode: mode, reporter: rep}
+	if sd := newDBusSystemd(s); sd != nil {
+		return sd
+	}
+	return s
 }
 
 // InstanceMode determines which instance of systemd to control.
@@ -248,10 +335,12 @@ func (s *systemd) DaemonReload() error {
 	if s.mode == GlobalUserMode {
 		panic("cannot call daemon-reload with GlobalUserMode")
 	}
-	daemonReloadLock.Lock()
-	defer daemonReloadLock.Unlock()
+	return daemonReloads[s.mode].do(func() error {
+		daemonReloadLock.Lock()
+		defer daemonReloadLock.Unlock()
 
-	return s.daemonReloadNoLock()
+		return s.daemonReloadNoLock()
+	})
 }
 
 func (s *systemd) daemonReloadNoLock() error {
@@ -261,9 +350,12 @@ func (s *systemd) daemonReloadNoLock() error {
 	return err
 }
 
-// Enable the given service
-func (s *systemd) Enable(serviceName string) error {
-	_, err := s.systemctl("--root", s.rootDir, "enable", serviceName)
+// Enable the given service or services
+func (s *systemd) Enable(serviceNames ...string) error {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	_, err := s.systemctl(append([]string{"--root", s.rootDir, "enable"}, serviceNames...)...)
 	return err
 }
 
@@ -273,9 +365,12 @@ func (s *systemd) Unmask(serviceName string) error {
 	return err
 }
 
-// Disable the given service
-func (s *systemd) Disable(serviceName string) error {
-	_, err := s.systemctl("--root", s.rootDir, "disable", serviceName)
+// Disable the given service or services
+func (s *systemd) Disable(serviceNames ...string) error {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	_, err := s.systemctl(append([]string{"--root", s.rootDir, "disable"}, serviceNames...)...)
 	return err
 }
 
@@ -479,6 +574,57 @@ func (s *systemd) IsEnabled(serviceName string) (bool, error) {
 	return false, err
 }
 
+// IsEnabledMany checks whether the given services are enabled, with a single
+// call to systemctl. The results are in the same order as the services.
+func (s *systemd) IsEnabledMany(serviceNames ...string) ([]bool, error) {
+	if s.mode == GlobalUserMode {
+		panic("cannot call is-enabled with GlobalUserMode")
+	}
+	switch len(serviceNames) {
+	case 0:
+		return nil, nil
+	case 1:
+		// the exit status is authoritative for a single service
+		enabled, err := s.IsEnabled(serviceNames[0])
+		if err != nil {
+			return nil, err
+		}
+		return []bool{enabled}, nil
+	}
+	out, err := s.systemctl(append([]string{"--root", s.rootDir, "is-enabled"}, serviceNames...)...)
+	if err != nil {
+		// "systemctl is-enabled" returns exit code 1 when none of
+		// the services are enabled, the states are still printed
+		sysdErr, ok := err.(*Error)
+		if !ok || sysdErr.exitCode != 1 {
+			return nil, err
+		}
+		out = sysdErr.msg
+	}
+	states := strings.Split(strings.TrimSpace(string(out)), "\n")
+	if len(states) != len(serviceNames) {
+		if err != nil {
+			return nil, err
+		}
+		return nil, fmt.Errorf("cannot determine if services are enabled: expected %d results, got %q", len(serviceNames), out)
+	}
+	enabled := make([]bool, len(serviceNames))
+	for i, state := range states {
+		switch strings.TrimSpace(state) {
+		case "enabled", "enabled-runtime", "static", "indirect", "generated", "transient", "alias":
+			enabled[i] = true
+		case "disabled":
+			enabled[i] = false
+		default:
+			if err != nil {
+				return nil, err
+			}
+			return nil, fmt.Errorf("cannot determine if service %q is enabled: unexpected state %q", serviceNames[i], state)
+		}
+	}
+	return enabled, nil
+}
+
 // IsActive checkes whether the given service is Active
 func (s *systemd) IsActive(serviceName string) (bool, error) {
 	if s.mode == GlobalUserMode {
@@ -496,22 +642,45 @@ func (s *systemd) IsActive(serviceName string) (bool, error) {
 	return false, err
 }
 
-// Stop the given service, and wait until it has stopped.
-func (s *systemd) Stop(serviceName string, timeout time.Duration) error {
+// stoppedUnits returns which of the units are reported as stopped in the
+// output of "systemctl show --property=ActiveState" for them. Output that
+// cannot be matched to the units reports none of them as stopped.
+func stoppedUnits(out []byte, serviceNames []string) []bool {
+	stopped := make([]bool, len(serviceNames))
+	matches := activeStateRe.FindAllSubmatch(out, -1)
+	if len(matches) != len(serviceNames) {
+		return stopped
+	}
+	for i, m := range matches {
+		state := string(m[1])
+		stopped[i] = state == "failed" || state == "inactive"
+	}
+	return stopped
+}
+
+// Stop the given services, and wait until they have all stopped.
+//
+// The services are stopped with a single call to systemctl, and their state
+// is then polled together until the timeout expires.
+func (s *systemd) Stop(serviceNames []string, timeout time.Duration) error {
 	if s.mode == GlobalUserMode {
 		panic("cannot call stop with GlobalUserMode")
 	}
-	if _, err := s.systemctl("stop", serviceName); err != nil {
+	if len(serviceNames) == 0 {
+		return nil
+	}
+	if _, err := s.systemctl(append([]string{"stop"}, serviceNames...)...); err != nil {
 		return err
 	}
 
-	// and now wait for it to actually stop
+	// and now wait for them to actually stop
 	giveup := time.NewTimer(timeout)
 	notify := time.NewTicker(stopNotifyDelay)
 	defer notify.Stop()
 	check := time.NewTicker(stopCheckDelay)
 	defer check.Stop()
 
+	pending := serviceNames
 	firstCheck := true
 loop:
 	for {
@@ -519,11 +688,19 @@ loop:
 		case <-giveup.C:
 			break loop
 		case <-check.C:
-			bs, err := s.systemctl("show", "--property=ActiveState", serviceName)
+			bs, err := s.systemctl(append([]string{"show", "--property=ActiveState"}, pending...)...)
 			if err != nil {
 				return err
 			}
-			if isStopDone(bs) {
+			stopped := stoppedUnits(bs, pending)
+			var stillPending []string
+			for i, name := range pending {
+				if !stopped[i] {
+					stillPending = append(stillPending, name)
+				}
+			}
+			pending = stillPending
+			if len(pending) == 0 {
 				return nil
 			}
 			if !firstCheck {
@@ -533,10 +710,12 @@ loop:
 		case <-notify.C:
 		}
 		// after notify delay or after a failed first check
-		s.reporter.Notify(fmt.Sprintf("Waiting for %s to stop.", serviceName))
+		for _, name := range pending {
+			s.reporter.Notify(fmt.Sprintf("Waiting for %s to stop.", name))
+		}
 	}
 
-	return &Timeout{action: "stop", service: serviceName}
+	return &Timeout{action: "stop", services: pending}
 }
 
 // Kill all processes of the unit with the given signal
@@ -556,7 +735,7 @@ func (s *systemd) Restart(serviceName string, timeout time.Duration) error {
 	if s.mode == GlobalUserMode {
 		panic("cannot call restart with GlobalUserMode")
 	}
-	if err := s.Stop(serviceName, timeout); err != nil {
+	if err := s.Stop([]string{serviceName}, timeout); err != nil {
 		return err
 	}
 	return s.Start(serviceName)
@@ -576,12 +755,18 @@ func (e *Error) Error() string {
 // Timeout is returned if the systemd action failed to reach the
 // expected state in a reasonable amount of time
 type Timeout struct {
-	action  string
-	service string
+	action   string
+	services []string
 }
 
 func (e *Timeout) Error() string {
-	return fmt.Sprintf("%v failed to %v: timeout", e.service, e.action)
+	return fmt.Sprintf("%v failed to %v: timeout", strings.Join(e.services, ", "), e.action)
+}
+
+// Services returns the services that failed to reach the expected state in
+// time.
+func (e *Timeout) Services() []string {
+	return e.services
 }
 
 // IsTimeout checks whether the given error is a Timeout
@@ -643,9 +828,6 @@ func MountUnitPath(baseDir string) string {
 
 // AddMountUnitFile adds/enables/starts a mount unit.
 func (s *systemd) AddMountUnitFile(snapName, revision, what, where, fstype string) (string, error) {
-	daemonReloadLock.Lock()
-	defer daemonReloadLock.Unlock()
-
 	options := []string{"nodev"}
 	if fstype == "squashfs" {
 		newFsType, newOptions, err := squashfs.FsType()
@@ -686,11 +868,16 @@ WantedBy=multi-user.target
 	}
 
 	// we need to do a daemon-reload here to ensure that systemd really
-	// knows about this new mount unit file
-	if err := s.daemonReloadNoLock(); err != nil {
+	// knows about this new mount unit file, the reload is shared with
+	// any other unit being added at the same time
+	if err := s.DaemonReload(); err != nil {
 		return "", err
 	}
 
+	// but no reload can happen while the unit is being activated
+	daemonReloadLock.Lock()
+	defer daemonReloadLock.Unlock()
+
 	if err := s.Enable(mountUnitName); err != nil {
 		return "", err
 	}
@@ -702,12 +889,24 @@ WantedBy=multi-user.target
 }
 
 func (s *systemd) RemoveMountUnitFile(mountedDir string) error {
+	removed, err := s.removeMountUnit(mountedDir)
+	if err != nil || !removed {
+		return err
+	}
+	// daemon-reload to ensure that systemd actually really
+	// forgets about this mount unit
+	return s.DaemonReload()
+}
+
+// removeMountUnit deactivates and removes the mount unit of the given
+// directory, reporting whether there was one.
+func (s *systemd) removeMountUnit(mountedDir string) (removed bool, err error) {
 	daemonReloadLock.Lock()
 	defer daemonReloadLock.Unlock()
 
 	unit := MountUnitPath(dirs.StripRootDir(mountedDir))
 	if !osutil.FileExists(unit) {
-		return nil
+		return false, nil
 	}
 
 	// use umount -d (cleanup loopback devices) -l (lazy) to ensure that even busy mount points
@@ -716,28 +915,23 @@ func (s *systemd) RemoveMountUnitFile(mountedDir string) error {
 	// the explicit -d is only needed on trusty.
 	isMounted, err := osutil.IsMounted(mountedDir)
 	if err != nil {
-		return err
+		return false, err
 	}
 	if isMounted {
 		if output, err := exec.Command("umount", "-d", "-l", mountedDir).CombinedOutput(); err != nil {
-			return osutil.OutputErr(output, err)
+			return false, osutil.OutputErr(output, err)
 		}
 
-		if err := s.Stop(filepath.Base(unit), time.Duration(1*time.Second)); err != nil {
-			return err
+		if err := s.Stop([]string{filepath.Base(unit)}, time.Duration(1*time.Second)); err != nil {
+			return false, err
 		}
 	}
 	if err := s.Disable(filepath.Base(unit)); err != nil {
-		return err
+		return false, err
 	}
 	if err := os.Remove(unit); err != nil {
-		return err
-	}
-	// daemon-reload to ensure that systemd actually really
-	// forgets about this mount unit
-	if err := s.daemonReloadNoLock(); err != nil {
-		return err
+		return false, err
 	}
 
-	return nil
+	return true, nil
 }
@@ -27,6 +27,7 @@ import (
 	"os"
 	"path/filepath"
 	"strconv"
+	"sync"
 	"testing"
 	"time"
 
@@ -171,7 +172,7 @@ func (s *SystemdTestSuite) TestStop(c *C) {
 		[]byte("ActiveState=inactive\n"),
 	}
 	s.errors = []error{nil, nil, nil, nil, &Timeout{}}
-	err := New("", SystemMode, s.rep).Stop("foo", 1*time.Second)
+	err := New("", SystemMode, s.rep).Stop([]string{"foo"}, 1*time.Second)
 	c.Assert(err, IsNil)
 	c.Assert(s.argses, HasLen, 4)
 	c.Check(s.argses[0], DeepEquals, []string{"stop", "foo"})
@@ -180,6 +181,47 @@ func (s *SystemdTestSuite) TestStop(c *C) {
 	c.Check(s.argses[1], DeepEquals, s.argses[3])
 }
 
+func (s *SystemdTestSuite) TestStopMany(c *C) {
+	restore := MockStopDelays(time.Millisecond, 25*time.Second)
+	defer restore()
+	s.outs = [][]byte{
+		nil, // for the "stop" itself
+		[]byte("ActiveState=inactive\n\nActiveState=active\n\nActiveState=deactivating\n"),
+		[]byte("ActiveState=failed\n\nActiveState=active\n"),
+		[]byte("ActiveState=inactive\n"),
+	}
+	err := New("", SystemMode, s.rep).Stop([]string{"foo", "bar", "baz"}, 1*time.Second)
+	c.Assert(err, IsNil)
+	c.Check(s.argses, DeepEquals, [][]string{
+		{"stop", "foo", "bar", "baz"},
+		{"show", "--property=ActiveState", "foo", "bar", "baz"},
+		{"show", "--property=ActiveState", "bar", "baz"},
+		{"show", "--property=ActiveState", "baz"},
+	})
+}
+
+func (s *SystemdTestSuite) TestStopManyTimeout(c *C) {
+	restore := MockStopDelays(time.Millisecond, 25*time.Second)
+	defer restore()
+	s.outs = [][]byte{
+		nil, // for the "stop" itself
+		[]byte("ActiveState=active\n\nActiveState=inactive\n\nActiveState=active\n"),
+	}
+	for i := 0; i < 100; i++ {
+		s.outs = append(s.outs, []byte("ActiveState=active\n\nActiveState=active\n"))
+	}
+	err := New("", SystemMode, s.rep).Stop([]string{"foo", "bar", "baz"}, 10*time.Millisecond)
+	c.Assert(err, FitsTypeOf, &Timeout{})
+	c.Check(err.(*Timeout).Services(), DeepEquals, []string{"foo", "baz"})
+	c.Check(err, ErrorMatches, "foo, baz failed to stop: timeout")
+}
+
+func (s *SystemdTestSuite) TestStopNothing(c *C) {
+	err := New("", SystemMode, s.rep).Stop(nil, 1*time.Second)
+	c.Assert(err, IsNil)
+	c.Check(s.argses, HasLen, 0)
+}
+
 func (s *SystemdTestSuite) TestStatus(c *C) {
 	s.outs = [][]byte{
 		[]byte(`
@@ -372,7 +414,7 @@ UnitFileState=enabled
 func (s *SystemdTestSuite) TestStopTimeout(c *C) {
 	restore := MockStopDelays(time.Millisecond, 25*time.Second)
 	defer restore()
-	err := New("", SystemMode, s.rep).Stop("foo", 10*time.Millisecond)
+	err := New("", SystemMode, s.rep).Stop([]string{"foo"}, 10*time.Millisecond)
 	c.Assert(err, FitsTypeOf, &Timeout{})
 	c.Assert(len(s.rep.msgs) > 0, Equals, true)
 	c.Check(s.rep.msgs[0], Equals, "Waiting for foo to stop.")
@@ -384,6 +426,12 @@ func (s *SystemdTestSuite) TestDisable(c *C) {
 	c.Check(s.argses, DeepEquals, [][]string{{"--root", "xyzzy", "disable", "foo"}})
 }
 
+func (s *SystemdTestSuite) TestDisableMany(c *C) {
+	err := New("xyzzy", SystemMode, s.rep).Disable("foo", "bar")
+	c.Assert(err, IsNil)
+	c.Check(s.argses, DeepEquals, [][]string{{"--root", "xyzzy", "disable", "foo", "bar"}})
+}
+
 func (s *SystemdTestSuite) TestAvailable(c *C) {
 	err := Available()
 	c.Assert(err, IsNil)
@@ -396,6 +444,51 @@ func (s *SystemdTestSuite) TestEnable(c *C) {
 	c.Check(s.argses, DeepEquals, [][]string{{"--root", "xyzzy", "enable", "foo"}})
 }
 
+func (s *SystemdTestSuite) TestEnableMany(c *C) {
+	err := New("xyzzy", SystemMode, s.rep).Enable("foo", "bar")
+	c.Assert(err, IsNil)
+	c.Check(s.argses, DeepEquals, [][]string{{"--root", "xyzzy", "enable", "foo", "bar"}})
+
+	// nothing to do
+	s.argses = nil
+	c.Assert(New("xyzzy", SystemMode, s.rep).Enable(), IsNil)
+	c.Check(s.argses, HasLen, 0)
+}
+
+func (s *SystemdTestSuite) TestIsEnabledMany(c *C) {
+	s.outs = [][]byte{[]byte("enabled\ndisabled\nstatic\n")}
+	enabled, err := New("xyzzy", SystemMode, s.rep).IsEnabledMany("foo", "bar", "baz")
+	c.Assert(err, IsNil)
+	c.Check(enabled, DeepEquals, []bool{true, false, true})
+	c.Check(s.argses, DeepEquals, [][]string{{"--root", "xyzzy", "is-enabled", "foo", "bar", "baz"}})
+}
+
+func (s *SystemdTestSuite) TestIsEnabledManyNoneEnabled(c *C) {
+	// systemctl exits with 1 when none of the units are enabled
+	sysErr := &Error{}
+	sysErr.SetExitCode(1)
+	sysErr.SetMsg([]byte("disabled\ndisabled\n"))
+	s.errors = []error{sysErr}
+	enabled, err := New("xyzzy", SystemMode, s.rep).IsEnabledMany("foo", "bar")
+	c.Assert(err, IsNil)
+	c.Check(enabled, DeepEquals, []bool{false, false})
+}
+
+func (s *SystemdTestSuite) TestIsEnabledManyErrors(c *C) {
+	sysErr := &Error{}
+	sysErr.SetExitCode(1)
+	sysErr.SetMsg([]byte("Failed to get unit file state for bar: No such file or directory\n"))
+	s.errors = []error{sysErr}
+	_, err := New("xyzzy", SystemMode, s.rep).IsEnabledMany("foo", "bar")
+	c.Assert(err, ErrorMatches, ".*No such file or directory.*")
+
+	s.i = 0
+	s.errors = nil
+	s.outs = [][]byte{[]byte("enabled\nbad\n")}
+	_, err = New("xyzzy", SystemMode, s.rep).IsEnabledMany("foo", "bar")
+	c.Assert(err, ErrorMatches, `cannot determine if service "bar" is enabled: unexpected state "bad"`)
+}
+
 func (s *SystemdTestSuite) TestMask(c *C) {
 	err := New("xyzzy", SystemMode, s.rep).Mask("foo")
 	c.Assert(err, IsNil)
@@ -791,6 +884,65 @@ func (s *SystemdTestSuite) TestDaemonReloadMutex(c *C) {
 	<-stoppedCh
 }
 
+func (s *SystemdTestSuite) TestDaemonReloadCoalesced(c *C) {
+	var mu sync.Mutex
+	reloads := 0
+	started := make(chan bool, 1)
+	unblock := make(chan bool)
+	restore := MockSystemctl(func(args ...string) ([]byte, error) {
+		if args[0] != "daemon-reload" {
+			return nil, nil
+		}
+		mu.Lock()
+		reloads++
+		n := reloads
+		mu.Unlock()
+		if n == 1 {
+			started <- true
+			<-unblock
+		}
+		return nil, nil
+	})
+	defer restore()
+
+	sysd := New("", SystemMode, s.rep)
+	var wg sync.WaitGroup
+	reload := func() {
+		defer wg.Done()
+		c.Check(sysd.DaemonReload(), IsNil)
+	}
+	wg.Add(1)
+	go reload()
+	<-started
+
+	// the tasks of 40 snaps being refreshed ask for a reload while the
+	// first one is still running
+	const snaps = 40
+	for i := 0; i < snaps; i++ {
+		wg.Add(1)
+		go reload()
+	}
+	for DaemonReloadWaiters(SystemMode) != snaps {
+		time.Sleep(time.Millisecond)
+	}
+	close(unblock)
+	wg.Wait()
+
+	// they all shared a single reload after the first one
+	c.Check(reloads, Equals, 2)
+	c.Check(DaemonReloadWaiters(SystemMode), Equals, 0)
+}
+
+func (s *SystemdTestSuite) TestDaemonReloadCoalescedError(c *C) {
+	restore := MockSystemctl(func(args ...string) ([]byte, error) {
+		return nil, fmt.Errorf("boom")
+	})
+	defer restore()
+
+	err := New("", SystemMode, s.rep).DaemonReload()
+	c.Check(err, ErrorMatches, "boom")
+}
+
 func (s *SystemdTestSuite) TestUserMode(c *C) {
 	rootDir := dirs.GlobalRootDir
 	sysd := New(rootDir, UserMode, nil)
@@ -818,10 +970,11 @@ func (s *SystemdTestSuite) TestGlobalUserMode(c *C) {
 	c.Check(sysd.DaemonReload, Panics, "cannot call daemon-reload with GlobalUserMode")
 	c.Check(func() { sysd.Start("foo") }, Panics, "cannot call start with GlobalUserMode")
 	c.Check(func() { sysd.StartNoBlock("foo") }, Panics, "cannot call start with GlobalUserMode")
-	c.Check(func() { sysd.Stop("foo", 0) }, Panics, "cannot call stop with GlobalUserMode")
+	c.Check(func() { sysd.Stop([]string{"foo"}, 0) }, Panics, "cannot call stop with GlobalUserMode")
 	c.Check(func() { sysd.Restart("foo", 0) }, Panics, "cannot call restart with GlobalUserMode")
 	c.Check(func() { sysd.Kill("foo", "HUP", "") }, Panics, "cannot call kill with GlobalUserMode")
 	c.Check(func() { sysd.Status("foo") }, Panics, "cannot call status with GlobalUserMode")
 	c.Check(func() { sysd.IsEnabled("foo") }, Panics, "cannot call is-enabled with GlobalUserMode")
+	c.Check(func() { sysd.IsEnabledMany("foo", "bar") }, Panics, "cannot call is-enabled with GlobalUserMode")
 	c.Check(func() { sysd.IsActive("foo") }, Panics, "cannot call is-active with GlobalUserMode")
 }
@@ -105,6 +105,17 @@ func (t *Timings) StartSpan(label, summary string) *Span {
 	return tmeas
 }
 
+// AddSpan adds a Span for a measurement taken by other means, which
+// started at the given time and lasted for d.
+func (t *Timings) AddSpan(label, summary string, start time.Time, d time.Duration) {
+	t.timings = append(t.timings, &Span{
+		label:   label,
+		summary: summary,
+		start:   start,
+		stop:    start.Add(d),
+	})
+}
+
 // StartSpan creates a new nested Span and initiates performance measurement.
 // Nested measurements need to be stopped by calling Stop on it.
 func (t *Span) StartSpan(label, summary string) *Span {
@@ -155,6 +155,30 @@ func (s *timingsSuite) TestSave(c *C) {
 			}}})
 }
 
+func (s *timingsSuite) TestAddSpan(c *C) {
+	s.st.Lock()
+	defer s.st.Unlock()
+
+	timing := timings.New(map[string]string{"ensure": "foo"})
+	timing.AddSpan("slow", "...", s.fakeTime, 7*time.Millisecond)
+	timing.Save(s.st)
+
+	var stateTimings []interface{}
+	c.Assert(s.st.Get("timings", &stateTimings), IsNil)
+	c.Assert(stateTimings, DeepEquals, []interface{}{
+		map[string]interface{}{
+			"tags":       map[string]interface{}{"ensure": "foo"},
+			"start-time": "2019-03-11T09:01:00Z",
+			"stop-time":  "2019-03-11T09:01:00.007Z",
+			"timings": []interface{}{
+				map[string]interface{}{
+					"label":    "slow",
+					"summary":  "...",
+					"duration": float64(7000000),
+				},
+			}}})
+}
+
 func (s *timingsSuite) TestSaveNoTimings(c *C) {
 	s.mockDuration(c)
 
@@ -138,7 +138,7 @@ func writeSnapdServicesOnCore(s *snap.Info, inter interacter) error {
 	}
 	// stop all removed units first
 	for _, unit := range removed {
-		if err := sysd.Stop(unit, 5*time.Second); err != nil {
+		if err := sysd.Stop([]string{unit}, 5*time.Second); err != nil {
 			logger.Noticef("failed to stop %q: %v", unit, err)
 		}
 		if err := sysd.Disable(unit); err != nil {
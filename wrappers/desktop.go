@@ -234,6 +234,10 @@ func AddSnapDesktopFiles(s *snap.Info) (err error) {
 		return fmt.Errorf("cannot get desktop files for %v: %s", baseDir, err)
 	}
 
+	// The desktop files are written as one batch so that they are made
+	// durable together.
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
 	for _, df := range desktopFiles {
 		content, err := ioutil.ReadFile(df)
 		if err != nil {
@@ -246,11 +250,14 @@ func AddSnapDesktopFiles(s *snap.Info) (err error) {
 		// --create-new, --open-existing etc
 		installedDesktopFileName := filepath.Join(dirs.SnapDesktopFilesDir, fmt.Sprintf("%s_%s", desktopPrefix(s), filepath.Base(df)))
 		content = sanitizeDesktopFile(s, installedDesktopFileName, content)
-		if err := osutil.AtomicWriteFile(installedDesktopFileName, content, 0755, 0); err != nil {
+		if err := batch.WriteFile(installedDesktopFileName, content, 0755, 0); err != nil {
 			return err
 		}
 		created = append(created, installedDesktopFileName)
 	}
+	if err := batch.Commit(); err != nil {
+		return err
+	}
 
 	// updates mime info etc
 	if err := updateDesktopDatabase(desktopFiles); err != nil {
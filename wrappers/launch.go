@@ -0,0 +1,55 @@
+// -*- Mode: Go; indent-tabs-mode: t -*-
+
+/*
+ * Copyright (C) 2019 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+package wrappers
+
+import (
+	"encoding/json"
+	"os"
+
+	"github.com/snapcore/snapd/dirs"
+	"github.com/snapcore/snapd/osutil"
+	"github.com/snapcore/snapd/snap"
+)
+
+// AddSnapLaunchDescriptor writes the launch descriptor of the snap used
+// by "snap run" to start its apps and hooks without parsing snap.yaml.
+func AddSnapLaunchDescriptor(s *snap.Info) error {
+	desc, err := snap.NewLaunchDescriptor(s)
+	if err != nil {
+		return err
+	}
+	content, err := json.Marshal(desc)
+	if err != nil {
+		return err
+	}
+	if err := os.MkdirAll(dirs.SnapLaunchDir, 0755); err != nil {
+		return err
+	}
+	return osutil.AtomicWriteFile(snap.LaunchDescriptorFile(s.InstanceName()), content, 0644, 0)
+}
+
+// RemoveSnapLaunchDescriptor removes the launch descriptor of the snap.
+func RemoveSnapLaunchDescriptor(s *snap.Info) error {
+	err := os.Remove(snap.LaunchDescriptorFile(s.InstanceName()))
+	if err != nil && !os.IsNotExist(err) {
+		return err
+	}
+	return nil
+}
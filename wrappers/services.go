@@ -63,40 +63,62 @@ func generateSnapServiceFile(app *snap.AppInfo) ([]byte, error) {
 	return genServiceFile(app), nil
 }
 
-func stopService(sysd systemd.Systemd, app *snap.AppInfo, inter interacter) error {
-	serviceName := app.ServiceName()
-	tout := serviceStopTimeout(app)
-
-	stopErrors := []error{}
+// activatorUnits returns the names of the socket and timer units that
+// activate the service of the given app.
+func activatorUnits(app *snap.AppInfo) []string {
+	var units []string
 	for _, socket := range app.Sockets {
-		if err := sysd.Stop(filepath.Base(socket.File()), tout); err != nil {
-			stopErrors = append(stopErrors, err)
-		}
+		units = append(units, filepath.Base(socket.File()))
 	}
-
 	if app.Timer != nil {
-		if err := sysd.Stop(filepath.Base(app.Timer.File()), tout); err != nil {
-			stopErrors = append(stopErrors, err)
+		units = append(units, filepath.Base(app.Timer.File()))
+	}
+	return units
+}
+
+// stopServices stops the services of the given apps. The socket and timer
+// units of all the apps are stopped first with a single call to systemd,
+// then all the services are stopped together as well, each group waiting for
+// as long as the longest stop timeout among its apps.
+func stopServices(sysd systemd.Systemd, apps []*snap.AppInfo, inter interacter) error {
+	var activators, services []string
+	var activatorsTout, servicesTout time.Duration
+	for _, app := range apps {
+		tout := serviceStopTimeout(app)
+		if units := activatorUnits(app); len(units) > 0 {
+			activators = append(activators, units...)
+			if tout > activatorsTout {
+				activatorsTout = tout
+			}
+		}
+		services = append(services, app.ServiceName())
+		if tout > servicesTout {
+			servicesTout = tout
 		}
 	}
 
-	if err := sysd.Stop(serviceName, tout); err != nil {
-		if !systemd.IsTimeout(err) {
+	stopErr := sysd.Stop(activators, activatorsTout)
+
+	if err := sysd.Stop(services, servicesTout); err != nil {
+		timeoutErr, ok := err.(*systemd.Timeout)
+		if !ok {
 			return err
 		}
-		inter.Notify(fmt.Sprintf("%s refused to stop, killing.", serviceName))
+		stuck := timeoutErr.Services()
+		for _, serviceName := range stuck {
+			inter.Notify(fmt.Sprintf("%s refused to stop, killing.", serviceName))
+		}
 		// ignore errors for kill; nothing we'd do differently at this point
-		sysd.Kill(serviceName, "TERM", "")
+		for _, serviceName := range stuck {
+			sysd.Kill(serviceName, "TERM", "")
+		}
 		time.Sleep(killWait)
-		sysd.Kill(serviceName, "KILL", "")
-
-	}
-
-	if len(stopErrors) > 0 {
-		return stopErrors[0]
+		for _, serviceName := range stuck {
+			sysd.Kill(serviceName, "KILL", "")
+		}
 	}
 
-	return nil
+	return stopErr
 }
 
 // StartServices starts service units for the applications from the snap which
@@ -105,77 +127,66 @@ func stopService(sysd systemd.Systemd, app *snap.AppInfo, inter interacter) erro
 func StartServices(apps []*snap.AppInfo, inter interacter, tm timings.Measurer) (err error) {
 	sysd := systemd.New(dirs.GlobalRootDir, systemd.SystemMode, inter)
 
-	services := make([]string, 0, len(apps))
+	var serviceApps []*snap.AppInfo
+	var candidates []string
+	var activators []string
 	for _, app := range apps {
 		// they're *supposed* to be all services, but checking doesn't hurt
 		if !app.IsService() {
 			continue
 		}
+		serviceApps = append(serviceApps, app)
 
-		defer func(app *snap.AppInfo) {
-			if err == nil {
-				return
-			}
-			if e := stopService(sysd, app, inter); e != nil {
-				inter.Notify(fmt.Sprintf("While trying to stop previously started service %q: %v", app.ServiceName(), e))
-			}
-			for _, socket := range app.Sockets {
-				socketService := filepath.Base(socket.File())
-				if e := sysd.Disable(socketService); e != nil {
-					inter.Notify(fmt.Sprintf("While trying to disable previously enabled socket service %q: %v", socketService, e))
-				}
-			}
-			if app.Timer != nil {
-				timerService := filepath.Base(app.Timer.File())
-				if e := sysd.Disable(timerService); e != nil {
-					inter.Notify(fmt.Sprintf("While trying to disable previously enabled timer service %q: %v", timerService, e))
-				}
-			}
-		}(app)
-
-		if len(app.Sockets) == 0 && app.Timer == nil {
-			// check if the service is disabled, if so don't start it up
-			// this could happen for example if the service was disabled in
-			// the install hook by snapctl or if the service was disabled in
-			// the previous installation
-			isEnabled, err := sysd.IsEnabled(app.ServiceName())
-			if err != nil {
-				return err
-			}
-
-			if isEnabled {
-				services = append(services, app.ServiceName())
-			}
+		if units := activatorUnits(app); len(units) > 0 {
+			activators = append(activators, units...)
+		} else {
+			candidates = append(candidates, app.ServiceName())
 		}
+	}
 
-		for _, socket := range app.Sockets {
-			socketService := filepath.Base(socket.File())
-			// enable the socket
-			if err := sysd.Enable(socketService); err != nil {
-				return err
-			}
-
-			timings.Run(tm, "start-socket-service", fmt.Sprintf("start socket service %q", socketService), func(nested timings.Measurer) {
-				err = sysd.Start(socketService)
-			})
-			if err != nil {
-				return err
-			}
+	var enabledActivators bool
+	defer func() {
+		if err == nil {
+			return
+		}
+		if e := stopServices(sysd, serviceApps, inter); e != nil {
+			inter.Notify(fmt.Sprintf("While trying to stop previously started services: %v", e))
+		}
+		if !enabledActivators {
+			return
 		}
+		if e := sysd.Disable(activators...); e != nil {
+			inter.Notify(fmt.Sprintf("While trying to disable previously enabled socket and timer services %q: %v", activators, e))
+		}
+	}()
 
-		if app.Timer != nil {
-			timerService := filepath.Base(app.Timer.File())
-			// enable the timer
-			if err := sysd.Enable(timerService); err != nil {
-				return err
-			}
+	// check if the services are disabled, if so don't start them up
+	// this could happen for example if the service was disabled in
+	// the install hook by snapctl or if the service was disabled in
+	// the previous installation
+	isEnabled, err := sysd.IsEnabledMany(candidates...)
+	if err != nil {
+		return err
+	}
+	services := make([]string, 0, len(candidates))
+	for i, srv := range candidates {
+		if isEnabled[i] {
+			services = append(services, srv)
+		}
+	}
 
-			timings.Run(tm, "start-timer-service", fmt.Sprintf("start timer service %q", timerService), func(nested timings.Measurer) {
-				err = sysd.Start(timerService)
-			})
-			if err != nil {
-				return err
-			}
+	if len(activators) > 0 {
+		// enable and start all the sockets and timers together, they
+		// only need to be in place before the services they activate
+		enabledActivators = true
+		if err := sysd.Enable(activators...); err != nil {
+			return err
+		}
+		timings.Run(tm, "start-activator-services", fmt.Sprintf("start socket and timer services %q", activators), func(nested timings.Measurer) {
+			err = sysd.Start(activators...)
+		})
+		if err != nil {
+			return err
 		}
 	}
 
@@ -190,7 +201,7 @@ func StartServices(apps []*snap.AppInfo, inter interacter, tm timings.Measurer)
 			err = sysd.Start(srv)
 		})
 		if err != nil {
-			// cleanup was set up by iterating over apps
+			// cleanup was set up for all the apps
 			return err
 		}
 	}
@@ -211,13 +222,13 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 		if err == nil {
 			return
 		}
-		for _, s := range enabled {
-			if e := sysd.Disable(s); e != nil {
-				inter.Notify(fmt.Sprintf("while trying to disable %s due to previous failure: %v", s, e))
+		if len(enabled) > 0 {
+			if e := sysd.Disable(enabled...); e != nil {
+				inter.Notify(fmt.Sprintf("while trying to disable %s due to previous failure: %v", strings.Join(enabled, ", "), e))
 			}
 		}
 		for _, s := range written {
-			if e := os.Remove(s); e != nil {
+			if e := os.Remove(s); e != nil && !os.IsNotExist(e) {
 				inter.Notify(fmt.Sprintf("while trying to remove %s due to previous failure: %v", s, e))
 			}
 		}
@@ -228,6 +239,12 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 		}
 	}()
 
+	// All the unit files are written as one batch so that they are made
+	// durable together.
+	batch := osutil.NewAtomicBatch()
+	defer batch.Cancel()
+	var batched []string
+	var toEnable []string
 	for _, app := range s.Apps {
 		if !app.IsService() {
 			continue
@@ -239,10 +256,10 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 		}
 		svcFilePath := app.ServiceFile()
 		os.MkdirAll(filepath.Dir(svcFilePath), 0755)
-		if err := osutil.AtomicWriteFile(svcFilePath, content, 0644, 0); err != nil {
+		if err := batch.WriteFile(svcFilePath, content, 0644, 0); err != nil {
 			return err
 		}
-		written = append(written, svcFilePath)
+		batched = append(batched, svcFilePath)
 
 		// Generate systemd .socket files if needed
 		socketFiles, err := generateSnapSocketFiles(app)
@@ -251,10 +268,10 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 		}
 		for path, content := range *socketFiles {
 			os.MkdirAll(filepath.Dir(path), 0755)
-			if err := osutil.AtomicWriteFile(path, content, 0644, 0); err != nil {
+			if err := batch.WriteFile(path, content, 0644, 0); err != nil {
 				return err
 			}
-			written = append(written, path)
+			batched = append(batched, path)
 		}
 
 		if app.Timer != nil {
@@ -264,10 +281,10 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 			}
 			path := app.Timer.File()
 			os.MkdirAll(filepath.Dir(path), 0755)
-			if err := osutil.AtomicWriteFile(path, content, 0644, 0); err != nil {
+			if err := batch.WriteFile(path, content, 0644, 0); err != nil {
 				return err
 			}
-			written = append(written, path)
+			batched = append(batched, path)
 		}
 
 		if app.Timer != nil || len(app.Sockets) != 0 {
@@ -276,11 +293,21 @@ func AddSnapServices(s *snap.Info, inter interacter) (err error) {
 			continue
 		}
 
-		svcName := app.ServiceName()
-		if err := sysd.Enable(svcName); err != nil {
+		toEnable = append(toEnable, app.ServiceName())
+	}
+
+	// Some of the files may be in place even if committing fails, so
+	// they all need to be cleaned up in that case.
+	written = batched
+	if err := batch.Commit(); err != nil {
+		return err
+	}
+
+	if len(toEnable) > 0 {
+		if err := sysd.Enable(toEnable...); err != nil {
 			return err
 		}
-		enabled = append(enabled, svcName)
+		enabled = toEnable
 	}
 
 	if len(written) > 0 {
@@ -297,6 +324,7 @@ func StopServices(apps []*snap.AppInfo, reason snap.ServiceStopReason, inter int
 	sysd := systemd.New(dirs.GlobalRootDir, systemd.SystemMode, inter)
 
 	logger.Debugf("StopServices called for %q, reason: %v", apps, reason)
+	var toStop []*snap.AppInfo
 	for _, app := range apps {
 		// Handle the case where service file doesn't exist and don't try to stop it as it will fail.
 		// This can happen with snap try when snap.yaml is modified on the fly and a daemon line is added.
@@ -313,24 +341,44 @@ func StopServices(apps []*snap.AppInfo, reason snap.ServiceStopReason, inter int
 				continue
 			}
 		}
+		toStop = append(toStop, app)
+	}
+	if len(toStop) == 0 {
+		return nil
+	}
 
-		var err error
-		timings.Run(tm, "stop-service", fmt.Sprintf("stop service %q", app.ServiceName()), func(nested timings.Measurer) {
-			err = stopService(sysd, app, inter)
-		})
-		if err != nil {
-			return err
-		}
+	serviceNames := make([]string, len(toStop))
+	for i, app := range toStop {
+		serviceNames[i] = app.ServiceName()
+	}
+	var err error
+	timings.Run(tm, "stop-services", fmt.Sprintf("stop services %q", serviceNames), func(nested timings.Measurer) {
+		err = stopServices(sysd, toStop, inter)
+	})
+	if err != nil {
+		return err
+	}
 
-		// ensure the service is really stopped on remove regardless
-		// of stop-mode
-		if reason == snap.StopReasonRemove && !app.StopMode.KillAll() {
+	// ensure the services are really stopped on remove regardless
+	// of stop-mode
+	if reason == snap.StopReasonRemove {
+		var toKill []string
+		for _, app := range toStop {
+			if !app.StopMode.KillAll() {
+				toKill = append(toKill, app.ServiceName())
+			}
+		}
+		if len(toKill) > 0 {
 			// FIXME: make this smarter and avoid the killWait
 			//        delay if not needed (i.e. if all processes
 			//        have died)
-			sysd.Kill(app.ServiceName(), "TERM", "all")
+			for _, serviceName := range toKill {
+				sysd.Kill(serviceName, "TERM", "all")
+			}
 			time.Sleep(killWait)
-			sysd.Kill(app.ServiceName(), "KILL", "")
+			for _, serviceName := range toKill {
+				sysd.Kill(serviceName, "KILL", "")
+			}
 		}
 	}
 
@@ -341,23 +389,32 @@ func StopServices(apps []*snap.AppInfo, reason snap.ServiceStopReason, inter int
 // RemoveSnapServices disables and removes service units for the applications from the snap which are services.
 func RemoveSnapServices(s *snap.Info, inter interacter) error {
 	sysd := systemd.New(dirs.GlobalRootDir, systemd.SystemMode, inter)
-	nservices := 0
 
+	var apps []*snap.AppInfo
+	var units []string
 	for _, app := range s.Apps {
 		if !app.IsService() || !osutil.FileExists(app.ServiceFile()) {
 			continue
 		}
-		nservices++
+		apps = append(apps, app)
+		units = append(units, activatorUnits(app)...)
+		units = append(units, filepath.Base(app.ServiceFile()))
+	}
+	// only disable and reload if we actually had services
+	if len(apps) == 0 {
+		return nil
+	}
+
+	// all the units are disabled with a single call to systemd
+	if err := sysd.Disable(units...); err != nil {
+		return err
+	}
 
+	for _, app := range apps {
 		serviceName := filepath.Base(app.ServiceFile())
 
 		for _, socket := range app.Sockets {
 			path := socket.File()
-			socketServiceName := filepath.Base(path)
-			if err := sysd.Disable(socketServiceName); err != nil {
-				return err
-			}
-
 			if err := os.Remove(path); err != nil && !os.IsNotExist(err) {
 				logger.Noticef("Failed to remove socket file %q for %q: %v", path, serviceName, err)
 			}
@@ -365,32 +422,18 @@ func RemoveSnapServices(s *snap.Info, inter interacter) error {
 
 		if app.Timer != nil {
 			path := app.Timer.File()
-
-			timerName := filepath.Base(path)
-			if err := sysd.Disable(timerName); err != nil {
-				return err
-			}
-
 			if err := os.Remove(path); err != nil && !os.IsNotExist(err) {
 				logger.Noticef("Failed to remove timer file %q for %q: %v", path, serviceName, err)
 			}
 		}
 
-		if err := sysd.Disable(serviceName); err != nil {
-			return err
-		}
-
 		if err := os.Remove(app.ServiceFile()); err != nil && !os.IsNotExist(err) {
 			logger.Noticef("Failed to remove service file for %q: %v", serviceName, err)
 		}
-
 	}
 
-	// only reload if we actually had services
-	if nservices > 0 {
-		if err := sysd.DaemonReload(); err != nil {
-			return err
-		}
+	if err := sysd.DaemonReload(); err != nil {
+		return err
 	}
 
 	return nil
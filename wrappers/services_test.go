@@ -20,6 +20,7 @@
 package wrappers_test
 
 import (
+	"bytes"
 	"fmt"
 	"io/ioutil"
 	"path/filepath"
@@ -61,13 +62,28 @@ func (s *servicesTestSuite) SetUpTest(c *C) {
 
 	s.systemctlRestorer = systemd.MockSystemctl(func(cmd ...string) ([]byte, error) {
 		s.sysdLog = append(s.sysdLog, cmd)
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	s.delaysRestorer = systemd.MockStopDelays(time.Millisecond, 25*time.Second)
 	s.perfTimings = timings.New(nil)
 
 }
 
+// systemctlOutput returns what systemctl would print for the given command
+// if all the units involved were enabled and inactive.
+func systemctlOutput(cmd []string) []byte {
+	if len(cmd) > 2 && cmd[0] == "--root" {
+		cmd = cmd[2:]
+	}
+	switch {
+	case len(cmd) > 1 && cmd[0] == "is-enabled":
+		return []byte(strings.Repeat("enabled\n", len(cmd)-1))
+	case len(cmd) > 2 && cmd[0] == "show" && cmd[1] == "--property=ActiveState":
+		return []byte(strings.Repeat("ActiveState=inactive\n\n", len(cmd)-2))
+	}
+	return []byte("ActiveState=inactive\n")
+}
+
 func (s *servicesTestSuite) TearDownTest(c *C) {
 	dirs.SetRootDir("")
 	s.systemctlRestorer()
@@ -193,9 +209,9 @@ func (s *servicesTestSuite) TestStopServicesWithSockets(c *C) {
 	var sysdLog []string
 	r := systemd.MockSystemctl(func(cmd ...string) ([]byte, error) {
 		if cmd[0] == "stop" {
-			sysdLog = append(sysdLog, cmd[1])
+			sysdLog = append(sysdLog, cmd[1:]...)
 		}
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -476,7 +492,7 @@ func (s *servicesTestSuite) TestStartSnapMultiServicesFailStartCleanup(c *C) {
 				return nil, fmt.Errorf("failed")
 			}
 		}
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -493,16 +509,13 @@ func (s *servicesTestSuite) TestStartSnapMultiServicesFailStartCleanup(c *C) {
 	}
 	err := wrappers.StartServices(svcs, nil, s.perfTimings)
 	c.Assert(err, ErrorMatches, "failed")
-	c.Assert(sysdLog, HasLen, 8, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
+	c.Assert(sysdLog, HasLen, 5, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
 	c.Check(sysdLog, DeepEquals, [][]string{
-		{"--root", s.tempdir, "is-enabled", svc1Name},
-		{"--root", s.tempdir, "is-enabled", svc2Name},
+		{"--root", s.tempdir, "is-enabled", svc1Name, svc2Name},
 		{"start", svc1Name},
 		{"start", svc2Name}, // one of the services fails
-		{"stop", svc2Name},
-		{"show", "--property=ActiveState", svc2Name},
-		{"stop", svc1Name},
-		{"show", "--property=ActiveState", svc1Name},
+		{"stop", svc1Name, svc2Name},
+		{"show", "--property=ActiveState", svc1Name, svc2Name},
 	}, Commentf("calls: %v", sysdLog))
 }
 
@@ -517,11 +530,11 @@ func (s *servicesTestSuite) TestStartSnapMultiServicesFailStartCleanupWithSocket
 	r := systemd.MockSystemctl(func(cmd ...string) ([]byte, error) {
 		sysdLog = append(sysdLog, cmd)
 		c.Logf("call: %v", cmd)
-		if len(cmd) >= 2 && cmd[0] == "start" && cmd[1] == svc3SocketName {
-			// svc2 socket fails
+		if len(cmd) >= 2 && cmd[0] == "start" && strutil.ListContains(cmd[1:], svc3SocketName) {
+			// svc3 socket fails
 			return nil, fmt.Errorf("failed")
 		}
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -548,25 +561,16 @@ func (s *servicesTestSuite) TestStartSnapMultiServicesFailStartCleanupWithSocket
 	err := wrappers.StartServices(apps, nil, s.perfTimings)
 	c.Assert(err, ErrorMatches, "failed")
 	c.Logf("sysdlog: %v", sysdLog)
-	c.Assert(sysdLog, HasLen, 17, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
+	c.Assert(sysdLog, HasLen, 8, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
 	c.Check(sysdLog, DeepEquals, [][]string{
 		{"--root", s.tempdir, "is-enabled", svc1Name},
-		{"--root", s.tempdir, "enable", svc2SocketName},
-		{"start", svc2SocketName},
-		{"--root", s.tempdir, "enable", svc3SocketName},
-		{"start", svc3SocketName}, // start failed, what follows is the cleanup
-		{"stop", svc3SocketName},
-		{"show", "--property=ActiveState", svc3SocketName},
-		{"stop", svc3Name},
-		{"show", "--property=ActiveState", svc3Name},
-		{"--root", s.tempdir, "disable", svc3SocketName},
-		{"stop", svc2SocketName},
-		{"show", "--property=ActiveState", svc2SocketName},
-		{"stop", svc2Name},
-		{"show", "--property=ActiveState", svc2Name},
-		{"--root", s.tempdir, "disable", svc2SocketName},
-		{"stop", svc1Name},
-		{"show", "--property=ActiveState", svc1Name},
+		{"--root", s.tempdir, "enable", svc2SocketName, svc3SocketName},
+		{"start", svc2SocketName, svc3SocketName}, // start failed, what follows is the cleanup
+		{"stop", svc2SocketName, svc3SocketName},
+		{"show", "--property=ActiveState", svc2SocketName, svc3SocketName},
+		{"stop", svc1Name, svc2Name, svc3Name},
+		{"show", "--property=ActiveState", svc1Name, svc2Name, svc3Name},
+		{"--root", s.tempdir, "disable", svc2SocketName, svc3SocketName},
 	}, Commentf("calls: %v", sysdLog))
 }
 
@@ -578,7 +582,7 @@ func (s *servicesTestSuite) TestStartSnapServicesKeepsOrder(c *C) {
 
 	r := systemd.MockSystemctl(func(cmd ...string) ([]byte, error) {
 		sysdLog = append(sysdLog, cmd)
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -603,11 +607,9 @@ apps:
 
 	err = wrappers.StartServices(sorted, nil, s.perfTimings)
 	c.Assert(err, IsNil)
-	c.Assert(sysdLog, HasLen, 6, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
+	c.Assert(sysdLog, HasLen, 4, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
 	c.Check(sysdLog, DeepEquals, [][]string{
-		{"--root", s.tempdir, "is-enabled", svc1Name},
-		{"--root", s.tempdir, "is-enabled", svc3Name},
-		{"--root", s.tempdir, "is-enabled", svc2Name},
+		{"--root", s.tempdir, "is-enabled", svc1Name, svc3Name, svc2Name},
 		{"start", svc1Name},
 		{"start", svc3Name},
 		{"start", svc2Name},
@@ -619,11 +621,9 @@ apps:
 	// we should observe the calls done in the same order as services
 	err = wrappers.StartServices(sorted, nil, s.perfTimings)
 	c.Assert(err, IsNil)
-	c.Assert(sysdLog, HasLen, 12, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
-	c.Check(sysdLog[6:], DeepEquals, [][]string{
-		{"--root", s.tempdir, "is-enabled", svc3Name},
-		{"--root", s.tempdir, "is-enabled", svc1Name},
-		{"--root", s.tempdir, "is-enabled", svc2Name},
+	c.Assert(sysdLog, HasLen, 8, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
+	c.Check(sysdLog[4:], DeepEquals, [][]string{
+		{"--root", s.tempdir, "is-enabled", svc3Name, svc1Name, svc2Name},
 		{"start", svc3Name},
 		{"start", svc1Name},
 		{"start", svc2Name},
@@ -870,7 +870,7 @@ func (s *servicesTestSuite) TestStartSnapTimerCleanup(c *C) {
 		if len(cmd) >= 2 && cmd[0] == "start" && cmd[1] == svc2Timer {
 			return nil, fmt.Errorf("failed")
 		}
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -885,18 +885,16 @@ func (s *servicesTestSuite) TestStartSnapTimerCleanup(c *C) {
 	apps := []*snap.AppInfo{info.Apps["svc1"], info.Apps["svc2"]}
 	err := wrappers.StartServices(apps, nil, s.perfTimings)
 	c.Assert(err, ErrorMatches, "failed")
-	c.Assert(sysdLog, HasLen, 10, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
+	c.Assert(sysdLog, HasLen, 8, Commentf("len: %v calls: %v", len(sysdLog), sysdLog))
 	c.Check(sysdLog, DeepEquals, [][]string{
 		{"--root", dirs.GlobalRootDir, "is-enabled", svc1Name},
 		{"--root", dirs.GlobalRootDir, "enable", svc2Timer},
 		{"start", svc2Timer}, // this call fails
 		{"stop", svc2Timer},
 		{"show", "--property=ActiveState", svc2Timer},
-		{"stop", svc2Name},
-		{"show", "--property=ActiveState", svc2Name},
+		{"stop", svc1Name, svc2Name},
+		{"show", "--property=ActiveState", svc1Name, svc2Name},
 		{"--root", dirs.GlobalRootDir, "disable", svc2Timer},
-		{"stop", svc1Name},
-		{"show", "--property=ActiveState", svc1Name},
 	}, Commentf("calls: %v", sysdLog))
 }
 
@@ -951,7 +949,7 @@ func (s *servicesTestSuite) TestFailedAddSnapCleansUp(c *C) {
 			calls += 1
 			return nil, fmt.Errorf("failed")
 		}
-		return []byte("ActiveState=inactive\n"), nil
+		return systemctlOutput(cmd), nil
 	})
 	defer r()
 
@@ -1069,3 +1067,53 @@ func (s *servicesTestSuite) TestServiceRestartDelay(c *C) {
 	c.Assert(err, IsNil)
 	c.Check(strings.Contains(string(content), "RestartSec="), Equals, false)
 }
+
+func (s *servicesTestSuite) TestManyServicesBatchedSystemctlCalls(c *C) {
+	var yaml bytes.Buffer
+	yaml.WriteString("name: many-snap\nversion: 1.0\napps:\n")
+	for i := 0; i < 30; i++ {
+		fmt.Fprintf(&yaml, " svc%d:\n  command: bin/svc\n  daemon: simple\n", i)
+	}
+	yaml.WriteString(" sock:\n  command: bin/svc\n  daemon: simple\n  plugs: [network-bind]\n  sockets:\n    sock1:\n      listen-stream: $SNAP_COMMON/sock1.socket\n")
+	yaml.WriteString(" timer:\n  command: bin/svc\n  daemon: oneshot\n  timer: 10:00-12:00\n")
+	info := snaptest.MockSnap(c, yaml.String(), &snap.SideInfo{Revision: snap.R(1)})
+	svcs := info.Services()
+	c.Assert(svcs, HasLen, 32)
+	sort.Slice(svcs, func(i, j int) bool { return svcs[i].Name < svcs[j].Name })
+
+	err := wrappers.AddSnapServices(info, nil)
+	c.Assert(err, IsNil)
+	// a single enable for all the services plus the daemon-reload
+	c.Check(s.sysdLog, HasLen, 2)
+	c.Check(s.sysdLog[0][:3], DeepEquals, []string{"--root", dirs.GlobalRootDir, "enable"})
+	c.Check(s.sysdLog[0][3:], HasLen, 30)
+
+	s.sysdLog = nil
+	err = wrappers.StartServices(svcs, nil, s.perfTimings)
+	c.Assert(err, IsNil)
+	// one is-enabled for all the services, one enable and one start for
+	// the socket and timer, and one start per service to keep the order
+	c.Check(s.sysdLog, HasLen, 3+30)
+	c.Check(s.sysdLog[0][:3], DeepEquals, []string{"--root", dirs.GlobalRootDir, "is-enabled"})
+	c.Check(s.sysdLog[0][3:], HasLen, 30)
+	c.Check(s.sysdLog[1], DeepEquals, []string{"--root", dirs.GlobalRootDir, "enable", "snap.many-snap.sock.sock1.socket", "snap.many-snap.timer.timer"})
+	c.Check(s.sysdLog[2], DeepEquals, []string{"start", "snap.many-snap.sock.sock1.socket", "snap.many-snap.timer.timer"})
+
+	s.sysdLog = nil
+	err = wrappers.StopServices(svcs, "", progress.Null, s.perfTimings)
+	c.Assert(err, IsNil)
+	// the socket and timer are stopped together, then all the services
+	c.Assert(s.sysdLog, HasLen, 4)
+	c.Check(s.sysdLog[0], DeepEquals, []string{"stop", "snap.many-snap.sock.sock1.socket", "snap.many-snap.timer.timer"})
+	c.Check(s.sysdLog[2][0], Equals, "stop")
+	c.Check(s.sysdLog[2][1:], HasLen, 32)
+
+	s.sysdLog = nil
+	err = wrappers.RemoveSnapServices(info, progress.Null)
+	c.Assert(err, IsNil)
+	// a single disable for all the units plus the daemon-reload
+	c.Assert(s.sysdLog, HasLen, 2)
+	c.Check(s.sysdLog[0][:3], DeepEquals, []string{"--root", dirs.GlobalRootDir, "disable"})
+	c.Check(s.sysdLog[0][3:], HasLen, 34)
+	c.Check(s.sysdLog[1], DeepEquals, []string{"daemon-reload"})
+}